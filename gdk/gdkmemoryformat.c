@@ -25,6 +25,15 @@
 
 #include <epoxy/gl.h>
 
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_AMD64)))
+#define HAVE_CONVERT_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+/* vector division is only available on AArch64 */
+#define HAVE_CONVERT_NEON 1
+#include <arm_neon.h>
+#endif
+
 typedef struct _GdkMemoryFormatDescription GdkMemoryFormatDescription;
 
 #define TYPED_FUNCS(name, T, R, G, B, A, bpp, scale) \
@@ -274,6 +283,9 @@ struct _GdkMemoryFormatDescription
   /* no premultiplication going on here */
   void (* to_float) (float *, const guchar*, gsize);
   void (* from_float) (guchar *, const float *, gsize);
+  /* index of red, green, blue and alpha in units of the channel type,
+   * -1 if not present. Gray formats use the same index for all colors */
+  gint8 channels[4];
 };
 
 #if  G_BYTE_ORDER == G_LITTLE_ENDIAN
@@ -294,6 +306,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGBA8, GL_BGRA, GL_UNSIGNED_BYTE, { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } },
     b8g8r8a8_premultiplied_to_float,
     b8g8r8a8_premultiplied_from_float,
+    { 2, 1, 0, 3 },
   },
   [GDK_MEMORY_A8R8G8B8_PREMULTIPLIED] = {
     GDK_MEMORY_ALPHA_PREMULTIPLIED,
@@ -304,6 +317,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGBA8, GL_BGRA, GDK_GL_UNSIGNED_BYTE_FLIPPED, { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } },
     a8r8g8b8_premultiplied_to_float,
     a8r8g8b8_premultiplied_from_float,
+    { 1, 2, 3, 0 },
   },
   [GDK_MEMORY_R8G8B8A8_PREMULTIPLIED] = {
     GDK_MEMORY_ALPHA_PREMULTIPLIED,
@@ -314,6 +328,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } },
     r8g8b8a8_premultiplied_to_float,
     r8g8b8a8_premultiplied_from_float,
+    { 0, 1, 2, 3 },
   },
   [GDK_MEMORY_B8G8R8A8] = {
     GDK_MEMORY_ALPHA_STRAIGHT,
@@ -324,6 +339,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGBA8, GL_BGRA, GL_UNSIGNED_BYTE, { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } },
     b8g8r8a8_to_float,
     b8g8r8a8_from_float,
+    { 2, 1, 0, 3 },
   },
   [GDK_MEMORY_A8R8G8B8] = {
     GDK_MEMORY_ALPHA_STRAIGHT,
@@ -334,6 +350,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGBA8, GL_RGBA, GDK_GL_UNSIGNED_BYTE_FLIPPED, { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } },
     a8r8g8b8_to_float,
     a8r8g8b8_from_float,
+    { 1, 2, 3, 0 },
   },
   [GDK_MEMORY_R8G8B8A8] = {
     GDK_MEMORY_ALPHA_STRAIGHT,
@@ -344,6 +361,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } },
     r8g8b8a8_to_float,
     r8g8b8a8_from_float,
+    { 0, 1, 2, 3 },
   },
   [GDK_MEMORY_A8B8G8R8] = {
     GDK_MEMORY_ALPHA_STRAIGHT,
@@ -354,6 +372,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGBA8, GL_BGRA, GDK_GL_UNSIGNED_BYTE_FLIPPED, { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } },
     a8b8g8r8_to_float,
     a8b8g8r8_from_float,
+    { 3, 2, 1, 0 },
   },
   [GDK_MEMORY_R8G8B8] = {
     GDK_MEMORY_ALPHA_OPAQUE,
@@ -364,6 +383,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE, { GL_RED, GL_GREEN, GL_BLUE, GL_ONE } },
     r8g8b8_to_float,
     r8g8b8_from_float,
+    { 0, 1, 2, -1 },
   },
   [GDK_MEMORY_B8G8R8] = {
     GDK_MEMORY_ALPHA_OPAQUE,
@@ -374,6 +394,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGB8, GL_BGR, GL_UNSIGNED_BYTE, { GL_RED, GL_GREEN, GL_BLUE, GL_ONE } },
     b8g8r8_to_float,
     b8g8r8_from_float,
+    { 2, 1, 0, -1 },
   },
   [GDK_MEMORY_R16G16B16] = {
     GDK_MEMORY_ALPHA_OPAQUE,
@@ -384,6 +405,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGB16, GL_RGB, GL_UNSIGNED_SHORT, { GL_RED, GL_GREEN, GL_BLUE, GL_ONE } },
     r16g16b16_to_float,
     r16g16b16_from_float,
+    { 0, 1, 2, -1 },
   },
   [GDK_MEMORY_R16G16B16A16_PREMULTIPLIED] = {
     GDK_MEMORY_ALPHA_PREMULTIPLIED,
@@ -394,6 +416,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGBA16, GL_RGBA, GL_UNSIGNED_SHORT, { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } },
     r16g16b16a16_to_float,
     r16g16b16a16_from_float,
+    { 0, 1, 2, 3 },
   },
   [GDK_MEMORY_R16G16B16A16] = {
     GDK_MEMORY_ALPHA_STRAIGHT,
@@ -404,6 +427,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGBA16, GL_RGBA, GL_UNSIGNED_SHORT, { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } },
     r16g16b16a16_to_float,
     r16g16b16a16_from_float,
+    { 0, 1, 2, 3 },
   },
   [GDK_MEMORY_R16G16B16_FLOAT] = {
     GDK_MEMORY_ALPHA_OPAQUE,
@@ -414,6 +438,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGB16F, GL_RGB, GL_HALF_FLOAT, { GL_RED, GL_GREEN, GL_BLUE, GL_ONE } },
     r16g16b16_float_to_float,
     r16g16b16_float_from_float,
+    { 0, 1, 2, -1 },
   },
   [GDK_MEMORY_R16G16B16A16_FLOAT_PREMULTIPLIED] = {
     GDK_MEMORY_ALPHA_PREMULTIPLIED,
@@ -424,6 +449,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } },
     r16g16b16a16_float_to_float,
     r16g16b16a16_float_from_float,
+    { 0, 1, 2, 3 },
   },
   [GDK_MEMORY_R16G16B16A16_FLOAT] = {
     GDK_MEMORY_ALPHA_STRAIGHT,
@@ -434,6 +460,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } },
     r16g16b16a16_float_to_float,
     r16g16b16a16_float_from_float,
+    { 0, 1, 2, 3 },
   },
   [GDK_MEMORY_R32G32B32_FLOAT] = {
     GDK_MEMORY_ALPHA_OPAQUE,
@@ -444,16 +471,18 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGB32F, GL_RGB, GL_FLOAT, { GL_RED, GL_GREEN, GL_BLUE, GL_ONE } },
     r32g32b32_float_to_float,
     r32g32b32_float_from_float,
+    { 0, 1, 2, -1 },
   },
   [GDK_MEMORY_R32G32B32A32_FLOAT_PREMULTIPLIED] = {
     GDK_MEMORY_ALPHA_PREMULTIPLIED,
     16,
     G_ALIGNOF (float),
-    TRUE,
+    GDK_MEMORY_FLOAT32,
     { 0, 0, 3, 0 },
     { GL_RGBA32F, GL_RGBA, GL_FLOAT, { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } },
     r32g32b32a32_float_to_float,
     r32g32b32a32_float_from_float,
+    { 0, 1, 2, 3 },
   },
   [GDK_MEMORY_R32G32B32A32_FLOAT] = {
     GDK_MEMORY_ALPHA_STRAIGHT,
@@ -464,6 +493,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RGBA32F, GL_RGBA, GL_FLOAT, { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } },
     r32g32b32a32_float_to_float,
     r32g32b32a32_float_from_float,
+    { 0, 1, 2, 3 },
   },
   [GDK_MEMORY_G8A8_PREMULTIPLIED] = {
     GDK_MEMORY_ALPHA_PREMULTIPLIED,
@@ -474,6 +504,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RG8, GL_RG, GL_UNSIGNED_BYTE, { GL_RED, GL_RED, GL_RED, GL_GREEN } },
     g8a8_premultiplied_to_float,
     g8a8_premultiplied_from_float,
+    { 0, 0, 0, 1 },
   },
   [GDK_MEMORY_G8A8] = {
     GDK_MEMORY_ALPHA_STRAIGHT,
@@ -484,6 +515,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RG8, GL_RG, GL_UNSIGNED_BYTE, { GL_RED, GL_RED, GL_RED, GL_GREEN } },
     g8a8_to_float,
     g8a8_from_float,
+    { 0, 0, 0, 1 },
   },
   [GDK_MEMORY_G8] = {
     GDK_MEMORY_ALPHA_OPAQUE,
@@ -494,6 +526,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_R8, GL_RED, GL_UNSIGNED_BYTE, { GL_RED, GL_RED, GL_RED, GL_ONE } },
     g8_to_float,
     g8_from_float,
+    { 0, 0, 0, -1 },
   },
   [GDK_MEMORY_G16A16_PREMULTIPLIED] = {
     GDK_MEMORY_ALPHA_PREMULTIPLIED,
@@ -504,6 +537,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RG16, GL_RG, GL_UNSIGNED_SHORT, { GL_RED, GL_RED, GL_RED, GL_GREEN } },
     g16a16_premultiplied_to_float,
     g16a16_premultiplied_from_float,
+    { 0, 0, 0, 1 },
   },
   [GDK_MEMORY_G16A16] = {
     GDK_MEMORY_ALPHA_STRAIGHT,
@@ -514,6 +548,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_RG16, GL_RG, GL_UNSIGNED_SHORT, { GL_RED, GL_RED, GL_RED, GL_GREEN } },
     g16a16_to_float,
     g16a16_from_float,
+    { 0, 0, 0, 1 },
   },
   [GDK_MEMORY_G16] = {
     GDK_MEMORY_ALPHA_OPAQUE,
@@ -524,6 +559,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_R16, GL_RED, GL_UNSIGNED_SHORT, { GL_RED, GL_RED, GL_RED, GL_ONE } },
     g16_to_float,
     g16_from_float,
+    { 0, 0, 0, -1 },
   },
   [GDK_MEMORY_A8] = {
     GDK_MEMORY_ALPHA_STRAIGHT,
@@ -534,6 +570,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_R8, GL_RED, GL_UNSIGNED_BYTE, { GL_ONE, GL_ONE, GL_ONE, GL_RED } },
     a8_to_float,
     a8_from_float,
+    { -1, -1, -1, 0 },
   },
   [GDK_MEMORY_A16] = {
     GDK_MEMORY_ALPHA_STRAIGHT,
@@ -544,6 +581,7 @@ static const GdkMemoryFormatDescription memory_formats[GDK_MEMORY_N_FORMATS] = {
     { GL_R16, GL_RED, GL_UNSIGNED_SHORT, { GL_ONE, GL_ONE, GL_ONE, GL_RED } },
     a16_to_float,
     a16_from_float,
+    { -1, -1, -1, 0 },
   }
 };
 
@@ -656,6 +694,28 @@ static void
 premultiply (float *rgba,
              gsize  n)
 {
+#if defined(HAVE_CONVERT_SSE2)
+  const __m128 color_mask = _mm_castsi128_ps (_mm_setr_epi32 (-1, -1, -1, 0));
+
+  for (gsize i = 0; i < n; i++)
+    {
+      __m128 v = _mm_loadu_ps (rgba);
+      __m128 a = _mm_shuffle_ps (v, v, _MM_SHUFFLE (3, 3, 3, 3));
+      __m128 p = _mm_mul_ps (v, a);
+
+      _mm_storeu_ps (rgba, _mm_or_ps (_mm_and_ps (color_mask, p),
+                                      _mm_andnot_ps (color_mask, v)));
+      rgba += 4;
+    }
+#elif defined(HAVE_CONVERT_NEON)
+  for (gsize i = 0; i < n; i++)
+    {
+      float32x4_t v = vld1q_f32 (rgba);
+
+      vst1q_f32 (rgba, vsetq_lane_f32 (rgba[3], vmulq_n_f32 (v, rgba[3]), 3));
+      rgba += 4;
+    }
+#else
   for (gsize i = 0; i < n; i++)
     {
       rgba[0] *= rgba[3];
@@ -663,12 +723,44 @@ premultiply (float *rgba,
       rgba[2] *= rgba[3];
       rgba += 4;
     }
+#endif
 }
 
 static void
 unpremultiply (float *rgba,
                gsize  n)
 {
+#if defined(HAVE_CONVERT_SSE2)
+  const __m128 color_mask = _mm_castsi128_ps (_mm_setr_epi32 (-1, -1, -1, 0));
+  /* (float) 1/255 rounds up, so >= matches the scalar "> 1/255.0" */
+  const __m128 threshold = _mm_set1_ps (1/255.0);
+
+  for (gsize i = 0; i < n; i++)
+    {
+      __m128 v = _mm_loadu_ps (rgba);
+      __m128 a = _mm_shuffle_ps (v, v, _MM_SHUFFLE (3, 3, 3, 3));
+      __m128 mask = _mm_and_ps (color_mask, _mm_cmpge_ps (a, threshold));
+      __m128 d = _mm_div_ps (v, _mm_max_ps (a, threshold));
+
+      _mm_storeu_ps (rgba, _mm_or_ps (_mm_and_ps (mask, d),
+                                      _mm_andnot_ps (mask, v)));
+      rgba += 4;
+    }
+#elif defined(HAVE_CONVERT_NEON)
+  const uint32x4_t color_mask = vsetq_lane_u32 (0, vdupq_n_u32 (0xffffffff), 3);
+  const float32x4_t threshold = vdupq_n_f32 (1/255.0);
+
+  for (gsize i = 0; i < n; i++)
+    {
+      float32x4_t v = vld1q_f32 (rgba);
+      float32x4_t a = vdupq_laneq_f32 (v, 3);
+      uint32x4_t mask = vandq_u32 (color_mask, vcgeq_f32 (a, threshold));
+      float32x4_t d = vdivq_f32 (v, vmaxq_f32 (a, threshold));
+
+      vst1q_f32 (rgba, vbslq_f32 (mask, d, v));
+      rgba += 4;
+    }
+#else
   for (gsize i = 0; i < n; i++)
     {
       if (rgba[3] > 1/255.0)
@@ -679,26 +771,655 @@ unpremultiply (float *rgba,
         }
       rgba += 4;
     }
+#endif
 }
 
-void
-gdk_memory_convert (guchar              *dest_data,
-                    gsize                dest_stride,
-                    GdkMemoryFormat      dest_format,
-                    const guchar        *src_data,
-                    gsize                src_stride,
-                    GdkMemoryFormat      src_format,
-                    gsize                width,
-                    gsize                height)
+typedef enum {
+  CONVERT_COPY,
+  CONVERT_PREMULTIPLY,
+  CONVERT_UNPREMULTIPLY
+} ConvertOp;
+
+static inline guchar
+u8_premultiply (guchar c,
+                guchar a)
+{
+  guint16 t = (guint16) c * a + 128;
+
+  return (t + (t >> 8)) >> 8;
+}
+
+static inline guchar
+u8_unpremultiply (guchar c,
+                  guchar a)
+{
+  /* matches the 1/255 threshold used by unpremultiply(),
+   * which lets an alpha of exactly 1/255 through */
+  if (a == 0)
+    return c;
+
+  return MIN (((guint) c * 255 + a / 2) / a, 255);
+}
+
+static inline guint16
+u16_premultiply (guint16 c,
+                 guint16 a)
+{
+  guint32 t = (guint32) c * a + 32768;
+
+  return (t + (t >> 16)) >> 16;
+}
+
+static inline guint16
+u16_unpremultiply (guint16 c,
+                   guint16 a)
+{
+  if (a < 257)
+    return c;
+
+  return MIN (((guint32) c * 65535 + a / 2) / a, 65535);
+}
+
+static inline float
+f32_premultiply (float c,
+                 float a)
+{
+  return c * a;
+}
+
+static inline float
+f32_unpremultiply (float c,
+                   float a)
+{
+  if (a <= 1/255.0)
+    return c;
+
+  return c / a;
+}
+
+/* Generates a direct converter between two formats with the same
+ * channel type. The channel positions are loop invariants, so the
+ * compiler can keep them in registers and the loop stays free of
+ * any float conversion.
+ */
+#define DIRECT_CONVERT_FUNC(name, T, premultiply_func, unpremultiply_func) \
+static void \
+name (guchar                           *dest_data, \
+      const GdkMemoryFormatDescription *dest_desc, \
+      const guchar                     *src_data, \
+      const GdkMemoryFormatDescription *src_desc, \
+      ConvertOp                         op, \
+      T                                 one, \
+      gsize                             n) \
+{ \
+  const int sr = src_desc->channels[0], sg = src_desc->channels[1]; \
+  const int sb = src_desc->channels[2], sa = src_desc->channels[3]; \
+  const int dr = dest_desc->channels[0], dg = dest_desc->channels[1]; \
+  const int db = dest_desc->channels[2], da = dest_desc->channels[3]; \
+  const gsize src_step = src_desc->bytes_per_pixel / sizeof (T); \
+  const gsize dest_step = dest_desc->bytes_per_pixel / sizeof (T); \
+  const T *src = (const T *) src_data; \
+  T *dest = (T *) dest_data; \
+\
+  for (gsize i = 0; i < n; i++) \
+    { \
+      T r = sr >= 0 ? src[sr] : one; \
+      T g = sg >= 0 ? src[sg] : one; \
+      T b = sb >= 0 ? src[sb] : one; \
+      T a = sa >= 0 ? src[sa] : one; \
+\
+      if (op == CONVERT_PREMULTIPLY) \
+        { \
+          r = premultiply_func (r, a); \
+          g = premultiply_func (g, a); \
+          b = premultiply_func (b, a); \
+        } \
+      else if (op == CONVERT_UNPREMULTIPLY) \
+        { \
+          r = unpremultiply_func (r, a); \
+          g = unpremultiply_func (g, a); \
+          b = unpremultiply_func (b, a); \
+        } \
+\
+      if (dr >= 0) dest[dr] = r; \
+      if (dg >= 0) dest[dg] = g; \
+      if (db >= 0) dest[db] = b; \
+      if (da >= 0) dest[da] = a; \
+\
+      src += src_step; \
+      dest += dest_step; \
+    } \
+}
+
+DIRECT_CONVERT_FUNC (u8_convert, guchar, u8_premultiply, u8_unpremultiply)
+DIRECT_CONVERT_FUNC (u16_convert, guint16, u16_premultiply, u16_unpremultiply)
+DIRECT_CONVERT_FUNC (f32_convert, float, f32_premultiply, f32_unpremultiply)
+
+static void
+direct_convert (guchar                           *dest_data,
+                const GdkMemoryFormatDescription *dest_desc,
+                const guchar                     *src_data,
+                const GdkMemoryFormatDescription *src_desc,
+                ConvertOp                         op,
+                gsize                             n)
+{
+  switch (src_desc->depth)
+    {
+    case GDK_MEMORY_U8:
+      u8_convert (dest_data, dest_desc, src_data, src_desc, op, 255, n);
+      break;
+    case GDK_MEMORY_U16:
+      u16_convert (dest_data, dest_desc, src_data, src_desc, op, 65535, n);
+      break;
+    case GDK_MEMORY_FLOAT16:
+      /* only reordering, so the bits can be moved as is */
+      u16_convert (dest_data, dest_desc, src_data, src_desc, op, FP16_ONE, n);
+      break;
+    case GDK_MEMORY_FLOAT32:
+      f32_convert (dest_data, dest_desc, src_data, src_desc, op, 1.0f, n);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+/* The vector versions of the direct converters compute exactly what
+ * the scalar ones do, so it doesn't matter which one a pixel ends up
+ * in. They convert as many pixels as fit into whole vectors and
+ * return how many that were, the scalar converters do the rest.
+ *
+ * Exactly means the same as the scalar direct converters. Those round
+ * after premultiplying in integer math, so both can be one step off
+ * from gdk_memory_convert_via_float().
+ */
+#if defined(HAVE_CONVERT_SSE2)
+
+/* All values are in 32-bit lanes, so the products fit in the low 16 bits */
+static inline __m128i
+u8_premultiply_sse2 (__m128i c,
+                     __m128i a)
+{
+  __m128i t = _mm_add_epi32 (_mm_mullo_epi16 (c, a), _mm_set1_epi32 (128));
+
+  return _mm_srli_epi32 (_mm_add_epi32 (t, _mm_srli_epi32 (t, 8)), 8);
+}
+
+/* The numerator fits in 16 bits, so float division rounds down to the
+ * same integer as the scalar division */
+static inline __m128i
+u8_unpremultiply_sse2 (__m128i c,
+                       __m128i a)
+{
+  __m128i num = _mm_add_epi32 (_mm_mullo_epi16 (c, _mm_set1_epi32 (255)),
+                               _mm_srli_epi32 (a, 1));
+  __m128 q = _mm_div_ps (_mm_cvtepi32_ps (num), _mm_cvtepi32_ps (a));
+  __m128i r = _mm_cvttps_epi32 (_mm_min_ps (q, _mm_set1_ps (255)));
+  __m128i keep = _mm_cmpeq_epi32 (a, _mm_setzero_si128 ());
+
+  return _mm_or_si128 (_mm_and_si128 (keep, c), _mm_andnot_si128 (keep, r));
+}
+
+static gsize
+u8_convert_simd (guchar                           *dest_data,
+                 const GdkMemoryFormatDescription *dest_desc,
+                 const guchar                     *src_data,
+                 const GdkMemoryFormatDescription *src_desc,
+                 ConvertOp                         op,
+                 gsize                             n)
+{
+  const __m128i mask = _mm_set1_epi32 (0xff);
+  __m128i src_shift[4], dest_shift[4];
+  gsize i;
+  int k;
+
+  /* Pixels are 32-bit lanes, so channels are picked with shifts */
+  for (k = 0; k < 4; k++)
+    {
+      src_shift[k] = _mm_cvtsi32_si128 (8 * src_desc->channels[k]);
+      dest_shift[k] = _mm_cvtsi32_si128 (8 * dest_desc->channels[k]);
+    }
+
+  for (i = 0; i + 4 <= n; i += 4)
+    {
+      __m128i v = _mm_loadu_si128 ((const __m128i *) (src_data + 4 * i));
+      __m128i c[4], out;
+
+      for (k = 0; k < 4; k++)
+        c[k] = _mm_and_si128 (_mm_srl_epi32 (v, src_shift[k]), mask);
+
+      if (op == CONVERT_PREMULTIPLY)
+        {
+          for (k = 0; k < 3; k++)
+            c[k] = u8_premultiply_sse2 (c[k], c[3]);
+        }
+      else if (op == CONVERT_UNPREMULTIPLY)
+        {
+          for (k = 0; k < 3; k++)
+            c[k] = u8_unpremultiply_sse2 (c[k], c[3]);
+        }
+
+      out = _mm_setzero_si128 ();
+      for (k = 0; k < 4; k++)
+        out = _mm_or_si128 (out, _mm_sll_epi32 (c[k], dest_shift[k]));
+
+      _mm_storeu_si128 ((__m128i *) (dest_data + 4 * i), out);
+    }
+
+  return i;
+}
+
+/* SSE2 can only pack with signed saturation, so shift the range */
+static inline __m128i
+u16_pack_sse2 (__m128i lo,
+               __m128i hi)
+{
+  const __m128i bias = _mm_set1_epi32 (32768);
+
+  return _mm_xor_si128 (_mm_packs_epi32 (_mm_sub_epi32 (lo, bias), _mm_sub_epi32 (hi, bias)),
+                        _mm_set1_epi16 ((short) 0x8000));
+}
+
+static inline __m128i
+u16_premultiply_sse2 (__m128i v)
+{
+  const __m128i bias = _mm_set1_epi32 (32768);
+  __m128i a = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (v, _MM_SHUFFLE (3, 3, 3, 3)),
+                                   _MM_SHUFFLE (3, 3, 3, 3));
+  __m128i lo = _mm_mullo_epi16 (v, a);
+  __m128i hi = _mm_mulhi_epu16 (v, a);
+  __m128i t0 = _mm_add_epi32 (_mm_unpacklo_epi16 (lo, hi), bias);
+  __m128i t1 = _mm_add_epi32 (_mm_unpackhi_epi16 (lo, hi), bias);
+
+  t0 = _mm_srli_epi32 (_mm_add_epi32 (t0, _mm_srli_epi32 (t0, 16)), 16);
+  t1 = _mm_srli_epi32 (_mm_add_epi32 (t1, _mm_srli_epi32 (t1, 16)), 16);
+
+  return u16_pack_sse2 (t0, t1);
+}
+
+/* The numerator needs 32 bits, so this divides in doubles, which
+ * still round down to the same integer as the scalar division */
+static inline __m128i
+u16_unpremultiply_sse2 (__m128i c)
+{
+  const __m128d max = _mm_set1_pd (65535);
+  __m128i a = _mm_shuffle_epi32 (c, _MM_SHUFFLE (3, 3, 3, 3));
+  __m128d ad = _mm_cvtepi32_pd (a);
+  __m128d half = _mm_cvtepi32_pd (_mm_srli_epi32 (a, 1));
+  __m128d q0 = _mm_div_pd (_mm_add_pd (_mm_mul_pd (_mm_cvtepi32_pd (c), max), half), ad);
+  __m128d q1 = _mm_div_pd (_mm_add_pd (_mm_mul_pd (_mm_cvtepi32_pd (_mm_srli_si128 (c, 8)), max), half), ad);
+  __m128i r = _mm_unpacklo_epi64 (_mm_cvttpd_epi32 (_mm_min_pd (q0, max)),
+                                  _mm_cvttpd_epi32 (_mm_min_pd (q1, max)));
+  __m128i keep = _mm_cmplt_epi32 (a, _mm_set1_epi32 (257));
+
+  return _mm_or_si128 (_mm_and_si128 (keep, c), _mm_andnot_si128 (keep, r));
+}
+
+static gsize
+u16_convert_rgba_simd (guchar       *dest_data,
+                       const guchar *src_data,
+                       ConvertOp     op,
+                       gsize         n)
+{
+  const __m128i alpha_mask = _mm_setr_epi16 (0, 0, 0, -1, 0, 0, 0, -1);
+  gsize i;
+
+  for (i = 0; i + 2 <= n; i += 2)
+    {
+      __m128i v = _mm_loadu_si128 ((const __m128i *) (src_data + 8 * i));
+      __m128i r;
+
+      if (op == CONVERT_PREMULTIPLY)
+        {
+          r = u16_premultiply_sse2 (v);
+        }
+      else
+        {
+          __m128i zero = _mm_setzero_si128 ();
+
+          r = u16_pack_sse2 (u16_unpremultiply_sse2 (_mm_unpacklo_epi16 (v, zero)),
+                             u16_unpremultiply_sse2 (_mm_unpackhi_epi16 (v, zero)));
+        }
+
+      r = _mm_or_si128 (_mm_and_si128 (alpha_mask, v), _mm_andnot_si128 (alpha_mask, r));
+      _mm_storeu_si128 ((__m128i *) (dest_data + 8 * i), r);
+    }
+
+  return i;
+}
+
+#elif defined(HAVE_CONVERT_NEON)
+
+static inline uint8x8_t
+u8_premultiply_neon (uint8x8_t c,
+                     uint8x8_t a)
+{
+  uint16x8_t t = vaddq_u16 (vmull_u8 (c, a), vdupq_n_u16 (128));
+
+  return vshrn_n_u16 (vaddq_u16 (t, vshrq_n_u16 (t, 8)), 8);
+}
+
+/* The numerator fits in 16 bits, so float division rounds down to the
+ * same integer as the scalar division */
+static inline uint16x4_t
+u8_unpremultiply_neon4 (uint16x4_t c,
+                        uint16x4_t a)
+{
+  uint32x4_t c32 = vmovl_u16 (c);
+  uint32x4_t a32 = vmovl_u16 (a);
+  float32x4_t num = vcvtq_f32_u32 (vmlaq_n_u32 (vshrq_n_u32 (a32, 1), c32, 255));
+  float32x4_t q = vminq_f32 (vdivq_f32 (num, vcvtq_f32_u32 (a32)), vdupq_n_f32 (255));
+
+  return vmovn_u32 (vbslq_u32 (vceqq_u32 (a32, vdupq_n_u32 (0)), c32, vcvtq_u32_f32 (q)));
+}
+
+static inline uint8x8_t
+u8_unpremultiply_neon (uint8x8_t c,
+                       uint8x8_t a)
+{
+  uint16x8_t c16 = vmovl_u8 (c);
+  uint16x8_t a16 = vmovl_u8 (a);
+
+  return vmovn_u16 (vcombine_u16 (u8_unpremultiply_neon4 (vget_low_u16 (c16), vget_low_u16 (a16)),
+                                  u8_unpremultiply_neon4 (vget_high_u16 (c16), vget_high_u16 (a16))));
+}
+
+static gsize
+u8_convert_simd (guchar                           *dest_data,
+                 const GdkMemoryFormatDescription *dest_desc,
+                 const guchar                     *src_data,
+                 const GdkMemoryFormatDescription *src_desc,
+                 ConvertOp                         op,
+                 gsize                             n)
+{
+  gsize i;
+  int k;
+
+  for (i = 0; i + 8 <= n; i += 8)
+    {
+      uint8x8x4_t in = vld4_u8 (src_data + 4 * i);
+      uint8x8x4_t out;
+      uint8x8_t c[4];
+
+      for (k = 0; k < 4; k++)
+        c[k] = in.val[src_desc->channels[k]];
+
+      if (op == CONVERT_PREMULTIPLY)
+        {
+          for (k = 0; k < 3; k++)
+            c[k] = u8_premultiply_neon (c[k], c[3]);
+        }
+      else if (op == CONVERT_UNPREMULTIPLY)
+        {
+          for (k = 0; k < 3; k++)
+            c[k] = u8_unpremultiply_neon (c[k], c[3]);
+        }
+
+      for (k = 0; k < 4; k++)
+        out.val[dest_desc->channels[k]] = c[k];
+
+      vst4_u8 (dest_data + 4 * i, out);
+    }
+
+  return i;
+}
+
+static inline uint16x4_t
+u16_premultiply_neon (uint16x4_t c,
+                      uint16x4_t a)
+{
+  uint32x4_t t = vaddq_u32 (vmull_u16 (c, a), vdupq_n_u32 (32768));
+
+  return vshrn_n_u32 (vaddq_u32 (t, vshrq_n_u32 (t, 16)), 16);
+}
+
+static inline float64x2_t
+u32_to_f64 (uint32x2_t v)
+{
+  return vcvtq_f64_u64 (vmovl_u32 (v));
+}
+
+/* The numerator needs 32 bits, so this divides in doubles, which
+ * still round down to the same integer as the scalar division */
+static inline uint32x2_t
+u16_unpremultiply_neon2 (uint32x2_t c,
+                         uint32x2_t a)
+{
+  const float64x2_t max = vdupq_n_f64 (65535);
+  float64x2_t num = vaddq_f64 (vmulq_f64 (u32_to_f64 (c), max), u32_to_f64 (vshr_n_u32 (a, 1)));
+  float64x2_t q = vminq_f64 (vdivq_f64 (num, u32_to_f64 (a)), max);
+
+  return vbsl_u32 (vclt_u32 (a, vdup_n_u32 (257)), c, vmovn_u64 (vcvtq_u64_f64 (q)));
+}
+
+static inline uint16x4_t
+u16_unpremultiply_neon (uint16x4_t c,
+                        uint16x4_t a)
+{
+  uint32x4_t c32 = vmovl_u16 (c);
+  uint32x4_t a32 = vmovl_u16 (a);
+
+  return vmovn_u32 (vcombine_u32 (u16_unpremultiply_neon2 (vget_low_u32 (c32), vget_low_u32 (a32)),
+                                  u16_unpremultiply_neon2 (vget_high_u32 (c32), vget_high_u32 (a32))));
+}
+
+static gsize
+u16_convert_rgba_simd (guchar       *dest_data,
+                       const guchar *src_data,
+                       ConvertOp     op,
+                       gsize         n)
+{
+  gsize i;
+  int k;
+
+  for (i = 0; i + 4 <= n; i += 4)
+    {
+      uint16x4x4_t v = vld4_u16 ((const guint16 *) (src_data + 8 * i));
+
+      for (k = 0; k < 3; k++)
+        {
+          if (op == CONVERT_PREMULTIPLY)
+            v.val[k] = u16_premultiply_neon (v.val[k], v.val[3]);
+          else
+            v.val[k] = u16_unpremultiply_neon (v.val[k], v.val[3]);
+        }
+
+      vst4_u16 ((guint16 *) (dest_data + 8 * i), v);
+    }
+
+  return i;
+}
+
+#endif
+
+static gboolean
+is_rgba (const GdkMemoryFormatDescription *desc)
+{
+  return desc->channels[0] == 0 && desc->channels[1] == 1 &&
+         desc->channels[2] == 2 && desc->channels[3] == 3;
+}
+
+/* Whether direct_convert_simd() handles the pair. It is only asked
+ * about pairs that can_convert_directly() accepted. */
+static gboolean
+can_convert_simd (const GdkMemoryFormatDescription *dest_desc,
+                  const GdkMemoryFormatDescription *src_desc,
+                  ConvertOp                         op)
+{
+  switch (src_desc->depth)
+    {
+#if defined(HAVE_CONVERT_SSE2) || defined(HAVE_CONVERT_NEON)
+    case GDK_MEMORY_U8:
+      /* 4 bytes per pixel means all 4 channels */
+      return src_desc->bytes_per_pixel == 4 && dest_desc->bytes_per_pixel == 4;
+    case GDK_MEMORY_U16:
+      return is_rgba (src_desc) && is_rgba (dest_desc) && op != CONVERT_COPY;
+#endif
+    case GDK_MEMORY_FLOAT32:
+      /* premultiply() and unpremultiply() are vectorized */
+      return is_rgba (src_desc) && is_rgba (dest_desc);
+    default:
+      return FALSE;
+    }
+}
+
+static gsize
+direct_convert_simd (guchar                           *dest_data,
+                     const GdkMemoryFormatDescription *dest_desc,
+                     const guchar                     *src_data,
+                     const GdkMemoryFormatDescription *src_desc,
+                     ConvertOp                         op,
+                     gsize                             n)
+{
+  switch (src_desc->depth)
+    {
+#if defined(HAVE_CONVERT_SSE2) || defined(HAVE_CONVERT_NEON)
+    case GDK_MEMORY_U8:
+      return u8_convert_simd (dest_data, dest_desc, src_data, src_desc, op, n);
+    case GDK_MEMORY_U16:
+      return u16_convert_rgba_simd (dest_data, src_data, op, n);
+#endif
+    case GDK_MEMORY_FLOAT32:
+      memcpy (dest_data, src_data, n * 4 * sizeof (float));
+      if (op == CONVERT_PREMULTIPLY)
+        premultiply ((float *) dest_data, n);
+      else if (op == CONVERT_UNPREMULTIPLY)
+        unpremultiply ((float *) dest_data, n);
+      return n;
+    default:
+      g_assert_not_reached ();
+      return 0;
+    }
+}
+
+static ConvertOp
+get_convert_op (const GdkMemoryFormatDescription *dest_desc,
+                const GdkMemoryFormatDescription *src_desc)
+{
+  if (src_desc->alpha == GDK_MEMORY_ALPHA_PREMULTIPLIED && dest_desc->alpha == GDK_MEMORY_ALPHA_STRAIGHT)
+    return CONVERT_UNPREMULTIPLY;
+  else if (src_desc->alpha == GDK_MEMORY_ALPHA_STRAIGHT && dest_desc->alpha != GDK_MEMORY_ALPHA_STRAIGHT)
+    return CONVERT_PREMULTIPLY;
+  else
+    return CONVERT_COPY;
+}
+
+static gboolean
+can_convert_directly (const GdkMemoryFormatDescription *dest_desc,
+                      const GdkMemoryFormatDescription *src_desc,
+                      ConvertOp                         op)
+{
+  if (dest_desc->depth != src_desc->depth)
+    return FALSE;
+
+  /* Going to gray needs to average the colors */
+  if (dest_desc->channels[0] >= 0 &&
+      dest_desc->channels[0] == dest_desc->channels[1] &&
+      src_desc->channels[0] != src_desc->channels[1])
+    return FALSE;
+
+  /* half floats need the float path for any math */
+  if (dest_desc->depth == GDK_MEMORY_FLOAT16 && op != CONVERT_COPY)
+    return FALSE;
+
+  return TRUE;
+}
+
+typedef struct _ConvertJob ConvertJob;
+
+struct _ConvertJob
+{
+  guchar *dest_data;
+  gsize dest_stride;
+  GdkMemoryFormat dest_format;
+  const guchar *src_data;
+  gsize src_stride;
+  GdkMemoryFormat src_format;
+  gsize width;
+  gsize y_start;
+  gsize y_end;
+
+  GMutex *lock;
+  GCond *cond;
+  guint *pending;
+};
+
+static void
+convert_rows_via_float (guchar                           *dest_data,
+                        gsize                             dest_stride,
+                        const GdkMemoryFormatDescription *dest_desc,
+                        const guchar                     *src_data,
+                        gsize                             src_stride,
+                        const GdkMemoryFormatDescription *src_desc,
+                        ConvertOp                         op,
+                        gsize                             width,
+                        gsize                             height)
 {
-  const GdkMemoryFormatDescription *dest_desc = &memory_formats[dest_format];
-  const GdkMemoryFormatDescription *src_desc = &memory_formats[src_format];
   float *tmp;
   gsize y;
+
+  tmp = g_new (float, width * 4);
+
+  for (y = 0; y < height; y++)
+    {
+      src_desc->to_float (tmp, src_data, width);
+      if (op == CONVERT_UNPREMULTIPLY)
+        unpremultiply (tmp, width);
+      else if (op == CONVERT_PREMULTIPLY)
+        premultiply (tmp, width);
+      dest_desc->from_float (dest_data, tmp, width);
+      src_data += src_stride;
+      dest_data += dest_stride;
+    }
+
+  g_free (tmp);
+}
+
+static void
+convert_rows (const ConvertJob *job)
+{
+  const GdkMemoryFormatDescription *dest_desc = &memory_formats[job->dest_format];
+  const GdkMemoryFormatDescription *src_desc = &memory_formats[job->src_format];
+  GdkMemoryFormat dest_format = job->dest_format;
+  GdkMemoryFormat src_format = job->src_format;
+  guchar *dest_data = job->dest_data + job->y_start * job->dest_stride;
+  const guchar *src_data = job->src_data + job->y_start * job->src_stride;
+  gsize dest_stride = job->dest_stride;
+  gsize src_stride = job->src_stride;
+  gsize width = job->width;
+  gsize height = job->y_end - job->y_start;
+  ConvertOp op;
+  gboolean direct;
+  gsize y;
   void (*func) (guchar *, const guchar *, gsize) = NULL;
 
-  g_assert (dest_format < GDK_MEMORY_N_FORMATS);
-  g_assert (src_format < GDK_MEMORY_N_FORMATS);
+  if (src_format == dest_format)
+    {
+      for (y = 0; y < height; y++)
+        {
+          memcpy (dest_data, src_data, width * src_desc->bytes_per_pixel);
+          src_data += src_stride;
+          dest_data += dest_stride;
+        }
+      return;
+    }
+
+  op = get_convert_op (dest_desc, src_desc);
+  direct = can_convert_directly (dest_desc, src_desc, op);
+
+  if (direct && can_convert_simd (dest_desc, src_desc, op))
+    {
+      for (y = 0; y < height; y++)
+        {
+          gsize done = direct_convert_simd (dest_data, dest_desc, src_data, src_desc, op, width);
+
+          direct_convert (dest_data + done * dest_desc->bytes_per_pixel, dest_desc,
+                          src_data + done * src_desc->bytes_per_pixel, src_desc,
+                          op, width - done);
+          src_data += src_stride;
+          dest_data += dest_stride;
+        }
+      return;
+    }
 
   if (src_format == GDK_MEMORY_R8G8B8A8 && dest_format == GDK_MEMORY_R8G8B8A8_PREMULTIPLIED)
     func = r8g8b8a8_to_r8g8b8a8_premultiplied;
@@ -748,19 +1469,177 @@ gdk_memory_convert (guchar              *dest_data,
       return;
     }
 
-  tmp = g_new (float, width * 4);
+  if (direct)
+    {
+      for (y = 0; y < height; y++)
+        {
+          direct_convert (dest_data, dest_desc, src_data, src_desc, op, width);
+          src_data += src_stride;
+          dest_data += dest_stride;
+        }
+      return;
+    }
 
-  for (y = 0; y < height; y++)
+  convert_rows_via_float (dest_data, dest_stride, dest_desc,
+                          src_data, src_stride, src_desc,
+                          op, width, height);
+}
+
+static void
+convert_rows_in_thread (gpointer data,
+                        gpointer user_data)
+{
+  ConvertJob *job = data;
+
+  convert_rows (job);
+
+  g_mutex_lock (job->lock);
+  *job->pending -= 1;
+  if (*job->pending == 0)
+    g_cond_signal (job->cond);
+  g_mutex_unlock (job->lock);
+}
+
+static GThreadPool *
+get_convert_pool (void)
+{
+  static GThreadPool *pool;
+
+  if (g_once_init_enter (&pool))
     {
-      src_desc->to_float (tmp, src_data, width);
-      if (src_desc->alpha == GDK_MEMORY_ALPHA_PREMULTIPLIED && dest_desc->alpha == GDK_MEMORY_ALPHA_STRAIGHT)
-        unpremultiply (tmp, width);
-      else if (src_desc->alpha == GDK_MEMORY_ALPHA_STRAIGHT && dest_desc->alpha != GDK_MEMORY_ALPHA_STRAIGHT)
-        premultiply (tmp, width);
-      dest_desc->from_float (dest_data, tmp, width);
-      src_data += src_stride;
-      dest_data += dest_stride;
+      GThreadPool *new_pool = g_thread_pool_new (convert_rows_in_thread,
+                                                 NULL,
+                                                 g_get_num_processors (),
+                                                 FALSE,
+                                                 NULL);
+
+      g_once_init_leave (&pool, new_pool);
     }
 
-  g_free (tmp);
+  return pool;
+}
+
+/* Images with fewer pixels than this are not worth splitting up */
+#define MIN_PIXELS_PER_THREAD (256 * 256)
+
+static GPrivate convert_single_threaded;
+
+/*
+ * gdk_memory_convert_set_single_threaded:
+ * @single_threaded: %TRUE to not use worker threads
+ *
+ * Makes gdk_memory_convert() calls from the current thread do
+ * all their work in that thread.
+ *
+ * This is meant for code that already runs on a pool of worker
+ * threads, so that conversions don't queue up behind it.
+ */
+void
+gdk_memory_convert_set_single_threaded (gboolean single_threaded)
+{
+  g_private_set (&convert_single_threaded, GINT_TO_POINTER (single_threaded));
+}
+
+void
+gdk_memory_convert (guchar              *dest_data,
+                    gsize                dest_stride,
+                    GdkMemoryFormat      dest_format,
+                    const guchar        *src_data,
+                    gsize                src_stride,
+                    GdkMemoryFormat      src_format,
+                    gsize                width,
+                    gsize                height)
+{
+  ConvertJob job = {
+    dest_data, dest_stride, dest_format,
+    src_data, src_stride, src_format,
+    width, 0, height,
+  };
+  gsize n_jobs;
+
+  g_assert (dest_format < GDK_MEMORY_N_FORMATS);
+  g_assert (src_format < GDK_MEMORY_N_FORMATS);
+
+  if (GPOINTER_TO_INT (g_private_get (&convert_single_threaded)))
+    {
+      n_jobs = 1;
+    }
+  else
+    {
+      n_jobs = MIN (g_get_num_processors (), width * height / MIN_PIXELS_PER_THREAD);
+      n_jobs = MIN (n_jobs, height);
+    }
+
+  if (n_jobs <= 1)
+    {
+      convert_rows (&job);
+    }
+  else
+    {
+      GThreadPool *pool = get_convert_pool ();
+      ConvertJob *jobs;
+      GMutex lock;
+      GCond cond;
+      guint pending;
+      gsize i;
+
+      g_mutex_init (&lock);
+      g_cond_init (&cond);
+      jobs = g_new (ConvertJob, n_jobs);
+      pending = n_jobs - 1;
+
+      for (i = 0; i < n_jobs; i++)
+        {
+          jobs[i] = job;
+          jobs[i].y_start = height * i / n_jobs;
+          jobs[i].y_end = height * (i + 1) / n_jobs;
+          jobs[i].lock = &lock;
+          jobs[i].cond = &cond;
+          jobs[i].pending = &pending;
+
+          /* we do the first part ourselves */
+          if (i > 0)
+            g_thread_pool_push (pool, &jobs[i], NULL);
+        }
+
+      convert_rows (&jobs[0]);
+
+      g_mutex_lock (&lock);
+      while (pending > 0)
+        g_cond_wait (&cond, &lock);
+      g_mutex_unlock (&lock);
+
+      g_free (jobs);
+      g_mutex_clear (&lock);
+      g_cond_clear (&cond);
+    }
+}
+
+/*
+ * gdk_memory_convert_via_float:
+ *
+ * Converts like gdk_memory_convert(), but always goes through
+ * floats and never uses the direct converters. This is the
+ * reference the direct converters are tested against.
+ */
+void
+gdk_memory_convert_via_float (guchar              *dest_data,
+                              gsize                dest_stride,
+                              GdkMemoryFormat      dest_format,
+                              const guchar        *src_data,
+                              gsize                src_stride,
+                              GdkMemoryFormat      src_format,
+                              gsize                width,
+                              gsize                height)
+{
+  const GdkMemoryFormatDescription *dest_desc = &memory_formats[dest_format];
+  const GdkMemoryFormatDescription *src_desc = &memory_formats[src_format];
+
+  g_assert (dest_format < GDK_MEMORY_N_FORMATS);
+  g_assert (src_format < GDK_MEMORY_N_FORMATS);
+
+  convert_rows_via_float (dest_data, dest_stride, dest_desc,
+                          src_data, src_stride, src_desc,
+                          get_convert_op (dest_desc, src_desc),
+                          width, height);
 }
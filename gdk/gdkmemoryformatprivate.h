@@ -61,7 +61,16 @@ void                    gdk_memory_convert                  (guchar
                                                              GdkMemoryFormat             src_format,
                                                              gsize                       width,
                                                              gsize                       height);
-
+void                    gdk_memory_convert_set_single_threaded
+                                                            (gboolean                    single_threaded);
+void                    gdk_memory_convert_via_float        (guchar                     *dest_data,
+                                                             gsize                       dest_stride,
+                                                             GdkMemoryFormat             dest_format,
+                                                             const guchar               *src_data,
+                                                             gsize                       src_stride,
+                                                             GdkMemoryFormat             src_format,
+                                                             gsize                       width,
+                                                             gsize                       height);
 
 G_END_DECLS
 
@@ -507,19 +507,21 @@ gdk_texture_can_load (GBytes *bytes)
 
 static GdkTexture *
 gdk_texture_new_from_bytes_internal (GBytes  *bytes,
+                                     int      width,
+                                     int      height,
                                      GError **error)
 {
   if (gdk_is_png (bytes))
     {
-      return gdk_load_png (bytes, error);
+      return gdk_load_png (bytes, width, height, error);
     }
   else if (gdk_is_jpeg (bytes))
     {
-      return gdk_load_jpeg (bytes, error);
+      return gdk_load_jpeg (bytes, width, height, error);
     }
   else if (gdk_is_tiff (bytes))
     {
-      return gdk_load_tiff (bytes, error);
+      return gdk_load_tiff (bytes, width, height, error);
     }
   else
     {
@@ -574,6 +576,50 @@ gdk_texture_new_from_bytes_pixbuf (GBytes  *bytes,
 GdkTexture *
 gdk_texture_new_from_bytes (GBytes  *bytes,
                             GError **error)
+{
+  g_return_val_if_fail (bytes != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  return gdk_texture_new_from_bytes_at_size (bytes, -1, -1, error);
+}
+
+/**
+ * gdk_texture_new_from_bytes_at_size:
+ * @bytes: a `GBytes` containing the data to load
+ * @width: the minimum width of the texture, or -1
+ * @height: the minimum height of the texture, or -1
+ * @error: Return location for an error
+ *
+ * Creates a new texture by loading an image from memory, scaling
+ * it down while it is decoded.
+ *
+ * This is meant for loading images that are only ever shown much
+ * smaller than their actual size, like thumbnails. Decoding at a
+ * smaller size is faster and needs less memory than loading the
+ * full image and scaling it down afterwards.
+ *
+ * The image keeps its aspect ratio and is scaled down by powers of
+ * two for as long as it stays at least @width by @height pixels.
+ * Passing -1 for @width or @height leaves that dimension unconstrained.
+ * The resulting texture may be larger than the requested size, in
+ * particular if the image format does not support scaling while
+ * decoding.
+ *
+ * See [ctor@Gdk.Texture.new_from_bytes] for the supported formats.
+ *
+ * If %NULL is returned, then @error will be set.
+ *
+ * This function is threadsafe.
+ *
+ * Return value: A newly-created `GdkTexture`
+ *
+ * Since: 4.12
+ */
+GdkTexture *
+gdk_texture_new_from_bytes_at_size (GBytes  *bytes,
+                                    int      width,
+                                    int      height,
+                                    GError **error)
 {
   GdkTexture *texture;
   GError *internal_error = NULL;
@@ -581,7 +627,7 @@ gdk_texture_new_from_bytes (GBytes  *bytes,
   g_return_val_if_fail (bytes != NULL, NULL);
   g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-  texture = gdk_texture_new_from_bytes_internal (bytes, &internal_error);
+  texture = gdk_texture_new_from_bytes_internal (bytes, width, height, &internal_error);
   if (texture)
     return texture;
 
@@ -636,6 +682,164 @@ gdk_texture_new_from_filename (const char  *path,
   return texture;
 }
 
+typedef struct
+{
+  GFile *file;
+  int width;
+  int height;
+} GdkTextureLoad;
+
+static void
+gdk_texture_load_free (gpointer data)
+{
+  GdkTextureLoad *load = data;
+
+  g_object_unref (load->file);
+  g_free (load);
+}
+
+static void
+gdk_texture_load_thread (gpointer data,
+                         gpointer unused)
+{
+  GTask *task = data;
+  GdkTextureLoad *load = g_task_get_task_data (task);
+  GCancellable *cancellable = g_task_get_cancellable (task);
+  GdkTexture *texture;
+  GBytes *bytes;
+  GError *error = NULL;
+
+  /* Loads that were cancelled while waiting in the queue are skipped */
+  if (g_task_return_error_if_cancelled (task))
+    goto out;
+
+  bytes = g_file_load_bytes (load->file, cancellable, NULL, &error);
+  if (bytes == NULL)
+    {
+      g_task_return_error (task, error);
+      goto out;
+    }
+
+  if (g_task_return_error_if_cancelled (task))
+    {
+      g_bytes_unref (bytes);
+      goto out;
+    }
+
+  texture = gdk_texture_new_from_bytes_at_size (bytes, load->width, load->height, &error);
+  g_bytes_unref (bytes);
+
+  if (texture)
+    g_task_return_pointer (task, texture, g_object_unref);
+  else
+    g_task_return_error (task, error);
+
+out:
+  g_object_unref (task);
+}
+
+/* Decoding is CPU bound, so run at most one load per core instead of
+ * using the GTask pool, which would also make loads of hundreds of
+ * images at once decode all of them in parallel and use a lot of memory.
+ */
+static GThreadPool *
+gdk_texture_get_load_pool (void)
+{
+  static gsize pool__set;
+  static GThreadPool *pool;
+
+  if (g_once_init_enter (&pool__set))
+    {
+      pool = g_thread_pool_new (gdk_texture_load_thread,
+                                NULL,
+                                g_get_num_processors (),
+                                FALSE,
+                                NULL);
+
+      g_once_init_leave (&pool__set, 1);
+    }
+
+  return pool;
+}
+
+/**
+ * gdk_texture_new_from_file_async:
+ * @file: `GFile` to load
+ * @width: the minimum width of the texture, or -1
+ * @height: the minimum height of the texture, or -1
+ * @cancellable: (nullable): a `GCancellable`
+ * @callback: (scope async): callback to call when the texture is loaded
+ * @user_data: the data to pass to @callback
+ *
+ * Asynchronously loads a texture from a file.
+ *
+ * The file is read and decoded on a pool of worker threads, so
+ * many images can be loaded without blocking the main thread. The
+ * image is scaled while decoding, like with
+ * [ctor@Gdk.Texture.new_from_bytes_at_size]. Pass -1 for @width and
+ * @height to load it at full size.
+ *
+ * When the load is finished, @callback is called in the thread-default
+ * main context of the calling thread, and should call
+ * [ctor@Gdk.Texture.new_from_file_finish] to get the result.
+ *
+ * Loads that are cancelled via @cancellable before they started
+ * don't do any work.
+ *
+ * Since: 4.12
+ */
+void
+gdk_texture_new_from_file_async (GFile               *file,
+                                 int                  width,
+                                 int                  height,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+  GdkTextureLoad *load;
+  GTask *task;
+
+  g_return_if_fail (G_IS_FILE (file));
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gdk_texture_new_from_file_async);
+
+  load = g_new (GdkTextureLoad, 1);
+  load->file = g_object_ref (file);
+  load->width = width;
+  load->height = height;
+  g_task_set_task_data (task, load, gdk_texture_load_free);
+
+  /* The pool takes the reference */
+  g_thread_pool_push (gdk_texture_get_load_pool (), task, NULL);
+}
+
+/**
+ * gdk_texture_new_from_file_finish:
+ * @result: the `GAsyncResult` passed to the callback
+ * @error: Return location for an error
+ *
+ * Finishes an asynchronous load started with
+ * [ctor@Gdk.Texture.new_from_file_async].
+ *
+ * If %NULL is returned, then @error will be set.
+ *
+ * Return value: (transfer full): A newly-created `GdkTexture`
+ *
+ * Since: 4.12
+ */
+GdkTexture *
+gdk_texture_new_from_file_finish (GAsyncResult  *result,
+                                  GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gdk_texture_new_from_file_async, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 /**
  * gdk_texture_get_width: (attributes org.gtk.Method.get_property=width)
  * @texture: a `GdkTexture`
@@ -75,6 +75,21 @@ GdkTexture *            gdk_texture_new_from_filename          (const char
 GDK_AVAILABLE_IN_4_6
 GdkTexture *            gdk_texture_new_from_bytes             (GBytes          *bytes,
                                                                 GError         **error);
+GDK_AVAILABLE_IN_4_12
+GdkTexture *            gdk_texture_new_from_bytes_at_size     (GBytes          *bytes,
+                                                                int              width,
+                                                                int              height,
+                                                                GError         **error);
+GDK_AVAILABLE_IN_4_12
+void                    gdk_texture_new_from_file_async        (GFile           *file,
+                                                                int              width,
+                                                                int              height,
+                                                                GCancellable    *cancellable,
+                                                                GAsyncReadyCallback callback,
+                                                                gpointer         user_data);
+GDK_AVAILABLE_IN_4_12
+GdkTexture *            gdk_texture_new_from_file_finish       (GAsyncResult    *result,
+                                                                GError         **error);
 
 GDK_AVAILABLE_IN_ALL
 int                     gdk_texture_get_width                  (GdkTexture      *texture) G_GNUC_PURE;
@@ -20,6 +20,7 @@
 #include "config.h"
 
 #include "gdkjpegprivate.h"
+#include "gdkloaderprivate.h"
 
 #include <glib/gi18n-lib.h>
 #include "gdktexture.h"
@@ -136,6 +137,8 @@ convert_cmyk_to_rgba (guchar *data,
 
 GdkTexture *
 gdk_load_jpeg (GBytes  *input_bytes,
+               int      target_width,
+               int      target_height,
                GError **error)
 {
   struct jpeg_decompress_struct info;
@@ -170,6 +173,15 @@ gdk_load_jpeg (GBytes  *input_bytes,
                 g_bytes_get_size (input_bytes));
 
   jpeg_read_header (&info, TRUE);
+
+  /* libjpeg can skip work in the DCT to scale down by up to 8,
+   * which is a lot faster than decoding at full size.
+   */
+  info.scale_num = 1;
+  info.scale_denom = MIN (gdk_loader_get_scale (info.image_width, info.image_height,
+                                                target_width, target_height),
+                          8);
+
   jpeg_start_decompress (&info);
 
   width = info.output_width;
@@ -237,7 +249,7 @@ gdk_load_jpeg (GBytes  *input_bytes,
 
   g_bytes_unref (bytes);
 
-  gdk_profiler_end_mark (before, "jpeg load", NULL);
+  gdk_profiler_end_markf (before, "jpeg load", "%ux%u", width, height);
  
   return texture;
 }
@@ -23,7 +23,9 @@
 #define JPEG_SIGNATURE "\xff\xd8"
 
 GdkTexture *gdk_load_jpeg         (GBytes           *bytes,
-                                   GError          **error);
+                                   int               target_width,
+                                   int               target_height,
+                                   GError           **error);
 
 GBytes     *gdk_save_jpeg         (GdkTexture     *texture);
 
@@ -0,0 +1,74 @@
+/* GDK - The GIMP Drawing Kit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <string.h>
+
+/* Helpers shared by the loaders for decoding at a reduced size */
+
+#define GDK_LOADER_MAX_SCALE 256
+
+/*
+ * gdk_loader_get_scale:
+ * @image_width: width of the image
+ * @image_height: height of the image
+ * @width: requested width, or -1
+ * @height: requested height, or -1
+ *
+ * Finds the largest power of two that the image can be divided
+ * by and still be at least as large as the requested size.
+ *
+ * Returns: the scale factor, 1 if no scaling should happen
+ */
+static inline guint
+gdk_loader_get_scale (guint image_width,
+                      guint image_height,
+                      int   width,
+                      int   height)
+{
+  guint scale = 1;
+
+  if (width <= 0 && height <= 0)
+    return 1;
+
+  while (scale < GDK_LOADER_MAX_SCALE &&
+         (width <= 0 || image_width / (scale * 2) >= (guint) width) &&
+         (height <= 0 || image_height / (scale * 2) >= (guint) height))
+    scale *= 2;
+
+  return scale;
+}
+
+static inline guint
+gdk_loader_scale_size (guint size,
+                       guint scale)
+{
+  return (size + scale - 1) / scale;
+}
+
+/* Picks every @scale'th pixel of @src */
+static inline void
+gdk_loader_decimate_row (guchar       *dest,
+                         const guchar *src,
+                         guint         dest_width,
+                         gsize         bpp,
+                         guint         scale)
+{
+  for (guint x = 0; x < dest_width; x++)
+    memcpy (dest + x * bpp, src + x * scale * bpp, bpp);
+}
@@ -18,6 +18,7 @@
 #include "config.h"
 
 #include "gdkpngprivate.h"
+#include "gdkloaderprivate.h"
 
 #include <glib/gi18n-lib.h>
 #include "gdkmemoryformatprivate.h"
@@ -131,16 +132,20 @@ png_simple_warning_callback (png_structp     png,
 
 GdkTexture *
 gdk_load_png (GBytes  *bytes,
+              int      target_width,
+              int      target_height,
               GError **error)
 {
   png_io io;
   png_struct *png = NULL;
   png_info *info;
   guint width, height;
+  guint scale, scaled_width, scaled_height;
   int depth, color_type;
   int interlace, stride;
   GdkMemoryFormat format;
   guchar *buffer = NULL;
+  guchar *image = NULL;
   guchar **row_pointers = NULL;
   GBytes *out_bytes;
   GdkTexture *texture;
@@ -169,6 +174,7 @@ gdk_load_png (GBytes  *bytes,
   if (sigsetjmp (png_jmpbuf (png), 1))
     {
       g_free (buffer);
+      g_free (image);
       g_free (row_pointers);
       png_destroy_read_struct (&png, &info, NULL);
       return NULL;
@@ -263,16 +269,39 @@ gdk_load_png (GBytes  *bytes,
     }
 
   bpp = gdk_memory_format_bytes_per_pixel (format);
-  stride = width * bpp;
+
+  scale = gdk_loader_get_scale (width, height, target_width, target_height);
+  scaled_width = gdk_loader_scale_size (width, scale);
+  scaled_height = gdk_loader_scale_size (height, scale);
+
+  stride = scaled_width * bpp;
   if (stride % 8)
     stride += 8 - stride % 8;
 
-  buffer = g_try_malloc_n (height, stride);
-  row_pointers = g_try_malloc_n (height, sizeof (char *));
+  buffer = g_try_malloc_n (scaled_height, stride);
+  if (scale == 1)
+    {
+      /* Decode straight into the texture */
+      row_pointers = g_try_malloc_n (height, sizeof (char *));
+    }
+  else if (interlace == PNG_INTERLACE_NONE)
+    {
+      /* Decode one row at a time and only keep the ones we need */
+      image = g_try_malloc (png_get_rowbytes (png, info));
+    }
+  else
+    {
+      /* Interlaced images need all rows for every pass */
+      image = g_try_malloc_n (height, png_get_rowbytes (png, info));
+      row_pointers = g_try_malloc_n (height, sizeof (char *));
+    }
 
-  if (!buffer || !row_pointers)
+  if (!buffer ||
+      ((scale == 1 || interlace != PNG_INTERLACE_NONE) && !row_pointers) ||
+      (scale > 1 && !image))
     {
       g_free (buffer);
+      g_free (image);
       g_free (row_pointers);
       png_destroy_read_struct (&png, &info, NULL);
       g_set_error (error,
@@ -281,16 +310,43 @@ gdk_load_png (GBytes  *bytes,
       return NULL;
     }
 
-  for (int i = 0; i < height; i++)
-    row_pointers[i] = &buffer[i * stride];
+  if (scale == 1)
+    {
+      for (int i = 0; i < height; i++)
+        row_pointers[i] = &buffer[i * stride];
+
+      png_read_image (png, row_pointers);
+    }
+  else if (interlace == PNG_INTERLACE_NONE)
+    {
+      for (int i = 0; i < height; i++)
+        {
+          png_read_row (png, image, NULL);
+
+          if (i % scale == 0)
+            gdk_loader_decimate_row (&buffer[(i / scale) * stride], image, scaled_width, bpp, scale);
+        }
+    }
+  else
+    {
+      gsize rowbytes = png_get_rowbytes (png, info);
+
+      for (int i = 0; i < height; i++)
+        row_pointers[i] = &image[i * rowbytes];
+
+      png_read_image (png, row_pointers);
+
+      for (int i = 0; i < scaled_height; i++)
+        gdk_loader_decimate_row (&buffer[i * stride], row_pointers[i * scale], scaled_width, bpp, scale);
+    }
 
-  png_read_image (png, row_pointers);
   png_read_end (png, info);
 
-  out_bytes = g_bytes_new_take (buffer, height * stride);
-  texture = gdk_memory_texture_new (width, height, format, out_bytes, stride);
+  out_bytes = g_bytes_new_take (buffer, scaled_height * stride);
+  texture = gdk_memory_texture_new (scaled_width, scaled_height, format, out_bytes, stride);
   g_bytes_unref (out_bytes);
 
+  g_free (image);
   g_free (row_pointers);
   png_destroy_read_struct (&png, &info, NULL);
 
@@ -23,7 +23,9 @@
 #define PNG_SIGNATURE "\x89PNG"
 
 GdkTexture *gdk_load_png        (GBytes         *bytes,
-                                 GError        **error);
+                                 int             target_width,
+                                 int             target_height,
+                                 GError         **error);
 
 GBytes     *gdk_save_png        (GdkTexture     *texture);
 
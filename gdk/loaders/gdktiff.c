@@ -18,6 +18,7 @@
 #include "config.h"
 
 #include "gdktiffprivate.h"
+#include "gdkloaderprivate.h"
 
 #include <glib/gi18n-lib.h>
 #include "gdkmemoryformatprivate.h"
@@ -367,6 +368,8 @@ load_fallback (TIFF    *tif,
 
 GdkTexture *
 gdk_load_tiff (GBytes  *input_bytes,
+               int      target_width,
+               int      target_height,
                GError **error)
 {
   TIFF *tif;
@@ -377,10 +380,11 @@ gdk_load_tiff (GBytes  *input_bytes,
   guint16 sample_format;
   guint16 orientation;
   guint32 width, height;
+  guint scale, scaled_width, scaled_height;
   guint16 alpha_samples;
   GdkMemoryFormat format;
-  guchar *data, *line;
-  gsize stride;
+  guchar *data, *line, *scanline;
+  gsize stride, scaled_stride;
   int bpp;
   GBytes *bytes;
   GdkTexture *texture;
@@ -453,42 +457,64 @@ gdk_load_tiff (GBytes  *input_bytes,
       return texture;
     }
 
-  stride = width * gdk_memory_format_bytes_per_pixel (format);
+  bpp = gdk_memory_format_bytes_per_pixel (format);
+  stride = width * bpp;
 
   g_assert (TIFFScanlineSize (tif) == stride);
 
-  data = g_try_malloc_n (height, stride);
-  if (!data)
+  /* Compressed strips have to be decoded in order, so all rows
+   * get read, but only the ones we keep need to be stored.
+   */
+  scale = gdk_loader_get_scale (width, height, target_width, target_height);
+  scaled_width = gdk_loader_scale_size (width, scale);
+  scaled_height = gdk_loader_scale_size (height, scale);
+  scaled_stride = scaled_width * bpp;
+
+  data = g_try_malloc_n (scaled_height, scaled_stride);
+  scanline = scale > 1 ? g_try_malloc (stride) : NULL;
+  if (!data || (scale > 1 && !scanline))
     {
       g_set_error (error,
                    GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_TOO_LARGE,
                    _("Not enough memory for image size %ux%u"), width, height);
       TIFFClose (tif);
+      g_free (data);
+      g_free (scanline);
       return NULL;
     }
 
   line = data;
   for (int y = 0; y < height; y++)
     {
-      if (TIFFReadScanline (tif, line, y, 0) == -1)
+      if (TIFFReadScanline (tif, scale > 1 ? scanline : line, y, 0) == -1)
         {
           g_set_error (error,
                        GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE,
                        _("Reading data failed at row %d"), y);
           TIFFClose (tif);
           g_free (data);
+          g_free (scanline);
           return NULL;
         }
 
-      line += stride;
+      if (scale > 1)
+        {
+          if (y % scale != 0)
+            continue;
+
+          gdk_loader_decimate_row (line, scanline, scaled_width, bpp, scale);
+        }
+
+      line += scaled_stride;
     }
 
-  bpp = gdk_memory_format_bytes_per_pixel (format);
-  bytes = g_bytes_new_take (data, width * height * bpp);
+  g_free (scanline);
 
-  texture = gdk_memory_texture_new (width, height,
+  bytes = g_bytes_new_take (data, scaled_height * scaled_stride);
+
+  texture = gdk_memory_texture_new (scaled_width, scaled_height,
                                     format,
-                                    bytes, width * bpp);
+                                    bytes, scaled_stride);
   g_bytes_unref (bytes);
 
   TIFFClose (tif);
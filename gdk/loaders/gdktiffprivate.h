@@ -24,7 +24,9 @@
 #define TIFF_SIGNATURE2 "II\x2a\x00"
 
 GdkTexture *gdk_load_tiff         (GBytes           *bytes,
-                                   GError          **error);
+                                   int               target_width,
+                                   int               target_height,
+                                   GError           **error);
 
 GBytes *    gdk_save_tiff         (GdkTexture       *texture);
 
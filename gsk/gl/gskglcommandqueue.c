@@ -1266,6 +1266,12 @@ gsk_gl_command_queue_execute (GskGLCommandQueue    *self,
   gdk_profiler_set_int_counter (self->metrics.n_programs, n_programs);
   gdk_profiler_set_int_counter (self->metrics.n_uploads, self->n_uploads);
   gdk_profiler_set_int_counter (self->metrics.queue_depth, self->batches.len);
+  gdk_profiler_set_int_counter (self->metrics.n_cache_hits, self->n_cache_hits);
+  gdk_profiler_set_int_counter (self->metrics.n_cache_misses, self->n_cache_misses);
+  gdk_profiler_set_int_counter (self->metrics.cached_texture_size, self->cached_texture_size);
+  gdk_profiler_set_int_counter (self->metrics.n_glyph_hits, self->n_glyph_hits);
+  gdk_profiler_set_int_counter (self->metrics.n_glyph_misses, self->n_glyph_misses);
+  gdk_profiler_set_int_counter (self->metrics.n_glyph_stalls, self->n_glyph_stalls);
 
 #ifdef G_ENABLE_DEBUG
   {
@@ -1276,6 +1282,12 @@ gsk_gl_command_queue_execute (GskGLCommandQueue    *self,
     gsk_profiler_timer_set (self->profiler, self->metrics.gpu_time, gpu_time);
     gsk_profiler_timer_set (self->profiler, self->metrics.cpu_time, cpu_time);
     gsk_profiler_counter_inc (self->profiler, self->metrics.n_frames);
+    gsk_profiler_counter_add (self->profiler, self->metrics.cache_hits, self->n_cache_hits);
+    gsk_profiler_counter_add (self->profiler, self->metrics.cache_misses, self->n_cache_misses);
+    gsk_profiler_counter_set (self->profiler, self->metrics.cache_size, self->cached_texture_size);
+    gsk_profiler_counter_add (self->profiler, self->metrics.glyph_hits, self->n_glyph_hits);
+    gsk_profiler_counter_add (self->profiler, self->metrics.glyph_misses, self->n_glyph_misses);
+    gsk_profiler_counter_add (self->profiler, self->metrics.glyph_stalls, self->n_glyph_stalls);
 
     gsk_profiler_push_samples (self->profiler);
   }
@@ -1337,6 +1349,11 @@ gsk_gl_command_queue_end_frame (GskGLCommandQueue *self)
   self->batch_uniforms.len = 0;
   self->syncs.len = 0;
   self->n_uploads = 0;
+  self->n_cache_hits = 0;
+  self->n_cache_misses = 0;
+  self->n_glyph_hits = 0;
+  self->n_glyph_misses = 0;
+  self->n_glyph_stalls = 0;
   self->tail_batch_index = -1;
   self->in_frame = FALSE;
 }
@@ -1729,6 +1746,12 @@ gsk_gl_command_queue_set_profiler (GskGLCommandQueue *self,
       self->metrics.n_frames = gsk_profiler_add_counter (profiler, "frames", "Frames", FALSE);
       self->metrics.cpu_time = gsk_profiler_add_timer (profiler, "cpu-time", "CPU Time", FALSE, TRUE);
       self->metrics.gpu_time = gsk_profiler_add_timer (profiler, "gpu-time", "GPU Time", FALSE, TRUE);
+      self->metrics.cache_hits = gsk_profiler_add_counter (profiler, "offscreen-hits", "Offscreens reused", TRUE);
+      self->metrics.cache_misses = gsk_profiler_add_counter (profiler, "offscreen-misses", "Offscreens not cached", TRUE);
+      self->metrics.cache_size = gsk_profiler_add_counter (profiler, "offscreen-cache-size", "Bytes in cached offscreens", FALSE);
+      self->metrics.glyph_hits = gsk_profiler_add_counter (profiler, "glyph-hits", "Glyphs found in cache", TRUE);
+      self->metrics.glyph_misses = gsk_profiler_add_counter (profiler, "glyph-misses", "Glyphs rasterized", TRUE);
+      self->metrics.glyph_stalls = gsk_profiler_add_counter (profiler, "glyph-stalls", "Glyphs waited for", TRUE);
 
       self->metrics.n_binds = gdk_profiler_define_int_counter ("attachments", "Number of texture attachments");
       self->metrics.n_fbos = gdk_profiler_define_int_counter ("fbos", "Number of framebuffers attached");
@@ -1736,6 +1759,12 @@ gsk_gl_command_queue_set_profiler (GskGLCommandQueue *self,
       self->metrics.n_uploads = gdk_profiler_define_int_counter ("uploads", "Number of texture uploads");
       self->metrics.n_programs = gdk_profiler_define_int_counter ("programs", "Number of program changes");
       self->metrics.queue_depth = gdk_profiler_define_int_counter ("gl-queue-depth", "Depth of GL command batches");
+      self->metrics.n_cache_hits = gdk_profiler_define_int_counter ("offscreen-hits", "Number of cached offscreens reused");
+      self->metrics.n_cache_misses = gdk_profiler_define_int_counter ("offscreen-misses", "Number of offscreens not in cache");
+      self->metrics.cached_texture_size = gdk_profiler_define_int_counter ("offscreen-cache-size", "Bytes in cached offscreens");
+      self->metrics.n_glyph_hits = gdk_profiler_define_int_counter ("glyph-hits", "Number of glyphs found in cache");
+      self->metrics.n_glyph_misses = gdk_profiler_define_int_counter ("glyph-misses", "Number of glyphs rasterized");
+      self->metrics.n_glyph_stalls = gdk_profiler_define_int_counter ("glyph-stalls", "Number of glyphs waited for");
     }
 #endif
 }
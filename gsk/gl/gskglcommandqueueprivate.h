@@ -270,11 +270,37 @@ struct _GskGLCommandQueue
     guint n_uploads;
     guint n_programs;
     guint queue_depth;
+    guint n_cache_hits;
+    guint n_cache_misses;
+    guint cached_texture_size;
+    guint n_glyph_hits;
+    guint n_glyph_misses;
+    guint n_glyph_stalls;
+    GQuark cache_hits;
+    GQuark cache_misses;
+    GQuark cache_size;
+    GQuark glyph_hits;
+    GQuark glyph_misses;
+    GQuark glyph_stalls;
   } metrics;
 
   /* Counter for uploads on the frame */
   guint n_uploads;
 
+  /* Lookups in the driver's cache of textures rendered for nodes
+   * on the frame, and the size of that cache in bytes.
+   */
+  guint n_cache_hits;
+  guint n_cache_misses;
+  gsize cached_texture_size;
+
+  /* Glyph lookups on the frame, and how many glyphs we had
+   * to wait for to finish rasterizing.
+   */
+  guint n_glyph_hits;
+  guint n_glyph_misses;
+  guint n_glyph_stalls;
+
   /* If the GL context is new enough for sampler support */
   guint has_samplers : 1;
 
@@ -26,6 +26,8 @@
 
 #include "gskglcommandqueueprivate.h"
 #include "gskglcompilerprivate.h"
+#include "gskgldriverprivate.h"
+#include "gskglprogramcacheprivate.h"
 #include "gskglprogramprivate.h"
 
 #define SHADER_VERSION_GLES       "100"
@@ -34,6 +36,9 @@
 #define SHADER_VERSION_GL3_LEGACY "130"
 #define SHADER_VERSION_GL3        "150"
 
+/* version, debug, legacy, gl3, gles, clip, 2 preambles, source, suffix */
+#define N_SOURCES 10
+
 struct _GskGLCompiler
 {
   GObject parent_instance;
@@ -532,6 +537,51 @@ get_shader_string (GBytes *bytes)
   return str ? str : "";
 }
 
+/* Identifies a program by everything that goes into linking it,
+ * which is what the program cache is keyed by.
+ */
+static char *
+gsk_gl_compiler_get_program_key (GskGLCompiler      *self,
+                                 const char * const *vertex_sources,
+                                 const int          *vertex_lengths,
+                                 const char * const *fragment_sources,
+                                 const int          *fragment_lengths)
+{
+  GChecksum *checksum;
+  char *key;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+
+  /* Include the lengths, so moving text between sources changes the key */
+  for (guint i = 0; i < N_SOURCES; i++)
+    {
+      guint32 len = vertex_lengths[i];
+      g_checksum_update (checksum, (const guchar *) &len, sizeof len);
+      g_checksum_update (checksum, (const guchar *) vertex_sources[i], len);
+    }
+
+  for (guint i = 0; i < N_SOURCES; i++)
+    {
+      guint32 len = fragment_lengths[i];
+      g_checksum_update (checksum, (const guchar *) &len, sizeof len);
+      g_checksum_update (checksum, (const guchar *) fragment_sources[i], len);
+    }
+
+  for (guint i = 0; i < self->attrib_locations->len; i++)
+    {
+      const GskGLProgramAttrib *attrib;
+
+      attrib = &g_array_index (self->attrib_locations, GskGLProgramAttrib, i);
+      g_checksum_update (checksum, (const guchar *) attrib->name, strlen (attrib->name) + 1);
+      g_checksum_update (checksum, (const guchar *) &attrib->location, sizeof attrib->location);
+    }
+
+  key = g_strdup (g_checksum_get_string (checksum));
+  g_checksum_free (checksum);
+
+  return key;
+}
+
 GskGLProgram *
 gsk_gl_compiler_compile (GskGLCompiler  *self,
                          const char     *name,
@@ -543,6 +593,12 @@ gsk_gl_compiler_compile (GskGLCompiler  *self,
   const char *legacy = "";
   const char *gl3 = "";
   const char *gles = "";
+  const char *vertex_sources[N_SOURCES];
+  const char *fragment_sources[N_SOURCES];
+  int vertex_lengths[N_SOURCES];
+  int fragment_lengths[N_SOURCES];
+  GskGLProgramCache *program_cache;
+  char *key = NULL;
   int program_id;
   int vertex_id;
   int fragment_id;
@@ -572,68 +628,69 @@ gsk_gl_compiler_compile (GskGLCompiler  *self,
   if (self->gl3)
     gl3 = "#define GSK_GL3 1\n";
 
+  vertex_sources[0] = fragment_sources[0] = version;
+  vertex_sources[1] = fragment_sources[1] = debug;
+  vertex_sources[2] = fragment_sources[2] = legacy;
+  vertex_sources[3] = fragment_sources[3] = gl3;
+  vertex_sources[4] = fragment_sources[4] = gles;
+  vertex_sources[5] = fragment_sources[5] = clip;
+  vertex_sources[6] = fragment_sources[6] = get_shader_string (self->all_preamble);
+  vertex_sources[7] = get_shader_string (self->vertex_preamble);
+  vertex_sources[8] = get_shader_string (self->vertex_source);
+  vertex_sources[9] = get_shader_string (self->vertex_suffix);
+  fragment_sources[7] = get_shader_string (self->fragment_preamble);
+  fragment_sources[8] = get_shader_string (self->fragment_source);
+  fragment_sources[9] = get_shader_string (self->fragment_suffix);
+
+  for (guint i = 0; i < 6; i++)
+    vertex_lengths[i] = fragment_lengths[i] = strlen (vertex_sources[i]);
+  vertex_lengths[6] = fragment_lengths[6] = g_bytes_get_size (self->all_preamble);
+  vertex_lengths[7] = g_bytes_get_size (self->vertex_preamble);
+  vertex_lengths[8] = g_bytes_get_size (self->vertex_source);
+  vertex_lengths[9] = g_bytes_get_size (self->vertex_suffix);
+  fragment_lengths[7] = g_bytes_get_size (self->fragment_preamble);
+  fragment_lengths[8] = g_bytes_get_size (self->fragment_source);
+  fragment_lengths[9] = g_bytes_get_size (self->fragment_suffix);
+
+  program_cache = self->driver->program_cache;
+
+  if (program_cache != NULL)
+    {
+      key = gsk_gl_compiler_get_program_key (self,
+                                             vertex_sources, vertex_lengths,
+                                             fragment_sources, fragment_lengths);
+
+      program_id = glCreateProgram ();
+      if (gsk_gl_program_cache_load_program (program_cache, key, program_id))
+        {
+          g_free (key);
+          return gsk_gl_program_new (self->driver, name, program_id);
+        }
+      glDeleteProgram (program_id);
+    }
+
   vertex_id = glCreateShader (GL_VERTEX_SHADER);
-  glShaderSource (vertex_id,
-                  10,
-                  (const char *[]) {
-                    version, debug, legacy, gl3, gles,
-                    clip,
-                    get_shader_string (self->all_preamble),
-                    get_shader_string (self->vertex_preamble),
-                    get_shader_string (self->vertex_source),
-                    get_shader_string (self->vertex_suffix),
-                  },
-                  (int[]) {
-                    strlen (version),
-                    strlen (debug),
-                    strlen (legacy),
-                    strlen (gl3),
-                    strlen (gles),
-                    strlen (clip),
-                    g_bytes_get_size (self->all_preamble),
-                    g_bytes_get_size (self->vertex_preamble),
-                    g_bytes_get_size (self->vertex_source),
-                    g_bytes_get_size (self->vertex_suffix),
-                  });
+  glShaderSource (vertex_id, N_SOURCES, vertex_sources, vertex_lengths);
   glCompileShader (vertex_id);
 
   if (!check_shader_error (vertex_id, error))
     {
       glDeleteShader (vertex_id);
+      g_free (key);
       return NULL;
     }
 
   print_shader_info ("Vertex shader", vertex_id, name);
 
   fragment_id = glCreateShader (GL_FRAGMENT_SHADER);
-  glShaderSource (fragment_id,
-                  10,
-                  (const char *[]) {
-                    version, debug, legacy, gl3, gles,
-                    clip,
-                    get_shader_string (self->all_preamble),
-                    get_shader_string (self->fragment_preamble),
-                    get_shader_string (self->fragment_source),
-                    get_shader_string (self->fragment_suffix),
-                  },
-                  (int[]) {
-                    strlen (version),
-                    strlen (debug),
-                    strlen (legacy),
-                    strlen (gl3),
-                    strlen (gles),
-                    strlen (clip),
-                    g_bytes_get_size (self->all_preamble),
-                    g_bytes_get_size (self->fragment_preamble),
-                    g_bytes_get_size (self->fragment_source),
-                    g_bytes_get_size (self->fragment_suffix),
-                  });
+  glShaderSource (fragment_id, N_SOURCES, fragment_sources, fragment_lengths);
   glCompileShader (fragment_id);
 
   if (!check_shader_error (fragment_id, error))
     {
       glDeleteShader (vertex_id);
       glDeleteShader (fragment_id);
+      g_free (key);
       return NULL;
     }
 
@@ -651,6 +708,9 @@ gsk_gl_compiler_compile (GskGLCompiler  *self,
       glBindAttribLocation (program_id, attrib->location, attrib->name);
     }
 
+  if (program_cache != NULL)
+    glProgramParameteri (program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
   glLinkProgram (program_id);
 
   glGetProgramiv (program_id, GL_LINK_STATUS, &status);
@@ -687,9 +747,15 @@ gsk_gl_compiler_compile (GskGLCompiler  *self,
       g_free (buffer);
 
       glDeleteProgram (program_id);
+      g_free (key);
 
       return NULL;
     }
 
+  if (program_cache != NULL)
+    gsk_gl_program_cache_add_program (program_cache, key, program_id);
+
+  g_free (key);
+
   return gsk_gl_program_new (self->driver, name, program_id);
 }
@@ -45,6 +45,14 @@
 
 #include <gdk/gdkmemoryformatprivate.h>
 
+/* Textures rendered for a node are kept for this many frames after
+ * they were last used, as long as they fit into the budget. That way
+ * unchanged subtrees don't need to be rendered offscreen again when
+ * they reappear, e.g. while scrolling.
+ */
+#define MAX_CACHED_TEXTURE_AGE 60
+#define CACHED_TEXTURE_BUDGET (32 * 1024 * 1024)
+
 G_DEFINE_TYPE (GskGLDriver, gsk_gl_driver, G_TYPE_OBJECT)
 
 static guint
@@ -79,6 +87,15 @@ texture_key_equal (gconstpointer v1,
          (!k1->pointer_is_child || memcmp (&k1->parent_rect, &k2->parent_rect, sizeof k1->parent_rect) == 0);
 }
 
+static void
+texture_key_free (gpointer data)
+{
+  GskTextureKey *key = data;
+
+  gsk_render_node_unref ((GskRenderNode *) key->pointer);
+  g_free (key);
+}
+
 static void
 remove_texture_key_for_id (GskGLDriver *self,
                            guint        texture_id)
@@ -111,12 +128,40 @@ gsk_gl_driver_autorelease_texture (GskGLDriver *self,
   g_array_append_val (self->texture_pool, texture_id);
 }
 
+static void
+gsk_gl_driver_collect_texture (GskGLDriver  *self,
+                               GskGLTexture *t)
+{
+  g_assert (t->link.prev == NULL);
+  g_assert (t->link.next == NULL);
+  g_assert (t->link.data == t);
+
+  remove_texture_key_for_id (self, t->texture_id);
+  gsk_gl_driver_autorelease_texture (self, t->texture_id);
+  t->texture_id = 0;
+  gsk_gl_texture_free (t);
+}
+
+static int
+compare_last_used (gconstpointer a,
+                   gconstpointer b)
+{
+  const GskGLTexture *ta = *(GskGLTexture * const *) a;
+  const GskGLTexture *tb = *(GskGLTexture * const *) b;
+
+  return (ta->last_used_in_frame > tb->last_used_in_frame) -
+         (ta->last_used_in_frame < tb->last_used_in_frame);
+}
+
 static guint
 gsk_gl_driver_collect_unused_textures (GskGLDriver *self,
                                        gint64       watermark)
 {
   GHashTableIter iter;
   gpointer k, v;
+  GPtrArray *retained = NULL;
+  gint64 cached_watermark;
+  gsize cached_size = 0;
   guint old_size;
   guint collected;
 
@@ -124,29 +169,62 @@ gsk_gl_driver_collect_unused_textures (GskGLDriver *self,
 
   old_size = g_hash_table_size (self->textures);
 
+  /* Textures cached for a node live longer than other textures */
+  cached_watermark = MIN (watermark, self->current_frame_id - MAX_CACHED_TEXTURE_AGE);
+
   g_hash_table_iter_init (&iter, self->textures);
   while (g_hash_table_iter_next (&iter, &k, &v))
     {
       GskGLTexture *t = v;
+      gboolean cached;
 
       if (t->user || t->permanent)
         continue;
 
-      if (t->last_used_in_frame <= watermark)
+      cached = g_hash_table_contains (self->texture_id_to_key, k);
+
+      if (t->last_used_in_frame <= (cached ? cached_watermark : watermark))
         {
           g_hash_table_iter_steal (&iter);
+          gsk_gl_driver_collect_texture (self, t);
+        }
+      else if (cached)
+        {
+          cached_size += (gsize) t->width * t->height * 4;
 
-          g_assert (t->link.prev == NULL);
-          g_assert (t->link.next == NULL);
-          g_assert (t->link.data == t);
+          /* Only kept around because of its age limit */
+          if (t->last_used_in_frame <= watermark)
+            {
+              if (retained == NULL)
+                retained = g_ptr_array_new ();
+              g_ptr_array_add (retained, t);
+            }
+        }
+    }
+
+  /* Drop the least recently used textures until we fit into the budget */
+  if (retained != NULL)
+    {
+      if (cached_size > CACHED_TEXTURE_BUDGET)
+        {
+          g_ptr_array_sort (retained, compare_last_used);
 
-          remove_texture_key_for_id (self, t->texture_id);
-          gsk_gl_driver_autorelease_texture (self, t->texture_id);
-          t->texture_id = 0;
-          gsk_gl_texture_free (t);
+          for (guint i = 0; i < retained->len && cached_size > CACHED_TEXTURE_BUDGET; i++)
+            {
+              GskGLTexture *t = g_ptr_array_index (retained, i);
+
+              cached_size -= (gsize) t->width * t->height * 4;
+              g_hash_table_steal (self->textures, GUINT_TO_POINTER (t->texture_id));
+              gsk_gl_driver_collect_texture (self, t);
+            }
         }
+
+      g_ptr_array_unref (retained);
     }
 
+  if (self->command_queue != NULL)
+    self->command_queue->cached_texture_size = cached_size;
+
   collected = old_size - g_hash_table_size (self->textures);
 
   return collected;
@@ -257,6 +335,13 @@ gsk_gl_driver_dispose (GObject *object)
       g_clear_pointer (&self->shader_cache, g_hash_table_unref);
     }
 
+  if (self->save_program_cache_source != 0)
+    {
+      g_clear_handle_id (&self->save_program_cache_source, g_source_remove);
+      gsk_gl_program_cache_save (self->program_cache);
+    }
+  g_clear_pointer (&self->program_cache, gsk_gl_program_cache_free);
+
   if (self->command_queue != NULL)
     {
       gsk_gl_command_queue_make_current (self->command_queue);
@@ -309,13 +394,39 @@ gsk_gl_driver_init (GskGLDriver *self)
   self->texture_id_to_key = g_hash_table_new (NULL, NULL);
   self->key_to_texture_id = g_hash_table_new_full (texture_key_hash,
                                                    texture_key_equal,
-                                                   g_free,
+                                                   texture_key_free,
                                                    NULL);
   self->shader_cache = g_hash_table_new_full (NULL, NULL, NULL, remove_program);
   self->texture_pool = g_array_new (FALSE, FALSE, sizeof (guint));
   self->render_targets = g_ptr_array_new ();
 }
 
+static gboolean
+gsk_gl_driver_save_program_cache_cb (gpointer data)
+{
+  GskGLDriver *self = data;
+
+  gsk_gl_program_cache_save (self->program_cache);
+
+  self->save_program_cache_source = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gsk_gl_driver_program_cache_updated (GskGLDriver *self)
+{
+  if (self->program_cache == NULL ||
+      !gsk_gl_program_cache_is_dirty (self->program_cache))
+    return;
+
+  g_clear_handle_id (&self->save_program_cache_source, g_source_remove);
+  self->save_program_cache_source = g_timeout_add_seconds_full (G_PRIORITY_DEFAULT_IDLE - 10,
+                                                                5, /* out of the way of startup */
+                                                                gsk_gl_driver_save_program_cache_cb,
+                                                                self,
+                                                                NULL);
+}
+
 static gboolean
 gsk_gl_driver_load_programs (GskGLDriver  *self,
                              GError      **error)
@@ -456,12 +567,18 @@ gsk_gl_driver_new (GskGLCommandQueue  *command_queue,
   self->shared_command_queue = g_object_ref (command_queue);
   self->debug = !!debug_shaders;
 
+  /* Always compile when shaders are debugged, so their sources get printed */
+  if (!self->debug)
+    self->program_cache = gsk_gl_program_cache_new (context);
+
   if (!gsk_gl_driver_load_programs (self, error))
     {
       g_object_unref (self);
       return NULL;
     }
 
+  gsk_gl_driver_program_cache_updated (self);
+
   self->glyphs_library = gsk_gl_glyph_library_new (self);
   self->icons_library = gsk_gl_icon_library_new (self);
   self->shadows_library = gsk_gl_shadow_library_new (self);
@@ -568,6 +685,9 @@ gsk_gl_driver_begin_frame (GskGLDriver       *self,
 
   gsk_gl_command_queue_begin_frame (self->command_queue);
 
+  /* Glyphs prewarmed outside of a frame must land before atlases change */
+  gsk_gl_glyph_library_upload_pending (self->glyphs_library);
+
   /* Mark unused pixel regions of the atlases */
   gsk_gl_texture_library_begin_frame (GSK_GL_TEXTURE_LIBRARY (self->icons_library),
                                       self->current_frame_id);
@@ -678,8 +798,12 @@ gsk_gl_driver_get_context (GskGLDriver *self)
  * Textures can be looked up by @key after calling this function using
  * gsk_gl_driver_lookup_texture().
  *
+ * The render node that is the pointer of @key is kept alive while the
+ * texture is cached, so that a new node can't end up with the same key.
+ *
  * Textures that have not been used within a number of frames will be
- * purged from the texture cache automatically.
+ * purged from the texture cache automatically, least recently used ones
+ * first when the cached textures exceed their memory budget.
  */
 void
 gsk_gl_driver_cache_texture (GskGLDriver         *self,
@@ -696,6 +820,7 @@ gsk_gl_driver_cache_texture (GskGLDriver         *self,
       GskTextureKey *k;
 
       k = g_memdup (key, sizeof *key);
+      gsk_render_node_ref ((GskRenderNode *) k->pointer);
 
       g_assert (!g_hash_table_contains (self->texture_id_to_key, GUINT_TO_POINTER (texture_id)));
       g_hash_table_insert (self->key_to_texture_id, k, GUINT_TO_POINTER (texture_id));
@@ -1128,6 +1253,8 @@ gsk_gl_driver_lookup_shader (GskGLDriver  *self,
           g_object_weak_ref (G_OBJECT (shader),
                              gsk_gl_driver_shader_weak_cb,
                              self);
+
+          gsk_gl_driver_program_cache_updated (self);
         }
 
       g_object_unref (compiler);
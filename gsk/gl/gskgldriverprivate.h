@@ -23,6 +23,8 @@
 #include <gdk/gdkgltextureprivate.h>
 
 #include "gskgltypesprivate.h"
+#include "gskglcommandqueueprivate.h"
+#include "gskglprogramcacheprivate.h"
 #include "gskgltextureprivate.h"
 
 G_BEGIN_DECLS
@@ -57,7 +59,7 @@ enum {
 };
 
 typedef struct {
-  gconstpointer   pointer;
+  gconstpointer   pointer; /* A GskRenderNode, kept alive while cached */
   float           scale_x;
   float           scale_y;
   int             pointer_is_child;
@@ -107,6 +109,9 @@ struct _GskGLDriver
 
   GHashTable *shader_cache;
 
+  GskGLProgramCache *program_cache;
+  guint save_program_cache_source;
+
   GArray *autorelease_framebuffers;
   GPtrArray *render_targets;
 
@@ -216,9 +221,13 @@ gsk_gl_driver_lookup_texture (GskGLDriver         *self,
       if (texture != NULL)
         texture->last_used_in_frame = self->current_frame_id;
 
+      self->command_queue->n_cache_hits++;
+
       return GPOINTER_TO_UINT (id);
     }
 
+  self->command_queue->n_cache_misses++;
+
   return 0;
 }
 
@@ -91,6 +91,7 @@ gsk_gl_glyph_library_clear_cache (GskGLTextureLibrary *library)
   g_assert (GSK_IS_GL_GLYPH_LIBRARY (self));
 
   memset (self->front, 0, sizeof self->front);
+  g_hash_table_remove_all (self->prewarmed);
 }
 
 static void
@@ -142,12 +143,160 @@ gsk_gl_glyph_library_init_atlas (GskGLTextureLibrary *self,
 }
 
 
+typedef struct _GskGLGlyphUpload
+{
+  GskGLGlyphLibrary *library;
+
+  /* Set when rasterizing on a worker thread */
+  cairo_scaled_font_t *scaled_font;
+
+  PangoGlyph glyph;
+  guint xshift;
+  guint yshift;
+  PangoRectangle ink_rect;
+
+  /* Size in pixels, without the padding */
+  int width;
+  int height;
+
+  guint texture_id;
+  guint packed_x;
+  guint packed_y;
+
+  /* Premultiplied pixels of (width + 2) x (height + 2), with the
+   * glyph's edges repeated into the padding, in the format that
+   * we upload.
+   */
+  guchar *pixels;
+
+  guint use_es : 1;
+  /* Protected by library->lock */
+  guint done : 1;
+} GskGLGlyphUpload;
+
+static void
+gsk_gl_glyph_upload_free (GskGLGlyphUpload *upload)
+{
+  g_clear_pointer (&upload->scaled_font, cairo_scaled_font_destroy);
+  g_free (upload->pixels);
+  g_free (upload);
+}
+
+/* Can be called from a worker thread, as long as @font is %NULL
+ * and the scaled font is used instead.
+ */
+static void
+gsk_gl_glyph_upload_rasterize (GskGLGlyphUpload *upload,
+                               PangoFont        *font)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  int width = upload->width + 2;
+  int height = upload->height + 2;
+  int stride = width * 4;
+  guchar *pixels;
+
+  pixels = g_malloc0 (stride * height);
+  surface = cairo_image_surface_create_for_data (pixels,
+                                                 CAIRO_FORMAT_ARGB32,
+                                                 width, height, stride);
+  cairo_surface_set_device_scale (surface,
+                                  upload->width / (double) upload->ink_rect.width,
+                                  upload->height / (double) upload->ink_rect.height);
+  /* Skip the padding */
+  cairo_surface_set_device_offset (surface, 1, 1);
+
+  cr = cairo_create (surface);
+  cairo_set_source_rgba (cr, 1, 1, 1, 1);
+
+  if (upload->scaled_font)
+    {
+      cairo_glyph_t glyph;
+
+      glyph.index = upload->glyph;
+      glyph.x = 0.25 * upload->xshift - upload->ink_rect.x;
+      glyph.y = 0.25 * upload->yshift - upload->ink_rect.y;
+
+      cairo_set_scaled_font (cr, upload->scaled_font);
+      cairo_show_glyphs (cr, &glyph, 1);
+    }
+  else
+    {
+      PangoGlyphString glyph_string;
+      PangoGlyphInfo glyph_info;
+
+      glyph_info.glyph = upload->glyph;
+      glyph_info.geometry.width = upload->ink_rect.width * 1024;
+      glyph_info.geometry.x_offset = (0.25 * upload->xshift - upload->ink_rect.x) * 1024;
+      glyph_info.geometry.y_offset = (0.25 * upload->yshift - upload->ink_rect.y) * 1024;
+
+      glyph_string.num_glyphs = 1;
+      glyph_string.glyphs = &glyph_info;
+
+      pango_cairo_show_glyph_string (cr, font, &glyph_string);
+    }
+
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+  cairo_surface_destroy (surface);
+
+  /* Repeat the outermost pixels into the padding, so that
+   * linear filtering doesn't pick up neighbouring glyphs.
+   */
+  for (int y = 1; y < height - 1; y++)
+    {
+      guint32 *row = (guint32 *) (pixels + y * stride);
+
+      row[0] = row[1];
+      row[width - 1] = row[width - 2];
+    }
+  memcpy (pixels, pixels + stride, stride);
+  memcpy (pixels + (height - 1) * stride, pixels + (height - 2) * stride, stride);
+
+  if G_UNLIKELY (upload->use_es)
+    {
+      upload->pixels = g_malloc (stride * height);
+      gdk_memory_convert (upload->pixels, stride,
+                          GDK_MEMORY_R8G8B8A8_PREMULTIPLIED,
+                          pixels, stride,
+                          GDK_MEMORY_DEFAULT,
+                          width, height);
+      g_free (pixels);
+    }
+  else
+    {
+      upload->pixels = pixels;
+    }
+}
+
+static void
+gsk_gl_glyph_library_rasterize_func (gpointer data,
+                                     gpointer user_data)
+{
+  GskGLGlyphUpload *upload = data;
+  GskGLGlyphLibrary *self = upload->library;
+
+  gsk_gl_glyph_upload_rasterize (upload, NULL);
+
+  g_mutex_lock (&self->lock);
+  upload->done = TRUE;
+  g_cond_broadcast (&self->cond);
+  g_mutex_unlock (&self->lock);
+}
+
 static void
 gsk_gl_glyph_library_finalize (GObject *object)
 {
   GskGLGlyphLibrary *self = (GskGLGlyphLibrary *)object;
 
-  g_clear_pointer (&self->surface_data, g_free);
+  /* Waits for glyphs that are still being rasterized */
+  if (self->pool != NULL)
+    g_thread_pool_free (self->pool, FALSE, TRUE);
+
+  g_clear_pointer (&self->pending, g_ptr_array_unref);
+  g_clear_pointer (&self->prewarmed, g_hash_table_unref);
+  g_mutex_clear (&self->lock);
+  g_cond_clear (&self->cond);
 
   G_OBJECT_CLASS (gsk_gl_glyph_library_parent_class)->finalize (object);
 }
@@ -175,214 +324,187 @@ gsk_gl_glyph_library_init (GskGLGlyphLibrary *self)
                                     gsk_gl_glyph_key_equal,
                                     gsk_gl_glyph_key_free,
                                     gsk_gl_glyph_value_free);
+
+  self->pending = g_ptr_array_new_with_free_func ((GDestroyNotify) gsk_gl_glyph_upload_free);
+  self->prewarmed = g_hash_table_new_full (gsk_gl_glyph_key_hash,
+                                           gsk_gl_glyph_key_equal,
+                                           gsk_gl_glyph_key_free,
+                                           NULL);
+  g_mutex_init (&self->lock);
+  g_cond_init (&self->cond);
+
+  /* Leave one core for the thread that renders */
+  if (g_get_num_processors () > 1)
+    self->pool = g_thread_pool_new (gsk_gl_glyph_library_rasterize_func,
+                                    NULL,
+                                    MIN (g_get_num_processors () - 1, 4),
+                                    FALSE,
+                                    NULL);
 }
 
-static cairo_surface_t *
-gsk_gl_glyph_library_create_surface (GskGLGlyphLibrary *self,
-                                     int                stride,
-                                     int                width,
-                                     int                height,
-                                     int                uwidth,
-                                     int                uheight)
+static int
+compare_upload_texture (gconstpointer a,
+                        gconstpointer b)
 {
-  cairo_surface_t *surface;
-  gsize n_bytes;
-
-  g_assert (GSK_IS_GL_GLYPH_LIBRARY (self));
-  g_assert (width > 0);
-  g_assert (height > 0);
-
-  n_bytes = stride * height;
-
-  if G_LIKELY (n_bytes > self->surface_data_len)
-    {
-      self->surface_data = g_realloc (self->surface_data, n_bytes);
-      self->surface_data_len = n_bytes;
-    }
+  const GskGLGlyphUpload *ua = *(GskGLGlyphUpload * const *) a;
+  const GskGLGlyphUpload *ub = *(GskGLGlyphUpload * const *) b;
 
-  memset (self->surface_data, 0, n_bytes);
-  surface = cairo_image_surface_create_for_data (self->surface_data,
-                                                 CAIRO_FORMAT_ARGB32,
-                                                 width, height, stride);
-  cairo_surface_set_device_scale (surface, width / (double)uwidth, height / (double)uheight);
-
-  return surface;
+  return (ua->texture_id > ub->texture_id) - (ua->texture_id < ub->texture_id);
 }
 
-static void
-render_glyph (cairo_surface_t           *surface,
-              const GskGLGlyphKey       *key,
-              const GskGLGlyphValue     *value)
+/**
+ * gsk_gl_glyph_library_upload_pending:
+ * @self: a `GskGLGlyphLibrary`
+ *
+ * Uploads all glyphs that were added since the last call, waiting
+ * for the ones that are still being rasterized.
+ *
+ * This must be called before the command queue is executed, as the
+ * atlas entries of pending glyphs have no contents yet.
+ */
+void
+gsk_gl_glyph_library_upload_pending (GskGLGlyphLibrary *self)
 {
-  cairo_t *cr;
-  PangoGlyphString glyph_string;
-  PangoGlyphInfo glyph_info;
-
-  g_assert (surface != NULL);
-
-  cr = cairo_create (surface);
-  cairo_set_source_rgba (cr, 1, 1, 1, 1);
+  GskGLTextureLibrary *tl = (GskGLTextureLibrary *)self;
+  GskGLCommandQueue *command_queue = tl->driver->command_queue;
+  G_GNUC_UNUSED gint64 start_time = GDK_PROFILER_CURRENT_TIME;
+  guint last_texture_id = 0;
+  guint n_glyphs;
+  guint gl_format;
+  guint gl_type;
 
-  glyph_info.glyph = key->glyph;
-  glyph_info.geometry.width = value->ink_rect.width * 1024;
-  glyph_info.geometry.x_offset = (0.25 * key->xshift - value->ink_rect.x) * 1024;
-  glyph_info.geometry.y_offset = (0.25 * key->yshift - value->ink_rect.y) * 1024;
+  g_assert (GSK_IS_GL_GLYPH_LIBRARY (self));
 
-  glyph_string.num_glyphs = 1;
-  glyph_string.glyphs = &glyph_info;
+  n_glyphs = self->pending->len;
 
-  pango_cairo_show_glyph_string (cr, key->font, &glyph_string);
-  cairo_destroy (cr);
+  if (n_glyphs > 0)
+    {
+      gdk_gl_context_push_debug_group_printf (gdk_gl_context_get_current (),
+                                              "Uploading %u glyphs", n_glyphs);
+
+      if G_UNLIKELY (gdk_gl_context_get_use_es (gdk_gl_context_get_current ()))
+        {
+          gl_format = GL_RGBA;
+          gl_type = GL_UNSIGNED_BYTE;
+        }
+      else
+        {
+          gl_format = GL_BGRA;
+          gl_type = GL_UNSIGNED_INT_8_8_8_8_REV;
+        }
+
+      /* Fewer texture binds */
+      g_ptr_array_sort (self->pending, compare_upload_texture);
+
+      for (guint i = 0; i < n_glyphs; i++)
+        {
+          GskGLGlyphUpload *upload = g_ptr_array_index (self->pending, i);
+
+          g_mutex_lock (&self->lock);
+          if (!upload->done)
+            {
+              self->n_stalls++;
+              while (!upload->done)
+                g_cond_wait (&self->cond, &self->lock);
+            }
+          g_mutex_unlock (&self->lock);
+
+          if (upload->texture_id != last_texture_id)
+            {
+              glBindTexture (GL_TEXTURE_2D, upload->texture_id);
+              last_texture_id = upload->texture_id;
+            }
+
+          /* The padding is part of the pixels, so this is one upload */
+          glTexSubImage2D (GL_TEXTURE_2D, 0,
+                           upload->packed_x, upload->packed_y,
+                           upload->width + 2, upload->height + 2,
+                           gl_format, gl_type,
+                           upload->pixels);
+
+          command_queue->n_uploads++;
+        }
+
+      g_ptr_array_set_size (self->pending, 0);
+
+      gdk_gl_context_pop_debug_group (gdk_gl_context_get_current ());
+
+      if (gdk_profiler_is_running ())
+        {
+          char message[64];
+          g_snprintf (message, sizeof message, "%u glyphs", n_glyphs);
+          gdk_profiler_add_mark (start_time, GDK_PROFILER_CURRENT_TIME-start_time, "Upload Glyphs", message);
+        }
+    }
 
-  cairo_surface_flush (surface);
+  command_queue->n_glyph_hits += self->n_hits;
+  command_queue->n_glyph_misses += self->n_misses;
+  command_queue->n_glyph_stalls += self->n_stalls;
+  self->n_hits = 0;
+  self->n_misses = 0;
+  self->n_stalls = 0;
 }
 
 static void
-gsk_gl_glyph_library_upload_glyph (GskGLGlyphLibrary     *self,
+gsk_gl_glyph_library_queue_upload (GskGLGlyphLibrary     *self,
                                    const GskGLGlyphKey   *key,
                                    const GskGLGlyphValue *value,
-                                   int                    packed_x,
-                                   int                    packed_y,
+                                   guint                  packed_x,
+                                   guint                  packed_y,
                                    int                    width,
-                                   int                    height,
-                                   int                    uwidth,
-                                   int                    uheight)
+                                   int                    height)
 {
-  GskGLTextureLibrary *tl = (GskGLTextureLibrary *)self;
-  G_GNUC_UNUSED gint64 start_time = GDK_PROFILER_CURRENT_TIME;
-  cairo_surface_t *surface;
-  guchar *pixel_data;
-  guchar *free_data = NULL;
-  guint gl_format;
-  guint gl_type;
-  guint texture_id;
-  gsize stride;
+  GskGLGlyphUpload *upload;
 
   g_assert (GSK_IS_GL_GLYPH_LIBRARY (self));
   g_assert (key != NULL);
   g_assert (value != NULL);
 
-  stride = cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, width);
-
-  gdk_gl_context_push_debug_group_printf (gdk_gl_context_get_current (),
-                                          "Uploading glyph %d",
-                                          key->glyph);
-
-  surface = gsk_gl_glyph_library_create_surface (self, stride, width, height, uwidth, uheight);
-  render_glyph (surface, key, value);
-
-  texture_id = GSK_GL_TEXTURE_ATLAS_ENTRY_TEXTURE (value);
-
-  g_assert (texture_id > 0);
-
-  if G_UNLIKELY (gdk_gl_context_get_use_es (gdk_gl_context_get_current ()))
-    {
-      pixel_data = free_data = g_malloc (width * height * 4);
-      gdk_memory_convert (pixel_data, width * 4,
-                          GDK_MEMORY_R8G8B8A8_PREMULTIPLIED,
-                          cairo_image_surface_get_data (surface),
-                          stride,
-                          GDK_MEMORY_DEFAULT,
-                          width, height);
-      stride = width * 4;
-      gl_format = GL_RGBA;
-      gl_type = GL_UNSIGNED_BYTE;
-    }
-  else
+  upload = g_new0 (GskGLGlyphUpload, 1);
+  upload->library = self;
+  upload->glyph = key->glyph;
+  upload->xshift = key->xshift;
+  upload->yshift = key->yshift;
+  upload->ink_rect = value->ink_rect;
+  upload->width = width;
+  upload->height = height;
+  upload->texture_id = GSK_GL_TEXTURE_ATLAS_ENTRY_TEXTURE (value);
+  upload->packed_x = packed_x;
+  upload->packed_y = packed_y;
+  upload->use_es = gdk_gl_context_get_use_es (gdk_gl_context_get_current ());
+
+  g_assert (upload->texture_id > 0);
+
+  g_ptr_array_add (self->pending, upload);
+
+  /* Only the cairo scaled font is safe to use from other threads,
+   * and hex boxes for unknown glyphs are drawn by Pango itself.
+   */
+  if (self->pool != NULL &&
+      (key->glyph & PANGO_GLYPH_UNKNOWN_FLAG) == 0 &&
+      PANGO_IS_CAIRO_FONT (key->font))
     {
-      pixel_data = cairo_image_surface_get_data (surface);
-      gl_format = GL_BGRA;
-      gl_type = GL_UNSIGNED_INT_8_8_8_8_REV;
+      cairo_scaled_font_t *scaled_font;
+
+      scaled_font = pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (key->font));
+      if (scaled_font != NULL &&
+          cairo_scaled_font_status (scaled_font) == CAIRO_STATUS_SUCCESS)
+        {
+          upload->scaled_font = cairo_scaled_font_reference (scaled_font);
+          g_thread_pool_push (self->pool, upload, NULL);
+          return;
+        }
     }
 
-  glPixelStorei (GL_UNPACK_ROW_LENGTH, stride / 4);
-  glBindTexture (GL_TEXTURE_2D, texture_id);
-
-  glTexSubImage2D (GL_TEXTURE_2D, 0,
-                   packed_x + 1, packed_y + 1,
-                   width, height,
-                   gl_format, gl_type,
-                   pixel_data);
-
-  /* Padding top */
-  glTexSubImage2D (GL_TEXTURE_2D, 0,
-                   packed_x + 1, packed_y,
-                   width, 1,
-                   gl_format, gl_type,
-                   pixel_data);
-  /* Padding left */
-  glTexSubImage2D (GL_TEXTURE_2D, 0,
-                   packed_x, packed_y + 1,
-                   1, height,
-                   gl_format, gl_type,
-                   pixel_data);
-  /* Padding top left */
-  glTexSubImage2D (GL_TEXTURE_2D, 0,
-                   packed_x, packed_y,
-                   1, 1,
-                   gl_format, gl_type,
-                   pixel_data);
-  /* Padding right */
-  glPixelStorei (GL_UNPACK_ROW_LENGTH, width);
-  glPixelStorei (GL_UNPACK_SKIP_PIXELS, width - 1);
-  glTexSubImage2D (GL_TEXTURE_2D, 0,
-                   packed_x + width + 1, packed_y + 1,
-                   1, height,
-                   gl_format, gl_type,
-                   pixel_data);
-  /* Padding top right */
-  glTexSubImage2D (GL_TEXTURE_2D, 0,
-                   packed_x + width + 1, packed_y,
-                   1, 1,
-                   gl_format, gl_type,
-                   pixel_data);
-  /* Padding bottom */
-  glPixelStorei (GL_UNPACK_SKIP_PIXELS, 0);
-  glPixelStorei (GL_UNPACK_ROW_LENGTH, 0);
-  glPixelStorei (GL_UNPACK_SKIP_ROWS, height - 1);
-  glTexSubImage2D (GL_TEXTURE_2D, 0,
-                   packed_x + 1, packed_y + 1 + height,
-                   width, 1,
-                   gl_format, gl_type,
-                   pixel_data);
-  /* Padding bottom left */
-  glTexSubImage2D (GL_TEXTURE_2D, 0,
-                   packed_x, packed_y + 1 + height,
-                   1, 1,
-                   gl_format, gl_type,
-                   pixel_data);
-  /* Padding bottom right */
-  glPixelStorei (GL_UNPACK_ROW_LENGTH, width);
-  glPixelStorei (GL_UNPACK_SKIP_PIXELS, width - 1);
-  glTexSubImage2D (GL_TEXTURE_2D, 0,
-                   packed_x + 1 + width, packed_y + 1 + height,
-                   1, 1,
-                   gl_format, gl_type,
-                   pixel_data);
-  /* Reset this */
-  glPixelStorei (GL_UNPACK_SKIP_PIXELS, 0);
-  glPixelStorei (GL_UNPACK_ROW_LENGTH, 0);
-  glPixelStorei (GL_UNPACK_SKIP_ROWS, 0);
-
-  cairo_surface_destroy (surface);
-  g_free (free_data);
-
-  gdk_gl_context_pop_debug_group (gdk_gl_context_get_current ());
-
-  tl->driver->command_queue->n_uploads++;
-
-  if (gdk_profiler_is_running ())
-    {
-      char message[64];
-      g_snprintf (message, sizeof message, "Size %dx%d", width, height);
-      gdk_profiler_add_mark (start_time, GDK_PROFILER_CURRENT_TIME-start_time, "Upload Glyph", message);
-    }
+  gsk_gl_glyph_upload_rasterize (upload, key->font);
+  upload->done = TRUE;
 }
 
-gboolean
-gsk_gl_glyph_library_add (GskGLGlyphLibrary      *self,
-                          GskGLGlyphKey          *key,
-                          const GskGLGlyphValue **out_value)
+/* Packs the glyph and queues it for upload, without counting a miss */
+static void
+gsk_gl_glyph_library_add_glyph (GskGLGlyphLibrary      *self,
+                                GskGLGlyphKey          *key,
+                                const GskGLGlyphValue **out_value)
 {
   GskGLTextureLibrary *tl = (GskGLTextureLibrary *)self;
   PangoRectangle ink_rect;
@@ -392,10 +514,6 @@ gsk_gl_glyph_library_add (GskGLGlyphLibrary      *self,
   guint packed_x;
   guint packed_y;
 
-  g_assert (GSK_IS_GL_GLYPH_LIBRARY (self));
-  g_assert (key != NULL);
-  g_assert (out_value != NULL);
-
   pango_font_get_glyph_extents (key->font, key->glyph, &ink_rect, NULL);
   pango_extents_to_pixels (&ink_rect, NULL);
 
@@ -418,17 +536,107 @@ gsk_gl_glyph_library_add (GskGLGlyphLibrary      *self,
   memcpy (&value->ink_rect, &ink_rect, sizeof ink_rect);
 
   if (key->scale > 0 && width > 0 && height > 0)
-    gsk_gl_glyph_library_upload_glyph (self,
+    gsk_gl_glyph_library_queue_upload (self,
                                        key,
                                        value,
                                        packed_x,
                                        packed_y,
                                        width,
-                                       height,
-                                       ink_rect.width,
-                                       ink_rect.height);
+                                       height);
 
   *out_value = value;
+}
+
+gboolean
+gsk_gl_glyph_library_add (GskGLGlyphLibrary      *self,
+                          GskGLGlyphKey          *key,
+                          const GskGLGlyphValue **out_value)
+{
+  g_assert (GSK_IS_GL_GLYPH_LIBRARY (self));
+  g_assert (key != NULL);
+  g_assert (out_value != NULL);
+
+  self->n_misses++;
+
+  gsk_gl_glyph_library_add_glyph (self, key, out_value);
+
+  return GSK_GL_TEXTURE_ATLAS_ENTRY_TEXTURE (*out_value) != 0;
+}
+
+/**
+ * gsk_gl_glyph_library_prewarm:
+ * @self: a `GskGLGlyphLibrary`
+ * @font: the font to load glyphs for
+ * @scale: the scale the font will be rendered at
+ *
+ * Adds the glyphs for printable ASCII characters of @font at all
+ * horizontal subpixel positions, so they are rasterized in the
+ * background before text using them is drawn.
+ *
+ * This does nothing if @font has already been prewarmed at @scale
+ * since the glyph cache was last cleared, or if there are no worker
+ * threads to rasterize on.
+ *
+ * The glyphs are uploaded with the next call to
+ * gsk_gl_glyph_library_upload_pending(). They are not counted
+ * as misses.
+ *
+ * Every font and scale costs hundreds of glyphs in the atlas, so
+ * this is meant to be called explicitly for the fonts that are
+ * known to be needed, not for every text that gets drawn.
+ */
+void
+gsk_gl_glyph_library_prewarm (GskGLGlyphLibrary *self,
+                              PangoFont         *font,
+                              float              scale)
+{
+  GskGLTextureAtlasEntry *entry;
+  const GskGLGlyphValue *value;
+  GskGLGlyphKey key;
+  GskGLGlyphKey *k;
+  hb_font_t *hb_font;
+
+  g_return_if_fail (GSK_IS_GL_GLYPH_LIBRARY (self));
+  g_return_if_fail (PANGO_IS_FONT (font));
 
-  return GSK_GL_TEXTURE_ATLAS_ENTRY_TEXTURE (value) != 0;
+  if (self->pool == NULL)
+    return;
+
+  memset (&key, 0, sizeof key);
+  key.font = font;
+  key.scale = (guint) (scale * 1024);
+
+  if (g_hash_table_contains (self->prewarmed, &key))
+    return;
+
+  k = g_memdup2 (&key, sizeof key);
+  g_object_ref (k->font);
+  g_hash_table_add (self->prewarmed, k);
+
+  hb_font = pango_font_get_hb_font (font);
+  if (hb_font == NULL)
+    return;
+
+  for (gunichar c = 0x20; c < 0x7f; c++)
+    {
+      hb_codepoint_t glyph;
+
+      if (!hb_font_get_nominal_glyph (hb_font, c, &glyph))
+        continue;
+
+      key.glyph = glyph;
+
+      for (guint xshift = 0; xshift < 4; xshift++)
+        {
+          key.xshift = xshift;
+
+          /* Not a lookup_or_add(), so that we don't count hits */
+          if (gsk_gl_texture_library_lookup ((GskGLTextureLibrary *)self, &key, &entry))
+            continue;
+
+          k = g_memdup2 (&key, sizeof key);
+          g_object_ref (k->font);
+          gsk_gl_glyph_library_add_glyph (self, k, &value);
+        }
+    }
 }
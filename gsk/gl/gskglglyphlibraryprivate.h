@@ -54,18 +54,39 @@ G_DECLARE_FINAL_TYPE (GskGLGlyphLibrary, gsk_gl_glyph_library, GSK, GL_GLYPH_LIB
 struct _GskGLGlyphLibrary
 {
   GskGLTextureLibrary parent_instance;
-  guint8 *surface_data;
-  gsize surface_data_len;
   struct {
     GskGLGlyphKey key;
     const GskGLGlyphValue *value;
   } front[256];
+
+  /* Glyphs that have been packed, but not uploaded yet. They are
+   * rasterized on @pool, if we have one, and uploaded together by
+   * gsk_gl_glyph_library_upload_pending().
+   */
+  GPtrArray *pending;
+  GThreadPool *pool;
+  GMutex lock;
+  GCond cond;
+
+  /* Keys with only font and scale set, for fonts that have been
+   * passed to gsk_gl_glyph_library_prewarm()
+   */
+  GHashTable *prewarmed;
+
+  /* Statistics since the last upload */
+  guint n_hits;
+  guint n_misses;
+  guint n_stalls;
 };
 
-GskGLGlyphLibrary *gsk_gl_glyph_library_new (GskGLDriver            *driver);
-gboolean           gsk_gl_glyph_library_add (GskGLGlyphLibrary      *self,
-                                             GskGLGlyphKey          *key,
-                                             const GskGLGlyphValue **out_value);
+GskGLGlyphLibrary *gsk_gl_glyph_library_new            (GskGLDriver            *driver);
+gboolean           gsk_gl_glyph_library_add            (GskGLGlyphLibrary      *self,
+                                                        GskGLGlyphKey          *key,
+                                                        const GskGLGlyphValue **out_value);
+void               gsk_gl_glyph_library_prewarm        (GskGLGlyphLibrary      *self,
+                                                        PangoFont              *font,
+                                                        float                   scale);
+void               gsk_gl_glyph_library_upload_pending (GskGLGlyphLibrary      *self);
 
 static inline guint
 gsk_gl_glyph_library_lookup_or_add (GskGLGlyphLibrary      *self,
@@ -78,12 +99,14 @@ gsk_gl_glyph_library_lookup_or_add (GskGLGlyphLibrary      *self,
   if (memcmp (key, &self->front[front_index], sizeof *key) == 0)
     {
       *out_value = self->front[front_index].value;
+      self->n_hits++;
     }
   else if (gsk_gl_texture_library_lookup ((GskGLTextureLibrary *)self, key, &entry))
     {
       *out_value = (GskGLGlyphValue *)entry;
       self->front[front_index].key = *key;
       self->front[front_index].value = *out_value;
+      self->n_hits++;
     }
   else
     {
@@ -0,0 +1,420 @@
+/* gskglprogramcache.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <gdk/gdkglcontextprivate.h>
+#include <gsk/gskdebugprivate.h>
+#include <gio/gio.h>
+#include <string.h>
+
+#include "gskglprogramcacheprivate.h"
+
+/* The cache file is a serialized GVariant holding the renderer
+ * string it was created for and a dictionary mapping the hash of
+ * a program's sources to its binary format and data.
+ */
+#define CACHE_FORMAT "(sa{s(uay)})"
+
+struct _GskGLProgramCache
+{
+  /* GL_VENDOR, GL_RENDERER and GL_VERSION, binaries are only
+   * valid for the exact driver that produced them.
+   */
+  char *renderer;
+
+  GFile *file;
+  char *etag;
+
+  /* Supported values for the binary format */
+  GArray *formats;
+
+  /* Programs used or added by this process, which is what we
+   * write back. Entries that were loaded from disk but not used
+   * are kept in @loaded, so stale programs from older shader
+   * sources drop out when the cache is rewritten.
+   */
+  GHashTable *programs;
+  GHashTable *loaded;
+
+  guint dirty : 1;
+};
+
+static char *
+gsk_gl_program_cache_get_dirname (void)
+{
+  return g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "gl-program-cache", NULL);
+}
+
+static gboolean
+gsk_gl_program_cache_load_file (GskGLProgramCache *self,
+                                GHashTable        *programs)
+{
+  GError *error = NULL;
+  GVariant *variant;
+  GVariant *dict;
+  GVariantIter iter;
+  const char *renderer;
+  char *etag, *data;
+  char *key;
+  GVariant *value;
+  gsize size;
+
+  if (!g_file_load_contents (self->file, NULL, &data, &size, &etag, &error))
+    {
+      GSK_DEBUG (OPENGL, "Failed to load GL program cache file '%s': %s",
+                 g_file_peek_path (self->file), error->message);
+      g_clear_error (&error);
+      return FALSE;
+    }
+
+  g_free (self->etag);
+  self->etag = etag;
+
+  variant = g_variant_new_from_data (G_VARIANT_TYPE (CACHE_FORMAT),
+                                     data, size, FALSE,
+                                     g_free, data);
+  g_variant_ref_sink (variant);
+  g_variant_get (variant, "(&s@a{s(uay)})", &renderer, &dict);
+
+  if (strcmp (renderer, self->renderer) != 0)
+    {
+      GSK_DEBUG (OPENGL, "GL program cache file '%s' is for a different renderer, ignoring",
+                 g_file_peek_path (self->file));
+      g_variant_unref (dict);
+      g_variant_unref (variant);
+      return FALSE;
+    }
+
+  g_variant_iter_init (&iter, dict);
+  while (g_variant_iter_next (&iter, "{s@(uay)}", &key, &value))
+    {
+      if (g_hash_table_contains (self->programs, key) ||
+          g_hash_table_contains (programs, key))
+        {
+          g_free (key);
+          g_variant_unref (value);
+          continue;
+        }
+
+      g_hash_table_insert (programs, key, value);
+    }
+
+  g_variant_unref (dict);
+  g_variant_unref (variant);
+
+  return TRUE;
+}
+
+/**
+ * gsk_gl_program_cache_new:
+ * @context: the current `GdkGLContext`
+ *
+ * Creates a cache for linked program binaries of the current GL
+ * driver and loads the previously saved binaries from disk.
+ *
+ * Returns: (transfer full) (nullable): a new `GskGLProgramCache`, or
+ *   %NULL if the driver can't retrieve program binaries
+ */
+GskGLProgramCache *
+gsk_gl_program_cache_new (GdkGLContext *context)
+{
+  GskGLProgramCache *self;
+  char *dirname, *basename, *path;
+  int n_formats = 0;
+
+  g_return_val_if_fail (GDK_IS_GL_CONTEXT (context), NULL);
+
+  if (!gdk_gl_context_check_version (context, "4.1", "3.0") &&
+      (gdk_gl_context_get_use_es (context) ||
+       !epoxy_has_gl_extension ("GL_ARB_get_program_binary")))
+    {
+      GSK_DEBUG (OPENGL, "GL program binaries not supported, not caching programs");
+      return NULL;
+    }
+
+  glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats);
+  if (n_formats <= 0)
+    {
+      GSK_DEBUG (OPENGL, "No GL program binary formats available, not caching programs");
+      return NULL;
+    }
+
+  self = g_new0 (GskGLProgramCache, 1);
+  self->formats = g_array_sized_new (FALSE, TRUE, sizeof (GLint), n_formats);
+  g_array_set_size (self->formats, n_formats);
+  glGetIntegerv (GL_PROGRAM_BINARY_FORMATS, (GLint *) (gpointer) self->formats->data);
+
+  self->renderer = g_strdup_printf ("%s\n%s\n%s",
+                                    (const char *) glGetString (GL_VENDOR),
+                                    (const char *) glGetString (GL_RENDERER),
+                                    (const char *) glGetString (GL_VERSION));
+
+  dirname = gsk_gl_program_cache_get_dirname ();
+  basename = g_compute_checksum_for_string (G_CHECKSUM_SHA256, self->renderer, -1);
+  path = g_build_filename (dirname, basename, NULL);
+  self->file = g_file_new_for_path (path);
+  g_free (path);
+  g_free (basename);
+  g_free (dirname);
+
+  self->programs = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                          g_free, (GDestroyNotify) g_variant_unref);
+  self->loaded = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                        g_free, (GDestroyNotify) g_variant_unref);
+
+  if (gsk_gl_program_cache_load_file (self, self->loaded))
+    GSK_DEBUG (OPENGL, "Loaded %u GL programs from %s",
+               g_hash_table_size (self->loaded),
+               g_file_peek_path (self->file));
+
+  return self;
+}
+
+void
+gsk_gl_program_cache_free (GskGLProgramCache *self)
+{
+  if (self == NULL)
+    return;
+
+  g_clear_pointer (&self->programs, g_hash_table_unref);
+  g_clear_pointer (&self->loaded, g_hash_table_unref);
+  g_clear_pointer (&self->formats, g_array_unref);
+  g_clear_object (&self->file);
+  g_free (self->etag);
+  g_free (self->renderer);
+  g_free (self);
+}
+
+static gboolean
+gsk_gl_program_cache_has_format (GskGLProgramCache *self,
+                                 GLenum             format)
+{
+  for (guint i = 0; i < self->formats->len; i++)
+    {
+      if ((GLenum) g_array_index (self->formats, GLint, i) == format)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/**
+ * gsk_gl_program_cache_load_program:
+ * @self: a `GskGLProgramCache`
+ * @key: the hash of the program's sources
+ * @program_id: a newly created program object
+ *
+ * Loads the cached binary for @key into @program_id.
+ *
+ * If the driver rejects the binary, it is dropped from the cache
+ * and the caller is expected to compile the program from source.
+ *
+ * Returns: %TRUE if @program_id was successfully linked
+ */
+gboolean
+gsk_gl_program_cache_load_program (GskGLProgramCache *self,
+                                   const char        *key,
+                                   guint              program_id)
+{
+  GVariant *value;
+  GVariant *binary;
+  gconstpointer data;
+  gsize size;
+  guint32 format;
+  int status;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+  g_return_val_if_fail (key != NULL, FALSE);
+
+  if (!(value = g_hash_table_lookup (self->programs, key)))
+    {
+      char *stolen_key;
+
+      if (!g_hash_table_steal_extended (self->loaded, key,
+                                        (gpointer *) &stolen_key,
+                                        (gpointer *) &value))
+        return FALSE;
+
+      g_hash_table_insert (self->programs, stolen_key, value);
+    }
+
+  g_variant_get (value, "(u@ay)", &format, &binary);
+  data = g_variant_get_fixed_array (binary, &size, 1);
+
+  if (size > 0 && size <= G_MAXINT && gsk_gl_program_cache_has_format (self, format))
+    {
+      glProgramBinary (program_id, format, data, size);
+      glGetProgramiv (program_id, GL_LINK_STATUS, &status);
+    }
+  else
+    {
+      status = GL_FALSE;
+    }
+
+  g_variant_unref (binary);
+
+  if (status == GL_FALSE)
+    {
+      GSK_DEBUG (OPENGL, "GL program binary %s was rejected by the driver", key);
+      g_hash_table_remove (self->programs, key);
+      self->dirty = TRUE;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * gsk_gl_program_cache_add_program:
+ * @self: a `GskGLProgramCache`
+ * @key: the hash of the program's sources
+ * @program_id: a successfully linked program
+ *
+ * Retrieves the binary of @program_id from the driver and
+ * stores it in the cache for @key.
+ *
+ * The program should have been linked with
+ * %GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+ */
+void
+gsk_gl_program_cache_add_program (GskGLProgramCache *self,
+                                  const char        *key,
+                                  guint              program_id)
+{
+  GVariant *value;
+  GLenum format;
+  int length = 0;
+  guint8 *data;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (key != NULL);
+
+  glGetProgramiv (program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+
+  data = g_malloc (length);
+  glGetProgramBinary (program_id, length, &length, &format, data);
+  if (length <= 0)
+    {
+      g_free (data);
+      return;
+    }
+
+  value = g_variant_new ("(u@ay)",
+                         format,
+                         g_variant_new_from_data (G_VARIANT_TYPE_BYTESTRING,
+                                                  data, length, TRUE,
+                                                  g_free, data));
+
+  g_hash_table_remove (self->loaded, key);
+  g_hash_table_insert (self->programs, g_strdup (key), g_variant_ref_sink (value));
+  self->dirty = TRUE;
+}
+
+gboolean
+gsk_gl_program_cache_is_dirty (GskGLProgramCache *self)
+{
+  g_return_val_if_fail (self != NULL, FALSE);
+
+  return self->dirty;
+}
+
+/**
+ * gsk_gl_program_cache_save:
+ * @self: a `GskGLProgramCache`
+ *
+ * Writes the programs used by this process back to disk, if
+ * any were added since the cache was loaded.
+ *
+ * If another process updated the file in the meantime, its
+ * programs are merged in before writing.
+ *
+ * Returns: %TRUE if the cache is saved
+ */
+gboolean
+gsk_gl_program_cache_save (GskGLProgramCache *self)
+{
+  GError *error = NULL;
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  GVariant *variant;
+  gpointer k, v;
+  char *path;
+  char *etag;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+
+  if (!self->dirty)
+    return TRUE;
+
+  path = gsk_gl_program_cache_get_dirname ();
+  if (g_mkdir_with_parents (path, 0755) != 0)
+    {
+      g_warning_once ("Failed to create GL program cache directory");
+      g_free (path);
+      return FALSE;
+    }
+  g_free (path);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{s(uay)}"));
+  g_hash_table_iter_init (&iter, self->programs);
+  while (g_hash_table_iter_next (&iter, &k, &v))
+    g_variant_builder_add (&builder, "{s@(uay)}", k, v);
+  variant = g_variant_ref_sink (g_variant_new ("(sa{s(uay)})", self->renderer, &builder));
+
+  GSK_DEBUG (OPENGL, "Saving %u GL programs to %s",
+             g_hash_table_size (self->programs),
+             g_file_peek_path (self->file));
+
+  if (!g_file_replace_contents (self->file,
+                                g_variant_get_data (variant),
+                                g_variant_get_size (variant),
+                                self->etag,
+                                FALSE,
+                                G_FILE_CREATE_NONE,
+                                &etag,
+                                NULL,
+                                &error))
+    {
+      g_variant_unref (variant);
+
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WRONG_ETAG))
+        {
+          GSK_DEBUG (OPENGL, "GL program cache file modified, merging into current");
+          if (!gsk_gl_program_cache_load_file (self, self->programs))
+            g_clear_pointer (&self->etag, g_free);
+          g_clear_error (&error);
+
+          /* try again */
+          return gsk_gl_program_cache_save (self);
+        }
+
+      g_warning ("Failed to save GL program cache: %s", error->message);
+      g_clear_error (&error);
+      return FALSE;
+    }
+
+  g_variant_unref (variant);
+  g_free (self->etag);
+  self->etag = etag;
+  self->dirty = FALSE;
+
+  return TRUE;
+}
@@ -0,0 +1,38 @@
+/* gskglprogramcacheprivate.h
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "gskgltypesprivate.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GskGLProgramCache GskGLProgramCache;
+
+GskGLProgramCache * gsk_gl_program_cache_new          (GdkGLContext      *context);
+void                gsk_gl_program_cache_free         (GskGLProgramCache *self);
+gboolean            gsk_gl_program_cache_load_program (GskGLProgramCache *self,
+                                                       const char        *key,
+                                                       guint              program_id);
+void                gsk_gl_program_cache_add_program  (GskGLProgramCache *self,
+                                                       const char        *key,
+                                                       guint              program_id);
+gboolean            gsk_gl_program_cache_is_dirty     (GskGLProgramCache *self);
+gboolean            gsk_gl_program_cache_save         (GskGLProgramCache *self);
+
+G_END_DECLS
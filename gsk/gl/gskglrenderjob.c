@@ -3925,6 +3925,62 @@ gsk_gl_render_job_visit_repeat_node (GskGLRenderJob      *job,
     }
 }
 
+static void
+gsk_gl_render_job_visit_container_node (GskGLRenderJob      *job,
+                                        const GskRenderNode *node)
+{
+  GskRenderNode **children;
+  guint n_children;
+
+  children = gsk_container_node_get_children (node, &n_children);
+
+  /* Large containers that are only partially visible can look up
+   * the visible children instead of checking every one of them.
+   */
+  if (!job->current_clip->is_fully_contained)
+    {
+      graphene_rect_t clip_rect;
+      GArray *indices;
+
+      gsk_gl_render_job_untransform_bounds (job, &job->current_clip->rect.bounds, &clip_rect);
+
+      indices = gsk_container_node_query (node, &clip_rect);
+      if (indices)
+        {
+          for (guint i = 0; i < indices->len; i++)
+            gsk_gl_render_job_visit_node (job, children[g_array_index (indices, guint, i)]);
+
+          g_array_unref (indices);
+          return;
+        }
+    }
+
+  for (guint i = 0; i < n_children; i++)
+    {
+      const GskRenderNode *child = children[i];
+
+      if (i + 1 < n_children &&
+          job->current_clip->is_fully_contained &&
+          gsk_render_node_get_node_type (child) == GSK_ROUNDED_CLIP_NODE)
+        {
+          const GskRenderNode *grandchild = gsk_rounded_clip_node_get_child (child);
+          const GskRenderNode *child2 = children[i + 1];
+          if (gsk_render_node_get_node_type (grandchild) == GSK_COLOR_NODE &&
+              gsk_render_node_get_node_type (child2) == GSK_BORDER_NODE &&
+              gsk_border_node_get_uniform_color (child2) &&
+              rounded_rect_equal (gsk_rounded_clip_node_get_clip (child),
+                                  gsk_border_node_get_outline (child2)))
+            {
+              gsk_gl_render_job_visit_css_background (job, child, child2);
+              i++; /* skip the border node */
+              continue;
+            }
+        }
+
+      gsk_gl_render_job_visit_node (job, child);
+    }
+}
+
 static void
 gsk_gl_render_job_visit_node (GskGLRenderJob      *job,
                               const GskRenderNode *node)
@@ -3983,37 +4039,7 @@ gsk_gl_render_job_visit_node (GskGLRenderJob      *job,
     break;
 
     case GSK_CONTAINER_NODE:
-      {
-        GskRenderNode **children;
-        guint n_children;
-
-        children = gsk_container_node_get_children (node, &n_children);
-
-        for (guint i = 0; i < n_children; i++)
-          {
-            const GskRenderNode *child = children[i];
-
-            if (i + 1 < n_children &&
-                job->current_clip->is_fully_contained &&
-                gsk_render_node_get_node_type (child) == GSK_ROUNDED_CLIP_NODE)
-              {
-                const GskRenderNode *grandchild = gsk_rounded_clip_node_get_child (child);
-                const GskRenderNode *child2 = children[i + 1];
-                if (gsk_render_node_get_node_type (grandchild) == GSK_COLOR_NODE &&
-                    gsk_render_node_get_node_type (child2) == GSK_BORDER_NODE &&
-                    gsk_border_node_get_uniform_color (child2) &&
-                    rounded_rect_equal (gsk_rounded_clip_node_get_clip (child),
-                                        gsk_border_node_get_outline (child2)))
-                  {
-                    gsk_gl_render_job_visit_css_background (job, child, child2);
-                    i++; /* skip the border node */
-                    continue;
-                  }
-              }
-
-            gsk_gl_render_job_visit_node (job, child);
-          }
-      }
+      gsk_gl_render_job_visit_container_node (job, node);
     break;
 
     case GSK_CROSS_FADE_NODE:
@@ -4398,6 +4424,7 @@ gsk_gl_render_job_render_flipped (GskGLRenderJob *job,
       gsk_gl_render_job_end_draw (job);
     }
 
+  gsk_gl_glyph_library_upload_pending (job->driver->glyphs_library);
   gdk_gl_context_push_debug_group (job->command_queue->context, "Executing command queue");
   gsk_gl_command_queue_execute (job->command_queue, surface_height, 1, NULL, job->default_framebuffer);
   gdk_gl_context_pop_debug_group (job->command_queue->context);
@@ -4448,6 +4475,7 @@ gsk_gl_render_job_render (GskGLRenderJob *job,
    */
   start_time = GDK_PROFILER_CURRENT_TIME;
   gsk_gl_command_queue_make_current (job->command_queue);
+  gsk_gl_glyph_library_upload_pending (job->driver->glyphs_library);
   gdk_gl_context_push_debug_group (job->command_queue->context, "Executing command queue");
   gsk_gl_command_queue_execute (job->command_queue, surface_height, scale, job->region, job->default_framebuffer);
   gdk_gl_context_pop_debug_group (job->command_queue->context);
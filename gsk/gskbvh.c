@@ -0,0 +1,318 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gskbvhprivate.h"
+
+#include "gskrendernodeprivate.h"
+
+/* A bounding volume hierarchy over the bounds of a list of render
+ * nodes, so that the ones intersecting a rectangle can be found
+ * without looking at all of them.
+ *
+ * The tree is built top-down by splitting the nodes at the median
+ * of their centers along the longer axis, which keeps it balanced.
+ * Tree nodes are stored in depth-first order, so the left child of
+ * an inner node always directly follows it.
+ */
+
+#define LEAF_SIZE 8
+#define MAX_DEPTH 64
+
+typedef struct _GskBvhNode GskBvhNode;
+
+struct _GskBvhNode
+{
+  graphene_rect_t bounds;
+  guint first; /* leaf: first entry in indices, inner node: index of right child */
+  guint n;     /* leaf: number of entries, inner node: 0 */
+};
+
+struct _GskBvh
+{
+  GskBvhNode *nodes;
+  guint n_nodes;
+
+  /* Both in leaf order */
+  guint *indices;
+  graphene_rect_t *bounds;
+};
+
+typedef struct
+{
+  GskRenderNode * const *nodes;
+  float *centers;
+  guint *indices;
+  GArray *tree;
+} GskBvhBuilder;
+
+static inline float
+center (const GskBvhBuilder *builder,
+        guint                idx,
+        guint                axis)
+{
+  return builder->centers[2 * idx + axis];
+}
+
+/* Partially sorts @indices so that the entry at @k is the one that
+ * would be there if it was sorted by center, with smaller ones before
+ * and larger ones after it.
+ */
+static void
+select_nth (const GskBvhBuilder *builder,
+            guint               *indices,
+            int                  n,
+            int                  k,
+            guint                axis)
+{
+  int lo, hi;
+
+  lo = 0;
+  hi = n - 1;
+
+  while (lo < hi)
+    {
+      float pivot = center (builder, indices[(lo + hi) / 2], axis);
+      int i = lo;
+      int j = hi;
+
+      while (i <= j)
+        {
+          while (center (builder, indices[i], axis) < pivot)
+            i++;
+          while (center (builder, indices[j], axis) > pivot)
+            j--;
+
+          if (i <= j)
+            {
+              guint tmp = indices[i];
+              indices[i] = indices[j];
+              indices[j] = tmp;
+              i++;
+              j--;
+            }
+        }
+
+      if (k <= j)
+        hi = j;
+      else if (k >= i)
+        lo = i;
+      else
+        break;
+    }
+}
+
+static guint
+gsk_bvh_build (GskBvhBuilder *builder,
+               guint          start,
+               guint          count)
+{
+  GskBvhNode *node;
+  float x0, y0, x1, y1;
+  float cx0, cy0, cx1, cy1;
+  guint self, right, half, axis, i;
+
+  self = builder->tree->len;
+  g_array_set_size (builder->tree, self + 1);
+
+  x0 = y0 = cx0 = cy0 = G_MAXFLOAT;
+  x1 = y1 = cx1 = cy1 = -G_MAXFLOAT;
+
+  for (i = start; i < start + count; i++)
+    {
+      guint idx = builder->indices[i];
+      const graphene_rect_t *b = &builder->nodes[idx]->bounds;
+
+      x0 = MIN (x0, b->origin.x);
+      y0 = MIN (y0, b->origin.y);
+      x1 = MAX (x1, b->origin.x + b->size.width);
+      y1 = MAX (y1, b->origin.y + b->size.height);
+
+      cx0 = MIN (cx0, center (builder, idx, 0));
+      cy0 = MIN (cy0, center (builder, idx, 1));
+      cx1 = MAX (cx1, center (builder, idx, 0));
+      cy1 = MAX (cy1, center (builder, idx, 1));
+    }
+
+  if (count > LEAF_SIZE)
+    {
+      axis = (cx1 - cx0 >= cy1 - cy0) ? 0 : 1;
+      half = count / 2;
+
+      select_nth (builder, builder->indices + start, count, half, axis);
+
+      /* The left child ends up at self + 1 */
+      gsk_bvh_build (builder, start, half);
+      right = gsk_bvh_build (builder, start + half, count - half);
+    }
+  else
+    {
+      right = 0;
+    }
+
+  /* Building the children may have reallocated the array */
+  node = &g_array_index (builder->tree, GskBvhNode, self);
+  graphene_rect_init (&node->bounds, x0, y0, x1 - x0, y1 - y0);
+  if (count > LEAF_SIZE)
+    {
+      node->first = right;
+      node->n = 0;
+    }
+  else
+    {
+      node->first = start;
+      node->n = count;
+    }
+
+  return self;
+}
+
+/*< private >
+ * gsk_bvh_new:
+ * @nodes: (array length=n_nodes): the nodes to index
+ * @n_nodes: the number of nodes, must not be 0
+ *
+ * Builds an index over the bounds of @nodes. The nodes themselves
+ * are not referenced, only their bounds are copied.
+ *
+ * Returns: (transfer full): a new `GskBvh`
+ */
+GskBvh *
+gsk_bvh_new (GskRenderNode * const *nodes,
+             guint                  n_nodes)
+{
+  GskBvhBuilder builder;
+  GskBvh *self;
+  guint i;
+
+  g_return_val_if_fail (n_nodes > 0, NULL);
+
+  builder.nodes = nodes;
+  builder.centers = g_new (float, 2 * n_nodes);
+  builder.indices = g_new (guint, n_nodes);
+  builder.tree = g_array_sized_new (FALSE, FALSE, sizeof (GskBvhNode),
+                                    2 * (n_nodes + LEAF_SIZE - 1) / LEAF_SIZE);
+
+  for (i = 0; i < n_nodes; i++)
+    {
+      const graphene_rect_t *b = &nodes[i]->bounds;
+
+      builder.centers[2 * i] = b->origin.x + b->size.width / 2;
+      builder.centers[2 * i + 1] = b->origin.y + b->size.height / 2;
+      builder.indices[i] = i;
+    }
+
+  gsk_bvh_build (&builder, 0, n_nodes);
+
+  self = g_new (GskBvh, 1);
+  self->n_nodes = builder.tree->len;
+  self->nodes = (GskBvhNode *) g_array_free (builder.tree, FALSE);
+  self->indices = builder.indices;
+  self->bounds = g_new (graphene_rect_t, n_nodes);
+  for (i = 0; i < n_nodes; i++)
+    self->bounds[i] = nodes[self->indices[i]]->bounds;
+
+  g_free (builder.centers);
+
+  return self;
+}
+
+void
+gsk_bvh_free (GskBvh *self)
+{
+  g_free (self->nodes);
+  g_free (self->indices);
+  g_free (self->bounds);
+  g_free (self);
+}
+
+/* Same semantics as graphene_rect_intersection(), touching
+ * rectangles don't intersect.
+ */
+static inline gboolean
+rect_intersects (const graphene_rect_t *r1,
+                 const graphene_rect_t *r2)
+{
+  return r1->origin.x < r2->origin.x + r2->size.width &&
+         r2->origin.x < r1->origin.x + r1->size.width &&
+         r1->origin.y < r2->origin.y + r2->size.height &&
+         r2->origin.y < r1->origin.y + r1->size.height;
+}
+
+static int
+compare_index (gconstpointer a,
+               gconstpointer b,
+               gpointer      unused)
+{
+  guint ia = *(const guint *) a;
+  guint ib = *(const guint *) b;
+
+  return (ia > ib) - (ia < ib);
+}
+
+/*< private >
+ * gsk_bvh_query:
+ * @self: a `GskBvh`
+ * @rect: the rectangle to look for
+ * @indices: (element-type guint): array to append the results to
+ *
+ * Appends the indices of all nodes whose bounds intersect @rect
+ * to @indices, in ascending order, so they can be drawn in the
+ * order they were given in.
+ */
+void
+gsk_bvh_query (const GskBvh          *self,
+               const graphene_rect_t *rect,
+               GArray                *indices)
+{
+  guint stack[MAX_DEPTH];
+  guint n_stack, start, i;
+
+  start = indices->len;
+  n_stack = 0;
+  stack[n_stack++] = 0;
+
+  while (n_stack > 0)
+    {
+      guint self_idx = stack[--n_stack];
+      const GskBvhNode *node = &self->nodes[self_idx];
+
+      if (!rect_intersects (&node->bounds, rect))
+        continue;
+
+      if (node->n > 0)
+        {
+          for (i = node->first; i < node->first + node->n; i++)
+            {
+              if (rect_intersects (&self->bounds[i], rect))
+                g_array_append_val (indices, self->indices[i]);
+            }
+        }
+      else
+        {
+          g_assert (n_stack + 2 <= MAX_DEPTH);
+          stack[n_stack++] = node->first;
+          stack[n_stack++] = self_idx + 1;
+        }
+    }
+
+  if (indices->len - start > 1)
+    g_qsort_with_data (&g_array_index (indices, guint, start),
+                       indices->len - start,
+                       sizeof (guint),
+                       compare_index,
+                       NULL);
+}
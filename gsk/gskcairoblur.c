@@ -122,6 +122,34 @@ blur_xspan (guchar *row,
   memcpy (row, tmp_buffer, row_width);
 }
 
+/* Applies the three box blur passes to a single row.
+ */
+static void
+blur_row (guchar *row,
+          guchar *tmp_buffer,
+          int     row_width,
+          int     d)
+{
+  /* We want to produce a symmetric blur that spreads a pixel
+   * equally far to the left and right. If d is odd that happens
+   * naturally, but for d even, we approximate by using a blur
+   * on either side and then a centered blur of size d + 1.
+   * (technique also from the SVG specification)
+   */
+  if (d % 2 == 1)
+    {
+      blur_xspan (row, tmp_buffer, row_width, d, 0);
+      blur_xspan (row, tmp_buffer, row_width, d, 0);
+      blur_xspan (row, tmp_buffer, row_width, d, 0);
+    }
+  else
+    {
+      blur_xspan (row, tmp_buffer, row_width, d, 1);
+      blur_xspan (row, tmp_buffer, row_width, d, -1);
+      blur_xspan (row, tmp_buffer, row_width, d + 1, 0);
+    }
+}
+
 static void
 blur_rows (guchar *dst_buffer,
            guchar *tmp_buffer,
@@ -135,25 +163,43 @@ blur_rows (guchar *dst_buffer,
     {
       guchar *row = dst_buffer + i * buffer_width;
 
-      /* We want to produce a symmetric blur that spreads a pixel
-       * equally far to the left and right. If d is odd that happens
-       * naturally, but for d even, we approximate by using a blur
-       * on either side and then a centered blur of size d + 1.
-       * (technique also from the SVG specification)
-       */
-      if (d % 2 == 1)
-        {
-          blur_xspan (row, tmp_buffer, buffer_width, d, 0);
-          blur_xspan (row, tmp_buffer, buffer_width, d, 0);
-          blur_xspan (row, tmp_buffer, buffer_width, d, 0);
-        }
-      else
+      blur_row (row, tmp_buffer, buffer_width, d);
+    }
+}
+
+/* Like blur_rows(), but for 4 interleaved channels, each of which
+ * is blurred independently.
+ */
+static void
+blur_channels (guchar *dst_buffer,
+               guchar *tmp_buffer,
+               int     width,
+               int     height,
+               int     stride,
+               int     d)
+{
+  guchar *channel;
+  int i, c, x;
+
+  channel = g_malloc (width);
+
+  for (i = 0; i < height; i++)
+    {
+      guchar *row = dst_buffer + i * stride;
+
+      for (c = 0; c < 4; c++)
         {
-          blur_xspan (row, tmp_buffer, buffer_width, d, 1);
-          blur_xspan (row, tmp_buffer, buffer_width, d, -1);
-          blur_xspan (row, tmp_buffer, buffer_width, d + 1, 0);
+          for (x = 0; x < width; x++)
+            channel[x] = row[4 * x + c];
+
+          blur_row (channel, tmp_buffer, width, d);
+
+          for (x = 0; x < width; x++)
+            row[4 * x + c] = channel[x];
         }
     }
+
+  g_free (channel);
 }
 
 /* Swaps width and height.
@@ -189,52 +235,581 @@ static void
 _boxblur (guchar      *buffer,
           int          width,
           int          height,
+          int          stride,
+          int          bpp,
           int          radius,
           GskBlurFlags flags)
 {
   guchar *flipped_buffer;
   int d = get_box_filter_size (radius);
 
-  flipped_buffer = g_malloc (width * height);
+  flipped_buffer = g_malloc (stride * height);
 
   if (flags & GSK_BLUR_Y)
     {
       /* Step 1: swap rows and columns */
-      flip_buffer (flipped_buffer, buffer, width, height);
+      flip_buffer (flipped_buffer, buffer, stride, height);
 
       /* Step 2: blur rows (really columns) */
-      blur_rows (flipped_buffer, buffer, height, width, d);
+      blur_rows (flipped_buffer, buffer, height, stride, d);
 
       /* Step 3: swap rows and columns */
-      flip_buffer (buffer, flipped_buffer, height, width);
+      flip_buffer (buffer, flipped_buffer, height, stride);
     }
 
   if (flags & GSK_BLUR_X)
     {
       /* Step 4: blur rows */
-      blur_rows (buffer, flipped_buffer, width, height, d);
+      if (bpp == 1)
+        blur_rows (buffer, flipped_buffer, stride, height, d);
+      else
+        blur_channels (buffer, flipped_buffer, width, height, stride, d);
     }
 
   g_free (flipped_buffer);
 }
 
-/*
- * _gsk_cairo_blur_surface:
- * @surface: a cairo image surface.
- * @radius: the blur radius.
+/* The vectorized kernels below blur a "strip": a buffer of len
+ * elements of lanes bytes each, where every lane is blurred
+ * independently. Loading several columns (for the vertical blur) or
+ * several transposed rows (for the horizontal blur) into the lanes
+ * lets us process them all at once.
  *
- * Blurs the cairo image surface at the given radius.
+ * They compute exactly the same values as blur_xspan(). The division
+ * is done in floating point and then corrected, which is exact as long
+ * as all sums fit into the 24 bit mantissa of a float.
+ */
+#define MAX_SIMD_BOX_FILTER_SIZE 65534
+
+typedef struct
+{
+  int lanes;
+  void (* blur_strip) (const guchar *src,
+                       guchar       *dst,
+                       int           len,
+                       int           d,
+                       int           shift);
+} BlurKernelImpl;
+
+static inline int
+blur_strip_offset (int d,
+                   int shift)
+{
+  if (d % 2 == 1)
+    return d / 2;
+  else
+    return (d - shift) / 2;
+}
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_BLUR_X86 1
+
+#include <immintrin.h>
+
+static inline void __attribute__((target ("sse2")))
+unpack_sse2 (const guchar *p,
+             __m128i       v[4])
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  __m128i b, lo, hi;
+
+  b = _mm_loadu_si128 ((const __m128i *) p);
+  lo = _mm_unpacklo_epi8 (b, zero);
+  hi = _mm_unpackhi_epi8 (b, zero);
+  v[0] = _mm_unpacklo_epi16 (lo, zero);
+  v[1] = _mm_unpackhi_epi16 (lo, zero);
+  v[2] = _mm_unpacklo_epi16 (hi, zero);
+  v[3] = _mm_unpackhi_epi16 (hi, zero);
+}
+
+static inline __m128i __attribute__((target ("sse2")))
+divide_sse2 (__m128i n,
+             __m128  df,
+             __m128  inv_d)
+{
+  __m128 nf, r;
+  __m128i q;
+
+  nf = _mm_cvtepi32_ps (n);
+  q = _mm_cvttps_epi32 (_mm_mul_ps (nf, inv_d));
+  r = _mm_sub_ps (nf, _mm_mul_ps (_mm_cvtepi32_ps (q), df));
+  /* comparison masks are -1, so this is q - 1 or q + 1 */
+  q = _mm_add_epi32 (q, _mm_castps_si128 (_mm_cmplt_ps (r, _mm_setzero_ps ())));
+  q = _mm_sub_epi32 (q, _mm_castps_si128 (_mm_cmpge_ps (r, df)));
+
+  return q;
+}
+
+static void __attribute__((target ("sse2")))
+blur_strip_sse2 (const guchar *src,
+                 guchar       *dst,
+                 int           len,
+                 int           d,
+                 int           shift)
+{
+  const __m128i half = _mm_set1_epi32 (d / 2);
+  const __m128 df = _mm_set1_ps (d);
+  const __m128 inv_d = _mm_set1_ps (1.0f / d);
+  __m128i sum[4], v[4], q[4];
+  int offset, i, j;
+
+  offset = blur_strip_offset (d, shift);
+
+  for (j = 0; j < 4; j++)
+    sum[j] = _mm_setzero_si128 ();
+
+  for (i = -d + offset; i < len + offset; i++)
+    {
+      if (i >= 0 && i < len)
+        {
+          unpack_sse2 (src + i * 16, v);
+          for (j = 0; j < 4; j++)
+            sum[j] = _mm_add_epi32 (sum[j], v[j]);
+        }
+
+      if (i >= offset)
+        {
+          if (i >= d)
+            {
+              unpack_sse2 (src + (i - d) * 16, v);
+              for (j = 0; j < 4; j++)
+                sum[j] = _mm_sub_epi32 (sum[j], v[j]);
+            }
+
+          for (j = 0; j < 4; j++)
+            q[j] = divide_sse2 (_mm_add_epi32 (sum[j], half), df, inv_d);
+
+          _mm_storeu_si128 ((__m128i *) (dst + (i - offset) * 16),
+                            _mm_packus_epi16 (_mm_packs_epi32 (q[0], q[1]),
+                                              _mm_packs_epi32 (q[2], q[3])));
+        }
+    }
+}
+
+static inline void __attribute__((target ("avx2")))
+unpack_avx2 (const guchar *p,
+             __m256i       v[4])
+{
+  int j;
+
+  for (j = 0; j < 4; j++)
+    v[j] = _mm256_cvtepu8_epi32 (_mm_loadl_epi64 ((const __m128i *) (p + 8 * j)));
+}
+
+static inline __m256i __attribute__((target ("avx2")))
+divide_avx2 (__m256i n,
+             __m256  df,
+             __m256  inv_d)
+{
+  __m256 nf, r;
+  __m256i q;
+
+  nf = _mm256_cvtepi32_ps (n);
+  q = _mm256_cvttps_epi32 (_mm256_mul_ps (nf, inv_d));
+  r = _mm256_sub_ps (nf, _mm256_mul_ps (_mm256_cvtepi32_ps (q), df));
+  q = _mm256_add_epi32 (q, _mm256_castps_si256 (_mm256_cmp_ps (r, _mm256_setzero_ps (), _CMP_LT_OQ)));
+  q = _mm256_sub_epi32 (q, _mm256_castps_si256 (_mm256_cmp_ps (r, df, _CMP_GE_OQ)));
+
+  return q;
+}
+
+static void __attribute__((target ("avx2")))
+blur_strip_avx2 (const guchar *src,
+                 guchar       *dst,
+                 int           len,
+                 int           d,
+                 int           shift)
+{
+  const __m256i half = _mm256_set1_epi32 (d / 2);
+  const __m256 df = _mm256_set1_ps (d);
+  const __m256 inv_d = _mm256_set1_ps (1.0f / d);
+  /* undoes the lane interleaving of the pack instructions */
+  const __m256i order = _mm256_setr_epi32 (0, 4, 1, 5, 2, 6, 3, 7);
+  __m256i sum[4], v[4], q[4];
+  int offset, i, j;
+
+  offset = blur_strip_offset (d, shift);
+
+  for (j = 0; j < 4; j++)
+    sum[j] = _mm256_setzero_si256 ();
+
+  for (i = -d + offset; i < len + offset; i++)
+    {
+      if (i >= 0 && i < len)
+        {
+          unpack_avx2 (src + i * 32, v);
+          for (j = 0; j < 4; j++)
+            sum[j] = _mm256_add_epi32 (sum[j], v[j]);
+        }
+
+      if (i >= offset)
+        {
+          if (i >= d)
+            {
+              unpack_avx2 (src + (i - d) * 32, v);
+              for (j = 0; j < 4; j++)
+                sum[j] = _mm256_sub_epi32 (sum[j], v[j]);
+            }
+
+          for (j = 0; j < 4; j++)
+            q[j] = divide_avx2 (_mm256_add_epi32 (sum[j], half), df, inv_d);
+
+          _mm256_storeu_si256 ((__m256i *) (dst + (i - offset) * 32),
+                               _mm256_permutevar8x32_epi32 (_mm256_packus_epi16 (_mm256_packs_epi32 (q[0], q[1]),
+                                                                                 _mm256_packs_epi32 (q[2], q[3])),
+                                                            order));
+        }
+    }
+}
+
+static const BlurKernelImpl blur_kernel_sse2 = { 16, blur_strip_sse2 };
+static const BlurKernelImpl blur_kernel_avx2 = { 32, blur_strip_avx2 };
+
+#endif /* x86 */
+
+#if defined(__ARM_NEON)
+#define HAVE_BLUR_NEON 1
+
+#include <arm_neon.h>
+
+static inline void
+unpack_neon (const guchar *p,
+             uint32x4_t    v[4])
+{
+  uint8x16_t b;
+  uint16x8_t lo, hi;
+
+  b = vld1q_u8 (p);
+  lo = vmovl_u8 (vget_low_u8 (b));
+  hi = vmovl_u8 (vget_high_u8 (b));
+  v[0] = vmovl_u16 (vget_low_u16 (lo));
+  v[1] = vmovl_u16 (vget_high_u16 (lo));
+  v[2] = vmovl_u16 (vget_low_u16 (hi));
+  v[3] = vmovl_u16 (vget_high_u16 (hi));
+}
+
+static inline uint32x4_t
+divide_neon (uint32x4_t  n,
+             float32x4_t df,
+             float32x4_t inv_d)
+{
+  float32x4_t nf, r;
+  uint32x4_t q;
+
+  nf = vcvtq_f32_u32 (n);
+  q = vcvtq_u32_f32 (vmulq_f32 (nf, inv_d));
+  r = vsubq_f32 (nf, vmulq_f32 (vcvtq_f32_u32 (q), df));
+  /* comparison masks are all ones, so this is q - 1 or q + 1 */
+  q = vaddq_u32 (q, vcltq_f32 (r, vdupq_n_f32 (0)));
+  q = vsubq_u32 (q, vcgeq_f32 (r, df));
+
+  return q;
+}
+
+static void
+blur_strip_neon (const guchar *src,
+                 guchar       *dst,
+                 int           len,
+                 int           d,
+                 int           shift)
+{
+  const uint32x4_t half = vdupq_n_u32 (d / 2);
+  const float32x4_t df = vdupq_n_f32 (d);
+  const float32x4_t inv_d = vdupq_n_f32 (1.0f / d);
+  uint32x4_t sum[4], v[4], q[4];
+  int offset, i, j;
+
+  offset = blur_strip_offset (d, shift);
+
+  for (j = 0; j < 4; j++)
+    sum[j] = vdupq_n_u32 (0);
+
+  for (i = -d + offset; i < len + offset; i++)
+    {
+      if (i >= 0 && i < len)
+        {
+          unpack_neon (src + i * 16, v);
+          for (j = 0; j < 4; j++)
+            sum[j] = vaddq_u32 (sum[j], v[j]);
+        }
+
+      if (i >= offset)
+        {
+          if (i >= d)
+            {
+              unpack_neon (src + (i - d) * 16, v);
+              for (j = 0; j < 4; j++)
+                sum[j] = vsubq_u32 (sum[j], v[j]);
+            }
+
+          for (j = 0; j < 4; j++)
+            q[j] = divide_neon (vaddq_u32 (sum[j], half), df, inv_d);
+
+          vst1q_u8 (dst + (i - offset) * 16,
+                    vcombine_u8 (vmovn_u16 (vcombine_u16 (vmovn_u32 (q[0]), vmovn_u32 (q[1]))),
+                                 vmovn_u16 (vcombine_u16 (vmovn_u32 (q[2]), vmovn_u32 (q[3])))));
+        }
+    }
+}
+
+static const BlurKernelImpl blur_kernel_neon = { 16, blur_strip_neon };
+
+#endif /* __ARM_NEON */
+
+/* Runs the three box blur passes over a strip, like blur_row().
+ * The result ends up in @tmp.
+ */
+static void
+blur_strip (const BlurKernelImpl *impl,
+            guchar               *strip,
+            guchar               *tmp,
+            int                   len,
+            int                   d)
+{
+  if (d % 2 == 1)
+    {
+      impl->blur_strip (strip, tmp, len, d, 0);
+      impl->blur_strip (tmp, strip, len, d, 0);
+      impl->blur_strip (strip, tmp, len, d, 0);
+    }
+  else
+    {
+      impl->blur_strip (strip, tmp, len, d, 1);
+      impl->blur_strip (tmp, strip, len, d, -1);
+      impl->blur_strip (strip, tmp, len, d + 1, 0);
+    }
+}
+
+/* Transposes up to lanes / bpp rows of @buffer into the lanes of
+ * @strip, or back if @to_strip is %FALSE. Like flip_buffer(), this
+ * works in blocks to be more cache friendly.
+ */
+static void
+transpose_strip (guchar   *strip,
+                 guchar   *buffer,
+                 int       stride,
+                 int       width,
+                 int       n_rows,
+                 int       bpp,
+                 int       lanes,
+                 gboolean  to_strip)
+{
+#define BLOCK_SIZE 64
+  int x0, x, k;
+
+  for (x0 = 0; x0 < width; x0 += BLOCK_SIZE)
+    {
+      int max_x = MIN (x0 + BLOCK_SIZE, width);
+
+      for (k = 0; k < n_rows; k++)
+        {
+          guchar *row = buffer + k * stride;
+
+          if (bpp == 4)
+            {
+              guint32 *s = (guint32 *) strip + k;
+              guint32 *r = (guint32 *) row;
+              int step = lanes / 4;
+
+              for (x = x0; x < max_x; x++)
+                {
+                  if (to_strip)
+                    s[x * step] = r[x];
+                  else
+                    r[x] = s[x * step];
+                }
+            }
+          else
+            {
+              for (x = x0; x < max_x; x++)
+                {
+                  if (to_strip)
+                    strip[x * lanes + k] = row[x];
+                  else
+                    row[x] = strip[x * lanes + k];
+                }
+            }
+        }
+    }
+#undef BLOCK_SIZE
+}
+
+/* Same as _boxblur(), using a vectorized kernel */
+static void
+_boxblur_simd (const BlurKernelImpl *impl,
+               guchar               *buffer,
+               int                   width,
+               int                   height,
+               int                   stride,
+               int                   bpp,
+               int                   radius,
+               GskBlurFlags          flags)
+{
+  int d = get_box_filter_size (radius);
+  int lanes = impl->lanes;
+  guchar *strip, *tmp;
+  int x, y;
+
+  strip = g_malloc_n (MAX (width, height), lanes);
+  tmp = g_malloc_n (MAX (width, height), lanes);
+
+  if (flags & GSK_BLUR_Y)
+    {
+      /* Columns are independent, so we can just load them into the
+       * lanes row by row.
+       */
+      for (x = 0; x < width * bpp; x += lanes)
+        {
+          int n = MIN (lanes, width * bpp - x);
+
+          for (y = 0; y < height; y++)
+            {
+              memcpy (strip + y * lanes, buffer + y * stride + x, n);
+              memset (strip + y * lanes + n, 0, lanes - n);
+            }
+
+          blur_strip (impl, strip, tmp, height, d);
+
+          for (y = 0; y < height; y++)
+            memcpy (buffer + y * stride + x, tmp + y * lanes, n);
+        }
+    }
+
+  if (flags & GSK_BLUR_X)
+    {
+      int rows_per_strip = lanes / bpp;
+
+      for (y = 0; y < height; y += rows_per_strip)
+        {
+          int n_rows = MIN (rows_per_strip, height - y);
+
+          if (n_rows < rows_per_strip)
+            memset (strip, 0, width * lanes);
+
+          transpose_strip (strip, buffer + y * stride, stride, width, n_rows, bpp, lanes, TRUE);
+          blur_strip (impl, strip, tmp, width, d);
+          transpose_strip (tmp, buffer + y * stride, stride, width, n_rows, bpp, lanes, FALSE);
+        }
+    }
+
+  g_free (strip);
+  g_free (tmp);
+}
+
+static const BlurKernelImpl *
+get_kernel_impl (GskBlurKernel kernel)
+{
+  switch (kernel)
+    {
+#ifdef HAVE_BLUR_X86
+    case GSK_BLUR_KERNEL_SSE2:
+      return &blur_kernel_sse2;
+    case GSK_BLUR_KERNEL_AVX2:
+      return &blur_kernel_avx2;
+#endif
+#ifdef HAVE_BLUR_NEON
+    case GSK_BLUR_KERNEL_NEON:
+      return &blur_kernel_neon;
+#endif
+    case GSK_BLUR_KERNEL_SCALAR:
+    default:
+      return NULL;
+    }
+}
+
+/*<private>
+ * gsk_cairo_blur_kernel_is_supported:
+ * @kernel: the kernel to check
+ *
+ * Checks if @kernel is compiled in and supported by the CPU.
+ *
+ * Returns: %TRUE if @kernel can be used
+ */
+gboolean
+gsk_cairo_blur_kernel_is_supported (GskBlurKernel kernel)
+{
+  switch (kernel)
+    {
+    case GSK_BLUR_KERNEL_SCALAR:
+      return TRUE;
+
+#ifdef HAVE_BLUR_X86
+    case GSK_BLUR_KERNEL_SSE2:
+      __builtin_cpu_init ();
+      return __builtin_cpu_supports ("sse2");
+
+    case GSK_BLUR_KERNEL_AVX2:
+      __builtin_cpu_init ();
+      return __builtin_cpu_supports ("avx2");
+#endif
+
+#ifdef HAVE_BLUR_NEON
+    case GSK_BLUR_KERNEL_NEON:
+      return TRUE;
+#endif
+
+    default:
+      return FALSE;
+    }
+}
+
+static GskBlurKernel
+get_default_kernel (void)
+{
+  static gsize kernel__set;
+  static GskBlurKernel kernel;
+
+  if (g_once_init_enter (&kernel__set))
+    {
+      const GskBlurKernel preferred[] = {
+        GSK_BLUR_KERNEL_AVX2,
+        GSK_BLUR_KERNEL_SSE2,
+        GSK_BLUR_KERNEL_NEON,
+      };
+      guint i;
+
+      kernel = GSK_BLUR_KERNEL_SCALAR;
+      for (i = 0; i < G_N_ELEMENTS (preferred); i++)
+        {
+          if (gsk_cairo_blur_kernel_is_supported (preferred[i]))
+            {
+              kernel = preferred[i];
+              break;
+            }
+        }
+
+      g_once_init_leave (&kernel__set, TRUE);
+    }
+
+  return kernel;
+}
+
+/*<private>
+ * gsk_cairo_blur_surface_with_kernel:
+ * @surface: a cairo image surface in A8 or ARGB32 format
+ * @radius: the blur radius
+ * @flags: the directions to blur in
+ * @kernel: the kernel to use
+ *
+ * Blurs the cairo image surface at the given radius, using the given
+ * implementation. All kernels produce identical results.
+ *
+ * If @kernel isn't supported, the scalar implementation is used.
  */
 void
-gsk_cairo_blur_surface (cairo_surface_t* surface,
-                        double           radius_d,
-                        GskBlurFlags     flags)
+gsk_cairo_blur_surface_with_kernel (cairo_surface_t *surface,
+                                    double           radius_d,
+                                    GskBlurFlags     flags,
+                                    GskBlurKernel    kernel)
 {
+  const BlurKernelImpl *impl;
   int radius = radius_d;
+  int bpp;
 
   g_return_if_fail (surface != NULL);
   g_return_if_fail (cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_IMAGE);
-  g_return_if_fail (cairo_image_surface_get_format (surface) == CAIRO_FORMAT_A8);
+  g_return_if_fail (cairo_image_surface_get_format (surface) == CAIRO_FORMAT_A8 ||
+                    cairo_image_surface_get_format (surface) == CAIRO_FORMAT_ARGB32);
 
   /* The code doesn't actually do any blurring for radius 1, as it
    * ends up with box filter size 1 */
@@ -244,18 +819,59 @@ gsk_cairo_blur_surface (cairo_surface_t* surface,
   if ((flags & (GSK_BLUR_X|GSK_BLUR_Y)) == 0)
     return;
 
+  if (cairo_image_surface_get_format (surface) == CAIRO_FORMAT_A8)
+    bpp = 1;
+  else
+    bpp = 4;
+
+  if (gsk_cairo_blur_kernel_is_supported (kernel) &&
+      get_box_filter_size (radius) <= MAX_SIMD_BOX_FILTER_SIZE)
+    impl = get_kernel_impl (kernel);
+  else
+    impl = NULL;
+
   /* Before we mess with the surface, execute any pending drawing. */
   cairo_surface_flush (surface);
 
-  _boxblur (cairo_image_surface_get_data (surface),
-            cairo_image_surface_get_stride (surface),
-            cairo_image_surface_get_height (surface),
-            radius, flags);
+  /* For A8, the padding at the end of the rows gets blurred, too.
+   * That's what we've always done, so the kernels need to agree.
+   */
+  if (impl)
+    _boxblur_simd (impl,
+                   cairo_image_surface_get_data (surface),
+                   cairo_image_surface_get_stride (surface) / bpp,
+                   cairo_image_surface_get_height (surface),
+                   cairo_image_surface_get_stride (surface),
+                   bpp,
+                   radius, flags);
+  else
+    _boxblur (cairo_image_surface_get_data (surface),
+              cairo_image_surface_get_stride (surface) / bpp,
+              cairo_image_surface_get_height (surface),
+              cairo_image_surface_get_stride (surface),
+              bpp,
+              radius, flags);
 
   /* Inform cairo we altered the surface contents. */
   cairo_surface_mark_dirty (surface);
 }
 
+/*
+ * _gsk_cairo_blur_surface:
+ * @surface: a cairo image surface.
+ * @radius: the blur radius.
+ *
+ * Blurs the cairo image surface at the given radius, using the
+ * fastest kernel available.
+ */
+void
+gsk_cairo_blur_surface (cairo_surface_t* surface,
+                        double           radius_d,
+                        GskBlurFlags     flags)
+{
+  gsk_cairo_blur_surface_with_kernel (surface, radius_d, flags, get_default_kernel ());
+}
+
 /*<private>
  * gsk_cairo_blur_compute_pixels:
  * @radius: the radius to compute the pixels for
@@ -35,9 +35,24 @@ typedef enum {
   GSK_BLUR_REPEAT = 1<<2
 } GskBlurFlags;
 
+typedef enum {
+  GSK_BLUR_KERNEL_SCALAR,
+  GSK_BLUR_KERNEL_SSE2,
+  GSK_BLUR_KERNEL_AVX2,
+  GSK_BLUR_KERNEL_NEON,
+  GSK_BLUR_N_KERNELS
+} GskBlurKernel;
+
 void            gsk_cairo_blur_surface          (cairo_surface_t *surface,
                                                  double           radius,
 						 GskBlurFlags     flags);
+void            gsk_cairo_blur_surface_with_kernel
+                                                (cairo_surface_t *surface,
+                                                 double           radius,
+                                                 GskBlurFlags     flags,
+                                                 GskBlurKernel    kernel);
+gboolean        gsk_cairo_blur_kernel_is_supported
+                                                (GskBlurKernel    kernel);
 int             gsk_cairo_blur_compute_pixels   (double           radius) G_GNUC_CONST;
 
 cairo_t *       gsk_cairo_blur_start_drawing    (cairo_t         *cr,
@@ -25,8 +25,16 @@
 #include "gskdebugprivate.h"
 #include "gskrendererprivate.h"
 #include "gskrendernodeprivate.h"
+#include "gdk/gdkmemoryformatprivate.h"
 #include "gdk/gdktextureprivate.h"
 
+#include <pango/pangocairo.h>
+
+/* Size of the tiles, in device pixels, that the damage area gets split
+ * into when rendering with worker threads.
+ */
+#define TILE_SIZE 256
+
 #ifdef G_ENABLE_DEBUG
 typedef struct {
   GQuark cpu_time;
@@ -40,11 +48,38 @@ struct _GskCairoRenderer
 
   GdkCairoContext *cairo_context;
 
+  /* Worker threads for tiled rendering, NULL if disabled */
+  GThreadPool *tile_pool;
+  guint n_threads;
+
 #ifdef G_ENABLE_DEBUG
   ProfileTimers profile_timers;
 #endif
 };
 
+typedef struct _TileFrame TileFrame;
+typedef struct _Tile Tile;
+
+struct _TileFrame
+{
+  GskRenderNode *root;
+  GHashTable *texture_surfaces;
+  cairo_matrix_t ctm;
+  double scale_x, scale_y;
+  double offset_x, offset_y;
+
+  GMutex lock;
+  GCond cond;
+  guint pending;
+};
+
+struct _Tile
+{
+  TileFrame *frame;
+  cairo_rectangle_int_t area; /* in device pixels */
+  cairo_surface_t *surface;
+};
+
 struct _GskCairoRendererClass
 {
   GskRendererClass parent_class;
@@ -52,6 +87,389 @@ struct _GskCairoRendererClass
 
 G_DEFINE_TYPE (GskCairoRenderer, gsk_cairo_renderer, GSK_TYPE_RENDERER)
 
+enum {
+  CAIRO_THREADED_UNKNOWN,
+  CAIRO_THREADED_YES,
+  CAIRO_THREADED_NO
+};
+
+/* Returns the @i-th child of @node, or %NULL if it has no more children */
+static GskRenderNode *
+gsk_cairo_renderer_get_child (GskRenderNode *node,
+                              guint          i)
+{
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      if (i < gsk_container_node_get_n_children (node))
+        return gsk_container_node_get_child (node, i);
+      return NULL;
+
+    case GSK_TRANSFORM_NODE:
+      return i == 0 ? gsk_transform_node_get_child (node) : NULL;
+
+    case GSK_OPACITY_NODE:
+      return i == 0 ? gsk_opacity_node_get_child (node) : NULL;
+
+    case GSK_COLOR_MATRIX_NODE:
+      return i == 0 ? gsk_color_matrix_node_get_child (node) : NULL;
+
+    case GSK_REPEAT_NODE:
+      return i == 0 ? gsk_repeat_node_get_child (node) : NULL;
+
+    case GSK_CLIP_NODE:
+      return i == 0 ? gsk_clip_node_get_child (node) : NULL;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      return i == 0 ? gsk_rounded_clip_node_get_child (node) : NULL;
+
+    case GSK_SHADOW_NODE:
+      return i == 0 ? gsk_shadow_node_get_child (node) : NULL;
+
+    case GSK_BLUR_NODE:
+      return i == 0 ? gsk_blur_node_get_child (node) : NULL;
+
+    case GSK_DEBUG_NODE:
+      return i == 0 ? gsk_debug_node_get_child (node) : NULL;
+
+    case GSK_BLEND_NODE:
+      if (i == 0)
+        return gsk_blend_node_get_bottom_child (node);
+      return i == 1 ? gsk_blend_node_get_top_child (node) : NULL;
+
+    case GSK_CROSS_FADE_NODE:
+      if (i == 0)
+        return gsk_cross_fade_node_get_start_child (node);
+      return i == 1 ? gsk_cross_fade_node_get_end_child (node) : NULL;
+
+    case GSK_MASK_NODE:
+      if (i == 0)
+        return gsk_mask_node_get_source (node);
+      return i == 1 ? gsk_mask_node_get_mask (node) : NULL;
+
+    default:
+      return NULL;
+    }
+}
+
+static gboolean gsk_cairo_renderer_can_draw_threaded (GskRenderNode *node);
+
+static gboolean
+gsk_cairo_renderer_compute_threaded (GskRenderNode *node,
+                                     gboolean      *has_textures)
+{
+  GskRenderNode *child;
+  guint i;
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+    case GSK_TRANSFORM_NODE:
+    case GSK_OPACITY_NODE:
+    case GSK_COLOR_MATRIX_NODE:
+    case GSK_REPEAT_NODE:
+    case GSK_CLIP_NODE:
+    case GSK_ROUNDED_CLIP_NODE:
+    case GSK_SHADOW_NODE:
+    case GSK_BLUR_NODE:
+    case GSK_DEBUG_NODE:
+    case GSK_BLEND_NODE:
+    case GSK_CROSS_FADE_NODE:
+    case GSK_MASK_NODE:
+      for (i = 0; (child = gsk_cairo_renderer_get_child (node, i)); i++)
+        {
+          if (!gsk_cairo_renderer_can_draw_threaded (child))
+            return FALSE;
+          *has_textures |= child->cairo_has_textures;
+        }
+      return TRUE;
+
+    case GSK_CAIRO_NODE:
+      {
+        cairo_surface_t *surface = gsk_cairo_node_get_surface (node);
+
+        return surface == NULL ||
+               cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_IMAGE;
+      }
+
+    case GSK_TEXTURE_NODE:
+      *has_textures = TRUE;
+      return GDK_IS_MEMORY_TEXTURE (gsk_texture_node_get_texture (node));
+
+    case GSK_TEXTURE_SCALE_NODE:
+      *has_textures = TRUE;
+      return GDK_IS_MEMORY_TEXTURE (gsk_texture_scale_node_get_texture (node));
+
+    case GSK_TEXT_NODE:
+      {
+        PangoFont *font = gsk_text_node_get_font (node);
+
+        if (!PANGO_IS_CAIRO_FONT (font))
+          return FALSE;
+
+        return pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (font)) != NULL;
+      }
+
+    case GSK_COLOR_NODE:
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+    case GSK_CONIC_GRADIENT_NODE:
+    case GSK_BORDER_NODE:
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+    case GSK_GL_SHADER_NODE:
+      return TRUE;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      g_assert_not_reached ();
+      return FALSE;
+    }
+}
+
+/* Checks if @node can be drawn concurrently from multiple threads.
+ *
+ * Nodes are immutable, but drawing some of them touches shared state
+ * that is not safe to access from worker threads: textures may need to
+ * be downloaded from the GPU and recording surfaces are replayed.
+ * As a side effect, this ensures the scaled fonts used by text nodes
+ * are created before any worker uses them.
+ *
+ * The result is kept in the node, so subtrees that are reused from
+ * the previous frame are not walked again.
+ */
+static gboolean
+gsk_cairo_renderer_can_draw_threaded (GskRenderNode *node)
+{
+  if (node->cairo_threaded == CAIRO_THREADED_UNKNOWN)
+    {
+      gboolean has_textures = FALSE;
+
+      if (gsk_cairo_renderer_compute_threaded (node, &has_textures))
+        node->cairo_threaded = CAIRO_THREADED_YES;
+      else
+        node->cairo_threaded = CAIRO_THREADED_NO;
+      node->cairo_has_textures = has_textures;
+    }
+
+  return node->cairo_threaded == CAIRO_THREADED_YES;
+}
+
+/* Downloads the textures used by @node into @surfaces, so that the
+ * tiles don't each download them again. Only walks into subtrees
+ * that contain textures.
+ */
+static void
+gsk_cairo_renderer_download_textures (GskRenderNode *node,
+                                      GHashTable    *surfaces)
+{
+  GskRenderNode *child;
+  GdkTexture *texture;
+  guint i;
+
+  if (!node->cairo_has_textures)
+    return;
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_TEXTURE_NODE:
+      texture = gsk_texture_node_get_texture (node);
+      break;
+
+    case GSK_TEXTURE_SCALE_NODE:
+      texture = gsk_texture_scale_node_get_texture (node);
+      break;
+
+    default:
+      for (i = 0; (child = gsk_cairo_renderer_get_child (node, i)); i++)
+        gsk_cairo_renderer_download_textures (child, surfaces);
+      return;
+    }
+
+  if (!g_hash_table_contains (surfaces, texture))
+    g_hash_table_insert (surfaces, texture, gdk_texture_download_surface (texture));
+}
+
+static void
+gsk_cairo_renderer_draw_tile (gpointer data,
+                              gpointer user_data)
+{
+  Tile *tile = data;
+  TileFrame *frame = tile->frame;
+  cairo_t *cr;
+
+  /* This already runs on all cores, don't wait for more threads */
+  gdk_memory_convert_set_single_threaded (TRUE);
+
+  tile->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                              tile->area.width,
+                                              tile->area.height);
+  cairo_surface_set_device_scale (tile->surface, frame->scale_x, frame->scale_y);
+  cairo_surface_set_device_offset (tile->surface,
+                                   frame->offset_x - tile->area.x,
+                                   frame->offset_y - tile->area.y);
+
+  cr = cairo_create (tile->surface);
+  cairo_set_matrix (cr, &frame->ctm);
+  gsk_render_node_draw_with_surfaces (frame->root, cr, frame->texture_surfaces);
+  cairo_destroy (cr);
+
+  /* The pool's threads may be shared with other pools */
+  gdk_memory_convert_set_single_threaded (FALSE);
+
+  g_mutex_lock (&frame->lock);
+  frame->pending--;
+  if (frame->pending == 0)
+    g_cond_signal (&frame->cond);
+  g_mutex_unlock (&frame->lock);
+}
+
+/* Collects the area to be drawn by @cr, in device pixels */
+static cairo_region_t *
+gsk_cairo_renderer_get_device_clip (cairo_t              *cr,
+                                    const cairo_matrix_t *device_matrix)
+{
+  cairo_rectangle_list_t *list;
+  cairo_region_t *region;
+  int i;
+
+  region = cairo_region_create ();
+
+  list = cairo_copy_clip_rectangle_list (cr);
+  if (list->status == CAIRO_STATUS_SUCCESS)
+    {
+      for (i = 0; i < list->num_rectangles; i++)
+        {
+          double x1 = list->rectangles[i].x;
+          double y1 = list->rectangles[i].y;
+          double x2 = x1 + list->rectangles[i].width;
+          double y2 = y1 + list->rectangles[i].height;
+
+          cairo_matrix_transform_point (device_matrix, &x1, &y1);
+          cairo_matrix_transform_point (device_matrix, &x2, &y2);
+
+          cairo_region_union_rectangle (region,
+                                        &(cairo_rectangle_int_t) {
+                                          floor (MIN (x1, x2)),
+                                          floor (MIN (y1, y2)),
+                                          ceil (MAX (x1, x2)) - floor (MIN (x1, x2)),
+                                          ceil (MAX (y1, y2)) - floor (MIN (y1, y2))
+                                        });
+        }
+    }
+  cairo_rectangle_list_destroy (list);
+
+  return region;
+}
+
+/* Splits the area to draw into tiles, draws them on the worker
+ * threads and composites the results back onto @cr.
+ *
+ * Returns: %FALSE if the node can't be drawn this way and needs
+ *   to be drawn directly
+ */
+static gboolean
+gsk_cairo_renderer_do_render_tiled (GskCairoRenderer *self,
+                                    cairo_t          *cr,
+                                    GskRenderNode    *root)
+{
+  cairo_surface_t *target = cairo_get_target (cr);
+  cairo_matrix_t device_matrix;
+  cairo_rectangle_int_t extents;
+  cairo_region_t *region;
+  TileFrame frame;
+  GArray *tiles;
+  guint i;
+  int x, y;
+
+  cairo_get_matrix (cr, &frame.ctm);
+  /* rotations would make tile edges not line up with pixels */
+  if (frame.ctm.xy != 0 || frame.ctm.yx != 0)
+    return FALSE;
+
+  if (!gsk_cairo_renderer_can_draw_threaded (root))
+    return FALSE;
+
+  cairo_surface_get_device_scale (target, &frame.scale_x, &frame.scale_y);
+  cairo_surface_get_device_offset (target, &frame.offset_x, &frame.offset_y);
+  cairo_matrix_multiply (&device_matrix,
+                         &frame.ctm,
+                         &(cairo_matrix_t) { frame.scale_x, 0, 0, frame.scale_y, frame.offset_x, frame.offset_y });
+
+  region = gsk_cairo_renderer_get_device_clip (cr, &device_matrix);
+  cairo_region_get_extents (region, &extents);
+
+  tiles = g_array_new (FALSE, FALSE, sizeof (Tile));
+  for (y = floor ((double) extents.y / TILE_SIZE) * TILE_SIZE; y < extents.y + extents.height; y += TILE_SIZE)
+    {
+      for (x = floor ((double) extents.x / TILE_SIZE) * TILE_SIZE; x < extents.x + extents.width; x += TILE_SIZE)
+        {
+          cairo_region_t *tile_region;
+          Tile tile = { &frame, };
+
+          tile_region = cairo_region_create_rectangle (&(cairo_rectangle_int_t) { x, y, TILE_SIZE, TILE_SIZE });
+          cairo_region_intersect (tile_region, region);
+          if (!cairo_region_is_empty (tile_region))
+            {
+              cairo_region_get_extents (tile_region, &tile.area);
+              g_array_append_val (tiles, tile);
+            }
+          cairo_region_destroy (tile_region);
+        }
+    }
+  cairo_region_destroy (region);
+
+  if (tiles->len < 2)
+    {
+      g_array_unref (tiles);
+      return FALSE;
+    }
+
+  frame.root = root;
+  frame.texture_surfaces = g_hash_table_new_full (NULL, NULL,
+                                                  NULL, (GDestroyNotify) cairo_surface_destroy);
+  gsk_cairo_renderer_download_textures (root, frame.texture_surfaces);
+  frame.pending = tiles->len;
+  g_mutex_init (&frame.lock);
+  g_cond_init (&frame.cond);
+
+  for (i = 0; i < tiles->len; i++)
+    g_thread_pool_push (self->tile_pool, &g_array_index (tiles, Tile, i), NULL);
+
+  g_mutex_lock (&frame.lock);
+  while (frame.pending > 0)
+    g_cond_wait (&frame.cond, &frame.lock);
+  g_mutex_unlock (&frame.lock);
+
+  g_mutex_clear (&frame.lock);
+  g_cond_clear (&frame.cond);
+  g_hash_table_unref (frame.texture_surfaces);
+
+  cairo_save (cr);
+  cairo_identity_matrix (cr);
+  for (i = 0; i < tiles->len; i++)
+    {
+      Tile *tile = &g_array_index (tiles, Tile, i);
+
+      cairo_set_source_surface (cr, tile->surface, 0, 0);
+      cairo_rectangle (cr,
+                       (tile->area.x - frame.offset_x) / frame.scale_x,
+                       (tile->area.y - frame.offset_y) / frame.scale_y,
+                       tile->area.width / frame.scale_x,
+                       tile->area.height / frame.scale_y);
+      cairo_fill (cr);
+
+      cairo_surface_destroy (tile->surface);
+    }
+  cairo_restore (cr);
+
+  g_array_unref (tiles);
+
+  return TRUE;
+}
+
 static gboolean
 gsk_cairo_renderer_realize (GskRenderer  *renderer,
                             GdkSurface   *surface,
@@ -62,6 +480,18 @@ gsk_cairo_renderer_realize (GskRenderer  *renderer,
   if (surface)
     self->cairo_context = gdk_surface_create_cairo_context (surface);
 
+  if (self->n_threads > 1)
+    {
+      self->tile_pool = g_thread_pool_new (gsk_cairo_renderer_draw_tile,
+                                           NULL,
+                                           self->n_threads,
+                                           FALSE,
+                                           NULL);
+
+      GSK_RENDERER_DEBUG (renderer, CAIRO, "Rendering in %ux%u tiles with %u threads",
+                          TILE_SIZE, TILE_SIZE, self->n_threads);
+    }
+
   return TRUE;
 }
 
@@ -70,6 +500,12 @@ gsk_cairo_renderer_unrealize (GskRenderer *renderer)
 {
   GskCairoRenderer *self = GSK_CAIRO_RENDERER (renderer);
 
+  if (self->tile_pool)
+    {
+      g_thread_pool_free (self->tile_pool, FALSE, TRUE);
+      self->tile_pool = NULL;
+    }
+
   g_clear_object (&self->cairo_context);
 }
 
@@ -78,8 +514,8 @@ gsk_cairo_renderer_do_render (GskRenderer   *renderer,
                               cairo_t       *cr,
                               GskRenderNode *root)
 {
-#ifdef G_ENABLE_DEBUG
   GskCairoRenderer *self = GSK_CAIRO_RENDERER (renderer);
+#ifdef G_ENABLE_DEBUG
   GskProfiler *profiler;
   gint64 cpu_time;
 #endif
@@ -89,7 +525,9 @@ gsk_cairo_renderer_do_render (GskRenderer   *renderer,
   gsk_profiler_timer_begin (profiler, self->profile_timers.cpu_time);
 #endif
 
-  gsk_render_node_draw (root, cr);
+  if (self->tile_pool == NULL ||
+      !gsk_cairo_renderer_do_render_tiled (self, cr, root))
+    gsk_render_node_draw (root, cr);
 
 #ifdef G_ENABLE_DEBUG
   cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
@@ -210,6 +648,19 @@ gsk_cairo_renderer_class_init (GskCairoRendererClass *klass)
 static void
 gsk_cairo_renderer_init (GskCairoRenderer *self)
 {
+  const char *threads;
+
+  /* Tiled rendering on worker threads is opt-in, it only pays off
+   * for large frames on machines without a GPU.
+   */
+  threads = g_getenv ("GSK_CAIRO_THREADS");
+  if (threads == NULL)
+    self->n_threads = 1;
+  else if (g_str_equal (threads, "auto"))
+    self->n_threads = g_get_num_processors ();
+  else
+    self->n_threads = CLAMP (atoi (threads), 1, 64);
+
 #ifdef G_ENABLE_DEBUG
   GskProfiler *profiler = gsk_renderer_get_profiler (GSK_RENDERER (self));
 
@@ -399,6 +399,36 @@ gsk_renderer_render_texture (GskRenderer           *renderer,
   return texture;
 }
 
+#ifdef G_ENABLE_DEBUG
+static void
+gsk_renderer_print_diff_stats (GskRenderer          *renderer,
+                               const cairo_region_t *clip,
+                               gint64                diff_time)
+{
+  GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+  guint64 damaged, total;
+  int i, n_rects;
+
+  n_rects = cairo_region_num_rectangles (clip);
+  damaged = 0;
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (clip, i, &rect);
+      damaged += (guint64) rect.width * rect.height;
+    }
+
+  total = (guint64) gdk_surface_get_width (priv->surface) * gdk_surface_get_height (priv->surface);
+
+  gdk_debug_message ("Diff: %.3f ms, %d rectangles, %" G_GUINT64_FORMAT " of %" G_GUINT64_FORMAT " pixels damaged (%.1f%%)",
+                     diff_time / 1000.,
+                     n_rects,
+                     damaged, total,
+                     total > 0 ? 100. * damaged / total : 0.);
+}
+#endif
+
 /**
  * gsk_renderer_render:
  * @renderer: a realized `GskRenderer`
@@ -445,9 +475,21 @@ gsk_renderer_render (GskRenderer          *renderer,
     }
   else
     {
+#ifdef G_ENABLE_DEBUG
+      gint64 diff_start = 0;
+
+      if (GSK_RENDERER_DEBUG_CHECK (renderer, DIFF_STATS))
+        diff_start = g_get_monotonic_time ();
+#endif
+
       clip = cairo_region_copy (region);
       gsk_render_node_diff (priv->prev_node, root, clip);
 
+#ifdef G_ENABLE_DEBUG
+      if (GSK_RENDERER_DEBUG_CHECK (renderer, DIFF_STATS))
+        gsk_renderer_print_diff_stats (renderer, clip, g_get_monotonic_time () - diff_start);
+#endif
+
       if (cairo_region_is_empty (clip))
         {
           cairo_region_destroy (clip);
@@ -159,6 +159,13 @@ gsk_render_node_real_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint
+gsk_render_node_real_hash (const GskRenderNode *node)
+{
+  /* Nodes we can't look into only match themselves */
+  return g_direct_hash (node);
+}
+
 static void
 gsk_render_node_class_init (GskRenderNodeClass *klass)
 {
@@ -167,6 +174,7 @@ gsk_render_node_class_init (GskRenderNodeClass *klass)
   klass->draw = gsk_render_node_real_draw;
   klass->can_diff = gsk_render_node_real_can_diff;
   klass->diff = gsk_render_node_real_diff;
+  klass->hash = gsk_render_node_real_hash;
 }
 
 static void
@@ -441,6 +449,47 @@ gsk_render_node_can_diff (const GskRenderNode *node1,
   return FALSE;
 }
 
+/*< private >
+ * gsk_render_node_get_hash:
+ * @node: a `GskRenderNode`
+ *
+ * Gets a hash of the structure of @node and all its children.
+ *
+ * Nodes that render the same are likely to have the same hash, even
+ * if they are different objects. This is used by the diffing code to
+ * match up nodes. Equal hashes do not guarantee that nodes are equal.
+ *
+ * The hash is computed on first use and cached on the node.
+ *
+ * Returns: the hash of @node
+ */
+guint
+gsk_render_node_get_hash (const GskRenderNode *node)
+{
+  guint hash;
+  float bounds[4];
+
+  hash = g_atomic_int_get (&node->hash);
+  if (G_LIKELY (hash != 0))
+    return hash;
+
+  graphene_rect_to_float (&node->bounds, bounds);
+
+  hash = _gsk_render_node_get_node_type (node);
+  for (guint i = 0; i < 4; i++)
+    hash = gsk_hash_float (hash, bounds[i]);
+  hash = gsk_hash_combine (hash, GSK_RENDER_NODE_GET_CLASS (node)->hash (node));
+
+  /* 0 means "not computed yet" */
+  if (hash == 0)
+    hash = 1;
+
+  /* Racing threads compute the same value, so no need to lock */
+  g_atomic_int_set (&((GskRenderNode *) node)->hash, hash);
+
+  return hash;
+}
+
 static void
 rectangle_init_from_graphene (cairo_rectangle_int_t *cairo,
                               const graphene_rect_t *graphene)
@@ -545,9 +594,11 @@ gsk_render_node_write_to_file (GskRenderNode *node,
  * @error_func: (nullable) (scope call): Callback on parsing errors
  * @user_data: (closure error_func): user_data for @error_func
  *
- * Loads data previously created via [method@Gsk.RenderNode.serialize].
+ * Loads data previously created via [method@Gsk.RenderNode.serialize]
+ * or [method@Gsk.RenderNode.serialize_binary].
  *
- * For a discussion of the supported format, see that function.
+ * The format is detected automatically. For a discussion of the
+ * supported formats, see those functions.
  *
  * Returns: (nullable) (transfer full): a new `GskRenderNode`
  */
@@ -20,6 +20,7 @@
 
 #include "gskrendernodeprivate.h"
 
+#include "gskbvhprivate.h"
 #include "gskcairoblurprivate.h"
 #include "gskcairorenderer.h"
 #include "gskdebugprivate.h"
@@ -46,6 +47,68 @@
  */
 #define MAX_RECTS_IN_DIFF 30
 
+/* Containers whose children changed get matched by their hashes
+ * first if they have at least this many children. Smaller ones
+ * just use gsk_diff().
+ */
+#define MIN_CHILDREN_FOR_KEYED_DIFF 8
+
+/* Helpers for the hash vfuncs, on top of gsk_hash_float() */
+static inline guint
+hash_point (guint                   hash,
+            const graphene_point_t *point)
+{
+  hash = gsk_hash_float (hash, point->x);
+  return gsk_hash_float (hash, point->y);
+}
+
+static inline guint
+hash_rect (guint                  hash,
+           const graphene_rect_t *rect)
+{
+  hash = hash_point (hash, &rect->origin);
+  hash = gsk_hash_float (hash, rect->size.width);
+  return gsk_hash_float (hash, rect->size.height);
+}
+
+static inline guint
+hash_rounded_rect (guint                 hash,
+                   const GskRoundedRect *rect)
+{
+  hash = hash_rect (hash, &rect->bounds);
+  for (guint i = 0; i < 4; i++)
+    {
+      hash = gsk_hash_float (hash, rect->corner[i].width);
+      hash = gsk_hash_float (hash, rect->corner[i].height);
+    }
+
+  return hash;
+}
+
+static inline guint
+hash_rgba (guint          hash,
+           const GdkRGBA *rgba)
+{
+  hash = gsk_hash_float (hash, rgba->red);
+  hash = gsk_hash_float (hash, rgba->green);
+  hash = gsk_hash_float (hash, rgba->blue);
+  return gsk_hash_float (hash, rgba->alpha);
+}
+
+static inline guint
+hash_color_stops (guint               hash,
+                  const GskColorStop *stops,
+                  gsize               n_stops)
+{
+  for (gsize i = 0; i < n_stops; i++)
+    {
+      hash = gsk_hash_float (hash, stops[i].offset);
+      hash = hash_rgba (hash, &stops[i].color);
+    }
+
+  return hash;
+}
+
 static inline void
 gsk_cairo_rectangle (cairo_t               *cr,
                      const graphene_rect_t *rect)
@@ -135,6 +198,17 @@ gsk_color_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint
+gsk_color_node_hash (const GskRenderNode *node)
+{
+  const GskColorNode *self = (const GskColorNode *) node;
+  guint hash = 0;
+
+  hash = hash_rgba (hash, &self->color);
+
+  return hash;
+}
+
 static void
 gsk_color_node_class_init (gpointer g_class,
                            gpointer class_data)
@@ -145,6 +219,7 @@ gsk_color_node_class_init (gpointer g_class,
 
   node_class->draw = gsk_color_node_draw;
   node_class->diff = gsk_color_node_diff;
+  node_class->hash = gsk_color_node_hash;
 }
 
 /**
@@ -295,6 +370,19 @@ gsk_linear_gradient_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint
+gsk_linear_gradient_node_hash (const GskRenderNode *node)
+{
+  const GskLinearGradientNode *self = (const GskLinearGradientNode *) node;
+  guint hash = 0;
+
+  hash = hash_point (hash, &self->start);
+  hash = hash_point (hash, &self->end);
+  hash = hash_color_stops (hash, self->stops, self->n_stops);
+
+  return hash;
+}
+
 static void
 gsk_linear_gradient_node_class_init (gpointer g_class,
                                      gpointer class_data)
@@ -306,6 +394,7 @@ gsk_linear_gradient_node_class_init (gpointer g_class,
   node_class->finalize = gsk_linear_gradient_node_finalize;
   node_class->draw = gsk_linear_gradient_node_draw;
   node_class->diff = gsk_linear_gradient_node_diff;
+  node_class->hash = gsk_linear_gradient_node_hash;
 }
 
 static void
@@ -319,6 +408,7 @@ gsk_repeating_linear_gradient_node_class_init (gpointer g_class,
   node_class->finalize = gsk_linear_gradient_node_finalize;
   node_class->draw = gsk_linear_gradient_node_draw;
   node_class->diff = gsk_linear_gradient_node_diff;
+  node_class->hash = gsk_linear_gradient_node_hash;
 }
 
 /**
@@ -611,6 +701,22 @@ gsk_radial_gradient_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint
+gsk_radial_gradient_node_hash (const GskRenderNode *node)
+{
+  const GskRadialGradientNode *self = (const GskRadialGradientNode *) node;
+  guint hash = 0;
+
+  hash = hash_point (hash, &self->center);
+  hash = gsk_hash_float (hash, self->hradius);
+  hash = gsk_hash_float (hash, self->vradius);
+  hash = gsk_hash_float (hash, self->start);
+  hash = gsk_hash_float (hash, self->end);
+  hash = hash_color_stops (hash, self->stops, self->n_stops);
+
+  return hash;
+}
+
 static void
 gsk_radial_gradient_node_class_init (gpointer g_class,
                                      gpointer class_data)
@@ -622,6 +728,7 @@ gsk_radial_gradient_node_class_init (gpointer g_class,
   node_class->finalize = gsk_radial_gradient_node_finalize;
   node_class->draw = gsk_radial_gradient_node_draw;
   node_class->diff = gsk_radial_gradient_node_diff;
+  node_class->hash = gsk_radial_gradient_node_hash;
 }
 
 static void
@@ -635,6 +742,7 @@ gsk_repeating_radial_gradient_node_class_init (gpointer g_class,
   node_class->finalize = gsk_radial_gradient_node_finalize;
   node_class->draw = gsk_radial_gradient_node_draw;
   node_class->diff = gsk_radial_gradient_node_diff;
+  node_class->hash = gsk_radial_gradient_node_hash;
 }
 
 /**
@@ -1097,6 +1205,19 @@ gsk_conic_gradient_node_diff (GskRenderNode  *node1,
     }
 }
 
+static guint
+gsk_conic_gradient_node_hash (const GskRenderNode *node)
+{
+  const GskConicGradientNode *self = (const GskConicGradientNode *) node;
+  guint hash = 0;
+
+  hash = hash_point (hash, &self->center);
+  hash = gsk_hash_float (hash, self->rotation);
+  hash = hash_color_stops (hash, self->stops, self->n_stops);
+
+  return hash;
+}
+
 static void
 gsk_conic_gradient_node_class_init (gpointer g_class,
                                     gpointer class_data)
@@ -1108,6 +1229,7 @@ gsk_conic_gradient_node_class_init (gpointer g_class,
   node_class->finalize = gsk_conic_gradient_node_finalize;
   node_class->draw = gsk_conic_gradient_node_draw;
   node_class->diff = gsk_conic_gradient_node_diff;
+  node_class->hash = gsk_conic_gradient_node_hash;
 }
 
 /**
@@ -1456,6 +1578,22 @@ gsk_border_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint
+gsk_border_node_hash (const GskRenderNode *node)
+{
+  const GskBorderNode *self = (const GskBorderNode *) node;
+  guint hash = 0;
+
+  hash = hash_rounded_rect (hash, &self->outline);
+  for (guint i = 0; i < 4; i++)
+    {
+      hash = gsk_hash_float (hash, self->border_width[i]);
+      hash = hash_rgba (hash, &self->border_color[i]);
+    }
+
+  return hash;
+}
+
 static void
 gsk_border_node_class_init (gpointer g_class,
                             gpointer class_data)
@@ -1466,6 +1604,7 @@ gsk_border_node_class_init (gpointer g_class,
 
   node_class->draw = gsk_border_node_draw;
   node_class->diff = gsk_border_node_diff;
+  node_class->hash = gsk_border_node_hash;
 }
 
 /**
@@ -1614,6 +1753,52 @@ gsk_texture_node_finalize (GskRenderNode *node)
   parent_class->finalize (node);
 }
 
+/* GdkTexture => cairo_surface_t, see gsk_render_node_draw_with_surfaces() */
+static GPrivate texture_surfaces;
+
+/*
+ * gsk_render_node_draw_with_surfaces:
+ * @node: a `GskRenderNode`
+ * @cr: cairo context to draw to
+ * @surfaces: a table mapping textures to their downloaded surfaces
+ *
+ * Draws like gsk_render_node_draw(), but uses the surfaces in
+ * @surfaces instead of downloading those textures again.
+ *
+ * The surfaces are only read, so the same table can be used by
+ * multiple threads drawing at the same time.
+ */
+void
+gsk_render_node_draw_with_surfaces (GskRenderNode *node,
+                                    cairo_t       *cr,
+                                    GHashTable    *surfaces)
+{
+  GHashTable *old_surfaces;
+
+  old_surfaces = g_private_get (&texture_surfaces);
+  g_private_set (&texture_surfaces, surfaces);
+
+  gsk_render_node_draw (node, cr);
+
+  g_private_set (&texture_surfaces, old_surfaces);
+}
+
+static cairo_surface_t *
+gsk_texture_get_surface (GdkTexture *texture)
+{
+  GHashTable *surfaces = g_private_get (&texture_surfaces);
+  cairo_surface_t *surface;
+
+  if (surfaces)
+    {
+      surface = g_hash_table_lookup (surfaces, texture);
+      if (surface)
+        return cairo_surface_reference (surface);
+    }
+
+  return gdk_texture_download_surface (texture);
+}
+
 static void
 gsk_texture_node_draw (GskRenderNode *node,
                        cairo_t       *cr)
@@ -1623,7 +1808,7 @@ gsk_texture_node_draw (GskRenderNode *node,
   cairo_pattern_t *pattern;
   cairo_matrix_t matrix;
 
-  surface = gdk_texture_download_surface (self->texture);
+  surface = gsk_texture_get_surface (self->texture);
   pattern = cairo_pattern_create_for_surface (surface);
   cairo_pattern_set_extend (pattern, CAIRO_EXTEND_PAD);
 
@@ -1674,6 +1859,17 @@ gsk_texture_node_diff (GskRenderNode  *node1,
   cairo_region_destroy (sub);
 }
 
+static guint
+gsk_texture_node_hash (const GskRenderNode *node)
+{
+  const GskTextureNode *self = (const GskTextureNode *) node;
+  guint hash = 0;
+
+  hash = gsk_hash_combine (hash, g_direct_hash (self->texture));
+
+  return hash;
+}
+
 static void
 gsk_texture_node_class_init (gpointer g_class,
                              gpointer class_data)
@@ -1685,6 +1881,7 @@ gsk_texture_node_class_init (gpointer g_class,
   node_class->finalize = gsk_texture_node_finalize;
   node_class->draw = gsk_texture_node_draw;
   node_class->diff = gsk_texture_node_diff;
+  node_class->hash = gsk_texture_node_hash;
 }
 
 /**
@@ -1798,7 +1995,7 @@ gsk_texture_scale_node_draw (GskRenderNode *node,
   cairo_surface_set_device_offset (surface2, -clip_rect.origin.x, -clip_rect.origin.y);
   cr2 = cairo_create (surface2);
 
-  surface = gdk_texture_download_surface (self->texture);
+  surface = gsk_texture_get_surface (self->texture);
   pattern = cairo_pattern_create_for_surface (surface);
   cairo_pattern_set_extend (pattern, CAIRO_EXTEND_PAD);
 
@@ -1869,6 +2066,18 @@ gsk_texture_scale_node_diff (GskRenderNode  *node1,
   cairo_region_destroy (sub);
 }
 
+static guint
+gsk_texture_scale_node_hash (const GskRenderNode *node)
+{
+  const GskTextureScaleNode *self = (const GskTextureScaleNode *) node;
+  guint hash = 0;
+
+  hash = gsk_hash_combine (hash, g_direct_hash (self->texture));
+  hash = gsk_hash_combine (hash, self->filter);
+
+  return hash;
+}
+
 static void
 gsk_texture_scale_node_class_init (gpointer g_class,
                                    gpointer class_data)
@@ -1880,6 +2089,7 @@ gsk_texture_scale_node_class_init (gpointer g_class,
   node_class->finalize = gsk_texture_scale_node_finalize;
   node_class->draw = gsk_texture_scale_node_draw;
   node_class->diff = gsk_texture_scale_node_diff;
+  node_class->hash = gsk_texture_scale_node_hash;
 }
 
 /**
@@ -2382,6 +2592,22 @@ gsk_inset_shadow_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint
+gsk_inset_shadow_node_hash (const GskRenderNode *node)
+{
+  const GskInsetShadowNode *self = (const GskInsetShadowNode *) node;
+  guint hash = 0;
+
+  hash = hash_rounded_rect (hash, &self->outline);
+  hash = hash_rgba (hash, &self->color);
+  hash = gsk_hash_float (hash, self->dx);
+  hash = gsk_hash_float (hash, self->dy);
+  hash = gsk_hash_float (hash, self->spread);
+  hash = gsk_hash_float (hash, self->blur_radius);
+
+  return hash;
+}
+
 static void
 gsk_inset_shadow_node_class_init (gpointer g_class,
                                   gpointer class_data)
@@ -2392,6 +2618,7 @@ gsk_inset_shadow_node_class_init (gpointer g_class,
 
   node_class->draw = gsk_inset_shadow_node_draw;
   node_class->diff = gsk_inset_shadow_node_diff;
+  node_class->hash = gsk_inset_shadow_node_hash;
 }
 
 /**
@@ -2695,6 +2922,22 @@ gsk_outset_shadow_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint
+gsk_outset_shadow_node_hash (const GskRenderNode *node)
+{
+  const GskOutsetShadowNode *self = (const GskOutsetShadowNode *) node;
+  guint hash = 0;
+
+  hash = hash_rounded_rect (hash, &self->outline);
+  hash = hash_rgba (hash, &self->color);
+  hash = gsk_hash_float (hash, self->dx);
+  hash = gsk_hash_float (hash, self->dy);
+  hash = gsk_hash_float (hash, self->spread);
+  hash = gsk_hash_float (hash, self->blur_radius);
+
+  return hash;
+}
+
 static void
 gsk_outset_shadow_node_class_init (gpointer g_class,
                                    gpointer class_data)
@@ -2705,6 +2948,7 @@ gsk_outset_shadow_node_class_init (gpointer g_class,
 
   node_class->draw = gsk_outset_shadow_node_draw;
   node_class->diff = gsk_outset_shadow_node_diff;
+  node_class->hash = gsk_outset_shadow_node_hash;
 }
 
 /**
@@ -3021,8 +3265,38 @@ struct _GskContainerNode
   gboolean disjoint;
   guint n_children;
   GskRenderNode **children;
+
+  GskBvh *index; /* (atomic), built on first use */
 };
 
+/* Containers with at least this many children get a spatial index
+ * the first time their children are culled against a rectangle.
+ * It can be changed with GSK_CONTAINER_INDEX_THRESHOLD, setting it
+ * to 0 disables the index.
+ */
+#define DEFAULT_INDEX_THRESHOLD 128
+
+static guint
+gsk_container_node_get_index_threshold (void)
+{
+  static gsize threshold__set;
+  static guint threshold;
+
+  if (g_once_init_enter (&threshold__set))
+    {
+      const char *env = g_getenv ("GSK_CONTAINER_INDEX_THRESHOLD");
+
+      if (env)
+        threshold = (guint) MIN (g_ascii_strtoull (env, NULL, 10), G_MAXUINT);
+      else
+        threshold = DEFAULT_INDEX_THRESHOLD;
+
+      g_once_init_leave (&threshold__set, 1);
+    }
+
+  return threshold;
+}
+
 static void
 gsk_container_node_finalize (GskRenderNode *node)
 {
@@ -3034,18 +3308,67 @@ gsk_container_node_finalize (GskRenderNode *node)
 
   g_free (container->children);
 
+  g_clear_pointer (&container->index, gsk_bvh_free);
+
   parent_class->finalize (node);
 }
 
+static const GskBvh *
+gsk_container_node_get_index (GskContainerNode *self)
+{
+  GskBvh *index;
+  guint threshold;
+
+  index = g_atomic_pointer_get (&self->index);
+  if (index)
+    return index;
+
+  threshold = gsk_container_node_get_index_threshold ();
+  if (threshold == 0 || self->n_children < threshold)
+    return NULL;
+
+  /* Nodes are drawn from multiple threads by the Cairo renderer,
+   * so more than one thread may get here. Only one index wins.
+   */
+  index = gsk_bvh_new (self->children, self->n_children);
+  if (!g_atomic_pointer_compare_and_exchange (&self->index, NULL, index))
+    {
+      gsk_bvh_free (index);
+      index = g_atomic_pointer_get (&self->index);
+    }
+
+  return index;
+}
+
 static void
 gsk_container_node_draw (GskRenderNode *node,
                          cairo_t       *cr)
 {
   GskContainerNode *container = (GskContainerNode *) node;
+  graphene_rect_t clip_rect;
+  GArray *indices;
   guint i;
 
+  /* Skip children outside of the clip, this matters when only
+   * a small part of the node is drawn, like with tiled rendering.
+   */
+  _graphene_rect_init_from_clip_extents (&clip_rect, cr);
+
+  indices = gsk_container_node_query (node, &clip_rect);
+  if (indices)
+    {
+      for (i = 0; i < indices->len; i++)
+        gsk_render_node_draw (container->children[g_array_index (indices, guint, i)], cr);
+
+      g_array_unref (indices);
+      return;
+    }
+
   for (i = 0; i < container->n_children; i++)
     {
+      if (!graphene_rect_intersection (&clip_rect, &container->children[i]->bounds, NULL))
+        continue;
+
       gsk_render_node_draw (container->children[i], cr);
     }
 }
@@ -3059,6 +3382,24 @@ gsk_container_node_compare_func (gconstpointer elem1, gconstpointer elem2, gpoin
 static GskDiffResult
 gsk_container_node_keep_func (gconstpointer elem1, gconstpointer elem2, gpointer data)
 {
+  const GskRenderNode *node1 = elem1;
+  const GskRenderNode *node2 = elem2;
+  cairo_region_t *region = data;
+
+  /* Diffing children whose area is already damaged can't add anything,
+   * and large containers of small children hit this a lot.
+   */
+  if (node1 != node2)
+    {
+      cairo_rectangle_int_t rect1, rect2;
+
+      rectangle_init_from_graphene (&rect1, &node1->bounds);
+      rectangle_init_from_graphene (&rect2, &node2->bounds);
+      if (cairo_region_contains_rectangle (region, &rect1) == CAIRO_REGION_OVERLAP_IN &&
+          cairo_region_contains_rectangle (region, &rect2) == CAIRO_REGION_OVERLAP_IN)
+        return GSK_DIFF_OK;
+    }
+
   gsk_render_node_diff ((GskRenderNode *) elem1, (GskRenderNode *) elem2, data);
   if (cairo_region_num_rectangles (data) > MAX_RECTS_IN_DIFF)
     return GSK_DIFF_ABORTED;
@@ -3098,6 +3439,148 @@ gsk_container_node_get_diff_settings (void)
   return settings;
 }
 
+typedef struct
+{
+  guint hash;
+  guint idx;
+} GskDiffKey;
+
+static int
+gsk_diff_key_compare (gconstpointer a,
+                      gconstpointer b,
+                      gpointer      unused)
+{
+  const GskDiffKey *ka = a;
+  const GskDiffKey *kb = b;
+
+  if (ka->hash != kb->hash)
+    return ka->hash < kb->hash ? -1 : 1;
+
+  return (ka->idx > kb->idx) - (ka->idx < kb->idx);
+}
+
+/* Matches up nodes1 and nodes2 by their hashes and returns the
+ * longest list of matches that keeps the order of both lists, as
+ * pairs of indices. Those are the nodes that stayed where they were,
+ * and anything between them was inserted, removed or moved.
+ */
+static GArray *
+gsk_render_node_find_anchors (GskRenderNode **nodes1,
+                              gsize           n_nodes1,
+                              GskRenderNode **nodes2,
+                              gsize           n_nodes2)
+{
+  GskDiffKey *keys;
+  GHashTable *next_key;
+  gssize *matches, *tails, *prev;
+  gsize i, n_tails;
+  GArray *anchors;
+
+  keys = g_new (GskDiffKey, n_nodes1);
+  for (i = 0; i < n_nodes1; i++)
+    {
+      keys[i].hash = gsk_render_node_get_hash (nodes1[i]);
+      keys[i].idx = i;
+    }
+  g_qsort_with_data (keys, n_nodes1, sizeof (GskDiffKey), gsk_diff_key_compare, NULL);
+
+  /* hash => position of the first unmatched key with that hash, + 1 */
+  next_key = g_hash_table_new (NULL, NULL);
+  for (i = n_nodes1; i-- > 0; )
+    g_hash_table_insert (next_key, GUINT_TO_POINTER (keys[i].hash), GSIZE_TO_POINTER (i + 1));
+
+  /* matches[j] is the node in nodes1 that nodes2[j] matched, or -1 */
+  matches = g_new (gssize, n_nodes2);
+  for (i = 0; i < n_nodes2; i++)
+    {
+      guint hash = gsk_render_node_get_hash (nodes2[i]);
+      gsize pos = GPOINTER_TO_SIZE (g_hash_table_lookup (next_key, GUINT_TO_POINTER (hash)));
+
+      if (pos == 0)
+        {
+          matches[i] = -1;
+          continue;
+        }
+
+      matches[i] = keys[pos - 1].idx;
+
+      if (pos < n_nodes1 && keys[pos].hash == hash)
+        g_hash_table_insert (next_key, GUINT_TO_POINTER (hash), GSIZE_TO_POINTER (pos + 1));
+      else
+        g_hash_table_remove (next_key, GUINT_TO_POINTER (hash));
+    }
+
+  g_hash_table_unref (next_key);
+  g_free (keys);
+
+  /* Longest increasing subsequence of the matches, by patience sorting.
+   * tails[k] is the index into nodes2 of the smallest tail of all
+   * subsequences of length k + 1.
+   */
+  tails = g_new (gssize, n_nodes2);
+  prev = g_new (gssize, n_nodes2);
+  n_tails = 0;
+  for (i = 0; i < n_nodes2; i++)
+    {
+      gsize lo, hi;
+
+      if (matches[i] < 0)
+        continue;
+
+      lo = 0;
+      hi = n_tails;
+      while (lo < hi)
+        {
+          gsize mid = (lo + hi) / 2;
+          if (matches[tails[mid]] < matches[i])
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+
+      prev[i] = lo > 0 ? tails[lo - 1] : -1;
+      tails[lo] = i;
+      if (lo == n_tails)
+        n_tails++;
+    }
+
+  anchors = g_array_sized_new (FALSE, FALSE, sizeof (gsize), 2 * n_tails);
+  g_array_set_size (anchors, 2 * n_tails);
+  if (n_tails > 0)
+    {
+      gssize j = tails[n_tails - 1];
+
+      for (i = n_tails; i-- > 0; )
+        {
+          g_array_index (anchors, gsize, 2 * i) = matches[j];
+          g_array_index (anchors, gsize, 2 * i + 1) = j;
+          j = prev[j];
+        }
+    }
+
+  g_free (tails);
+  g_free (prev);
+  g_free (matches);
+
+  return anchors;
+}
+
+static gboolean
+gsk_render_node_diff_range (GskRenderNode **nodes1,
+                            gsize           n_nodes1,
+                            GskRenderNode **nodes2,
+                            gsize           n_nodes2,
+                            cairo_region_t *region)
+{
+  if (n_nodes1 == 0 && n_nodes2 == 0)
+    return TRUE;
+
+  return gsk_diff ((gconstpointer *) nodes1, n_nodes1,
+                   (gconstpointer *) nodes2, n_nodes2,
+                   gsk_container_node_get_diff_settings (),
+                   region) == GSK_DIFF_OK;
+}
+
 static gboolean
 gsk_render_node_diff_multiple (GskRenderNode **nodes1,
                                gsize           n_nodes1,
@@ -3105,10 +3588,65 @@ gsk_render_node_diff_multiple (GskRenderNode **nodes1,
                                gsize           n_nodes2,
                                cairo_region_t *region)
 {
-  return gsk_diff ((gconstpointer *) nodes1, n_nodes1,
-                   (gconstpointer *) nodes2, n_nodes2,
-                   gsk_container_node_get_diff_settings (),
-                   region) == GSK_DIFF_OK;
+  GArray *anchors;
+  gsize start1, start2, i;
+  gboolean result;
+
+  /* Unchanged children at the start and end are the common case */
+  while (n_nodes1 > 0 && n_nodes2 > 0 && nodes1[0] == nodes2[0])
+    {
+      nodes1++;
+      nodes2++;
+      n_nodes1--;
+      n_nodes2--;
+    }
+  while (n_nodes1 > 0 && n_nodes2 > 0 && nodes1[n_nodes1 - 1] == nodes2[n_nodes2 - 1])
+    {
+      n_nodes1--;
+      n_nodes2--;
+    }
+
+  if (n_nodes1 < MIN_CHILDREN_FOR_KEYED_DIFF || n_nodes2 < MIN_CHILDREN_FOR_KEYED_DIFF)
+    return gsk_render_node_diff_range (nodes1, n_nodes1, nodes2, n_nodes2, region);
+
+  /* Matching by similarity like gsk_diff() does pairs up unrelated
+   * nodes of the same type when children get inserted, removed or
+   * reordered, and every one of them ends up damaged. So first pin
+   * down the nodes that are still there by their hashes, and only
+   * run gsk_diff() on the ranges between them. Equal hashes are not
+   * trusted on their own, the anchors still get diffed, which is
+   * cheap for nodes that are the same.
+   */
+  anchors = gsk_render_node_find_anchors (nodes1, n_nodes1, nodes2, n_nodes2);
+
+  result = TRUE;
+  start1 = start2 = 0;
+  for (i = 0; i < anchors->len; i += 2)
+    {
+      gsize anchor1 = g_array_index (anchors, gsize, i);
+      gsize anchor2 = g_array_index (anchors, gsize, i + 1);
+
+      if (!gsk_render_node_diff_range (nodes1 + start1, anchor1 - start1,
+                                       nodes2 + start2, anchor2 - start2,
+                                       region) ||
+          gsk_container_node_keep_func (nodes1[anchor1], nodes2[anchor2], region) != GSK_DIFF_OK)
+        {
+          result = FALSE;
+          break;
+        }
+
+      start1 = anchor1 + 1;
+      start2 = anchor2 + 1;
+    }
+
+  if (result)
+    result = gsk_render_node_diff_range (nodes1 + start1, n_nodes1 - start1,
+                                         nodes2 + start2, n_nodes2 - start2,
+                                         region);
+
+  g_array_unref (anchors);
+
+  return result;
 }
 
 void
@@ -3146,6 +3684,18 @@ gsk_container_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint
+gsk_container_node_hash (const GskRenderNode *node)
+{
+  const GskContainerNode *self = (const GskContainerNode *) node;
+  guint hash = 0;
+
+  for (guint i = 0; i < self->n_children; i++)
+    hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->children[i]));
+
+  return hash;
+}
+
 static void
 gsk_container_node_class_init (gpointer g_class,
                                gpointer class_data)
@@ -3157,6 +3707,7 @@ gsk_container_node_class_init (gpointer g_class,
   node_class->finalize = gsk_container_node_finalize;
   node_class->draw = gsk_container_node_draw;
   node_class->diff = gsk_container_node_diff;
+  node_class->hash = gsk_container_node_hash;
 }
 
 /**
@@ -3281,6 +3832,42 @@ gsk_container_node_is_disjoint (const GskRenderNode *node)
   return self->disjoint;
 }
 
+/*< private >
+ * gsk_container_node_query:
+ * @node: a container `GskRenderNode`
+ * @rect: the area of interest in the coordinate system of @node
+ *
+ * Looks up the children of @node whose bounds intersect @rect,
+ * using a spatial index.
+ *
+ * Only large containers are indexed. If @node isn't, or if @rect
+ * covers all of @node, this function returns %NULL and callers
+ * should just go through all the children themselves.
+ *
+ * Returns: (transfer full) (nullable) (element-type guint): the
+ *   indices of the intersecting children, in ascending order
+ */
+GArray *
+gsk_container_node_query (const GskRenderNode   *node,
+                          const graphene_rect_t *rect)
+{
+  GskContainerNode *self = (GskContainerNode *) node;
+  const GskBvh *index;
+  GArray *indices;
+
+  if (graphene_rect_contains_rect (rect, &node->bounds))
+    return NULL;
+
+  index = gsk_container_node_get_index (self);
+  if (index == NULL)
+    return NULL;
+
+  indices = g_array_new (FALSE, FALSE, sizeof (guint));
+  gsk_bvh_query (index, rect, indices);
+
+  return indices;
+}
+
 /* }}} */
 /* {{{ GSK_TRANSFORM_NODE */
 
@@ -3432,6 +4019,23 @@ gsk_transform_node_diff (GskRenderNode  *node1,
     }
 }
 
+static guint
+gsk_transform_node_hash (const GskRenderNode *node)
+{
+  const GskTransformNode *self = (const GskTransformNode *) node;
+  graphene_matrix_t matrix;
+  float values[16];
+  guint hash = 0;
+
+  gsk_transform_to_matrix (self->transform, &matrix);
+  graphene_matrix_to_float (&matrix, values);
+  for (guint i = 0; i < 16; i++)
+    hash = gsk_hash_float (hash, values[i]);
+  hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->child));
+
+  return hash;
+}
+
 static void
 gsk_transform_node_class_init (gpointer g_class,
                                gpointer class_data)
@@ -3444,6 +4048,7 @@ gsk_transform_node_class_init (gpointer g_class,
   node_class->draw = gsk_transform_node_draw;
   node_class->can_diff = gsk_transform_node_can_diff;
   node_class->diff = gsk_transform_node_diff;
+  node_class->hash = gsk_transform_node_hash;
 }
 
 /**
@@ -3593,6 +4198,18 @@ gsk_opacity_node_diff (GskRenderNode  *node1,
     gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint
+gsk_opacity_node_hash (const GskRenderNode *node)
+{
+  const GskOpacityNode *self = (const GskOpacityNode *) node;
+  guint hash = 0;
+
+  hash = gsk_hash_float (hash, self->opacity);
+  hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->child));
+
+  return hash;
+}
+
 static void
 gsk_opacity_node_class_init (gpointer g_class,
                              gpointer class_data)
@@ -3604,6 +4221,7 @@ gsk_opacity_node_class_init (gpointer g_class,
   node_class->finalize = gsk_opacity_node_finalize;
   node_class->draw = gsk_opacity_node_draw;
   node_class->diff = gsk_opacity_node_diff;
+  node_class->hash = gsk_opacity_node_hash;
 }
 
 /**
@@ -3816,6 +4434,25 @@ nope:
   return;
 }
 
+static guint
+gsk_color_matrix_node_hash (const GskRenderNode *node)
+{
+  const GskColorMatrixNode *self = (const GskColorMatrixNode *) node;
+  float values[16];
+  guint hash = 0;
+
+  graphene_matrix_to_float (&self->color_matrix, values);
+  for (guint i = 0; i < 16; i++)
+    hash = gsk_hash_float (hash, values[i]);
+  hash = gsk_hash_float (hash, graphene_vec4_get_x (&self->color_offset));
+  hash = gsk_hash_float (hash, graphene_vec4_get_y (&self->color_offset));
+  hash = gsk_hash_float (hash, graphene_vec4_get_z (&self->color_offset));
+  hash = gsk_hash_float (hash, graphene_vec4_get_w (&self->color_offset));
+  hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->child));
+
+  return hash;
+}
+
 static void
 gsk_color_matrix_node_class_init (gpointer g_class,
                                   gpointer class_data)
@@ -3827,6 +4464,7 @@ gsk_color_matrix_node_class_init (gpointer g_class,
   node_class->finalize = gsk_color_matrix_node_finalize;
   node_class->draw = gsk_color_matrix_node_draw;
   node_class->diff = gsk_color_matrix_node_diff;
+  node_class->hash = gsk_color_matrix_node_hash;
 }
 
 /**
@@ -3985,6 +4623,18 @@ gsk_repeat_node_draw (GskRenderNode *node,
   cairo_fill (cr);
 }
 
+static guint
+gsk_repeat_node_hash (const GskRenderNode *node)
+{
+  const GskRepeatNode *self = (const GskRepeatNode *) node;
+  guint hash = 0;
+
+  hash = hash_rect (hash, &self->child_bounds);
+  hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->child));
+
+  return hash;
+}
+
 static void
 gsk_repeat_node_class_init (gpointer g_class,
                             gpointer class_data)
@@ -3995,6 +4645,7 @@ gsk_repeat_node_class_init (gpointer g_class,
 
   node_class->finalize = gsk_repeat_node_finalize;
   node_class->draw = gsk_repeat_node_draw;
+  node_class->hash = gsk_repeat_node_hash;
 }
 
 /**
@@ -4139,6 +4790,18 @@ gsk_clip_node_diff (GskRenderNode  *node1,
     }
 }
  
+static guint
+gsk_clip_node_hash (const GskRenderNode *node)
+{
+  const GskClipNode *self = (const GskClipNode *) node;
+  guint hash = 0;
+
+  hash = hash_rect (hash, &self->clip);
+  hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->child));
+
+  return hash;
+}
+
 static void
 gsk_clip_node_class_init (gpointer g_class,
                                gpointer class_data)
@@ -4150,6 +4813,7 @@ gsk_clip_node_class_init (gpointer g_class,
   node_class->finalize = gsk_clip_node_finalize;
   node_class->draw = gsk_clip_node_draw;
   node_class->diff = gsk_clip_node_diff;
+  node_class->hash = gsk_clip_node_hash;
 }
 
 /**
@@ -4287,6 +4951,18 @@ gsk_rounded_clip_node_diff (GskRenderNode  *node1,
     }
 }
 
+static guint
+gsk_rounded_clip_node_hash (const GskRenderNode *node)
+{
+  const GskRoundedClipNode *self = (const GskRoundedClipNode *) node;
+  guint hash = 0;
+
+  hash = hash_rounded_rect (hash, &self->clip);
+  hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->child));
+
+  return hash;
+}
+
 static void
 gsk_rounded_clip_node_class_init (gpointer g_class,
                                   gpointer class_data)
@@ -4298,6 +4974,7 @@ gsk_rounded_clip_node_class_init (gpointer g_class,
   node_class->finalize = gsk_rounded_clip_node_finalize;
   node_class->draw = gsk_rounded_clip_node_draw;
   node_class->diff = gsk_rounded_clip_node_diff;
+  node_class->hash = gsk_rounded_clip_node_hash;
 }
 
 /**
@@ -4524,6 +5201,24 @@ gsk_shadow_node_get_bounds (GskShadowNode *self,
   bounds->size.height += top + bottom;
 }
 
+static guint
+gsk_shadow_node_hash (const GskRenderNode *node)
+{
+  const GskShadowNode *self = (const GskShadowNode *) node;
+  guint hash = 0;
+
+  for (gsize i = 0; i < self->n_shadows; i++)
+    {
+      hash = hash_rgba (hash, &self->shadows[i].color);
+      hash = gsk_hash_float (hash, self->shadows[i].dx);
+      hash = gsk_hash_float (hash, self->shadows[i].dy);
+      hash = gsk_hash_float (hash, self->shadows[i].radius);
+    }
+  hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->child));
+
+  return hash;
+}
+
 static void
 gsk_shadow_node_class_init (gpointer g_class,
                             gpointer class_data)
@@ -4535,6 +5230,7 @@ gsk_shadow_node_class_init (gpointer g_class,
   node_class->finalize = gsk_shadow_node_finalize;
   node_class->draw = gsk_shadow_node_draw;
   node_class->diff = gsk_shadow_node_diff;
+  node_class->hash = gsk_shadow_node_hash;
 }
 
 /**
@@ -4736,6 +5432,19 @@ gsk_blend_node_diff (GskRenderNode  *node1,
     }
 }
 
+static guint
+gsk_blend_node_hash (const GskRenderNode *node)
+{
+  const GskBlendNode *self = (const GskBlendNode *) node;
+  guint hash = 0;
+
+  hash = gsk_hash_combine (hash, self->blend_mode);
+  hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->bottom));
+  hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->top));
+
+  return hash;
+}
+
 static void
 gsk_blend_node_class_init (gpointer g_class,
                            gpointer class_data)
@@ -4747,6 +5456,7 @@ gsk_blend_node_class_init (gpointer g_class,
   node_class->finalize = gsk_blend_node_finalize;
   node_class->draw = gsk_blend_node_draw;
   node_class->diff = gsk_blend_node_diff;
+  node_class->hash = gsk_blend_node_hash;
 }
 
 /**
@@ -4902,6 +5612,19 @@ gsk_cross_fade_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint
+gsk_cross_fade_node_hash (const GskRenderNode *node)
+{
+  const GskCrossFadeNode *self = (const GskCrossFadeNode *) node;
+  guint hash = 0;
+
+  hash = gsk_hash_float (hash, self->progress);
+  hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->start));
+  hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->end));
+
+  return hash;
+}
+
 static void
 gsk_cross_fade_node_class_init (gpointer g_class,
                                 gpointer class_data)
@@ -4913,6 +5636,7 @@ gsk_cross_fade_node_class_init (gpointer g_class,
   node_class->finalize = gsk_cross_fade_node_finalize;
   node_class->draw = gsk_cross_fade_node_draw;
   node_class->diff = gsk_cross_fade_node_diff;
+  node_class->hash = gsk_cross_fade_node_hash;
 }
 
 /**
@@ -5093,6 +5817,28 @@ gsk_text_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint
+gsk_text_node_hash (const GskRenderNode *node)
+{
+  const GskTextNode *self = (const GskTextNode *) node;
+  guint hash = 0;
+
+  hash = gsk_hash_combine (hash, g_direct_hash (self->font));
+  hash = hash_rgba (hash, &self->color);
+  hash = hash_point (hash, &self->offset);
+  for (guint i = 0; i < self->num_glyphs; i++)
+    {
+      const PangoGlyphInfo *info = &self->glyphs[i];
+
+      hash = gsk_hash_combine (hash, info->glyph);
+      hash = gsk_hash_combine (hash, info->geometry.width);
+      hash = gsk_hash_combine (hash, info->geometry.x_offset);
+      hash = gsk_hash_combine (hash, info->geometry.y_offset);
+    }
+
+  return hash;
+}
+
 static void
 gsk_text_node_class_init (gpointer g_class,
                           gpointer class_data)
@@ -5104,6 +5850,7 @@ gsk_text_node_class_init (gpointer g_class,
   node_class->finalize = gsk_text_node_finalize;
   node_class->draw = gsk_text_node_draw;
   node_class->diff = gsk_text_node_diff;
+  node_class->hash = gsk_text_node_hash;
 }
 
 /**
@@ -5529,6 +6276,18 @@ gsk_blur_node_diff (GskRenderNode  *node1,
     }
 }
 
+static guint
+gsk_blur_node_hash (const GskRenderNode *node)
+{
+  const GskBlurNode *self = (const GskBlurNode *) node;
+  guint hash = 0;
+
+  hash = gsk_hash_float (hash, self->radius);
+  hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->child));
+
+  return hash;
+}
+
 static void
 gsk_blur_node_class_init (gpointer g_class,
                           gpointer class_data)
@@ -5540,6 +6299,7 @@ gsk_blur_node_class_init (gpointer g_class,
   node_class->finalize = gsk_blur_node_finalize;
   node_class->draw = gsk_blur_node_draw;
   node_class->diff = gsk_blur_node_diff;
+  node_class->hash = gsk_blur_node_hash;
 }
 
 /**
@@ -5755,6 +6515,19 @@ gsk_mask_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff (self1->mask, self2->mask, region);
 }
 
+static guint
+gsk_mask_node_hash (const GskRenderNode *node)
+{
+  const GskMaskNode *self = (const GskMaskNode *) node;
+  guint hash = 0;
+
+  hash = gsk_hash_combine (hash, self->mask_mode);
+  hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->source));
+  hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->mask));
+
+  return hash;
+}
+
 static void
 gsk_mask_node_class_init (gpointer g_class,
                           gpointer class_data)
@@ -5766,6 +6539,7 @@ gsk_mask_node_class_init (gpointer g_class,
   node_class->finalize = gsk_mask_node_finalize;
   node_class->draw = gsk_mask_node_draw;
   node_class->diff = gsk_mask_node_diff;
+  node_class->hash = gsk_mask_node_hash;
 }
 
 /**
@@ -5923,6 +6697,17 @@ gsk_debug_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff (self1->child, self2->child, region);
 }
 
+static guint
+gsk_debug_node_hash (const GskRenderNode *node)
+{
+  const GskDebugNode *self = (const GskDebugNode *) node;
+  guint hash = 0;
+
+  hash = gsk_hash_combine (hash, gsk_render_node_get_hash (self->child));
+
+  return hash;
+}
+
 static void
 gsk_debug_node_class_init (gpointer g_class,
                            gpointer class_data)
@@ -5935,6 +6720,7 @@ gsk_debug_node_class_init (gpointer g_class,
   node_class->draw = gsk_debug_node_draw;
   node_class->can_diff = gsk_debug_node_can_diff;
   node_class->diff = gsk_debug_node_diff;
+  node_class->hash = gsk_debug_node_hash;
 }
 
 /**
@@ -27,6 +27,7 @@
 #include "gskrendernodeprivate.h"
 #include "gsktransformprivate.h"
 
+#include "gdk/gdkmemoryformatprivate.h"
 #include "gdk/gdkrgbaprivate.h"
 #include "gdk/gdktextureprivate.h"
 #include <gtk/css/gtkcss.h>
@@ -34,6 +35,8 @@
 #include "gtk/css/gtkcssparserprivate.h"
 #include "gtk/css/gtkcssserializerprivate.h"
 
+#include <math.h>
+
 #ifdef CAIRO_HAS_SCRIPT_SURFACE
 #include <cairo-script.h>
 #endif
@@ -41,6 +44,13 @@
 #include <cairo-script-interpreter.h>
 #endif
 
+/* The binary format is described next to BinaryHeader */
+#define BINARY_MAGIC "\211GSK\r\n\032\n"
+#define BINARY_VERSION 1
+#define BINARY_BYTE_ORDER 0x01020304
+#define BINARY_DATA_ALIGNMENT 16
+#define BINARY_NONE G_MAXUINT32
+
 typedef struct _Context Context;
 
 struct _Context
@@ -267,6 +277,45 @@ csi_hooks_context_destroy (void *closure,
   cairo_destroy (cr);
 }
 
+#ifdef HAVE_CAIRO_SCRIPT_INTERPRETER
+static cairo_surface_t *
+surface_from_script (GBytes  *bytes,
+                     GError **error)
+{
+  cairo_script_interpreter_t *csi;
+  cairo_script_interpreter_hooks_t hooks = {
+    .surface_create = csi_hooks_surface_create,
+    .context_create = csi_hooks_context_create,
+    .context_destroy = csi_hooks_context_destroy,
+  };
+
+  hooks.closure = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
+  csi = cairo_script_interpreter_create ();
+  cairo_script_interpreter_install_hooks (csi, &hooks);
+  cairo_script_interpreter_feed_string (csi, g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes));
+  if (cairo_surface_status (hooks.closure) != CAIRO_STATUS_SUCCESS)
+    {
+      g_set_error (error,
+                   GTK_CSS_PARSER_ERROR,
+                   GTK_CSS_PARSER_ERROR_UNKNOWN_VALUE,
+                   "Invalid Cairo script: %s", cairo_status_to_string (cairo_surface_status (hooks.closure)));
+      cairo_script_interpreter_destroy (csi);
+      return NULL;
+    }
+  if (cairo_script_interpreter_destroy (csi) != CAIRO_STATUS_SUCCESS)
+    {
+      g_set_error_literal (error,
+                           GTK_CSS_PARSER_ERROR,
+                           GTK_CSS_PARSER_ERROR_UNKNOWN_VALUE,
+                           "Invalid Cairo script");
+      cairo_surface_destroy (hooks.closure);
+      return NULL;
+    }
+
+  return hooks.closure;
+}
+#endif
+
 static gboolean
 parse_script (GtkCssParser *parser,
               Context      *context,
@@ -276,13 +325,8 @@ parse_script (GtkCssParser *parser,
   GError *error = NULL;
   GBytes *bytes;
   GtkCssLocation start_location;
+  cairo_surface_t *surface;
   char *url, *scheme;
-  cairo_script_interpreter_t *csi;
-  cairo_script_interpreter_hooks_t hooks = {
-    .surface_create = csi_hooks_surface_create,
-    .context_create = csi_hooks_context_create,
-    .context_destroy = csi_hooks_context_destroy,
-  };
 
   start_location = *gtk_css_parser_get_start_location (parser);
   url = gtk_css_parser_consume_url (parser);
@@ -327,25 +371,16 @@ parse_script (GtkCssParser *parser,
       return FALSE;
     }
 
-  hooks.closure = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
-  csi = cairo_script_interpreter_create ();
-  cairo_script_interpreter_install_hooks (csi, &hooks);
-  cairo_script_interpreter_feed_string (csi, g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes));
+  surface = surface_from_script (bytes, &error);
   g_bytes_unref (bytes);
-  if (cairo_surface_status (hooks.closure) != CAIRO_STATUS_SUCCESS)
+  if (surface == NULL)
     {
-      gtk_css_parser_error_value (parser, "Invalid Cairo script: %s", cairo_status_to_string (cairo_surface_status (hooks.closure)));
-      cairo_script_interpreter_destroy (csi);
-      return FALSE;
-    }
-  if (cairo_script_interpreter_destroy (csi) != CAIRO_STATUS_SUCCESS)
-    {
-      gtk_css_parser_error_value (parser, "Invalid Cairo script");
-      cairo_surface_destroy (hooks.closure);
+      gtk_css_parser_error_value (parser, "%s", error->message);
+      g_clear_error (&error);
       return FALSE;
     }
 
-  *(cairo_surface_t **) out_data = hooks.closure;
+  *(cairo_surface_t **) out_data = surface;
   return TRUE;
 #else
   gtk_css_parser_warn (parser,
@@ -2306,6 +2341,21 @@ gsk_render_node_parser_error (GtkCssParser         *parser,
                                  error_func_pair->user_data);
 }
 
+static GskRenderNode *
+gsk_render_node_deserialize_binary (GBytes            *bytes,
+                                    GskParseErrorFunc  error_func,
+                                    gpointer           user_data);
+
+static gboolean
+gsk_render_node_bytes_are_binary (GBytes *bytes)
+{
+  gsize size;
+  const char *data = g_bytes_get_data (bytes, &size);
+
+  return size >= strlen (BINARY_MAGIC) &&
+         memcmp (data, BINARY_MAGIC, strlen (BINARY_MAGIC)) == 0;
+}
+
 GskRenderNode *
 gsk_render_node_deserialize_from_bytes (GBytes            *bytes,
                                         GskParseErrorFunc  error_func,
@@ -2319,6 +2369,9 @@ gsk_render_node_deserialize_from_bytes (GBytes            *bytes,
     gpointer user_data;
   } error_func_pair = { error_func, user_data };
 
+  if (gsk_render_node_bytes_are_binary (bytes))
+    return gsk_render_node_deserialize_binary (bytes, error_func, user_data);
+
   parser = gtk_css_parser_new_for_bytes (bytes, NULL, gsk_render_node_parser_error,
                                          &error_func_pair, NULL);
   context_init (&context);
@@ -2823,6 +2876,34 @@ cairo_destroy_array (gpointer array)
   g_byte_array_free (array, TRUE);
 }
 
+#ifdef CAIRO_HAS_SCRIPT_SURFACE
+static GBytes *
+script_from_recording_surface (cairo_surface_t *surface)
+{
+  static const cairo_user_data_key_t cairo_is_stupid_key;
+  cairo_device_t *script;
+  GByteArray *array;
+  GBytes *result = NULL;
+
+  array = g_byte_array_new ();
+  script = cairo_script_create_for_stream (cairo_write_array, array);
+
+  if (cairo_script_from_recording_surface (script, surface) == CAIRO_STATUS_SUCCESS)
+    result = g_bytes_new (array->data, array->len);
+
+  /* because Cairo is stupid and writes to the device after we finished it,
+   * we can't just
+  g_byte_array_free (array, TRUE);
+   * but have to
+   */
+  g_byte_array_set_size (array, 0);
+  cairo_device_set_user_data (script, &cairo_is_stupid_key, array, cairo_destroy_array);
+  cairo_device_destroy (script);
+
+  return result;
+}
+#endif
+
 static void
 append_escaping_newlines (GString    *str,
                           const char *string)
@@ -3652,30 +3733,19 @@ render_node_print (Printer       *p,
 #ifdef CAIRO_HAS_SCRIPT_SURFACE
             if (cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_RECORDING)
               {
-                static const cairo_user_data_key_t cairo_is_stupid_key;
-                cairo_device_t *script;
-
-                array = g_byte_array_new ();
-                script = cairo_script_create_for_stream (cairo_write_array, array);
+                GBytes *script = script_from_recording_surface (surface);
 
-                if (cairo_script_from_recording_surface (script, surface) == CAIRO_STATUS_SUCCESS)
+                if (script)
                   {
                     _indent (p);
                     g_string_append (p->str, "script: url(\"data:;base64,");
-                    b64 = base64_encode_with_linebreaks (array->data, array->len);
+                    b64 = base64_encode_with_linebreaks (g_bytes_get_data (script, NULL),
+                                                         g_bytes_get_size (script));
                     append_escaping_newlines (p->str, b64);
                     g_free (b64);
                     g_string_append (p->str, "\");\n");
+                    g_bytes_unref (script);
                   }
-
-                /* because Cairo is stupid and writes to the device after we finished it,
-                 * we can't just
-                g_byte_array_free (array, TRUE);
-                 * but have to
-                 */
-                g_byte_array_set_size (array, 0);
-                cairo_device_set_user_data (script, &cairo_is_stupid_key, array, cairo_destroy_array);
-                cairo_device_destroy (script);
               }
 #endif
           }
@@ -3736,3 +3806,1811 @@ gsk_render_node_serialize (GskRenderNode *node)
 
   return res;
 }
+
+/* The binary format is meant for capture and replay tools that need
+ * to load large files quickly. Everything is stored in the byte order
+ * of the machine that wrote it, in a layout that can be read straight
+ * from a mapped file:
+ *
+ *   BinaryHeader
+ *   BinaryBlob[n_blobs]         strings and other byte arrays
+ *   BinaryTexture[n_textures]   raw pixel data of all textures
+ *   node records
+ *   blob and pixel data
+ *
+ * Every node record starts with the node type and the number of
+ * 32bit words that follow. Nodes refer to other nodes, blobs and
+ * textures by index. Children are written before their parents,
+ * so every node can be created as soon as its record is read, and
+ * the last node is the root. Nodes and textures that are used more
+ * than once are only written once.
+ */
+
+typedef struct
+{
+  char magic[8];
+  guint32 version;
+  guint32 byte_order;
+  guint32 n_blobs;
+  guint32 n_textures;
+  guint32 n_nodes;
+  guint32 reserved;
+  guint64 blobs_offset;
+  guint64 textures_offset;
+  guint64 nodes_offset;
+  guint64 nodes_size;
+} BinaryHeader;
+
+typedef struct
+{
+  guint64 offset;
+  guint64 size;
+} BinaryBlob;
+
+typedef struct
+{
+  guint32 width;
+  guint32 height;
+  guint32 format;
+  guint32 reserved;
+  guint64 stride;
+  guint64 offset;
+} BinaryTexture;
+
+G_STATIC_ASSERT (sizeof (BinaryHeader) == 64);
+G_STATIC_ASSERT (sizeof (BinaryBlob) == 16);
+G_STATIC_ASSERT (sizeof (BinaryTexture) == 32);
+
+typedef struct
+{
+  GByteArray *nodes;
+  GByteArray *data;
+  GArray *blobs;
+  GArray *textures;
+  guint n_nodes;
+  /* these map to index + 1 */
+  GHashTable *node_indices;
+  GHashTable *texture_indices;
+  GHashTable *string_indices;
+} BinaryWriter;
+
+static void
+binary_writer_init (BinaryWriter *self)
+{
+  self->nodes = g_byte_array_new ();
+  self->data = g_byte_array_new ();
+  self->blobs = g_array_new (FALSE, FALSE, sizeof (BinaryBlob));
+  self->textures = g_array_new (FALSE, FALSE, sizeof (BinaryTexture));
+  self->n_nodes = 0;
+  self->node_indices = g_hash_table_new (NULL, NULL);
+  self->texture_indices = g_hash_table_new (NULL, NULL);
+  self->string_indices = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+}
+
+static void
+binary_writer_clear (BinaryWriter *self)
+{
+  g_byte_array_unref (self->nodes);
+  g_byte_array_unref (self->data);
+  g_array_unref (self->blobs);
+  g_array_unref (self->textures);
+  g_hash_table_unref (self->node_indices);
+  g_hash_table_unref (self->texture_indices);
+  g_hash_table_unref (self->string_indices);
+}
+
+static void
+binary_append_u32 (BinaryWriter *self,
+                   guint32       value)
+{
+  g_byte_array_append (self->nodes, (const guint8 *) &value, sizeof (guint32));
+}
+
+static void
+binary_append_float (BinaryWriter *self,
+                     float         value)
+{
+  g_byte_array_append (self->nodes, (const guint8 *) &value, sizeof (float));
+}
+
+static void
+binary_append_point (BinaryWriter           *self,
+                     const graphene_point_t *point)
+{
+  binary_append_float (self, point->x);
+  binary_append_float (self, point->y);
+}
+
+static void
+binary_append_rect (BinaryWriter          *self,
+                    const graphene_rect_t *rect)
+{
+  binary_append_float (self, rect->origin.x);
+  binary_append_float (self, rect->origin.y);
+  binary_append_float (self, rect->size.width);
+  binary_append_float (self, rect->size.height);
+}
+
+static void
+binary_append_rounded_rect (BinaryWriter         *self,
+                            const GskRoundedRect *rect)
+{
+  guint i;
+
+  binary_append_rect (self, &rect->bounds);
+  for (i = 0; i < 4; i++)
+    {
+      binary_append_float (self, rect->corner[i].width);
+      binary_append_float (self, rect->corner[i].height);
+    }
+}
+
+static void
+binary_append_rgba (BinaryWriter  *self,
+                    const GdkRGBA *rgba)
+{
+  binary_append_float (self, rgba->red);
+  binary_append_float (self, rgba->green);
+  binary_append_float (self, rgba->blue);
+  binary_append_float (self, rgba->alpha);
+}
+
+static void
+binary_append_stops (BinaryWriter       *self,
+                     const GskColorStop *stops,
+                     gsize               n_stops)
+{
+  gsize i;
+
+  binary_append_u32 (self, n_stops);
+  for (i = 0; i < n_stops; i++)
+    {
+      binary_append_float (self, stops[i].offset);
+      binary_append_rgba (self, &stops[i].color);
+    }
+}
+
+static void
+binary_append_node (BinaryWriter  *self,
+                    GskRenderNode *node)
+{
+  guint index = GPOINTER_TO_UINT (g_hash_table_lookup (self->node_indices, node));
+
+  g_assert (index > 0);
+
+  binary_append_u32 (self, index - 1);
+}
+
+static void
+binary_writer_align_data (BinaryWriter *self)
+{
+  static const guint8 zeroes[BINARY_DATA_ALIGNMENT] = { 0, };
+  gsize len = self->data->len;
+
+  if (len % BINARY_DATA_ALIGNMENT)
+    g_byte_array_append (self->data, zeroes, BINARY_DATA_ALIGNMENT - len % BINARY_DATA_ALIGNMENT);
+}
+
+static guint32
+binary_writer_add_blob (BinaryWriter *self,
+                        gconstpointer data,
+                        gsize         size)
+{
+  BinaryBlob blob;
+
+  blob.offset = self->data->len;
+  blob.size = size;
+  g_byte_array_append (self->data, data, size);
+  /* zero-terminate, so strings can be used in place */
+  g_byte_array_append (self->data, (const guint8 *) "", 1);
+  g_array_append_val (self->blobs, blob);
+
+  return self->blobs->len - 1;
+}
+
+static guint32
+binary_writer_add_string (BinaryWriter *self,
+                          const char   *string)
+{
+  guint index;
+
+  if (string == NULL)
+    return BINARY_NONE;
+
+  index = GPOINTER_TO_UINT (g_hash_table_lookup (self->string_indices, string));
+  if (index == 0)
+    {
+      index = binary_writer_add_blob (self, string, strlen (string)) + 1;
+      g_hash_table_insert (self->string_indices, g_strdup (string), GUINT_TO_POINTER (index));
+    }
+
+  return index - 1;
+}
+
+static guint32
+binary_writer_add_pixels (BinaryWriter    *self,
+                          gsize            width,
+                          gsize            height,
+                          GdkMemoryFormat  format,
+                          const guchar    *data,
+                          gsize            stride)
+{
+  BinaryTexture texture;
+  gsize y, row_size;
+
+  row_size = width * gdk_memory_format_bytes_per_pixel (format);
+
+  binary_writer_align_data (self);
+
+  texture.width = width;
+  texture.height = height;
+  texture.format = format;
+  texture.reserved = 0;
+  texture.stride = row_size;
+  texture.offset = self->data->len;
+
+  for (y = 0; y < height; y++)
+    g_byte_array_append (self->data, data + y * stride, row_size);
+
+  g_array_append_val (self->textures, texture);
+
+  return self->textures->len - 1;
+}
+
+static guint32
+binary_writer_add_texture (BinaryWriter *self,
+                           GdkTexture   *texture)
+{
+  GdkTextureDownloader *downloader;
+  GBytes *bytes;
+  gsize stride;
+  guint index;
+
+  index = GPOINTER_TO_UINT (g_hash_table_lookup (self->texture_indices, texture));
+  if (index > 0)
+    return index - 1;
+
+  downloader = gdk_texture_downloader_new (texture);
+  gdk_texture_downloader_set_format (downloader, gdk_texture_get_format (texture));
+  bytes = gdk_texture_downloader_download_bytes (downloader, &stride);
+  gdk_texture_downloader_free (downloader);
+
+  index = binary_writer_add_pixels (self,
+                                    gdk_texture_get_width (texture),
+                                    gdk_texture_get_height (texture),
+                                    gdk_texture_get_format (texture),
+                                    g_bytes_get_data (bytes, NULL),
+                                    stride);
+  g_bytes_unref (bytes);
+
+  g_hash_table_insert (self->texture_indices, texture, GUINT_TO_POINTER (index + 1));
+
+  return index;
+}
+
+/* Captures the pixels covered by @bounds, rounded out to whole pixels,
+ * just like Cairo does when writing the surface to a PNG.
+ */
+static guint32
+binary_writer_add_surface (BinaryWriter          *self,
+                           cairo_surface_t       *surface,
+                           const graphene_rect_t *bounds)
+{
+  cairo_surface_t *image;
+  cairo_t *cr;
+  int x, y, width, height;
+  guint32 index;
+
+  x = floorf (bounds->origin.x);
+  y = floorf (bounds->origin.y);
+  width = ceilf (bounds->origin.x + bounds->size.width) - x;
+  height = ceilf (bounds->origin.y + bounds->size.height) - y;
+  if (width <= 0 || height <= 0)
+    return BINARY_NONE;
+
+  image = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cr = cairo_create (image);
+  cairo_set_source_surface (cr, surface, - x, - y);
+  cairo_paint (cr);
+  cairo_destroy (cr);
+  cairo_surface_flush (image);
+
+  index = binary_writer_add_pixels (self,
+                                    width, height,
+                                    GDK_MEMORY_DEFAULT,
+                                    cairo_image_surface_get_data (image),
+                                    cairo_image_surface_get_stride (image));
+
+  cairo_surface_destroy (image);
+
+  return index;
+}
+
+static void
+binary_write_node (BinaryWriter  *self,
+                   GskRenderNode *node);
+
+static void
+binary_write_text_node (BinaryWriter  *self,
+                        GskRenderNode *node)
+{
+  const PangoGlyphInfo *glyphs;
+  PangoFontDescription *desc;
+  char *font_name;
+  guint i, n_glyphs;
+
+  desc = pango_font_describe (gsk_text_node_get_font (node));
+  font_name = pango_font_description_to_string (desc);
+  binary_append_u32 (self, binary_writer_add_string (self, font_name));
+  g_free (font_name);
+  pango_font_description_free (desc);
+
+  binary_append_rgba (self, gsk_text_node_get_color (node));
+  binary_append_point (self, gsk_text_node_get_offset (node));
+
+  glyphs = gsk_text_node_get_glyphs (node, &n_glyphs);
+  binary_append_u32 (self, n_glyphs);
+  for (i = 0; i < n_glyphs; i++)
+    {
+      binary_append_u32 (self, glyphs[i].glyph);
+      binary_append_u32 (self, glyphs[i].geometry.width);
+      binary_append_u32 (self, glyphs[i].geometry.x_offset);
+      binary_append_u32 (self, glyphs[i].geometry.y_offset);
+      binary_append_u32 (self, (glyphs[i].attr.is_cluster_start ? 1 : 0) |
+                               (glyphs[i].attr.is_color ? 2 : 0));
+    }
+}
+
+static void
+binary_write_node_data (BinaryWriter  *self,
+                        GskRenderNode *node)
+{
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      {
+        guint i;
+
+        binary_append_u32 (self, gsk_container_node_get_n_children (node));
+        for (i = 0; i < gsk_container_node_get_n_children (node); i++)
+          binary_append_node (self, gsk_container_node_get_child (node, i));
+      }
+      break;
+
+    case GSK_CAIRO_NODE:
+      {
+        cairo_surface_t *surface = gsk_cairo_node_get_surface (node);
+        guint32 script = BINARY_NONE;
+
+        binary_append_rect (self, &node->bounds);
+
+        if (surface == NULL)
+          {
+            binary_append_u32 (self, BINARY_NONE);
+            binary_append_u32 (self, BINARY_NONE);
+            break;
+          }
+
+        binary_append_u32 (self, binary_writer_add_surface (self, surface, &node->bounds));
+
+#ifdef CAIRO_HAS_SCRIPT_SURFACE
+        if (cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_RECORDING)
+          {
+            GBytes *bytes = script_from_recording_surface (surface);
+
+            if (bytes)
+              {
+                script = binary_writer_add_blob (self,
+                                                 g_bytes_get_data (bytes, NULL),
+                                                 g_bytes_get_size (bytes));
+                g_bytes_unref (bytes);
+              }
+          }
+#endif
+        binary_append_u32 (self, script);
+      }
+      break;
+
+    case GSK_COLOR_NODE:
+      binary_append_rect (self, &node->bounds);
+      binary_append_rgba (self, gsk_color_node_get_color (node));
+      break;
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      binary_append_rect (self, &node->bounds);
+      binary_append_point (self, gsk_linear_gradient_node_get_start (node));
+      binary_append_point (self, gsk_linear_gradient_node_get_end (node));
+      binary_append_stops (self,
+                           gsk_linear_gradient_node_get_color_stops (node, NULL),
+                           gsk_linear_gradient_node_get_n_color_stops (node));
+      break;
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      binary_append_rect (self, &node->bounds);
+      binary_append_point (self, gsk_radial_gradient_node_get_center (node));
+      binary_append_float (self, gsk_radial_gradient_node_get_hradius (node));
+      binary_append_float (self, gsk_radial_gradient_node_get_vradius (node));
+      binary_append_float (self, gsk_radial_gradient_node_get_start (node));
+      binary_append_float (self, gsk_radial_gradient_node_get_end (node));
+      binary_append_stops (self,
+                           gsk_radial_gradient_node_get_color_stops (node, NULL),
+                           gsk_radial_gradient_node_get_n_color_stops (node));
+      break;
+
+    case GSK_CONIC_GRADIENT_NODE:
+      binary_append_rect (self, &node->bounds);
+      binary_append_point (self, gsk_conic_gradient_node_get_center (node));
+      binary_append_float (self, gsk_conic_gradient_node_get_rotation (node));
+      binary_append_stops (self,
+                           gsk_conic_gradient_node_get_color_stops (node, NULL),
+                           gsk_conic_gradient_node_get_n_color_stops (node));
+      break;
+
+    case GSK_BORDER_NODE:
+      {
+        const GdkRGBA *colors = gsk_border_node_get_colors (node);
+        const float *widths = gsk_border_node_get_widths (node);
+        guint i;
+
+        binary_append_rounded_rect (self, gsk_border_node_get_outline (node));
+        for (i = 0; i < 4; i++)
+          binary_append_float (self, widths[i]);
+        for (i = 0; i < 4; i++)
+          binary_append_rgba (self, &colors[i]);
+      }
+      break;
+
+    case GSK_TEXTURE_NODE:
+      binary_append_rect (self, &node->bounds);
+      binary_append_u32 (self, binary_writer_add_texture (self, gsk_texture_node_get_texture (node)));
+      break;
+
+    case GSK_TEXTURE_SCALE_NODE:
+      binary_append_rect (self, &node->bounds);
+      binary_append_u32 (self, binary_writer_add_texture (self, gsk_texture_scale_node_get_texture (node)));
+      binary_append_u32 (self, gsk_texture_scale_node_get_filter (node));
+      break;
+
+    case GSK_INSET_SHADOW_NODE:
+      binary_append_rounded_rect (self, gsk_inset_shadow_node_get_outline (node));
+      binary_append_rgba (self, gsk_inset_shadow_node_get_color (node));
+      binary_append_float (self, gsk_inset_shadow_node_get_dx (node));
+      binary_append_float (self, gsk_inset_shadow_node_get_dy (node));
+      binary_append_float (self, gsk_inset_shadow_node_get_spread (node));
+      binary_append_float (self, gsk_inset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_OUTSET_SHADOW_NODE:
+      binary_append_rounded_rect (self, gsk_outset_shadow_node_get_outline (node));
+      binary_append_rgba (self, gsk_outset_shadow_node_get_color (node));
+      binary_append_float (self, gsk_outset_shadow_node_get_dx (node));
+      binary_append_float (self, gsk_outset_shadow_node_get_dy (node));
+      binary_append_float (self, gsk_outset_shadow_node_get_spread (node));
+      binary_append_float (self, gsk_outset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      {
+        char *transform = gsk_transform_to_string (gsk_transform_node_get_transform (node));
+
+        binary_append_u32 (self, binary_writer_add_string (self, transform));
+        binary_append_node (self, gsk_transform_node_get_child (node));
+        g_free (transform);
+      }
+      break;
+
+    case GSK_OPACITY_NODE:
+      binary_append_float (self, gsk_opacity_node_get_opacity (node));
+      binary_append_node (self, gsk_opacity_node_get_child (node));
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      {
+        float values[16];
+        guint i;
+
+        graphene_matrix_to_float (gsk_color_matrix_node_get_color_matrix (node), values);
+        for (i = 0; i < 16; i++)
+          binary_append_float (self, values[i]);
+        graphene_vec4_to_float (gsk_color_matrix_node_get_color_offset (node), values);
+        for (i = 0; i < 4; i++)
+          binary_append_float (self, values[i]);
+        binary_append_node (self, gsk_color_matrix_node_get_child (node));
+      }
+      break;
+
+    case GSK_REPEAT_NODE:
+      binary_append_rect (self, &node->bounds);
+      binary_append_rect (self, gsk_repeat_node_get_child_bounds (node));
+      binary_append_node (self, gsk_repeat_node_get_child (node));
+      break;
+
+    case GSK_CLIP_NODE:
+      binary_append_rect (self, gsk_clip_node_get_clip (node));
+      binary_append_node (self, gsk_clip_node_get_child (node));
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      binary_append_rounded_rect (self, gsk_rounded_clip_node_get_clip (node));
+      binary_append_node (self, gsk_rounded_clip_node_get_child (node));
+      break;
+
+    case GSK_SHADOW_NODE:
+      {
+        gsize i, n_shadows = gsk_shadow_node_get_n_shadows (node);
+
+        binary_append_u32 (self, n_shadows);
+        for (i = 0; i < n_shadows; i++)
+          {
+            const GskShadow *shadow = gsk_shadow_node_get_shadow (node, i);
+
+            binary_append_rgba (self, &shadow->color);
+            binary_append_float (self, shadow->dx);
+            binary_append_float (self, shadow->dy);
+            binary_append_float (self, shadow->radius);
+          }
+        binary_append_node (self, gsk_shadow_node_get_child (node));
+      }
+      break;
+
+    case GSK_BLEND_NODE:
+      binary_append_u32 (self, gsk_blend_node_get_blend_mode (node));
+      binary_append_node (self, gsk_blend_node_get_bottom_child (node));
+      binary_append_node (self, gsk_blend_node_get_top_child (node));
+      break;
+
+    case GSK_MASK_NODE:
+      binary_append_u32 (self, gsk_mask_node_get_mask_mode (node));
+      binary_append_node (self, gsk_mask_node_get_source (node));
+      binary_append_node (self, gsk_mask_node_get_mask (node));
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      binary_append_float (self, gsk_cross_fade_node_get_progress (node));
+      binary_append_node (self, gsk_cross_fade_node_get_start_child (node));
+      binary_append_node (self, gsk_cross_fade_node_get_end_child (node));
+      break;
+
+    case GSK_TEXT_NODE:
+      binary_write_text_node (self, node);
+      break;
+
+    case GSK_BLUR_NODE:
+      binary_append_float (self, gsk_blur_node_get_radius (node));
+      binary_append_node (self, gsk_blur_node_get_child (node));
+      break;
+
+    case GSK_DEBUG_NODE:
+      binary_append_u32 (self, binary_writer_add_string (self, gsk_debug_node_get_message (node)));
+      binary_append_node (self, gsk_debug_node_get_child (node));
+      break;
+
+    case GSK_GL_SHADER_NODE:
+      {
+        GskGLShader *shader = gsk_gl_shader_node_get_shader (node);
+        GBytes *source = gsk_gl_shader_get_source (shader);
+        GBytes *args = gsk_gl_shader_node_get_args (node);
+        char *sourcecode;
+        guint i;
+
+        binary_append_rect (self, &node->bounds);
+        /* Ensure we are zero-terminated */
+        sourcecode = g_strndup (g_bytes_get_data (source, NULL), g_bytes_get_size (source));
+        binary_append_u32 (self, binary_writer_add_string (self, sourcecode));
+        g_free (sourcecode);
+        binary_append_u32 (self, binary_writer_add_blob (self,
+                                                         g_bytes_get_data (args, NULL),
+                                                         g_bytes_get_size (args)));
+        binary_append_u32 (self, gsk_gl_shader_node_get_n_children (node));
+        for (i = 0; i < gsk_gl_shader_node_get_n_children (node); i++)
+          binary_append_node (self, gsk_gl_shader_node_get_child (node, i));
+      }
+      break;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+}
+
+static void
+binary_write_children (BinaryWriter  *self,
+                       GskRenderNode *node)
+{
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CAIRO_NODE:
+    case GSK_TEXT_NODE:
+    case GSK_COLOR_NODE:
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+    case GSK_CONIC_GRADIENT_NODE:
+    case GSK_BORDER_NODE:
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+    case GSK_TEXTURE_NODE:
+    case GSK_TEXTURE_SCALE_NODE:
+      /* no children */
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      binary_write_node (self, gsk_transform_node_get_child (node));
+      break;
+
+    case GSK_OPACITY_NODE:
+      binary_write_node (self, gsk_opacity_node_get_child (node));
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      binary_write_node (self, gsk_color_matrix_node_get_child (node));
+      break;
+
+    case GSK_BLUR_NODE:
+      binary_write_node (self, gsk_blur_node_get_child (node));
+      break;
+
+    case GSK_REPEAT_NODE:
+      binary_write_node (self, gsk_repeat_node_get_child (node));
+      break;
+
+    case GSK_CLIP_NODE:
+      binary_write_node (self, gsk_clip_node_get_child (node));
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      binary_write_node (self, gsk_rounded_clip_node_get_child (node));
+      break;
+
+    case GSK_SHADOW_NODE:
+      binary_write_node (self, gsk_shadow_node_get_child (node));
+      break;
+
+    case GSK_DEBUG_NODE:
+      binary_write_node (self, gsk_debug_node_get_child (node));
+      break;
+
+    case GSK_BLEND_NODE:
+      binary_write_node (self, gsk_blend_node_get_bottom_child (node));
+      binary_write_node (self, gsk_blend_node_get_top_child (node));
+      break;
+
+    case GSK_MASK_NODE:
+      binary_write_node (self, gsk_mask_node_get_source (node));
+      binary_write_node (self, gsk_mask_node_get_mask (node));
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      binary_write_node (self, gsk_cross_fade_node_get_start_child (node));
+      binary_write_node (self, gsk_cross_fade_node_get_end_child (node));
+      break;
+
+    case GSK_GL_SHADER_NODE:
+      {
+        guint i;
+
+        for (i = 0; i < gsk_gl_shader_node_get_n_children (node); i++)
+          binary_write_node (self, gsk_gl_shader_node_get_child (node, i));
+      }
+      break;
+
+    case GSK_CONTAINER_NODE:
+      {
+        guint i;
+
+        for (i = 0; i < gsk_container_node_get_n_children (node); i++)
+          binary_write_node (self, gsk_container_node_get_child (node, i));
+      }
+      break;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+}
+
+static void
+binary_write_node (BinaryWriter  *self,
+                   GskRenderNode *node)
+{
+  guint32 n_words;
+  gsize start;
+
+  if (g_hash_table_contains (self->node_indices, node))
+    return;
+
+  binary_write_children (self, node);
+
+  start = self->nodes->len;
+  binary_append_u32 (self, gsk_render_node_get_node_type (node));
+  binary_append_u32 (self, 0);
+
+  binary_write_node_data (self, node);
+
+  n_words = (self->nodes->len - start) / sizeof (guint32) - 2;
+  memcpy (self->nodes->data + start + sizeof (guint32), &n_words, sizeof (guint32));
+
+  g_hash_table_insert (self->node_indices, node, GUINT_TO_POINTER (++self->n_nodes));
+}
+
+/**
+ * gsk_render_node_serialize_binary:
+ * @node: a `GskRenderNode`
+ *
+ * Serializes the @node into a compact binary format.
+ *
+ * The result can be loaded with gsk_render_node_deserialize(), which
+ * detects the format automatically, and produces the same nodes as the
+ * text format created by gsk_render_node_serialize(). Unlike the text
+ * format, textures are stored as raw pixel data, so files are larger,
+ * but much faster to load.
+ *
+ * The binary format uses the byte order of the machine it was created
+ * on and is only meant to be read by the same version of GTK. Like the
+ * text format, it is intended for testing, benchmarking and debugging.
+ *
+ * Returns: a `GBytes` representing the node.
+ *
+ * Since: 4.12
+ */
+GBytes *
+gsk_render_node_serialize_binary (GskRenderNode *node)
+{
+  BinaryWriter writer;
+  BinaryHeader header;
+  GByteArray *result;
+  gsize data_offset;
+  guint i;
+
+  g_return_val_if_fail (GSK_IS_RENDER_NODE (node), NULL);
+
+  binary_writer_init (&writer);
+  binary_write_node (&writer, node);
+
+  memset (&header, 0, sizeof (BinaryHeader));
+  memcpy (header.magic, BINARY_MAGIC, sizeof (header.magic));
+  header.version = BINARY_VERSION;
+  header.byte_order = BINARY_BYTE_ORDER;
+  header.n_blobs = writer.blobs->len;
+  header.n_textures = writer.textures->len;
+  header.n_nodes = writer.n_nodes;
+  header.blobs_offset = sizeof (BinaryHeader);
+  header.textures_offset = header.blobs_offset + writer.blobs->len * sizeof (BinaryBlob);
+  header.nodes_offset = header.textures_offset + writer.textures->len * sizeof (BinaryTexture);
+  header.nodes_size = writer.nodes->len;
+
+  data_offset = header.nodes_offset + header.nodes_size;
+  data_offset = (data_offset + BINARY_DATA_ALIGNMENT - 1) & ~(gsize) (BINARY_DATA_ALIGNMENT - 1);
+
+  /* make the data offsets absolute */
+  for (i = 0; i < writer.blobs->len; i++)
+    g_array_index (writer.blobs, BinaryBlob, i).offset += data_offset;
+  for (i = 0; i < writer.textures->len; i++)
+    g_array_index (writer.textures, BinaryTexture, i).offset += data_offset;
+
+  result = g_byte_array_sized_new (data_offset + writer.data->len);
+  g_byte_array_append (result, (const guint8 *) &header, sizeof (BinaryHeader));
+  g_byte_array_append (result, (const guint8 *) writer.blobs->data, writer.blobs->len * sizeof (BinaryBlob));
+  g_byte_array_append (result, (const guint8 *) writer.textures->data, writer.textures->len * sizeof (BinaryTexture));
+  g_byte_array_append (result, writer.nodes->data, writer.nodes->len);
+  g_byte_array_set_size (result, data_offset);
+  memset (result->data + header.nodes_offset + header.nodes_size, 0, data_offset - header.nodes_offset - header.nodes_size);
+  g_byte_array_append (result, writer.data->data, writer.data->len);
+
+  binary_writer_clear (&writer);
+
+  return g_byte_array_free_to_bytes (result);
+}
+
+typedef struct
+{
+  GBytes *bytes;
+  const guchar *data;
+  gsize size;
+  BinaryHeader header;
+
+  /* the record that is currently read */
+  const guchar *pos;
+  const guchar *end;
+
+  GskRenderNode **nodes;
+  guint n_nodes;
+  GdkTexture **textures;
+  /* these are indexed by blob */
+  PangoFont **fonts;
+  GskGLShader **shaders;
+
+  GskParseErrorFunc error_func;
+  gpointer user_data;
+  gboolean failed;
+} BinaryReader;
+
+static void G_GNUC_PRINTF (2, 3)
+binary_reader_error (BinaryReader *self,
+                     const char   *format,
+                     ...)
+{
+  GskParseLocation location = { 0, };
+  GError *error;
+  va_list args;
+
+  /* Only report the first error, everything after it is garbage */
+  if (self->failed)
+    return;
+
+  self->failed = TRUE;
+
+  if (self->error_func == NULL)
+    return;
+
+  /* There are no lines in binary data, so report the byte offset */
+  if (self->pos)
+    location.bytes = location.chars = location.line_bytes = location.line_chars = self->pos - self->data;
+
+  va_start (args, format);
+  error = g_error_new_valist (GTK_CSS_PARSER_ERROR, GTK_CSS_PARSER_ERROR_SYNTAX, format, args);
+  va_end (args);
+
+  self->error_func (&location, &location, error, self->user_data);
+
+  g_error_free (error);
+}
+
+static gboolean
+binary_reader_check_range (BinaryReader *self,
+                           guint64       offset,
+                           guint64       size)
+{
+  return offset <= self->size && size <= self->size - offset;
+}
+
+static guint32
+binary_read_u32 (BinaryReader *self)
+{
+  guint32 result;
+
+  if (self->failed)
+    return 0;
+
+  if ((gsize) (self->end - self->pos) < sizeof (guint32))
+    {
+      binary_reader_error (self, "Unexpected end of node data");
+      return 0;
+    }
+
+  memcpy (&result, self->pos, sizeof (guint32));
+  self->pos += sizeof (guint32);
+
+  return result;
+}
+
+static float
+binary_read_float (BinaryReader *self)
+{
+  guint32 bits = binary_read_u32 (self);
+  float result;
+
+  memcpy (&result, &bits, sizeof (float));
+
+  return result;
+}
+
+static void
+binary_read_point (BinaryReader     *self,
+                   graphene_point_t *point)
+{
+  point->x = binary_read_float (self);
+  point->y = binary_read_float (self);
+}
+
+static void
+binary_read_rect (BinaryReader    *self,
+                  graphene_rect_t *rect)
+{
+  rect->origin.x = binary_read_float (self);
+  rect->origin.y = binary_read_float (self);
+  rect->size.width = binary_read_float (self);
+  rect->size.height = binary_read_float (self);
+}
+
+static void
+binary_read_rounded_rect (BinaryReader   *self,
+                          GskRoundedRect *rect)
+{
+  guint i;
+
+  binary_read_rect (self, &rect->bounds);
+  for (i = 0; i < 4; i++)
+    {
+      rect->corner[i].width = binary_read_float (self);
+      rect->corner[i].height = binary_read_float (self);
+    }
+}
+
+static void
+binary_read_rgba (BinaryReader *self,
+                  GdkRGBA      *rgba)
+{
+  rgba->red = binary_read_float (self);
+  rgba->green = binary_read_float (self);
+  rgba->blue = binary_read_float (self);
+  rgba->alpha = binary_read_float (self);
+}
+
+/* Reads a count of items that are n_words each, and makes sure that
+ * the record is large enough to contain them, so callers can safely
+ * allocate memory for them.
+ */
+static guint32
+binary_read_count (BinaryReader *self,
+                   gsize         n_words)
+{
+  guint32 count = binary_read_u32 (self);
+
+  if ((gsize) (self->end - self->pos) / sizeof (guint32) / n_words < count)
+    {
+      binary_reader_error (self, "Invalid number of items: %u", count);
+      return 0;
+    }
+
+  return count;
+}
+
+static GskColorStop *
+binary_read_stops (BinaryReader *self,
+                   gsize        *n_stops)
+{
+  GskColorStop *stops;
+  guint32 i, n;
+
+  n = binary_read_count (self, 5);
+  if (self->failed)
+    return NULL;
+
+  if (n < 2)
+    {
+      binary_reader_error (self, "Gradients need at least 2 color stops");
+      return NULL;
+    }
+
+  stops = g_new (GskColorStop, n);
+  for (i = 0; i < n; i++)
+    {
+      stops[i].offset = binary_read_float (self);
+      binary_read_rgba (self, &stops[i].color);
+      if (stops[i].offset < (i > 0 ? stops[i - 1].offset : 0) ||
+          stops[i].offset > 1)
+        binary_reader_error (self, "Color stop offsets must be increasing values between 0 and 1");
+    }
+
+  if (self->failed)
+    {
+      g_free (stops);
+      return NULL;
+    }
+
+  *n_stops = n;
+  return stops;
+}
+
+static GskRenderNode *
+binary_read_node_ref (BinaryReader *self)
+{
+  guint32 index = binary_read_u32 (self);
+
+  if (self->failed)
+    return NULL;
+
+  if (index >= self->n_nodes)
+    {
+      binary_reader_error (self, "Invalid node reference %u", index);
+      return NULL;
+    }
+
+  return self->nodes[index];
+}
+
+static GBytes *
+binary_read_blob (BinaryReader *self,
+                  gboolean      allow_none)
+{
+  BinaryBlob blob;
+  guint32 index;
+
+  index = binary_read_u32 (self);
+  if (self->failed)
+    return NULL;
+
+  if (index == BINARY_NONE && allow_none)
+    return NULL;
+
+  if (index >= self->header.n_blobs)
+    {
+      binary_reader_error (self, "Invalid blob reference %u", index);
+      return NULL;
+    }
+
+  memcpy (&blob, self->data + self->header.blobs_offset + index * sizeof (BinaryBlob), sizeof (BinaryBlob));
+
+  return g_bytes_new_from_bytes (self->bytes, blob.offset, blob.size);
+}
+
+static const char *
+binary_read_string (BinaryReader *self,
+                    guint32      *out_index,
+                    gboolean      allow_none)
+{
+  BinaryBlob blob;
+  guint32 index;
+
+  index = binary_read_u32 (self);
+  if (out_index)
+    *out_index = index;
+  if (self->failed)
+    return NULL;
+
+  if (index == BINARY_NONE && allow_none)
+    return NULL;
+
+  if (index >= self->header.n_blobs)
+    {
+      binary_reader_error (self, "Invalid string reference %u", index);
+      return NULL;
+    }
+
+  memcpy (&blob, self->data + self->header.blobs_offset + index * sizeof (BinaryBlob), sizeof (BinaryBlob));
+
+  /* The blob table was validated on load to be zero-terminated */
+  return (const char *) self->data + blob.offset;
+}
+
+static GdkTexture *
+binary_read_texture (BinaryReader *self,
+                     gboolean      allow_none)
+{
+  guint32 index = binary_read_u32 (self);
+
+  if (self->failed)
+    return NULL;
+
+  if (index == BINARY_NONE && allow_none)
+    return NULL;
+
+  if (index >= self->header.n_textures)
+    {
+      binary_reader_error (self, "Invalid texture reference %u", index);
+      return NULL;
+    }
+
+  return self->textures[index];
+}
+
+static guint32
+binary_read_enum (BinaryReader *self,
+                  guint32       n_values,
+                  const char   *name)
+{
+  guint32 value = binary_read_u32 (self);
+
+  if (value >= n_values)
+    {
+      binary_reader_error (self, "Invalid %s: %u", name, value);
+      return 0;
+    }
+
+  return value;
+}
+
+static GskRenderNode *
+binary_read_cairo_node (BinaryReader *self)
+{
+  graphene_rect_t bounds;
+  GdkTexture *pixels;
+  GBytes *script;
+  GskRenderNode *node;
+  cairo_surface_t *surface = NULL;
+
+  binary_read_rect (self, &bounds);
+  pixels = binary_read_texture (self, TRUE);
+  script = binary_read_blob (self, TRUE);
+  if (self->failed)
+    {
+      g_clear_pointer (&script, g_bytes_unref);
+      return NULL;
+    }
+
+#ifdef HAVE_CAIRO_SCRIPT_INTERPRETER
+  if (script)
+    surface = surface_from_script (script, NULL);
+#endif
+  g_clear_pointer (&script, g_bytes_unref);
+
+  node = gsk_cairo_node_new (&bounds);
+
+  if (surface != NULL)
+    {
+      cairo_t *cr = gsk_cairo_node_get_draw_context (node);
+      cairo_set_source_surface (cr, surface, 0, 0);
+      cairo_paint (cr);
+      cairo_destroy (cr);
+    }
+  else if (pixels != NULL)
+    {
+      cairo_t *cr = gsk_cairo_node_get_draw_context (node);
+      surface = gdk_texture_download_surface (pixels);
+      cairo_set_source_surface (cr, surface, floorf (bounds.origin.x), floorf (bounds.origin.y));
+      cairo_paint (cr);
+      cairo_destroy (cr);
+    }
+
+  g_clear_pointer (&surface, cairo_surface_destroy);
+
+  return node;
+}
+
+static GskRenderNode *
+binary_read_text_node (BinaryReader *self)
+{
+  PangoGlyphString *glyphs;
+  graphene_point_t offset;
+  const char *font_name;
+  GskRenderNode *node;
+  GdkRGBA color;
+  guint32 i, n_glyphs, font_index;
+
+  font_name = binary_read_string (self, &font_index, FALSE);
+  binary_read_rgba (self, &color);
+  binary_read_point (self, &offset);
+  n_glyphs = binary_read_count (self, 5);
+  if (self->failed)
+    return NULL;
+
+  if (self->fonts[font_index] == NULL)
+    {
+      self->fonts[font_index] = font_from_string (font_name);
+      if (self->fonts[font_index] == NULL)
+        {
+          binary_reader_error (self, "Font \"%s\" does not exist", font_name);
+          return NULL;
+        }
+    }
+
+  glyphs = pango_glyph_string_new ();
+  pango_glyph_string_set_size (glyphs, n_glyphs);
+  for (i = 0; i < n_glyphs; i++)
+    {
+      guint32 flags;
+
+      glyphs->glyphs[i].glyph = binary_read_u32 (self);
+      glyphs->glyphs[i].geometry.width = (gint32) binary_read_u32 (self);
+      glyphs->glyphs[i].geometry.x_offset = (gint32) binary_read_u32 (self);
+      glyphs->glyphs[i].geometry.y_offset = (gint32) binary_read_u32 (self);
+      flags = binary_read_u32 (self);
+      glyphs->glyphs[i].attr.is_cluster_start = (flags & 1) ? 1 : 0;
+      glyphs->glyphs[i].attr.is_color = (flags & 2) ? 1 : 0;
+    }
+
+  node = gsk_text_node_new (self->fonts[font_index], glyphs, &color, &offset);
+  pango_glyph_string_free (glyphs);
+
+  if (node == NULL)
+    binary_reader_error (self, "Glyphs result in empty text");
+
+  return node;
+}
+
+static GskRenderNode *
+binary_read_gl_shader_node (BinaryReader *self)
+{
+  GskRenderNode *children[4];
+  graphene_rect_t bounds;
+  const char *source;
+  GskGLShader *shader;
+  GskRenderNode *node;
+  GBytes *args;
+  guint32 i, n_children, source_index;
+
+  binary_read_rect (self, &bounds);
+  source = binary_read_string (self, &source_index, FALSE);
+  args = binary_read_blob (self, FALSE);
+  n_children = binary_read_u32 (self);
+  if (n_children > G_N_ELEMENTS (children))
+    binary_reader_error (self, "Too many children for a GL shader node: %u", n_children);
+  for (i = 0; i < n_children && !self->failed; i++)
+    children[i] = binary_read_node_ref (self);
+  if (self->failed)
+    {
+      g_clear_pointer (&args, g_bytes_unref);
+      return NULL;
+    }
+
+  if (self->shaders[source_index] == NULL)
+    {
+      GBytes *bytes = g_bytes_new (source, strlen (source));
+      self->shaders[source_index] = gsk_gl_shader_new_from_bytes (bytes);
+      g_bytes_unref (bytes);
+    }
+  shader = self->shaders[source_index];
+
+  if (g_bytes_get_size (args) != gsk_gl_shader_get_args_size (shader) ||
+      (n_children > 0 && n_children != gsk_gl_shader_get_n_textures (shader)))
+    {
+      binary_reader_error (self, "Arguments do not match the GL shader");
+      g_bytes_unref (args);
+      return NULL;
+    }
+
+  node = gsk_gl_shader_node_new (shader, &bounds, args, n_children > 0 ? children : NULL, n_children);
+  g_bytes_unref (args);
+
+  return node;
+}
+
+static GskRenderNode *
+binary_read_node_data (BinaryReader      *self,
+                       GskRenderNodeType  type)
+{
+  switch (type)
+    {
+    case GSK_CONTAINER_NODE:
+      {
+        GskRenderNode **children;
+        GskRenderNode *node;
+        guint32 i, n_children;
+
+        n_children = binary_read_count (self, 1);
+        children = g_new (GskRenderNode *, n_children);
+        for (i = 0; i < n_children; i++)
+          children[i] = binary_read_node_ref (self);
+
+        node = self->failed ? NULL : gsk_container_node_new (children, n_children);
+        g_free (children);
+
+        return node;
+      }
+
+    case GSK_CAIRO_NODE:
+      return binary_read_cairo_node (self);
+
+    case GSK_COLOR_NODE:
+      {
+        graphene_rect_t bounds;
+        GdkRGBA color;
+
+        binary_read_rect (self, &bounds);
+        binary_read_rgba (self, &color);
+        if (self->failed)
+          return NULL;
+
+        return gsk_color_node_new (&color, &bounds);
+      }
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      {
+        graphene_rect_t bounds;
+        graphene_point_t start, end;
+        GskColorStop *stops;
+        GskRenderNode *node;
+        gsize n_stops;
+
+        binary_read_rect (self, &bounds);
+        binary_read_point (self, &start);
+        binary_read_point (self, &end);
+        stops = binary_read_stops (self, &n_stops);
+        if (self->failed)
+          return NULL;
+
+        if (type == GSK_REPEATING_LINEAR_GRADIENT_NODE)
+          node = gsk_repeating_linear_gradient_node_new (&bounds, &start, &end, stops, n_stops);
+        else
+          node = gsk_linear_gradient_node_new (&bounds, &start, &end, stops, n_stops);
+        g_free (stops);
+
+        return node;
+      }
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      {
+        graphene_rect_t bounds;
+        graphene_point_t center;
+        float hradius, vradius, start, end;
+        GskColorStop *stops;
+        GskRenderNode *node;
+        gsize n_stops;
+
+        binary_read_rect (self, &bounds);
+        binary_read_point (self, &center);
+        hradius = binary_read_float (self);
+        vradius = binary_read_float (self);
+        start = binary_read_float (self);
+        end = binary_read_float (self);
+        if (!self->failed && !(hradius > 0 && vradius > 0 && start >= 0 && end > start))
+          binary_reader_error (self, "Invalid radial gradient");
+        stops = binary_read_stops (self, &n_stops);
+        if (self->failed)
+          return NULL;
+
+        if (type == GSK_REPEATING_RADIAL_GRADIENT_NODE)
+          node = gsk_repeating_radial_gradient_node_new (&bounds, &center, hradius, vradius, start, end, stops, n_stops);
+        else
+          node = gsk_radial_gradient_node_new (&bounds, &center, hradius, vradius, start, end, stops, n_stops);
+        g_free (stops);
+
+        return node;
+      }
+
+    case GSK_CONIC_GRADIENT_NODE:
+      {
+        graphene_rect_t bounds;
+        graphene_point_t center;
+        GskColorStop *stops;
+        GskRenderNode *node;
+        gsize n_stops;
+        float rotation;
+
+        binary_read_rect (self, &bounds);
+        binary_read_point (self, &center);
+        rotation = binary_read_float (self);
+        stops = binary_read_stops (self, &n_stops);
+        if (self->failed)
+          return NULL;
+
+        node = gsk_conic_gradient_node_new (&bounds, &center, rotation, stops, n_stops);
+        g_free (stops);
+
+        return node;
+      }
+
+    case GSK_BORDER_NODE:
+      {
+        GskRoundedRect outline;
+        float widths[4];
+        GdkRGBA colors[4];
+        guint i;
+
+        binary_read_rounded_rect (self, &outline);
+        for (i = 0; i < 4; i++)
+          widths[i] = binary_read_float (self);
+        for (i = 0; i < 4; i++)
+          binary_read_rgba (self, &colors[i]);
+        if (self->failed)
+          return NULL;
+
+        return gsk_border_node_new (&outline, widths, colors);
+      }
+
+    case GSK_TEXTURE_NODE:
+      {
+        graphene_rect_t bounds;
+        GdkTexture *texture;
+
+        binary_read_rect (self, &bounds);
+        texture = binary_read_texture (self, FALSE);
+        if (self->failed)
+          return NULL;
+
+        return gsk_texture_node_new (texture, &bounds);
+      }
+
+    case GSK_TEXTURE_SCALE_NODE:
+      {
+        graphene_rect_t bounds;
+        GdkTexture *texture;
+        GskScalingFilter filter;
+
+        binary_read_rect (self, &bounds);
+        texture = binary_read_texture (self, FALSE);
+        filter = binary_read_enum (self, GSK_SCALING_FILTER_TRILINEAR + 1, "scaling filter");
+        if (self->failed)
+          return NULL;
+
+        return gsk_texture_scale_node_new (texture, &bounds, filter);
+      }
+
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+      {
+        GskRoundedRect outline;
+        GdkRGBA color;
+        float dx, dy, spread, blur;
+
+        binary_read_rounded_rect (self, &outline);
+        binary_read_rgba (self, &color);
+        dx = binary_read_float (self);
+        dy = binary_read_float (self);
+        spread = binary_read_float (self);
+        blur = binary_read_float (self);
+        if (!self->failed && !(blur >= 0))
+          binary_reader_error (self, "Invalid blur radius");
+        if (self->failed)
+          return NULL;
+
+        if (type == GSK_INSET_SHADOW_NODE)
+          return gsk_inset_shadow_node_new (&outline, &color, dx, dy, spread, blur);
+        else
+          return gsk_outset_shadow_node_new (&outline, &color, dx, dy, spread, blur);
+      }
+
+    case GSK_TRANSFORM_NODE:
+      {
+        GskTransform *transform = NULL;
+        GskRenderNode *child, *node;
+        const char *string;
+
+        string = binary_read_string (self, NULL, FALSE);
+        child = binary_read_node_ref (self);
+        if (self->failed)
+          return NULL;
+
+        if (!gsk_transform_parse (string, &transform))
+          {
+            binary_reader_error (self, "Invalid transform \"%s\"", string);
+            return NULL;
+          }
+        if (transform == NULL)
+          transform = gsk_transform_new ();
+
+        node = gsk_transform_node_new (child, transform);
+        gsk_transform_unref (transform);
+
+        return node;
+      }
+
+    case GSK_OPACITY_NODE:
+      {
+        GskRenderNode *child;
+        float opacity;
+
+        opacity = binary_read_float (self);
+        child = binary_read_node_ref (self);
+        if (self->failed)
+          return NULL;
+
+        return gsk_opacity_node_new (child, opacity);
+      }
+
+    case GSK_COLOR_MATRIX_NODE:
+      {
+        graphene_matrix_t matrix;
+        graphene_vec4_t offset;
+        GskRenderNode *child;
+        float values[16];
+        guint i;
+
+        for (i = 0; i < 16; i++)
+          values[i] = binary_read_float (self);
+        graphene_matrix_init_from_float (&matrix, values);
+        for (i = 0; i < 4; i++)
+          values[i] = binary_read_float (self);
+        graphene_vec4_init_from_float (&offset, values);
+        child = binary_read_node_ref (self);
+        if (self->failed)
+          return NULL;
+
+        return gsk_color_matrix_node_new (child, &matrix, &offset);
+      }
+
+    case GSK_REPEAT_NODE:
+      {
+        graphene_rect_t bounds, child_bounds;
+        GskRenderNode *child;
+
+        binary_read_rect (self, &bounds);
+        binary_read_rect (self, &child_bounds);
+        child = binary_read_node_ref (self);
+        if (self->failed)
+          return NULL;
+
+        return gsk_repeat_node_new (&bounds, child, &child_bounds);
+      }
+
+    case GSK_CLIP_NODE:
+      {
+        graphene_rect_t clip;
+        GskRenderNode *child;
+
+        binary_read_rect (self, &clip);
+        child = binary_read_node_ref (self);
+        if (self->failed)
+          return NULL;
+
+        return gsk_clip_node_new (child, &clip);
+      }
+
+    case GSK_ROUNDED_CLIP_NODE:
+      {
+        GskRoundedRect clip;
+        GskRenderNode *child;
+
+        binary_read_rounded_rect (self, &clip);
+        child = binary_read_node_ref (self);
+        if (self->failed)
+          return NULL;
+
+        return gsk_rounded_clip_node_new (child, &clip);
+      }
+
+    case GSK_SHADOW_NODE:
+      {
+        GskRenderNode *child, *node;
+        GskShadow *shadows;
+        guint32 i, n_shadows;
+
+        n_shadows = binary_read_count (self, 7);
+        if (!self->failed && n_shadows == 0)
+          binary_reader_error (self, "Shadow nodes need at least one shadow");
+        if (self->failed)
+          return NULL;
+
+        shadows = g_new (GskShadow, n_shadows);
+        for (i = 0; i < n_shadows; i++)
+          {
+            binary_read_rgba (self, &shadows[i].color);
+            shadows[i].dx = binary_read_float (self);
+            shadows[i].dy = binary_read_float (self);
+            shadows[i].radius = binary_read_float (self);
+          }
+        child = binary_read_node_ref (self);
+
+        node = self->failed ? NULL : gsk_shadow_node_new (child, shadows, n_shadows);
+        g_free (shadows);
+
+        return node;
+      }
+
+    case GSK_BLEND_NODE:
+      {
+        GskRenderNode *bottom, *top;
+        GskBlendMode mode;
+
+        mode = binary_read_enum (self, GSK_BLEND_MODE_LUMINOSITY + 1, "blend mode");
+        bottom = binary_read_node_ref (self);
+        top = binary_read_node_ref (self);
+        if (self->failed)
+          return NULL;
+
+        return gsk_blend_node_new (bottom, top, mode);
+      }
+
+    case GSK_MASK_NODE:
+      {
+        GskRenderNode *source, *mask;
+        GskMaskMode mode;
+
+        mode = binary_read_enum (self, GSK_MASK_MODE_INVERTED_LUMINANCE + 1, "mask mode");
+        source = binary_read_node_ref (self);
+        mask = binary_read_node_ref (self);
+        if (self->failed)
+          return NULL;
+
+        return gsk_mask_node_new (source, mask, mode);
+      }
+
+    case GSK_CROSS_FADE_NODE:
+      {
+        GskRenderNode *start, *end;
+        float progress;
+
+        progress = binary_read_float (self);
+        start = binary_read_node_ref (self);
+        end = binary_read_node_ref (self);
+        if (self->failed)
+          return NULL;
+
+        return gsk_cross_fade_node_new (start, end, progress);
+      }
+
+    case GSK_TEXT_NODE:
+      return binary_read_text_node (self);
+
+    case GSK_BLUR_NODE:
+      {
+        GskRenderNode *child;
+        float radius;
+
+        radius = binary_read_float (self);
+        child = binary_read_node_ref (self);
+        if (!self->failed && !(radius >= 0))
+          binary_reader_error (self, "Invalid blur radius");
+        if (self->failed)
+          return NULL;
+
+        return gsk_blur_node_new (child, radius);
+      }
+
+    case GSK_DEBUG_NODE:
+      {
+        GskRenderNode *child;
+        const char *message;
+
+        message = binary_read_string (self, NULL, TRUE);
+        child = binary_read_node_ref (self);
+        if (self->failed)
+          return NULL;
+
+        return gsk_debug_node_new (child, g_strdup (message));
+      }
+
+    case GSK_GL_SHADER_NODE:
+      return binary_read_gl_shader_node (self);
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      binary_reader_error (self, "Unknown node type %u", type);
+      return NULL;
+    }
+}
+
+static gboolean
+binary_reader_load_tables (BinaryReader *self)
+{
+  guint i;
+
+  if (self->size < sizeof (BinaryHeader))
+    {
+      binary_reader_error (self, "File is too short");
+      return FALSE;
+    }
+
+  memcpy (&self->header, self->data, sizeof (BinaryHeader));
+
+  if (self->header.byte_order != BINARY_BYTE_ORDER)
+    {
+      binary_reader_error (self, "File was created on a machine with a different byte order");
+      return FALSE;
+    }
+
+  if (self->header.version != BINARY_VERSION)
+    {
+      binary_reader_error (self, "Unsupported version %u", self->header.version);
+      return FALSE;
+    }
+
+  if (self->header.n_nodes == 0 ||
+      !binary_reader_check_range (self, self->header.blobs_offset, (guint64) self->header.n_blobs * sizeof (BinaryBlob)) ||
+      !binary_reader_check_range (self, self->header.textures_offset, (guint64) self->header.n_textures * sizeof (BinaryTexture)) ||
+      !binary_reader_check_range (self, self->header.nodes_offset, self->header.nodes_size))
+    {
+      binary_reader_error (self, "Invalid header");
+      return FALSE;
+    }
+
+  for (i = 0; i < self->header.n_blobs; i++)
+    {
+      BinaryBlob blob;
+
+      memcpy (&blob, self->data + self->header.blobs_offset + i * sizeof (BinaryBlob), sizeof (BinaryBlob));
+      if (!binary_reader_check_range (self, blob.offset, blob.size) ||
+          blob.offset + blob.size == self->size ||
+          self->data[blob.offset + blob.size] != 0)
+        {
+          binary_reader_error (self, "Invalid blob %u", i);
+          return FALSE;
+        }
+    }
+
+  self->fonts = g_new0 (PangoFont *, self->header.n_blobs);
+  self->shaders = g_new0 (GskGLShader *, self->header.n_blobs);
+  self->textures = g_new0 (GdkTexture *, self->header.n_textures);
+
+  for (i = 0; i < self->header.n_textures; i++)
+    {
+      BinaryTexture texture;
+      GBytes *pixels;
+
+      memcpy (&texture, self->data + self->header.textures_offset + i * sizeof (BinaryTexture), sizeof (BinaryTexture));
+      if (texture.width == 0 || texture.width > G_MAXINT ||
+          texture.height == 0 || texture.height > G_MAXINT ||
+          texture.format >= GDK_MEMORY_N_FORMATS ||
+          texture.stride / gdk_memory_format_bytes_per_pixel (texture.format) < texture.width ||
+          texture.stride > G_MAXUINT64 / texture.height ||
+          !binary_reader_check_range (self, texture.offset, texture.stride * texture.height))
+        {
+          binary_reader_error (self, "Invalid texture %u", i);
+          return FALSE;
+        }
+
+      /* This does not copy, so textures point straight into the file */
+      pixels = g_bytes_new_from_bytes (self->bytes, texture.offset, texture.stride * texture.height);
+      self->textures[i] = gdk_memory_texture_new (texture.width,
+                                                  texture.height,
+                                                  texture.format,
+                                                  pixels,
+                                                  texture.stride);
+      g_bytes_unref (pixels);
+    }
+
+  return TRUE;
+}
+
+static GskRenderNode *
+gsk_render_node_deserialize_binary (GBytes            *bytes,
+                                    GskParseErrorFunc  error_func,
+                                    gpointer           user_data)
+{
+  BinaryReader reader = { 0, };
+  const guchar *records, *records_end;
+  GskRenderNode *result = NULL;
+  guint i;
+
+  reader.bytes = bytes;
+  reader.data = g_bytes_get_data (bytes, &reader.size);
+  reader.error_func = error_func;
+  reader.user_data = user_data;
+
+  if (!binary_reader_load_tables (&reader))
+    goto out;
+
+  reader.nodes = g_new0 (GskRenderNode *, reader.header.n_nodes);
+  records = reader.data + reader.header.nodes_offset;
+  records_end = records + reader.header.nodes_size;
+
+  for (i = 0; i < reader.header.n_nodes; i++)
+    {
+      guint32 header[2];
+
+      reader.pos = records;
+      reader.end = records_end;
+
+      if ((gsize) (records_end - records) < sizeof (header))
+        {
+          binary_reader_error (&reader, "Unexpected end of node data");
+          goto out;
+        }
+
+      memcpy (header, records, sizeof (header));
+      records += sizeof (header);
+      if ((gsize) (records_end - records) / sizeof (guint32) < header[1])
+        {
+          binary_reader_error (&reader, "Unexpected end of node data");
+          goto out;
+        }
+
+      reader.pos = records;
+      reader.end = records + header[1] * sizeof (guint32);
+
+      reader.nodes[i] = binary_read_node_data (&reader, header[0]);
+      if (reader.nodes[i] == NULL)
+        {
+          binary_reader_error (&reader, "Invalid node data");
+          goto out;
+        }
+      reader.n_nodes++;
+
+      if (reader.pos != reader.end)
+        {
+          binary_reader_error (&reader, "Unexpected data at end of node");
+          goto out;
+        }
+
+      records = reader.end;
+    }
+
+  result = gsk_render_node_ref (reader.nodes[reader.n_nodes - 1]);
+
+out:
+  for (i = 0; i < reader.n_nodes; i++)
+    gsk_render_node_unref (reader.nodes[i]);
+  g_free (reader.nodes);
+
+  for (i = 0; i < reader.header.n_textures && reader.textures; i++)
+    g_clear_object (&reader.textures[i]);
+  g_free (reader.textures);
+
+  for (i = 0; i < reader.header.n_blobs && reader.fonts; i++)
+    {
+      g_clear_object (&reader.fonts[i]);
+      g_clear_object (&reader.shaders[i]);
+    }
+  g_free (reader.fonts);
+  g_free (reader.shaders);
+
+  return result;
+}
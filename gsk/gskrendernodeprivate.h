@@ -5,6 +5,8 @@
 
 #include "gdk/gdkmemoryformatprivate.h"
 
+#include <string.h>
+
 G_BEGIN_DECLS
 
 typedef struct _GskRenderNodeClass GskRenderNodeClass;
@@ -31,6 +33,12 @@ struct _GskRenderNode
 
   guint preferred_depth : 2;
   guint offscreen_for_opacity : 1;
+
+  /* cached by the cairo renderer, 0 until computed */
+  guint cairo_threaded : 2;
+  guint cairo_has_textures : 1;
+
+  guint hash; /* (atomic), 0 until computed, see gsk_render_node_get_hash() */
 };
 
 struct _GskRenderNodeClass
@@ -47,6 +55,7 @@ struct _GskRenderNodeClass
   void            (* diff)        (GskRenderNode  *node1,
                                    GskRenderNode  *node2,
                                    cairo_region_t *region);
+  guint           (* hash)        (const GskRenderNode  *node);
 };
 
 void            gsk_render_node_init_types              (void);
@@ -62,6 +71,30 @@ gboolean        gsk_render_node_can_diff                (const GskRenderNode
 void            gsk_render_node_diff                    (GskRenderNode               *node1,
                                                          GskRenderNode               *node2,
                                                          cairo_region_t              *region);
+guint           gsk_render_node_get_hash                (const GskRenderNode         *node);
+/* Helpers for computing hashes, see gsk_render_node_get_hash() */
+static inline guint
+gsk_hash_combine (guint hash,
+                  guint value)
+{
+  return (hash << 5) - hash + value;
+}
+
+/* Hashes the value of @f, so that 0.0 and -0.0 hash the same */
+static inline guint
+gsk_hash_float (guint hash,
+                float f)
+{
+  guint32 bits;
+
+  if (f == 0.f)
+    return gsk_hash_combine (hash, 0);
+
+  memcpy (&bits, &f, sizeof (bits));
+
+  return gsk_hash_combine (hash, bits);
+}
+
 void            gsk_render_node_diff_impossible         (GskRenderNode               *node1,
                                                          GskRenderNode               *node2,
                                                          cairo_region_t              *region);
@@ -84,9 +117,15 @@ void            gsk_transform_node_get_translate        (const GskRenderNode
 GdkMemoryDepth  gsk_render_node_get_preferred_depth     (const GskRenderNode         *node);
 
 gboolean        gsk_container_node_is_disjoint          (const GskRenderNode         *node);
+GArray *        gsk_container_node_query                (const GskRenderNode         *node,
+                                                         const graphene_rect_t       *rect);
 
 gboolean        gsk_render_node_use_offscreen_for_opacity (const GskRenderNode       *node);
 
+void            gsk_render_node_draw_with_surfaces      (GskRenderNode               *node,
+                                                         cairo_t                     *cr,
+                                                         GHashTable                  *surfaces);
+
 
 G_END_DECLS
 
@@ -383,6 +383,25 @@ gsk_vulkan_render_pass_add_container_node (GskVulkanRenderPass       *self,
                                            const GskVulkanParseState *state,
                                            GskRenderNode             *node)
 {
+  GArray *indices;
+  graphene_rect_t clip;
+
+  /* Only look at the children that can be visible */
+  clip = state->clip.rect.bounds;
+  clip.origin.x -= state->offset.x;
+  clip.origin.y -= state->offset.y;
+
+  indices = gsk_container_node_query (node, &clip);
+  if (indices)
+    {
+      for (guint i = 0; i < indices->len; i++)
+        gsk_vulkan_render_pass_add_node (self, render, state,
+                                         gsk_container_node_get_child (node, g_array_index (indices, guint, i)));
+
+      g_array_unref (indices);
+      return TRUE;
+    }
+
   for (guint i = 0; i < gsk_container_node_get_n_children (node); i++)
     gsk_vulkan_render_pass_add_node (self, render, state, gsk_container_node_get_child (node, i));
 
@@ -145,10 +145,14 @@ gtk_style_context_pop_style_node (GtkStyleContext *context)
 }
 
 static void
-gtk_style_context_cascade_changed (GtkStyleCascade *cascade,
-                                   GtkStyleContext *context)
+gtk_style_context_cascade_changed (GtkStyleCascade          *cascade,
+                                   const GtkCssSelectorTree *rules,
+                                   GtkStyleContext          *context)
 {
-  gtk_css_node_invalidate_style_provider (gtk_style_context_get_root (context));
+  if (rules)
+    gtk_css_node_invalidate_style_provider_rules (gtk_style_context_get_root (context), rules);
+  else
+    gtk_css_node_invalidate_style_provider (gtk_style_context_get_root (context));
 }
 
 static void
@@ -179,7 +183,7 @@ gtk_style_context_set_cascade (GtkStyleContext *context,
   priv->cascade = cascade;
 
   if (cascade && priv->cssnode != NULL)
-    gtk_style_context_cascade_changed (cascade, context);
+    gtk_style_context_cascade_changed (cascade, NULL, context);
 }
 
 static void
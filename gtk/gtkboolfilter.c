@@ -21,6 +21,7 @@
 
 #include "gtkboolfilter.h"
 
+#include "gtkexpressionprivate.h"
 #include "gtktypebuiltins.h"
 
 /**
@@ -81,6 +82,14 @@ gtk_bool_filter_get_strictness (GtkFilter *filter)
   return GTK_FILTER_MATCH_SOME;
 }
 
+static gboolean
+gtk_bool_filter_is_thread_safe (GtkFilter *filter)
+{
+  GtkBoolFilter *self = GTK_BOOL_FILTER (filter);
+
+  return gtk_expression_is_thread_safe (self->expression);
+}
+
 static void
 gtk_bool_filter_set_property (GObject      *object,
                               guint         prop_id,
@@ -147,6 +156,7 @@ gtk_bool_filter_class_init (GtkBoolFilterClass *class)
 
   filter_class->match = gtk_bool_filter_match;
   filter_class->get_strictness = gtk_bool_filter_get_strictness;
+  filter_class->is_thread_safe = gtk_bool_filter_is_thread_safe;
 
   object_class->get_property = gtk_bool_filter_get_property;
   object_class->set_property = gtk_bool_filter_set_property;
@@ -19,6 +19,7 @@
 
 #include "gtkcssnodeprivate.h"
 
+#include "gtkcssselectorprivate.h"
 #include "gtkcssstaticstyleprivate.h"
 #include "gtkcssanimatedstyleprivate.h"
 #include "gtkcssstylepropertyprivate.h"
@@ -123,8 +124,14 @@ gtk_css_node_get_style_provider_or_null (GtkCssNode *cssnode)
 
 static int invalidated_nodes;
 static int created_styles;
+static int shared_styles;
 static guint invalidated_nodes_counter;
 static guint created_styles_counter;
+static guint shared_styles_counter;
+
+/* Totals for the inspector */
+static guint64 style_cache_hits;
+static guint64 style_cache_misses;
 
 static void
 gtk_css_node_set_invalid (GtkCssNode *node,
@@ -368,9 +375,14 @@ gtk_css_node_create_style (GtkCssNode                   *cssnode,
 
   style = lookup_in_global_parent_cache (cssnode, decl);
   if (style)
-    return g_object_ref (style);
+    {
+      shared_styles++;
+      style_cache_hits++;
+      return g_object_ref (style);
+    }
 
   created_styles++;
+  style_cache_misses++;
 
   if (change & GTK_CSS_CHANGE_NEEDS_RECOMPUTE)
     {
@@ -439,9 +451,12 @@ gtk_css_node_real_update_style (GtkCssNode                   *cssnode,
                                               gtk_css_node_get_style_provider (cssnode),
                                               should_create_transitions (change) ? style : NULL);
 
-      /* Clear the cache again, the static style we looked up above
-       * may have populated it. */
-      g_clear_pointer (&cssnode->cache, gtk_css_node_style_cache_unref);
+      /* The cache entry we looked up or created above is for the
+       * static style. Keep it if that is what we use, so children can
+       * share styles with the children of other nodes using the same
+       * entry, but clear it if we are animating. */
+      if (new_style != new_static_style)
+        g_clear_pointer (&cssnode->cache, gtk_css_node_style_cache_unref);
     }
   else if (static_style != style && (change & GTK_CSS_CHANGE_TIMESTAMP))
     {
@@ -605,6 +620,7 @@ gtk_css_node_class_init (GtkCssNodeClass *klass)
     {
       invalidated_nodes_counter = gdk_profiler_define_int_counter ("invalidated-nodes", "CSS Node Invalidations");
       created_styles_counter = gdk_profiler_define_int_counter ("created-styles", "CSS Style Creations");
+      shared_styles_counter = gdk_profiler_define_int_counter ("shared-styles", "CSS Style Cache Hits");
     }
 }
 
@@ -1258,6 +1274,32 @@ gtk_css_node_invalidate_style_provider (GtkCssNode *cssnode)
     }
 }
 
+/* Like gtk_css_node_invalidate_style_provider(), but only the given
+ * rules of the provider changed, so only nodes that can match them
+ * need a new style.
+ */
+void
+gtk_css_node_invalidate_style_provider_rules (GtkCssNode               *cssnode,
+                                              const GtkCssSelectorTree *rules)
+{
+  GtkCssNode *child;
+
+  /* Cached styles for nodes we don't invalidate are still correct,
+   * but other nodes looking them up might not be, so drop them all */
+  g_clear_pointer (&cssnode->cache, gtk_css_node_style_cache_unref);
+
+  if (gtk_css_selector_tree_may_match (rules, cssnode))
+    gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_SOURCE);
+
+  for (child = cssnode->first_child;
+       child;
+       child = child->next_sibling)
+    {
+      if (gtk_css_node_get_style_provider_or_null (child) == NULL)
+        gtk_css_node_invalidate_style_provider_rules (child, rules);
+    }
+}
+
 static void
 gtk_css_node_invalidate_timestamp (GtkCssNode *cssnode)
 {
@@ -1366,8 +1408,10 @@ gtk_css_node_validate (GtkCssNode *cssnode)
       gdk_profiler_end_mark (before,  "css validation", "");
       gdk_profiler_set_int_counter (invalidated_nodes_counter, invalidated_nodes);
       gdk_profiler_set_int_counter (created_styles_counter, created_styles);
+      gdk_profiler_set_int_counter (shared_styles_counter, shared_styles);
       invalidated_nodes = 0;
       created_styles = 0;
+      shared_styles = 0;
     }
 }
 
@@ -1454,3 +1498,11 @@ gtk_css_node_observe_children (GtkCssNode *cssnode)
   return G_LIST_MODEL (cssnode->children_observer);
 }
 
+/* Exported privately for use in GtkInspector */
+void
+gtk_css_node_get_style_cache_statistics (guint64 *hits,
+                                         guint64 *misses)
+{
+  *hits = style_cache_hits;
+  *misses = style_cache_misses;
+}
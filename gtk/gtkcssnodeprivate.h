@@ -144,6 +144,9 @@ GtkCssStyle *           gtk_css_node_get_style          (GtkCssNode            *
 
 void                    gtk_css_node_invalidate_style_provider
                                                         (GtkCssNode            *cssnode);
+void                    gtk_css_node_invalidate_style_provider_rules
+                                                        (GtkCssNode            *cssnode,
+                                                         const GtkCssSelectorTree *rules);
 void                    gtk_css_node_invalidate_frame_clock
                                                         (GtkCssNode            *cssnode,
                                                          gboolean               just_timestamp);
@@ -167,5 +170,9 @@ void                    gtk_css_node_print              (GtkCssNode           *c
 
 GListModel *            gtk_css_node_observe_children   (GtkCssNode                *cssnode);
 
+void                    gtk_css_node_get_style_cache_statistics
+                                                        (guint64                   *hits,
+                                                         guint64                   *misses);
+
 G_END_DECLS
 
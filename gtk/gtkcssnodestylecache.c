@@ -26,6 +26,7 @@ struct _GtkCssNodeStyleCache {
   guint        ref_count;
   GtkCssStyle *style;
   GHashTable  *children;
+  guint        shared : 1; /* stored in a parent cache, so used by unrelated nodes */
 };
 
 #define UNPACK_DECLARATION(packed) ((GtkCssNodeDeclaration *) (GPOINTER_TO_SIZE (packed) & ~0x3))
@@ -75,7 +76,8 @@ gtk_css_node_style_cache_get_style (GtkCssNodeStyleCache *cache)
 }
 
 static gboolean
-may_be_stored_in_cache (GtkCssStyle *style)
+may_be_stored_in_cache (GtkCssNodeStyleCache *parent,
+                        GtkCssStyle          *style)
 {
   GtkCssChange change;
 
@@ -108,6 +110,17 @@ may_be_stored_in_cache (GtkCssStyle *style)
   if (change & (GTK_CSS_CHANGE_NTH_CHILD | GTK_CSS_CHANGE_NTH_LAST_CHILD))
     return FALSE;
 
+  /* If the parent cache is shared, it is reached from all nodes with
+   * the same declarations and first/last child state along the path
+   * from the node owning the topmost cache, which may still differ
+   * in the position or siblings of their ancestors.
+   */
+  if (parent->shared &&
+      (change & (GTK_CSS_CHANGE_PARENT_NTH_CHILD |
+                 GTK_CSS_CHANGE_PARENT_NTH_LAST_CHILD |
+                 GTK_CSS_CHANGE_ANY_PARENT_SIBLING)))
+    return FALSE;
+
   return TRUE;
 }
 
@@ -144,7 +157,7 @@ gtk_css_node_style_cache_insert (GtkCssNodeStyleCache   *parent,
 {
   GtkCssNodeStyleCache *result;
 
-  if (!may_be_stored_in_cache (style))
+  if (!may_be_stored_in_cache (parent, style))
     return NULL;
 
   if (parent->children == NULL)
@@ -154,6 +167,7 @@ gtk_css_node_style_cache_insert (GtkCssNodeStyleCache   *parent,
                                               (GDestroyNotify) gtk_css_node_style_cache_unref);
 
   result = gtk_css_node_style_cache_new (style);
+  result->shared = TRUE;
 
   g_hash_table_insert (parent->children,
                        PACK (gtk_css_node_declaration_ref (decl), is_first, is_last),
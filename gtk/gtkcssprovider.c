@@ -95,6 +95,7 @@ struct _GtkCssProviderClass
 };
 
 typedef struct GtkCssRuleset GtkCssRuleset;
+typedef struct _GtkCssStylesheet GtkCssStylesheet;
 typedef struct _GtkCssScanner GtkCssScanner;
 typedef struct _PropertyValue PropertyValue;
 typedef enum ParserScope ParserScope;
@@ -115,6 +116,23 @@ struct GtkCssRuleset
   guint owns_styles : 1;
 };
 
+/* The result of parsing a toplevel stylesheet and everything it
+ * imports. Once built, it is never modified, so a reload can diff
+ * it against its replacement.
+ */
+struct _GtkCssStylesheet
+{
+  int ref_count;
+
+  GHashTable *symbolic_colors;
+  GHashTable *keyframes;
+
+  GArray *rulesets;
+  GtkCssSelectorTree *tree;
+
+  guint has_selectors : 1;  /* rulesets keep their selector for diffing */
+};
+
 struct _GtkCssScanner
 {
   GtkCssProvider *provider;
@@ -126,13 +144,12 @@ struct _GtkCssProviderPrivate
 {
   GScanner *scanner;
 
-  GHashTable *symbolic_colors;
-  GHashTable *keyframes;
+  GtkCssStylesheet *sheet;
 
-  GArray *rulesets;
-  GtkCssSelectorTree *tree;
   GResource *resource;
   char *path;
+
+  guint incremental_reload : 1;
 };
 
 enum {
@@ -155,6 +172,8 @@ gtk_css_provider_load_internal (GtkCssProvider *css_provider,
                                 GtkCssScanner  *scanner,
                                 GFile          *file,
                                 GBytes         *bytes);
+static void gtk_css_provider_print_keyframes (GHashTable *keyframes,
+                                              GString    *str);
 
 G_DEFINE_TYPE_EXTENDED (GtkCssProvider, gtk_css_provider, G_TYPE_OBJECT, 0,
                         G_ADD_PRIVATE (GtkCssProvider)
@@ -315,6 +334,53 @@ gtk_css_ruleset_add (GtkCssRuleset       *ruleset,
     ruleset->styles[i].section = NULL;
 }
 
+static GtkCssStylesheet *
+gtk_css_stylesheet_new (void)
+{
+  GtkCssStylesheet *sheet;
+
+  sheet = g_new0 (GtkCssStylesheet, 1);
+  sheet->ref_count = 1;
+
+  sheet->rulesets = g_array_new (FALSE, FALSE, sizeof (GtkCssRuleset));
+  sheet->symbolic_colors = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                  (GDestroyNotify) g_free,
+                                                  (GDestroyNotify) _gtk_css_value_unref);
+  sheet->keyframes = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                            (GDestroyNotify) g_free,
+                                            (GDestroyNotify) _gtk_css_keyframes_unref);
+
+  return sheet;
+}
+
+static GtkCssStylesheet *
+gtk_css_stylesheet_ref (GtkCssStylesheet *sheet)
+{
+  sheet->ref_count++;
+
+  return sheet;
+}
+
+static void
+gtk_css_stylesheet_unref (GtkCssStylesheet *sheet)
+{
+  guint i;
+
+  sheet->ref_count--;
+  if (sheet->ref_count > 0)
+    return;
+
+  for (i = 0; i < sheet->rulesets->len; i++)
+    gtk_css_ruleset_clear (&g_array_index (sheet->rulesets, GtkCssRuleset, i));
+  g_array_free (sheet->rulesets, TRUE);
+  _gtk_css_selector_tree_free (sheet->tree);
+
+  g_hash_table_destroy (sheet->symbolic_colors);
+  g_hash_table_destroy (sheet->keyframes);
+
+  g_free (sheet);
+}
+
 static void
 gtk_css_scanner_destroy (GtkCssScanner *scanner)
 {
@@ -395,14 +461,7 @@ gtk_css_provider_init (GtkCssProvider *css_provider)
 {
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
 
-  priv->rulesets = g_array_new (FALSE, FALSE, sizeof (GtkCssRuleset));
-
-  priv->symbolic_colors = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                                 (GDestroyNotify) g_free,
-                                                 (GDestroyNotify) _gtk_css_value_unref);
-  priv->keyframes = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                           (GDestroyNotify) g_free,
-                                           (GDestroyNotify) _gtk_css_keyframes_unref);
+  priv->sheet = gtk_css_stylesheet_new ();
 }
 
 static void
@@ -416,11 +475,11 @@ verify_tree_match_results (GtkCssProvider        *provider,
   gboolean should_match;
   int i, j;
 
-  for (i = 0; i < priv->rulesets->len; i++)
+  for (i = 0; i < priv->sheet->rulesets->len; i++)
     {
       gboolean found = FALSE;
 
-      ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+      ruleset = &g_array_index (priv->sheet->rulesets, GtkCssRuleset, i);
 
       for (j = 0; j < gtk_css_selector_matches_get_size (tree_rules); j++)
 	{
@@ -449,7 +508,7 @@ gtk_css_style_provider_get_color (GtkStyleProvider *provider,
   GtkCssProvider *css_provider = GTK_CSS_PROVIDER (provider);
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
 
-  return g_hash_table_lookup (priv->symbolic_colors, name);
+  return g_hash_table_lookup (priv->sheet->symbolic_colors, name);
 }
 
 static GtkCssKeyframes *
@@ -459,7 +518,7 @@ gtk_css_style_provider_get_keyframes (GtkStyleProvider *provider,
   GtkCssProvider *css_provider = GTK_CSS_PROVIDER (provider);
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
 
-  return g_hash_table_lookup (priv->keyframes, name);
+  return g_hash_table_lookup (priv->sheet->keyframes, name);
 }
 
 static void
@@ -471,16 +530,17 @@ gtk_css_style_provider_lookup (GtkStyleProvider             *provider,
 {
   GtkCssProvider *css_provider = GTK_CSS_PROVIDER (provider);
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
+  GtkCssSelectorTree *tree = priv->sheet->tree;
   GtkCssRuleset *ruleset;
   guint j;
   int i;
   GtkCssSelectorMatches tree_rules;
 
-  if (_gtk_css_selector_tree_is_empty (priv->tree))
+  if (_gtk_css_selector_tree_is_empty (tree))
     return;
 
   gtk_css_selector_matches_init (&tree_rules);
-  _gtk_css_selector_tree_match_all (priv->tree, filter, node, &tree_rules);
+  _gtk_css_selector_tree_match_all (tree, filter, node, &tree_rules);
 
   if (!gtk_css_selector_matches_is_empty (&tree_rules))
     {
@@ -511,7 +571,7 @@ gtk_css_style_provider_lookup (GtkStyleProvider             *provider,
   gtk_css_selector_matches_clear (&tree_rules);
 
   if (change)
-    *change = gtk_css_selector_tree_get_change_all (priv->tree, filter, node);
+    *change = gtk_css_selector_tree_get_change_all (tree, filter, node);
 }
 
 static void
@@ -528,16 +588,8 @@ gtk_css_provider_finalize (GObject *object)
 {
   GtkCssProvider *css_provider = GTK_CSS_PROVIDER (object);
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
-  guint i;
-
-  for (i = 0; i < priv->rulesets->len; i++)
-    gtk_css_ruleset_clear (&g_array_index (priv->rulesets, GtkCssRuleset, i));
 
-  g_array_free (priv->rulesets, TRUE);
-  _gtk_css_selector_tree_free (priv->tree);
-
-  g_hash_table_destroy (priv->symbolic_colors);
-  g_hash_table_destroy (priv->keyframes);
+  gtk_css_stylesheet_unref (priv->sheet);
 
   if (priv->resource)
     {
@@ -564,12 +616,73 @@ gtk_css_provider_new (void)
   return g_object_new (GTK_TYPE_CSS_PROVIDER, NULL);
 }
 
+/**
+ * gtk_css_provider_set_incremental_reload:
+ * @css_provider: a `GtkCssProvider`
+ * @incremental_reload: whether to reload incrementally
+ *
+ * Sets whether loading new CSS into @css_provider compares it with
+ * the previously loaded CSS.
+ *
+ * When enabled, only widgets that may be affected by rules that were
+ * added, removed or modified are restyled after a load, and nothing
+ * is restyled if the CSS did not change. This is meant for providers
+ * that are reloaded often, like when editing CSS while the application
+ * is running. It costs some memory, as the provider has to keep more
+ * information about the loaded CSS.
+ *
+ * Changes to `@define-color` or `@keyframes` always restyle everything,
+ * as they can affect the rules of other providers.
+ *
+ * CSS that was loaded before enabling this can't be compared, so
+ * the next load still restyles everything.
+ *
+ * Since: 4.12
+ */
+void
+gtk_css_provider_set_incremental_reload (GtkCssProvider *css_provider,
+                                         gboolean        incremental_reload)
+{
+  GtkCssProviderPrivate *priv;
+
+  g_return_if_fail (GTK_IS_CSS_PROVIDER (css_provider));
+
+  priv = gtk_css_provider_get_instance_private (css_provider);
+
+  priv->incremental_reload = incremental_reload != FALSE;
+}
+
+/**
+ * gtk_css_provider_get_incremental_reload:
+ * @css_provider: a `GtkCssProvider`
+ *
+ * Returns whether @css_provider reloads incrementally.
+ *
+ * See [method@Gtk.CssProvider.set_incremental_reload].
+ *
+ * Returns: %TRUE if @css_provider reloads incrementally
+ *
+ * Since: 4.12
+ */
+gboolean
+gtk_css_provider_get_incremental_reload (GtkCssProvider *css_provider)
+{
+  GtkCssProviderPrivate *priv;
+
+  g_return_val_if_fail (GTK_IS_CSS_PROVIDER (css_provider), FALSE);
+
+  priv = gtk_css_provider_get_instance_private (css_provider);
+
+  return priv->incremental_reload;
+}
+
 static void
 css_provider_commit (GtkCssProvider  *css_provider,
                      GtkCssSelectors *selectors,
                      GtkCssRuleset   *ruleset)
 {
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
+  GArray *rulesets = priv->sheet->rulesets;
   guint i;
 
   if (ruleset->styles == NULL)
@@ -583,9 +696,9 @@ css_provider_commit (GtkCssProvider  *css_provider,
     {
       GtkCssRuleset *new;
 
-      g_array_set_size (priv->rulesets, priv->rulesets->len + 1);
+      g_array_set_size (rulesets, rulesets->len + 1);
 
-      new = &g_array_index (priv->rulesets, GtkCssRuleset, priv->rulesets->len - 1);
+      new = &g_array_index (rulesets, GtkCssRuleset, rulesets->len - 1);
       gtk_css_ruleset_init_copy (new, ruleset, gtk_css_selectors_get (selectors, i));
     }
 }
@@ -594,7 +707,6 @@ static void
 gtk_css_provider_reset (GtkCssProvider *css_provider)
 {
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
-  guint i;
 
   if (priv->resource)
     {
@@ -609,14 +721,9 @@ gtk_css_provider_reset (GtkCssProvider *css_provider)
       priv->path = NULL;
     }
 
-  g_hash_table_remove_all (priv->symbolic_colors);
-  g_hash_table_remove_all (priv->keyframes);
-
-  for (i = 0; i < priv->rulesets->len; i++)
-    gtk_css_ruleset_clear (&g_array_index (priv->rulesets, GtkCssRuleset, i));
-  g_array_set_size (priv->rulesets, 0);
-  _gtk_css_selector_tree_free (priv->tree);
-  priv->tree = NULL;
+  /* The old stylesheet may still be referenced, so never modify it */
+  gtk_css_stylesheet_unref (priv->sheet);
+  priv->sheet = gtk_css_stylesheet_new ();
 }
 
 static gboolean
@@ -720,7 +827,7 @@ parse_color_definition (GtkCssScanner *scanner)
       return TRUE;
     }
 
-  g_hash_table_insert (priv->symbolic_colors, name, color);
+  g_hash_table_insert (priv->sheet->symbolic_colors, name, color);
 
   return TRUE;
 }
@@ -749,7 +856,7 @@ parse_keyframes (GtkCssScanner *scanner)
 
   keyframes = _gtk_css_keyframes_parse (scanner->parser);
   if (keyframes != NULL)
-    g_hash_table_insert (priv->keyframes, name, keyframes);
+    g_hash_table_insert (priv->sheet->keyframes, name, keyframes);
 
   if (!gtk_css_parser_has_token (scanner->parser, GTK_CSS_TOKEN_EOF))
     gtk_css_parser_error_syntax (scanner->parser, "Expected '}' after declarations");
@@ -980,45 +1087,239 @@ static void
 gtk_css_provider_postprocess (GtkCssProvider *css_provider)
 {
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
+  GtkCssStylesheet *sheet = priv->sheet;
   GtkCssSelectorTreeBuilder *builder;
+  GPtrArray *copies;
   guint i;
   gint64 before G_GNUC_UNUSED;
 
   before = GDK_PROFILER_CURRENT_TIME;
 
-  g_array_sort (priv->rulesets, gtk_css_provider_compare_rule);
+  g_array_sort (sheet->rulesets, gtk_css_provider_compare_rule);
+
+#ifdef VERIFY_TREE
+  sheet->has_selectors = TRUE;
+#else
+  sheet->has_selectors = priv->incremental_reload;
+#endif
+
+  /* Building the tree reorders the selectors, so give it copies
+   * if we keep them for comparing */
+  if (sheet->has_selectors)
+    copies = g_ptr_array_new_with_free_func ((GDestroyNotify) _gtk_css_selector_free);
+  else
+    copies = NULL;
 
   builder = _gtk_css_selector_tree_builder_new ();
-  for (i = 0; i < priv->rulesets->len; i++)
+  for (i = 0; i < sheet->rulesets->len; i++)
     {
       GtkCssRuleset *ruleset;
+      GtkCssSelector *selector;
+
+      ruleset = &g_array_index (sheet->rulesets, GtkCssRuleset, i);
 
-      ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+      selector = ruleset->selector;
+      if (copies)
+        {
+          selector = _gtk_css_selector_copy (selector);
+          g_ptr_array_add (copies, selector);
+        }
 
       _gtk_css_selector_tree_builder_add (builder,
-					  ruleset->selector,
+					  selector,
 					  &ruleset->selector_match,
 					  ruleset);
     }
 
-  priv->tree = _gtk_css_selector_tree_builder_build (builder);
+  sheet->tree = _gtk_css_selector_tree_builder_build (builder);
   _gtk_css_selector_tree_builder_free (builder);
 
-#ifndef VERIFY_TREE
-  for (i = 0; i < priv->rulesets->len; i++)
+  if (copies)
     {
-      GtkCssRuleset *ruleset;
+      g_ptr_array_unref (copies);
+    }
+  else
+    {
+      for (i = 0; i < sheet->rulesets->len; i++)
+        {
+          GtkCssRuleset *ruleset;
 
-      ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+          ruleset = &g_array_index (sheet->rulesets, GtkCssRuleset, i);
 
-      _gtk_css_selector_free (ruleset->selector);
-      ruleset->selector = NULL;
+          _gtk_css_selector_free (ruleset->selector);
+          ruleset->selector = NULL;
+        }
     }
-#endif
 
   gdk_profiler_end_mark (before, "create selector tree", NULL);
 }
 
+static gboolean
+gtk_css_ruleset_equal (const GtkCssRuleset *a,
+                       const GtkCssRuleset *b)
+{
+  guint i;
+
+  if (a->n_styles != b->n_styles)
+    return FALSE;
+
+  if (!_gtk_css_selector_equal (a->selector, b->selector))
+    return FALSE;
+
+  for (i = 0; i < a->n_styles; i++)
+    {
+      if (a->styles[i].property != b->styles[i].property ||
+          !_gtk_css_value_equal (a->styles[i].value, b->styles[i].value))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+gtk_css_stylesheet_colors_equal (GtkCssStylesheet *a,
+                                 GtkCssStylesheet *b)
+{
+  GHashTableIter iter;
+  gpointer name, color;
+
+  if (g_hash_table_size (a->symbolic_colors) != g_hash_table_size (b->symbolic_colors))
+    return FALSE;
+
+  g_hash_table_iter_init (&iter, a->symbolic_colors);
+  while (g_hash_table_iter_next (&iter, &name, &color))
+    {
+      GtkCssValue *other = g_hash_table_lookup (b->symbolic_colors, name);
+
+      if (other == NULL || !_gtk_css_value_equal (color, other))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+gtk_css_stylesheet_keyframes_equal (GtkCssStylesheet *a,
+                                    GtkCssStylesheet *b)
+{
+  GString *str_a, *str_b;
+  gboolean result;
+
+  if (g_hash_table_size (a->keyframes) != g_hash_table_size (b->keyframes))
+    return FALSE;
+
+  if (g_hash_table_size (a->keyframes) == 0)
+    return TRUE;
+
+  str_a = g_string_new (NULL);
+  str_b = g_string_new (NULL);
+  gtk_css_provider_print_keyframes (a->keyframes, str_a);
+  gtk_css_provider_print_keyframes (b->keyframes, str_b);
+
+  result = g_str_equal (str_a->str, str_b->str);
+
+  g_string_free (str_a, TRUE);
+  g_string_free (str_b, TRUE);
+
+  return result;
+}
+
+static void
+gtk_css_stylesheet_add_changed_rulesets (GtkCssStylesheet          *sheet,
+                                         guint                      start,
+                                         guint                      end,
+                                         GtkCssSelectorTreeBuilder *builder,
+                                         GPtrArray                 *copies)
+{
+  guint i;
+
+  for (i = start; i < end; i++)
+    {
+      GtkCssRuleset *ruleset = &g_array_index (sheet->rulesets, GtkCssRuleset, i);
+      GtkCssSelector *selector = _gtk_css_selector_copy (ruleset->selector);
+
+      g_ptr_array_add (copies, selector);
+      _gtk_css_selector_tree_builder_add (builder, selector, NULL, ruleset);
+    }
+}
+
+/* If more rulesets than this changed, restyling everything is
+ * cheaper than checking every node against them */
+#define MAX_CHANGED_RULESETS 64
+
+/* Finds the rulesets that differ between @old and @new.
+ *
+ * Rulesets are sorted in cascade order, so all rulesets between
+ * the longest common prefix and suffix of both count as changed.
+ * Nodes that can't match any of them get the same style from both
+ * stylesheets.
+ *
+ * Returns FALSE if the change can't be limited to some rulesets.
+ * Otherwise @changed is set to a selector tree of the changed
+ * rulesets, or to %NULL if the stylesheets are equal.
+ */
+static gboolean
+gtk_css_stylesheet_diff (GtkCssStylesheet    *old,
+                         GtkCssStylesheet    *new,
+                         GtkCssSelectorTree **changed)
+{
+  GtkCssSelectorTreeBuilder *builder;
+  GPtrArray *copies;
+  guint n_old, n_new, n_common, prefix, suffix;
+
+  *changed = NULL;
+
+  if (old == new)
+    return TRUE;
+
+  if (!old->has_selectors || !new->has_selectors)
+    return FALSE;
+
+  /* Colors and keyframes are looked up in all providers of the
+   * cascade, so rulesets anywhere may be affected */
+  if (!gtk_css_stylesheet_colors_equal (old, new) ||
+      !gtk_css_stylesheet_keyframes_equal (old, new))
+    return FALSE;
+
+  n_old = old->rulesets->len;
+  n_new = new->rulesets->len;
+  n_common = MIN (n_old, n_new);
+
+  for (prefix = 0; prefix < n_common; prefix++)
+    {
+      if (!gtk_css_ruleset_equal (&g_array_index (old->rulesets, GtkCssRuleset, prefix),
+                                  &g_array_index (new->rulesets, GtkCssRuleset, prefix)))
+        break;
+    }
+
+  for (suffix = 0; prefix + suffix < n_common; suffix++)
+    {
+      if (!gtk_css_ruleset_equal (&g_array_index (old->rulesets, GtkCssRuleset, n_old - suffix - 1),
+                                  &g_array_index (new->rulesets, GtkCssRuleset, n_new - suffix - 1)))
+        break;
+    }
+
+  if (prefix + suffix == n_old && prefix + suffix == n_new)
+    return TRUE;
+
+  if (n_old + n_new - 2 * (prefix + suffix) > MAX_CHANGED_RULESETS)
+    return FALSE;
+
+  /* Like in postprocess, the builder reorders the selectors */
+  copies = g_ptr_array_new_with_free_func ((GDestroyNotify) _gtk_css_selector_free);
+  builder = _gtk_css_selector_tree_builder_new ();
+
+  gtk_css_stylesheet_add_changed_rulesets (old, prefix, n_old - suffix, builder, copies);
+  gtk_css_stylesheet_add_changed_rulesets (new, prefix, n_new - suffix, builder, copies);
+
+  *changed = _gtk_css_selector_tree_builder_build (builder);
+
+  _gtk_css_selector_tree_builder_free (builder);
+  g_ptr_array_unref (copies);
+
+  return TRUE;
+}
+
 static void
 gtk_css_provider_load_internal (GtkCssProvider *self,
                                 GtkCssScanner  *parent,
@@ -1086,6 +1387,37 @@ gtk_css_provider_load_internal (GtkCssProvider *self,
     }
 }
 
+/* Loads a toplevel stylesheet, replacing the current one */
+static void
+gtk_css_provider_load (GtkCssProvider *self,
+                       GFile          *file,
+                       GBytes         *bytes)
+{
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (self);
+  GtkCssStylesheet *old_sheet;
+  GtkCssSelectorTree *changed = NULL;
+
+  old_sheet = gtk_css_stylesheet_ref (priv->sheet);
+
+  gtk_css_provider_reset (self);
+
+  gtk_css_provider_load_internal (self, NULL, file, bytes);
+
+  if (!priv->incremental_reload ||
+      gtk_keep_css_sections ||
+      !gtk_css_stylesheet_diff (old_sheet, priv->sheet, &changed))
+    {
+      gtk_style_provider_changed (GTK_STYLE_PROVIDER (self));
+    }
+  else if (changed)
+    {
+      gtk_style_provider_rules_changed (GTK_STYLE_PROVIDER (self), changed);
+      _gtk_css_selector_tree_free (changed);
+    }
+
+  gtk_css_stylesheet_unref (old_sheet);
+}
+
 /**
  * gtk_css_provider_load_from_data:
  * @css_provider: a `GtkCssProvider`
@@ -1164,11 +1496,7 @@ gtk_css_provider_load_from_bytes (GtkCssProvider *css_provider,
   g_return_if_fail (GTK_IS_CSS_PROVIDER (css_provider));
   g_return_if_fail (data != NULL);
 
-  gtk_css_provider_reset (css_provider);
-
-  gtk_css_provider_load_internal (css_provider, NULL, NULL, g_bytes_ref (data));
-
-  gtk_style_provider_changed (GTK_STYLE_PROVIDER (css_provider));
+  gtk_css_provider_load (css_provider, NULL, g_bytes_ref (data));
 }
 
 /**
@@ -1187,11 +1515,7 @@ gtk_css_provider_load_from_file (GtkCssProvider  *css_provider,
   g_return_if_fail (GTK_IS_CSS_PROVIDER (css_provider));
   g_return_if_fail (G_IS_FILE (file));
 
-  gtk_css_provider_reset (css_provider);
-
-  gtk_css_provider_load_internal (css_provider, NULL, file, NULL);
-
-  gtk_style_provider_changed (GTK_STYLE_PROVIDER (css_provider));
+  gtk_css_provider_load (css_provider, file, NULL);
 }
 
 /**
@@ -1391,7 +1715,8 @@ gtk_css_provider_load_named (GtkCssProvider *provider,
   g_return_if_fail (GTK_IS_CSS_PROVIDER (provider));
   g_return_if_fail (name != NULL);
 
-  gtk_css_provider_reset (provider);
+  /* Loading below resets the provider. Don't do it before, so
+   * incremental reloads can compare with the previous theme. */
 
   /* try loading the resource for the theme. This is mostly meant for built-in
    * themes.
@@ -1586,14 +1911,14 @@ gtk_css_provider_to_string (GtkCssProvider *provider)
 
   str = g_string_new ("");
 
-  gtk_css_provider_print_colors (priv->symbolic_colors, str);
-  gtk_css_provider_print_keyframes (priv->keyframes, str);
+  gtk_css_provider_print_colors (priv->sheet->symbolic_colors, str);
+  gtk_css_provider_print_keyframes (priv->sheet->keyframes, str);
 
-  for (i = 0; i < priv->rulesets->len; i++)
+  for (i = 0; i < priv->sheet->rulesets->len; i++)
     {
       if (str->len != 0)
         g_string_append (str, "\n");
-      gtk_css_ruleset_print (&g_array_index (priv->rulesets, GtkCssRuleset, i), str);
+      gtk_css_ruleset_print (&g_array_index (priv->sheet->rulesets, GtkCssRuleset, i), str);
     }
 
   return g_string_free (str, FALSE);
@@ -45,6 +45,12 @@ GtkCssProvider * gtk_css_provider_new (void);
 GDK_AVAILABLE_IN_ALL
 char *           gtk_css_provider_to_string      (GtkCssProvider  *provider);
 
+GDK_AVAILABLE_IN_4_12
+void             gtk_css_provider_set_incremental_reload (GtkCssProvider *css_provider,
+                                                          gboolean        incremental_reload);
+GDK_AVAILABLE_IN_4_12
+gboolean         gtk_css_provider_get_incremental_reload (GtkCssProvider *css_provider);
+
 GDK_DEPRECATED_IN_4_12_FOR(gtk_css_provider_load_from_string)
 void             gtk_css_provider_load_from_data (GtkCssProvider  *css_provider,
                                                   const char      *data,
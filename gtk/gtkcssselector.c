@@ -1605,6 +1605,14 @@ _gtk_css_selector_free (GtkCssSelector *selector)
   g_free (selector);
 }
 
+GtkCssSelector *
+_gtk_css_selector_copy (const GtkCssSelector *selector)
+{
+  g_return_val_if_fail (selector != NULL, NULL);
+
+  return g_memdup2 (selector, sizeof (GtkCssSelector) * gtk_css_selector_size (selector) + sizeof (gpointer));
+}
+
 void
 _gtk_css_selector_print (const GtkCssSelector *selector,
                          GString *             str)
@@ -1707,6 +1715,22 @@ _gtk_css_selector_compare (const GtkCssSelector *a,
   return a_elements - b_elements;
 }
 
+gboolean
+_gtk_css_selector_equal (const GtkCssSelector *a,
+                         const GtkCssSelector *b)
+{
+  while (a && b)
+    {
+      if (!gtk_css_selector_equal (a, b))
+        return FALSE;
+
+      a = gtk_css_selector_previous (a);
+      b = gtk_css_selector_previous (b);
+    }
+
+  return a == NULL && b == NULL;
+}
+
 GtkCssChange
 _gtk_css_selector_get_change (const GtkCssSelector *selector)
 {
@@ -1961,6 +1985,24 @@ gtk_css_selector_tree_get_change_all (const GtkCssSelectorTree     *tree,
   return change & ~GTK_CSS_CHANGE_RESERVED_BIT;
 }
 
+/* Checks if any rule in @tree can match @node, judging only by
+ * the node's name, id and classes. So unlike matching, the result
+ * does not change when the node's state or position changes.
+ */
+gboolean
+gtk_css_selector_tree_may_match (const GtkCssSelectorTree *tree,
+                                 GtkCssNode               *node)
+{
+  for (; tree != NULL;
+       tree = gtk_css_selector_tree_get_sibling (tree))
+    {
+      if (gtk_css_selector_tree_get_change (tree, NULL, node, FALSE) & GTK_CSS_CHANGE_GOT_MATCH)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
 #ifdef PRINT_TREE
 static void
 _gtk_css_selector_tree_print (const GtkCssSelectorTree *tree, GString *str, const char *prefix)
@@ -32,11 +32,11 @@
 G_BEGIN_DECLS
 
 typedef union _GtkCssSelector GtkCssSelector;
-typedef struct _GtkCssSelectorTree GtkCssSelectorTree;
 typedef struct _GtkCssSelectorTreeBuilder GtkCssSelectorTreeBuilder;
 
 GtkCssSelector *  _gtk_css_selector_parse           (GtkCssParser           *parser);
 void              _gtk_css_selector_free            (GtkCssSelector         *selector);
+GtkCssSelector *  _gtk_css_selector_copy            (const GtkCssSelector   *selector);
 
 char *            _gtk_css_selector_to_string       (const GtkCssSelector   *selector);
 void              _gtk_css_selector_print           (const GtkCssSelector   *selector,
@@ -45,6 +45,8 @@ void              _gtk_css_selector_print           (const GtkCssSelector   *sel
 gboolean          gtk_css_selector_matches          (const GtkCssSelector   *selector,
 						     GtkCssNode             *node);
 GtkCssChange      _gtk_css_selector_get_change      (const GtkCssSelector   *selector);
+gboolean          _gtk_css_selector_equal           (const GtkCssSelector   *a,
+                                                     const GtkCssSelector   *b);
 int               _gtk_css_selector_compare         (const GtkCssSelector   *a,
                                                      const GtkCssSelector   *b);
 
@@ -56,6 +58,8 @@ void         _gtk_css_selector_tree_match_all        (const GtkCssSelectorTree *
 GtkCssChange gtk_css_selector_tree_get_change_all    (const GtkCssSelectorTree *tree,
                                                       const GtkCountingBloomFilter *filter,
 						      GtkCssNode               *node);
+gboolean     gtk_css_selector_tree_may_match         (const GtkCssSelectorTree *tree,
+                                                      GtkCssNode               *node);
 void         _gtk_css_selector_tree_match_print      (const GtkCssSelectorTree *tree,
 						      GString                  *str);
 gboolean     _gtk_css_selector_tree_is_empty         (const GtkCssSelectorTree *tree) G_GNUC_CONST;
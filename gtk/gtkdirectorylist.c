@@ -53,6 +53,12 @@
 /* random number that everyone else seems to use, too */
 #define FILES_PER_QUERY 100
 
+/* The number of files queried at once adapts so that handling a batch
+ * takes about this long on the main thread */
+#define BATCH_TIME (G_USEC_PER_SEC / 240)
+#define MIN_FILES_PER_QUERY (FILES_PER_QUERY / 4)
+#define MAX_FILES_PER_QUERY (200 * FILES_PER_QUERY)
+
 enum {
   PROP_0,
   PROP_ATTRIBUTES,
@@ -74,6 +80,7 @@ struct _QueuedEvent
   GFile *file;
   GFileInfo *info;
   GFileMonitorEvent event;
+  gboolean queried;
 };
 
 static void
@@ -99,7 +106,11 @@ struct _GtkDirectoryList
   GCancellable *cancellable;
   GError *error; /* Error while loading */
   GSequence *items; /* Use GPtrArray or GListStore here? */
+  GHashTable *files; /* GFile => GSequenceIter in items */
+  guint batch_size;
+
   GQueue events;
+  guint events_idle;
 };
 
 struct _GtkDirectoryListClass
@@ -265,8 +276,10 @@ gtk_directory_list_dispose (GObject *object)
   g_clear_pointer (&self->attributes, g_free);
 
   g_clear_error (&self->error);
+  g_clear_pointer (&self->files, g_hash_table_unref);
   g_clear_pointer (&self->items, g_sequence_free);
 
+  g_clear_handle_id (&self->events_idle, g_source_remove);
   g_queue_foreach (&self->events, (GFunc) free_queued_event, NULL);
   g_queue_clear (&self->events);
 
@@ -373,6 +386,7 @@ static void
 gtk_directory_list_init (GtkDirectoryList *self)
 {
   self->items = g_sequence_new (g_object_unref);
+  self->files = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal, g_object_unref, NULL);
   self->io_priority = G_PRIORITY_DEFAULT;
   self->monitored = TRUE;
   g_queue_init (&self->events);
@@ -410,6 +424,7 @@ gtk_directory_list_clear_items (GtkDirectoryList *self)
   n_items = g_sequence_get_length (self->items);
   if (n_items > 0)
     {
+      g_hash_table_remove_all (self->files);
       g_sequence_remove_range (g_sequence_get_begin_iter (self->items),
                                g_sequence_get_end_iter (self->items));
 
@@ -432,6 +447,27 @@ gtk_directory_list_enumerator_closed_cb (GObject      *source,
   g_file_enumerator_close_finish (G_FILE_ENUMERATOR (source), res, NULL);
 }
 
+static void
+gtk_directory_list_adjust_batch_size (GtkDirectoryList *self,
+                                      guint             n_files,
+                                      gint64            elapsed)
+{
+  gint64 batch_size;
+
+  if (n_files == 0)
+    return;
+
+  /* Aim for BATCH_TIME, but don't change too quickly because a
+   * single batch might have been unlucky */
+  if (elapsed > 0)
+    batch_size = BATCH_TIME * n_files / elapsed;
+  else
+    batch_size = G_MAXINT;
+
+  batch_size = CLAMP (batch_size, self->batch_size / 2, self->batch_size * 2);
+  self->batch_size = CLAMP (batch_size, MIN_FILES_PER_QUERY, MAX_FILES_PER_QUERY);
+}
+
 static void
 gtk_directory_list_got_files_cb (GObject      *source,
                                  GAsyncResult *res,
@@ -441,7 +477,8 @@ gtk_directory_list_got_files_cb (GObject      *source,
   GFileEnumerator *enumerator = G_FILE_ENUMERATOR (source);
   GError *error = NULL;
   GList *l, *files;
-  guint n;
+  guint n, n_files;
+  gint64 start;
 
   files = g_file_enumerator_next_files_finish (enumerator, res, &error);
 
@@ -474,7 +511,10 @@ gtk_directory_list_got_files_cb (GObject      *source,
       return;
     }
 
+  start = g_get_monotonic_time ();
+
   n = 0;
+  n_files = 0;
   for (l = files; l; l = l->next)
     {
       GFileInfo *info;
@@ -482,15 +522,24 @@ gtk_directory_list_got_files_cb (GObject      *source,
 
       info = l->data;
       file = g_file_enumerator_get_child (enumerator, info);
+      n_files++;
+
+      /* The monitor might have told us about this file already */
+      if (g_hash_table_contains (self->files, file))
+        {
+          g_object_unref (file);
+          g_object_unref (info);
+          continue;
+        }
+
       g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
-      g_object_unref (file);
-      g_sequence_append (self->items, info);
+      g_hash_table_insert (self->files, file, g_sequence_append (self->items, info));
       n++;
     }
   g_list_free (files);
 
   g_file_enumerator_next_files_async (enumerator,
-                                      g_file_is_native (self->file) ? 50 * FILES_PER_QUERY : FILES_PER_QUERY,
+                                      self->batch_size,
                                       self->io_priority,
                                       self->cancellable,
                                       gtk_directory_list_got_files_cb,
@@ -501,6 +550,8 @@ gtk_directory_list_got_files_cb (GObject      *source,
       g_list_model_items_changed (G_LIST_MODEL (self), g_sequence_get_length (self->items) - n, 0, n);
       g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
     }
+
+  gtk_directory_list_adjust_batch_size (self, n_files, g_get_monotonic_time () - start);
 }
 
 static void
@@ -531,8 +582,9 @@ gtk_directory_list_got_enumerator_cb (GObject      *source,
       return;
     }
 
+  self->batch_size = g_file_is_native (file) ? 50 * FILES_PER_QUERY : FILES_PER_QUERY;
   g_file_enumerator_next_files_async (enumerator,
-                                      g_file_is_native (file) ? 50 * FILES_PER_QUERY : FILES_PER_QUERY,
+                                      self->batch_size,
                                       self->io_priority,
                                       self->cancellable,
                                       gtk_directory_list_got_files_cb,
@@ -571,28 +623,92 @@ gtk_directory_list_start_loading (GtkDirectoryList *self)
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOADING]);
 }
 
-static GSequenceIter *
-find_file (GSequence *sequence,
-           GFile     *file)
+/* A single change covering all the changes made while handling
+ * a batch of events */
+typedef struct
 {
-  GSequenceIter *iter;
+  guint position;
+  guint removed;
+  guint added;
+  guint n_changed; /* number of items actually changed */
+} Changes;
 
-  for (iter = g_sequence_get_begin_iter (sequence);
-       !g_sequence_iter_is_end (iter);
-       iter = g_sequence_iter_next (iter))
-    {
-      GFileInfo *item = G_FILE_INFO (g_sequence_get (iter));
-      GFile *f = G_FILE (g_file_info_get_attribute_object (item, "standard::file"));
+static void
+gtk_directory_list_emit_changes (GtkDirectoryList *self,
+                                 Changes          *changes)
+{
+  if (changes->removed > 0 || changes->added > 0)
+    g_list_model_items_changed (G_LIST_MODEL (self), changes->position, changes->removed, changes->added);
+
+  changes->position = 0;
+  changes->removed = 0;
+  changes->added = 0;
+  changes->n_changed = 0;
+}
 
-      if (g_file_equal (f, file))
-        return iter;
+/* Emits the collected changes if a change removing @removed items
+ * at @position can't be merged into them.
+ *
+ * This must happen before the items get modified, so that the
+ * emitted changes match the items.
+ */
+static void
+gtk_directory_list_prepare_change (GtkDirectoryList *self,
+                                   Changes          *changes,
+                                   guint             position,
+                                   guint             removed)
+{
+  guint gap;
+
+  if (changes->n_changed == 0)
+    return;
+
+  if (position > changes->position + changes->added)
+    gap = position - (changes->position + changes->added);
+  else if (position + removed < changes->position)
+    gap = changes->position - (position + removed);
+  else
+    gap = 0;
+
+  /* Don't make widgets for lots of unchanged items get recreated
+   * just to save a signal emission */
+  if (gap > changes->n_changed)
+    gtk_directory_list_emit_changes (self, changes);
+}
+
+/* Adds a change to the collected changes, after the items were
+ * modified. gtk_directory_list_prepare_change() must have been
+ * called before modifying them.
+ */
+static void
+gtk_directory_list_add_change (Changes *changes,
+                               guint    position,
+                               guint    removed,
+                               guint    added)
+{
+  guint start, end;
+
+  if (changes->n_changed == 0)
+    {
+      changes->position = position;
+      changes->removed = removed;
+      changes->added = added;
+      changes->n_changed = removed + added;
+      return;
     }
 
-  return NULL;
+  start = MIN (changes->position, position);
+  end = MAX (changes->position + changes->added, position + removed);
+
+  changes->removed = end - start + changes->removed - changes->added;
+  changes->added = end - start - removed + added;
+  changes->position = start;
+  changes->n_changed += removed + added;
 }
 
 static gboolean
-handle_event (QueuedEvent *event)
+handle_event (QueuedEvent *event,
+              Changes     *changes)
 {
   GtkDirectoryList *self = event->list;
   GFile *file = event->file;
@@ -604,51 +720,62 @@ handle_event (QueuedEvent *event)
     {
     case G_FILE_MONITOR_EVENT_MOVED_IN:
     case G_FILE_MONITOR_EVENT_CREATED:
-      if (!info)
+      if (!event->queried)
         return FALSE;
 
+      /* The file is already gone again */
+      if (!info)
+        break;
+
       g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
 
-      iter = find_file (self->items, file);
+      iter = g_hash_table_lookup (self->files, file);
       if (iter)
         {
           position = g_sequence_iter_get_position (iter);
+          gtk_directory_list_prepare_change (self, changes, position, 1);
           g_sequence_set (iter, g_object_ref (info));
-          g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 1);
+          gtk_directory_list_add_change (changes, position, 1, 1);
         }
       else
         {
           position = g_sequence_get_length (self->items);
-          g_sequence_append (self->items, g_object_ref (info));
-          g_list_model_items_changed (G_LIST_MODEL (self), position, 0, 1);
-          g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+          gtk_directory_list_prepare_change (self, changes, position, 0);
+          iter = g_sequence_append (self->items, g_object_ref (info));
+          g_hash_table_insert (self->files, g_object_ref (file), iter);
+          gtk_directory_list_add_change (changes, position, 0, 1);
         }
       break;
 
     case G_FILE_MONITOR_EVENT_MOVED_OUT:
     case G_FILE_MONITOR_EVENT_DELETED:
-      iter = find_file (self->items, file);
+      iter = g_hash_table_lookup (self->files, file);
       if (iter)
         {
           position = g_sequence_iter_get_position (iter);
+          gtk_directory_list_prepare_change (self, changes, position, 1);
+          g_hash_table_remove (self->files, file);
           g_sequence_remove (iter);
-          g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 0);
-          g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+          gtk_directory_list_add_change (changes, position, 1, 0);
         }
       break;
 
     case G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED:
-      if (!info)
+      if (!event->queried)
         return FALSE;
 
+      if (!info)
+        break;
+
       g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
 
-      iter = find_file (self->items, file);
+      iter = g_hash_table_lookup (self->files, file);
       if (iter)
         {
           position = g_sequence_iter_get_position (iter);
+          gtk_directory_list_prepare_change (self, changes, position, 1);
           g_sequence_set (iter, g_object_ref (info));
-          g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 1);
+          gtk_directory_list_add_change (changes, position, 1, 1);
         }
       break;
 
@@ -659,24 +786,49 @@ handle_event (QueuedEvent *event)
   return TRUE;
 }
 
-static void
-handle_events (GtkDirectoryList *self)
+static gboolean
+handle_events (gpointer data)
 {
+  GtkDirectoryList *self = data;
+  Changes changes = { 0, };
   QueuedEvent *event;
+  guint n_items;
+
+  self->events_idle = 0;
+  n_items = g_sequence_get_length (self->items);
 
   do
     {
       event = g_queue_peek_tail (&self->events);
       if (!event)
-        return;
+        break;
 
-      if (!handle_event (event))
-        return;
+      if (!handle_event (event, &changes))
+        break;
 
       event = g_queue_pop_tail (&self->events);
       free_queued_event (event);
     }
   while (TRUE);
+
+  gtk_directory_list_emit_changes (self, &changes);
+
+  if (n_items != g_sequence_get_length (self->items))
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Events often come in storms, so handle all that are ready at once
+ * and emit a single ::items-changed for them */
+static void
+queue_handle_events (GtkDirectoryList *self)
+{
+  if (self->events_idle)
+    return;
+
+  self->events_idle = g_idle_add_full (G_PRIORITY_HIGH_IDLE, handle_events, self, NULL);
+  gdk_source_set_static_name_by_id (self->events_idle, "[gtk] gtk_directory_list_handle_events");
 }
 
 static void
@@ -689,7 +841,8 @@ got_new_file_info_cb (GObject      *source,
   GFile *file = event->file;
 
   event->info = g_file_query_info_finish (file, res, NULL);
-  handle_events (self);
+  event->queried = TRUE;
+  queue_handle_events (self);
 }
 
 static void
@@ -702,7 +855,8 @@ got_existing_file_info_cb (GObject      *source,
   GFile *file = event->file;
 
   event->info = g_file_query_info_finish (file, res, NULL);
-  handle_events (self);
+  event->queried = TRUE;
+  queue_handle_events (self);
 }
 
 static void
@@ -742,7 +896,7 @@ directory_changed (GFileMonitor       *monitor,
       ev->file = g_object_ref (file);
       g_queue_push_head (&self->events, ev);
 
-      handle_events (self);
+      queue_handle_events (self);
       break;
 
     case G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED:
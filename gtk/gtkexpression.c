@@ -19,7 +19,7 @@
 
 #include "config.h"
 
-#include "gtkexpression.h"
+#include "gtkexpressionprivate.h"
 
 #include "gtkprivate.h"
 
@@ -1837,6 +1837,35 @@ gtk_expression_is_static (GtkExpression *self)
   return GTK_EXPRESSION_GET_CLASS (self)->is_static (self);
 }
 
+/*<private>
+ * gtk_expression_is_thread_safe:
+ * @self: (nullable): a `GtkExpression`
+ *
+ * Checks if @self can be evaluated from other threads, while
+ * the main thread is not modifying the objects it looks at.
+ *
+ * This is the case for chains of property lookups on constant values
+ * or objects, which only read properties. Closures can run arbitrary
+ * code and are never considered thread-safe.
+ *
+ * Returns: %TRUE if @self can be evaluated from other threads
+ **/
+gboolean
+gtk_expression_is_thread_safe (GtkExpression *self)
+{
+  while (self != NULL)
+    {
+      if (G_TYPE_CHECK_INSTANCE_TYPE (self, GTK_TYPE_PROPERTY_EXPRESSION))
+        self = ((GtkPropertyExpression *) self)->expr;
+      else
+        return G_TYPE_CHECK_INSTANCE_TYPE (self, GTK_TYPE_CONSTANT_EXPRESSION) ||
+               G_TYPE_CHECK_INSTANCE_TYPE (self, GTK_TYPE_OBJECT_EXPRESSION);
+    }
+
+  /* property lookups on the item itself */
+  return TRUE;
+}
+
 static gboolean
 gtk_expression_watch_is_watching (GtkExpressionWatch *watch)
 {
@@ -134,6 +134,7 @@ static GParamSpec *props[NUM_PROPERTIES] = { NULL, };
 static gboolean       gtk_file_filter_match          (GtkFilter *filter,
                                                       gpointer   item);
 static GtkFilterMatch gtk_file_filter_get_strictness (GtkFilter *filter);
+static gboolean       gtk_file_filter_is_thread_safe (GtkFilter *filter);
 
 static void           gtk_file_filter_buildable_init (GtkBuildableIface  *iface);
 
@@ -253,6 +254,7 @@ gtk_file_filter_class_init (GtkFileFilterClass *class)
 
   filter_class->get_strictness = gtk_file_filter_get_strictness;
   filter_class->match = gtk_file_filter_match;
+  filter_class->is_thread_safe = gtk_file_filter_is_thread_safe;
 
   /**
    * GtkFileFilter:name: (attributes org.gtk.Property.get=gtk_file_filter_get_name org.gtk.Property.set=gtk_file_filter_set_name)
@@ -891,6 +893,13 @@ _gtk_file_filter_get_as_patterns (GtkFileFilter *filter)
   return (char **)g_ptr_array_free (array, FALSE);
 }
 
+/* Only looks at the rules and the file info */
+static gboolean
+gtk_file_filter_is_thread_safe (GtkFilter *filter)
+{
+  return TRUE;
+}
+
 static GtkFilterMatch
 gtk_file_filter_get_strictness (GtkFilter *filter)
 {
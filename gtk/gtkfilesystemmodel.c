@@ -25,9 +25,12 @@
 
 #include "gtkfilechooserutils.h"
 #include "gtkmarshalers.h"
-#include "gtkfilter.h"
+#include "gtkfilterprivate.h"
+#include "gtkparallelprivate.h"
 #include "gtkprivate.h"
 
+#include "gdk/gdkprofilerprivate.h"
+
 /* priority used for all async callbacks in the main loop
  * This should be higher than redraw priorities so multiple callbacks
  * firing can be handled without intermediate redraws
@@ -75,12 +78,15 @@ struct _GtkFileSystemModel
 
   guint                 frozen;         /* number of times we're frozen */
 
+  gint64                load_start;     /* profiler time when loading started */
+
   unsigned int          filter_on_thaw   : 1; /* set when filtering needs to happen upon thawing */
   unsigned int          show_hidden      : 1; /* whether to show hidden files */
   unsigned int          show_folders     : 1; /* whether to show folders */
   unsigned int          show_files       : 1; /* whether to show files */
   unsigned int          filter_folders   : 1; /* whether filter applies to folders */
   unsigned int          can_select_files : 1;
+  unsigned int          shown_first_files : 1; /* set once the first loaded files were thawed */
 };
 
 static void freeze_updates (GtkFileSystemModel *model);
@@ -277,6 +283,114 @@ node_compute_visibility_and_filters (GtkFileSystemModel *model,
   node_set_visible_and_filtered_out (model, id, visible, filtered_out, selectable);
 }
 
+/*** Computing visibility on multiple threads ***/
+
+/* Whole directories get filtered at once when they are loaded and
+ * when the filter changes. With file filters doing glob and mime type
+ * matching that is too slow for the main thread when directories
+ * contain hundreds of thousands of files.
+ *
+ * So the nodes get split into chunks that are handled on a thread
+ * pool. The main thread handles one chunk itself and then waits for
+ * the others, so neither the model nor the filter can change while
+ * other threads look at them. Only the nodes themselves and their
+ * infos are modified, and every node belongs to one chunk only.
+ */
+#define PARALLEL_MIN_CHUNK_SIZE 256
+#define PARALLEL_MAX_CHUNKS 64
+
+typedef struct _VisibilityJob VisibilityJob;
+
+struct _VisibilityJob
+{
+  GtkFileSystemModel *model;
+  guint start;
+  guint end;
+};
+
+/* Like node_compute_visibility_and_filters(), but leaves invalidating
+ * the rows of nodes that changed visibility to the caller. */
+static void
+node_compute_visibility_and_filters_range (GtkFileSystemModel *model,
+                                           guint               start,
+                                           guint               end)
+{
+  guint i;
+
+  for (i = start; i < end; i++)
+    {
+      FileModelNode *node = get_node (model, i);
+      gboolean filtered_out;
+      gboolean visible;
+      gboolean selectable;
+
+      filtered_out = node_should_be_filtered_out (model, i);
+      visible = node_should_be_visible (model, i, filtered_out);
+      selectable = node_should_be_selectable (model, i);
+
+      g_file_info_set_attribute_boolean (node->info, "filechooser::filtered-out", filtered_out);
+      g_file_info_set_attribute_boolean (node->info, "filechooser::selectable", selectable);
+      g_file_info_set_attribute_boolean (node->info, "filechooser::visible", visible);
+
+      node->filtered_out = filtered_out;
+      node->visible = visible;
+      node->frozen_add = FALSE;
+    }
+}
+
+static void
+visibility_job_run (gpointer data)
+{
+  VisibilityJob *job = data;
+
+  node_compute_visibility_and_filters_range (job->model, job->start, job->end);
+}
+
+/* Computes visibility of the nodes from @start to the end and
+ * clears their frozen_add flag, then invalidates their rows */
+static void
+node_compute_visibility_and_filters_from (GtkFileSystemModel *model,
+                                          guint               start)
+{
+  VisibilityJob job_list[PARALLEL_MAX_CHUNKS];
+  guint i, n_items, n_chunks;
+  gint64 before G_GNUC_UNUSED;
+
+  if (start >= model->files->len)
+    return;
+
+  before = GDK_PROFILER_CURRENT_TIME;
+
+  n_items = model->files->len - start;
+  if (model->filter == NULL || !gtk_filter_is_thread_safe (GTK_FILTER (model->filter)))
+    n_chunks = 1;
+  else
+    n_chunks = MIN (MIN (g_get_num_processors (), PARALLEL_MAX_CHUNKS),
+                    n_items / PARALLEL_MIN_CHUNK_SIZE);
+
+  if (n_chunks <= 1)
+    {
+      node_compute_visibility_and_filters_range (model, start, model->files->len);
+    }
+  else
+    {
+      for (i = 0; i < n_chunks; i++)
+        {
+          job_list[i] = (VisibilityJob) {
+                          .model = model,
+                          .start = start + (guint64) n_items * i / n_chunks,
+                          .end = start + (guint64) n_items * (i + 1) / n_chunks,
+                        };
+        }
+
+      gtk_parallel_run (job_list, sizeof (VisibilityJob), n_chunks, visibility_job_run);
+    }
+
+  node_invalidate_index (model, start);
+
+  gdk_profiler_end_markf (before, "file chooser filter", "%u files in %u chunks", n_items, MAX (n_chunks, 1));
+}
+
 static guint
 node_get_for_file (GtkFileSystemModel *model,
                    GFile              *file)
@@ -370,8 +484,6 @@ freeze_updates (GtkFileSystemModel *model)
 static void
 gtk_file_system_model_refilter_all (GtkFileSystemModel *model)
 {
-  guint i;
-
   if (model->frozen)
     {
       model->filter_on_thaw = TRUE;
@@ -380,8 +492,7 @@ gtk_file_system_model_refilter_all (GtkFileSystemModel *model)
 
   freeze_updates (model);
 
-  for (i = 0; i < model->files->len; i++)
-    node_compute_visibility_and_filters (model, i);
+  node_compute_visibility_and_filters_from (model, 0);
 
   g_list_model_items_changed (G_LIST_MODEL (model), 0, model->files->len, model->files->len);
   model->filter_on_thaw = FALSE;
@@ -407,26 +518,23 @@ thaw_updates (GtkFileSystemModel *model)
     gtk_file_system_model_refilter_all (model);
   if (stuff_added)
     {
-      guint i;
-      guint changed_idx = G_MAXUINT;
+      guint changed_idx;
 
-      for (i = 0; i < model->files->len; i++)
-        {
-          FileModelNode *node = get_node (model, i);
+      /* Files get appended while frozen, so the added ones are at the end */
+      for (changed_idx = model->files->len;
+           changed_idx > 0 && get_node (model, changed_idx - 1)->frozen_add;
+           changed_idx--)
+        ;
 
-          if (!node->frozen_add)
-            continue;
+      /* Refiltering took care of them already */
+      if (changed_idx < model->files->len)
+        {
+          node_compute_visibility_and_filters_from (model, changed_idx);
 
-          node->frozen_add = FALSE;
-          node_compute_visibility_and_filters (model, i);
-          if (changed_idx == G_MAXUINT)
-            changed_idx = i;
+          g_list_model_items_changed (G_LIST_MODEL (model), changed_idx,
+                                      model->files->len - changed_idx,
+                                      model->files->len - changed_idx);
         }
-
-      if (changed_idx != G_MAXUINT)
-        g_list_model_items_changed (G_LIST_MODEL (model), changed_idx,
-                                    model->files->len - changed_idx,
-                                    model->files->len - changed_idx);
     }
 }
 
@@ -592,6 +700,23 @@ gtk_file_system_model_closed_enumerator (GObject      *object,
   g_file_enumerator_close_finish (G_FILE_ENUMERATOR (object), res, NULL);
 }
 
+/* Reports how long it took until the first files showed up */
+static void
+gtk_file_system_model_mark_first_files (GtkFileSystemModel *model)
+{
+  if (model->shown_first_files)
+    return;
+
+  model->shown_first_files = TRUE;
+
+  if (GDK_PROFILER_IS_RUNNING)
+    {
+      char *uri = g_file_get_uri (model->dir);
+      gdk_profiler_end_markf (model->load_start, "file chooser first files", "%u files in %s", model->files->len, uri);
+      g_free (uri);
+    }
+}
+
 static gboolean
 thaw_func (gpointer data)
 {
@@ -600,6 +725,8 @@ thaw_func (gpointer data)
   thaw_updates (model);
   model->dir_thaw_source = 0;
 
+  gtk_file_system_model_mark_first_files (model);
+
   return FALSE;
 }
 
@@ -670,6 +797,15 @@ gtk_file_system_model_got_files (GObject      *object,
               thaw_updates (model);
             }
 
+          gtk_file_system_model_mark_first_files (model);
+
+          if (GDK_PROFILER_IS_RUNNING)
+            {
+              char *uri = g_file_get_uri (model->dir);
+              gdk_profiler_end_markf (model->load_start, "file chooser load", "%u files in %s", model->files->len, uri);
+              g_free (uri);
+            }
+
           g_signal_emit (model, file_system_model_signals[FINISHED_LOADING], 0, error);
         }
 
@@ -821,6 +957,7 @@ gtk_file_system_model_set_directory (GtkFileSystemModel *model,
 
   model->dir = g_object_ref (dir);
   model->attributes = g_strdup (attributes);
+  model->load_start = GDK_PROFILER_CURRENT_TIME;
 
   g_file_enumerate_children_async (model->dir,
                                    attributes,
@@ -19,7 +19,7 @@
 
 #include "config.h"
 
-#include "gtkfilter.h"
+#include "gtkfilterprivate.h"
 
 #include "gtktypebuiltins.h"
 #include "gtkprivate.h"
@@ -45,6 +45,10 @@
  *
  * However, in particular for large lists or complex search methods, it is
  * also possible to subclass `GtkFilter` and provide one's own filter.
+ *
+ * Subclasses whose match function may be called from other threads can
+ * implement the `is_thread_safe` vfunc to return %TRUE. Models like
+ * [class@Gtk.FilterListModel] then match big lists on multiple threads.
  */
 
 enum {
@@ -71,6 +75,12 @@ gtk_filter_default_get_strictness (GtkFilter *self)
   return GTK_FILTER_MATCH_SOME;
 }
 
+static gboolean
+gtk_filter_default_is_thread_safe (GtkFilter *self)
+{
+  return FALSE;
+}
+
 static void
 gtk_filter_class_init (GtkFilterClass *class)
 {
@@ -78,6 +88,7 @@ gtk_filter_class_init (GtkFilterClass *class)
 
   class->match = gtk_filter_default_match;
   class->get_strictness = gtk_filter_default_get_strictness;
+  class->is_thread_safe = gtk_filter_default_is_thread_safe;
 
   /**
    * GtkFilter::changed:
@@ -158,6 +169,25 @@ gtk_filter_get_strictness (GtkFilter *self)
   return GTK_FILTER_GET_CLASS (self)->get_strictness (self);
 }
 
+/*<private>
+ * gtk_filter_is_thread_safe:
+ * @self: a `GtkFilter`
+ *
+ * Checks if gtk_filter_match() may be called from threads other
+ * than the main thread, while the main thread is not modifying
+ * the filter or the items.
+ *
+ * Filters opt into this by implementing the `is_thread_safe`
+ * vfunc, it is %FALSE by default.
+ *
+ * Returns: %TRUE if @self can be used from other threads
+ **/
+gboolean
+gtk_filter_is_thread_safe (GtkFilter *self)
+{
+  return GTK_FILTER_GET_CLASS (self)->is_thread_safe (self);
+}
+
 /**
  * gtk_filter_changed:
  * @self: a `GtkFilter`
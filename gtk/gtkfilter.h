@@ -86,9 +86,10 @@ struct _GtkFilterClass
 
   /* optional */
   GtkFilterMatch        (* get_strictness)                      (GtkFilter              *self);
+  /* optional, Since: 4.12 */
+  gboolean              (* is_thread_safe)                      (GtkFilter              *self);
 
   /* Padding for future expansion */
-  void (*_gtk_reserved1) (void);
   void (*_gtk_reserved2) (void);
   void (*_gtk_reserved3) (void);
   void (*_gtk_reserved4) (void);
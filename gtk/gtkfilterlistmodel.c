@@ -22,8 +22,11 @@
 #include "gtkfilterlistmodel.h"
 
 #include "gtkbitset.h"
+#include "gtkfilterprivate.h"
+#include "gtkparallelprivate.h"
 #include "gtkprivate.h"
 #include "gtksectionmodelprivate.h"
+#include "gtkstringfilterprivate.h"
 
 /**
  * GtkFilterListModel:
@@ -36,7 +39,9 @@
  *
  * The model can be set up to do incremental filtering, so that
  * filtering long lists doesn't block the UI. See
- * [method@Gtk.FilterListModel.set_incremental] for details.
+ * [method@Gtk.FilterListModel.set_incremental] for details. Filters
+ * that support it can also be run on multiple threads, see
+ * [method@Gtk.FilterListModel.set_parallel].
  *
  * `GtkFilterListModel` passes through sections from the underlying model.
  */
@@ -48,6 +53,7 @@ enum {
   PROP_ITEM_TYPE,
   PROP_MODEL,
   PROP_N_ITEMS,
+  PROP_PARALLEL,
   PROP_PENDING,
   NUM_PROPERTIES
 };
@@ -60,10 +66,13 @@ struct _GtkFilterListModel
   GtkFilter *filter;
   GtkFilterMatch strictness;
   gboolean incremental;
+  gboolean parallel;
 
   GtkBitset *matches; /* NULL if strictness != GTK_FILTER_MATCH_SOME */
   GtkBitset *pending; /* not yet filtered items or NULL if all filtered */
   guint pending_cb; /* idle callback handle */
+
+  GtkStringFilterCache *string_cache; /* if filter is a GtkStringFilter using an index */
 };
 
 struct _GtkFilterListModelClass
@@ -243,6 +252,9 @@ gtk_filter_list_model_run_filter_on_item (GtkFilterListModel *self,
   /* all other cases should have beeen optimized away */
   g_assert (self->strictness == GTK_FILTER_MATCH_SOME);
 
+  if (self->string_cache)
+    return gtk_string_filter_cache_match (self->string_cache, self->model, position);
+
   item = g_list_model_get_item (self->model, position);
   visible = gtk_filter_match (self->filter, item);
   g_object_unref (item);
@@ -250,12 +262,131 @@ gtk_filter_list_model_run_filter_on_item (GtkFilterListModel *self,
   return visible;
 }
 
+/* Parallel filtering
+ *
+ * When the filter is thread-safe, the pending items are split into
+ * chunks that get filtered on a thread pool. The items are looked up
+ * on the main thread, because models are not thread-safe, and the
+ * main thread waits for all chunks to be done, so neither the items
+ * nor the filter change while other threads look at them.
+ *
+ * When filtering incrementally, every step filters one chunk per
+ * thread, so the model is done sooner without blocking for longer.
+ */
+#define GTK_FILTER_PARALLEL_MIN_CHUNK_SIZE 256
+#define GTK_FILTER_PARALLEL_MAX_CHUNKS 64
+
+typedef struct _GtkFilterJob GtkFilterJob;
+
+struct _GtkFilterJob
+{
+  GtkFilter *filter;
+  GtkStringFilterCache *string_cache;
+
+  gpointer *items;
+  guint *positions;
+  gboolean *results;
+  gsize n_items;
+};
+
+static void
+gtk_filter_job_run (gpointer data)
+{
+  GtkFilterJob *job = data;
+  gsize i;
+
+  for (i = 0; i < job->n_items; i++)
+    {
+      if (job->string_cache)
+        job->results[i] = gtk_string_filter_cache_match_item (job->string_cache, job->items[i], job->positions[i]);
+      else
+        job->results[i] = gtk_filter_match (job->filter, job->items[i]);
+    }
+}
+
+/* Returns 1 if the filter can't be run in parallel */
+static guint
+gtk_filter_list_model_get_max_chunks (GtkFilterListModel *self)
+{
+  if (!self->parallel ||
+      g_get_num_processors () < 2 ||
+      !gtk_filter_is_thread_safe (self->filter))
+    return 1;
+
+  return MIN (g_get_num_processors (), GTK_FILTER_PARALLEL_MAX_CHUNKS);
+}
+
+/* Filters the first @n_items pending items in @n_chunks chunks.
+ * Returns the same as the iteration in gtk_filter_list_model_run_filter().
+ */
+static gboolean
+gtk_filter_list_model_run_filter_parallel (GtkFilterListModel *self,
+                                           guint               n_items,
+                                           guint               n_chunks,
+                                           guint              *next_pos)
+{
+  GtkFilterJob job_list[GTK_FILTER_PARALLEL_MAX_CHUNKS];
+  GtkBitsetIter iter;
+  gpointer *items;
+  guint *positions;
+  gboolean *results;
+  guint i, pos;
+  gboolean more;
+
+  items = g_new (gpointer, n_items);
+  positions = g_new (guint, n_items);
+  results = g_new (gboolean, n_items);
+
+  for (i = 0, more = gtk_bitset_iter_init_first (&iter, self->pending, &pos);
+       i < n_items && more;
+       i++, more = gtk_bitset_iter_next (&iter, &pos))
+    {
+      positions[i] = pos;
+      items[i] = g_list_model_get_item (self->model, pos);
+    }
+  g_assert (i == n_items);
+
+  if (self->string_cache)
+    gtk_string_filter_cache_validate (self->string_cache);
+
+  for (i = 0; i < n_chunks; i++)
+    {
+      guint start = (guint64) n_items * i / n_chunks;
+      guint end = (guint64) n_items * (i + 1) / n_chunks;
+
+      job_list[i] = (GtkFilterJob) {
+                      .filter = self->filter,
+                      .string_cache = self->string_cache,
+                      .items = items + start,
+                      .positions = positions + start,
+                      .results = results + start,
+                      .n_items = end - start,
+                    };
+    }
+
+  gtk_parallel_run (job_list, sizeof (GtkFilterJob), n_chunks, gtk_filter_job_run);
+
+  for (i = 0; i < n_items; i++)
+    {
+      if (results[i])
+        gtk_bitset_add (self->matches, positions[i]);
+      g_object_unref (items[i]);
+    }
+
+  g_free (items);
+  g_free (positions);
+  g_free (results);
+
+  *next_pos = pos;
+  return more;
+}
+
 static void
 gtk_filter_list_model_run_filter (GtkFilterListModel *self,
                                   guint               n_steps)
 {
   GtkBitsetIter iter;
-  guint i, pos;
+  guint i, pos, n_items, n_chunks;
   gboolean more;
 
   g_return_if_fail (GTK_IS_FILTER_LIST_MODEL (self));
@@ -263,12 +394,23 @@ gtk_filter_list_model_run_filter (GtkFilterListModel *self,
   if (self->pending == NULL)
     return;
 
-  for (i = 0, more = gtk_bitset_iter_init_first (&iter, self->pending, &pos);
-       i < n_steps && more;
-       i++, more = gtk_bitset_iter_next (&iter, &pos))
+  n_items = MIN (n_steps, gtk_bitset_get_size (self->pending));
+  n_chunks = MIN (gtk_filter_list_model_get_max_chunks (self),
+                  n_items / GTK_FILTER_PARALLEL_MIN_CHUNK_SIZE);
+
+  if (n_chunks > 1)
+    {
+      more = gtk_filter_list_model_run_filter_parallel (self, n_items, n_chunks, &pos);
+    }
+  else
     {
-      if (gtk_filter_list_model_run_filter_on_item (self, pos))
-        gtk_bitset_add (self->matches, pos);
+      for (i = 0, more = gtk_bitset_iter_init_first (&iter, self->pending, &pos);
+           i < n_steps && more;
+           i++, more = gtk_bitset_iter_next (&iter, &pos))
+        {
+          if (gtk_filter_list_model_run_filter_on_item (self, pos))
+            gtk_bitset_add (self->matches, pos);
+        }
     }
 
   if (more)
@@ -326,7 +468,7 @@ gtk_filter_list_model_run_filter_cb (gpointer data)
   GtkBitset *old;
 
   old = gtk_bitset_copy (self->matches);
-  gtk_filter_list_model_run_filter (self, 512);
+  gtk_filter_list_model_run_filter (self, 512 * gtk_filter_list_model_get_max_chunks (self));
 
   if (self->pending == NULL)
     gtk_filter_list_model_stop_filtering (self);
@@ -379,6 +521,9 @@ gtk_filter_list_model_items_changed_cb (GListModel         *model,
 {
   guint filter_removed, filter_added;
 
+  if (self->string_cache)
+    gtk_string_filter_cache_splice (self->string_cache, position, removed, added);
+
   switch (self->strictness)
     {
     case GTK_FILTER_MATCH_NONE:
@@ -444,6 +589,10 @@ gtk_filter_list_model_set_property (GObject      *object,
       gtk_filter_list_model_set_model (self, g_value_get_object (value));
       break;
 
+    case PROP_PARALLEL:
+      gtk_filter_list_model_set_parallel (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -480,6 +629,10 @@ gtk_filter_list_model_get_property (GObject     *object,
       g_value_set_uint (value, gtk_filter_list_model_get_n_items (G_LIST_MODEL (self)));
       break;
 
+    case PROP_PARALLEL:
+      g_value_set_boolean (value, self->parallel);
+      break;
+
     case PROP_PENDING:
       g_value_set_uint (value, gtk_filter_list_model_get_pending (self));
       break;
@@ -500,6 +653,7 @@ gtk_filter_list_model_clear_model (GtkFilterListModel *self)
   g_signal_handlers_disconnect_by_func (self->model, gtk_filter_list_model_items_changed_cb, self);
   g_signal_handlers_disconnect_by_func (self->model, gtk_filter_list_model_sections_changed_cb, self);
   g_clear_object (&self->model);
+  g_clear_pointer (&self->string_cache, gtk_string_filter_cache_free);
   if (self->matches)
     gtk_bitset_remove_all (self->matches);
 }
@@ -631,6 +785,22 @@ gtk_filter_list_model_refilter (GtkFilterListModel *self,
             pending = gtk_bitset_copy (old);
             break;
           }
+
+        /* Prepared strings are only kept for the index, as they go
+         * stale when items change without ::items-changed */
+        if (GTK_IS_STRING_FILTER (self->filter) &&
+            gtk_string_filter_get_use_index (GTK_STRING_FILTER (self->filter)))
+          {
+            if (self->string_cache == NULL)
+              self->string_cache = gtk_string_filter_cache_new (GTK_STRING_FILTER (self->filter),
+                                                                g_list_model_get_n_items (self->model));
+            gtk_string_filter_cache_filter_candidates (self->string_cache, self->model, pending);
+          }
+        else
+          {
+            g_clear_pointer (&self->string_cache, gtk_string_filter_cache_free);
+          }
+
         gtk_filter_list_model_start_filtering (self, pending);
 
         gtk_filter_list_model_emit_items_changed_for_changes (self, old);
@@ -653,6 +823,7 @@ gtk_filter_list_model_clear_filter (GtkFilterListModel *self)
     return;
 
   g_signal_handlers_disconnect_by_func (self->filter, gtk_filter_list_model_filter_changed_cb, self);
+  g_clear_pointer (&self->string_cache, gtk_string_filter_cache_free);
   g_clear_object (&self->filter);
 }
 
@@ -731,6 +902,18 @@ gtk_filter_list_model_class_init (GtkFilterListModelClass *class)
                        0, G_MAXUINT, 0,
                        G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GtkFilterListModel:parallel: (attributes org.gtk.Property.get=gtk_filter_list_model_get_parallel org.gtk.Property.set=gtk_filter_list_model_set_parallel)
+   *
+   * If the model should filter items using multiple threads.
+   *
+   * Since: 4.12
+   */
+  properties[PROP_PARALLEL] =
+      g_param_spec_boolean ("parallel", NULL, NULL,
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkFilterListModel:pending: (attributes org.gtk.Property.get=gtk_filter_list_model_get_pending)
    *
@@ -978,6 +1161,68 @@ gtk_filter_list_model_get_incremental (GtkFilterListModel *self)
   return self->incremental;
 }
 
+/**
+ * gtk_filter_list_model_set_parallel: (attributes org.gtk.Method.set_property=parallel)
+ * @self: a `GtkFilterListModel`
+ * @parallel: %TRUE to filter using multiple threads
+ *
+ * Sets the filter model to filter long lists using multiple threads.
+ *
+ * When parallel filtering is enabled and the filter supports it, the
+ * `GtkFilterListModel` splits the items to filter into chunks and
+ * filters them on a pool of threads. When filtering incrementally,
+ * every step filters one chunk per thread, so filtering finishes
+ * sooner.
+ *
+ * Only filters that look up properties of the items, like
+ * [class@Gtk.StringFilter] and [class@Gtk.BoolFilter] with property
+ * expressions, and [class@Gtk.MultiFilter]s made of such filters, can
+ * filter in parallel. Other filters and short lists are filtered as
+ * if parallel filtering was disabled.
+ *
+ * Note that when filtering in parallel, the properties used for
+ * filtering will be read from other threads, while the main thread
+ * waits for filtering to finish. So their getters must not depend on
+ * being called from the main thread.
+ *
+ * By default, parallel filtering is disabled.
+ *
+ * Since: 4.12
+ */
+void
+gtk_filter_list_model_set_parallel (GtkFilterListModel *self,
+                                    gboolean            parallel)
+{
+  g_return_if_fail (GTK_IS_FILTER_LIST_MODEL (self));
+
+  if (self->parallel == parallel)
+    return;
+
+  self->parallel = parallel;
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PARALLEL]);
+}
+
+/**
+ * gtk_filter_list_model_get_parallel: (attributes org.gtk.Method.get_property=parallel)
+ * @self: a `GtkFilterListModel`
+ *
+ * Returns whether parallel filtering is enabled.
+ *
+ * See [method@Gtk.FilterListModel.set_parallel].
+ *
+ * Returns: %TRUE if parallel filtering is enabled
+ *
+ * Since: 4.12
+ */
+gboolean
+gtk_filter_list_model_get_parallel (GtkFilterListModel *self)
+{
+  g_return_val_if_fail (GTK_IS_FILTER_LIST_MODEL (self), FALSE);
+
+  return self->parallel;
+}
+
 /**
  * gtk_filter_list_model_get_pending: (attributes org.gtk.Method.get_property=pending)
  * @self: a `GtkFilterListModel`
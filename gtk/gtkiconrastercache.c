@@ -0,0 +1,452 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkiconrastercacheprivate.h"
+
+#include "gtkdebug.h"
+#include "gtkprivate.h"
+#include "gdk/gdkmemoryformatprivate.h"
+
+#include <gio/gio.h>
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+/* Rasterizing SVG icons is expensive, symbolic icons even more so,
+ * as they are rendered once per color plane. So we keep the results
+ * in $XDG_CACHE_HOME/gtk-4.0/icons, one file per icon file, size and
+ * scale.
+ *
+ * The files are named after a hash of everything that goes into the
+ * result, including the mtime in nanoseconds, size and inode of the
+ * icon file, so changed icons never hit stale entries. They are written
+ * atomically and never modified, so they can be memory-mapped and the
+ * pixels used directly. Processes loading the same icons share the pages.
+ *
+ * Files are written on a worker thread, so the disk I/O doesn't delay
+ * painting. The cache is limited to GTK_ICON_RASTER_CACHE_SIZE kilobytes,
+ * when it grows larger, the files that were least recently accessed are
+ * deleted. Setting the size to 0 turns the cache off.
+ */
+
+#define RASTER_CACHE_MAGIC "GtkIcon\1"
+#define RASTER_CACHE_VERSION 2
+
+/* Bigger icons are rare and not worth the disk space */
+#define MAX_CACHED_SIZE (1024 * 1024)
+
+/* In kilobytes */
+#define DEFAULT_CACHE_SIZE (64 * 1024)
+
+typedef struct
+{
+  char magic[8];
+  guint32 width;
+  guint32 height;
+  guint32 stride;
+  guint32 format;
+} RasterHeader;
+
+typedef struct
+{
+  char *path;
+  GdkTexture *texture;
+} StoreJob;
+
+typedef struct
+{
+  char *path;
+  guint64 atime;
+  guint64 size;
+} CacheFile;
+
+static const char *
+get_cache_dir (void)
+{
+  static const char *cache_dir = NULL;
+
+  if (g_once_init_enter (&cache_dir))
+    {
+      char *dir = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "icons", NULL);
+      g_once_init_leave (&cache_dir, dir);
+    }
+
+  return cache_dir;
+}
+
+/* In bytes, 0 if the cache is turned off */
+static guint64
+get_max_cache_size (void)
+{
+  static gsize max_size = 0;
+
+  if (g_once_init_enter (&max_size))
+    {
+      const char *env = g_getenv ("GTK_ICON_RASTER_CACHE_SIZE");
+      guint64 size = DEFAULT_CACHE_SIZE;
+
+      if (env != NULL && !g_ascii_string_to_unsigned (env, 10, 0, G_MAXSIZE / 1024 - 1, &size, NULL))
+        {
+          g_warning ("Invalid value for GTK_ICON_RASTER_CACHE_SIZE: %s", env);
+          size = DEFAULT_CACHE_SIZE;
+        }
+
+      /* g_once_init_leave() doesn't take 0 */
+      g_once_init_leave (&max_size, size * 1024 + 1);
+    }
+
+  return max_size - 1;
+}
+
+static char *
+get_cache_path (const char *filename,
+                int         pixel_size,
+                int         scale,
+                gboolean    symbolic)
+{
+  GFile *file;
+  GFileInfo *info;
+  GChecksum *checksum;
+  gint64 values[9];
+  char *path;
+
+  file = g_file_new_for_path (filename);
+  info = g_file_query_info (file,
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED_NSEC ","
+                            G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                            G_FILE_ATTRIBUTE_UNIX_INODE,
+                            G_FILE_QUERY_INFO_NONE,
+                            NULL, NULL);
+  g_object_unref (file);
+  if (info == NULL)
+    return NULL;
+
+  /* The cache files are in native byte order */
+  values[0] = G_BYTE_ORDER;
+  values[1] = RASTER_CACHE_VERSION;
+  values[2] = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+  values[3] = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_NSEC);
+  values[4] = g_file_info_get_size (info);
+  values[5] = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_UNIX_INODE);
+  values[6] = pixel_size;
+  values[7] = scale;
+  values[8] = symbolic;
+
+  g_object_unref (info);
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, (const guchar *) filename, strlen (filename) + 1);
+  g_checksum_update (checksum, (const guchar *) values, sizeof (values));
+
+  path = g_build_filename (get_cache_dir (), g_checksum_get_string (checksum), NULL);
+
+  g_checksum_free (checksum);
+
+  return path;
+}
+
+/*
+ * gtk_icon_raster_cache_lookup:
+ * @filename: the icon file
+ * @pixel_size: the size the icon is rasterized at
+ * @scale: the scale the icon is rasterized for
+ * @symbolic: whether the icon is rasterized as a symbolic icon
+ * @cache_path: (out) (transfer full) (optional): return location for
+ *   the path to pass to gtk_icon_raster_cache_store() if the icon is
+ *   not in the cache
+ *
+ * Looks up the result of rasterizing the icon in @filename.
+ *
+ * The path is determined before the icon is rasterized, so the
+ * result is not stored under the name of a file that changed in
+ * the meantime. It is set to %NULL if the cache is turned off.
+ *
+ * Returns: (transfer full) (nullable): the texture or %NULL if
+ *   it is not in the cache
+ */
+GdkTexture *
+gtk_icon_raster_cache_lookup (const char  *filename,
+                              int          pixel_size,
+                              int          scale,
+                              gboolean     symbolic,
+                              char       **cache_path)
+{
+  GMappedFile *map;
+  RasterHeader header;
+  GBytes *bytes, *pixels;
+  GdkTexture *texture;
+  char *path;
+  gsize size, pixels_size;
+
+  if (cache_path)
+    *cache_path = NULL;
+
+  if (get_max_cache_size () == 0)
+    return NULL;
+
+  path = get_cache_path (filename, pixel_size, scale, symbolic);
+  if (path == NULL)
+    return NULL;
+
+  map = g_mapped_file_new (path, FALSE, NULL);
+  if (map == NULL)
+    {
+      if (cache_path)
+        *cache_path = path;
+      else
+        g_free (path);
+      return NULL;
+    }
+
+  texture = NULL;
+  size = g_mapped_file_get_length (map);
+  if (size < sizeof (RasterHeader))
+    goto out;
+
+  memcpy (&header, g_mapped_file_get_contents (map), sizeof (RasterHeader));
+
+  if (memcmp (header.magic, RASTER_CACHE_MAGIC, sizeof (header.magic)) != 0 ||
+      header.width == 0 || header.height == 0 ||
+      header.format >= GDK_MEMORY_N_FORMATS ||
+      header.stride / gdk_memory_format_bytes_per_pixel (header.format) < header.width ||
+      !g_size_checked_mul (&pixels_size, header.stride, header.height) ||
+      pixels_size != size - sizeof (RasterHeader))
+    {
+      GTK_DEBUG (ICONTHEME, "Ignoring broken icon cache file %s", path);
+      goto out;
+    }
+
+  bytes = g_mapped_file_get_bytes (map);
+  pixels = g_bytes_new_from_bytes (bytes, sizeof (RasterHeader), pixels_size);
+  texture = gdk_memory_texture_new (header.width, header.height,
+                                    header.format,
+                                    pixels,
+                                    header.stride);
+  g_bytes_unref (pixels);
+  g_bytes_unref (bytes);
+
+out:
+  g_mapped_file_unref (map);
+  g_free (path);
+
+  return texture;
+}
+
+static int
+compare_atime (gconstpointer a,
+               gconstpointer b)
+{
+  const CacheFile *fa = a;
+  const CacheFile *fb = b;
+
+  return (fa->atime > fb->atime) - (fa->atime < fb->atime);
+}
+
+/* Deletes the least recently accessed files until the cache is
+ * well below @max_size, and returns its size afterwards.
+ *
+ * Other processes may be writing and pruning at the same time,
+ * but they only lose their own accounting by it.
+ */
+static guint64
+prune_cache (guint64 max_size)
+{
+  GArray *files;
+  const char *name;
+  guint64 total;
+  GDir *dir;
+  guint i;
+
+  dir = g_dir_open (get_cache_dir (), 0, NULL);
+  if (dir == NULL)
+    return 0;
+
+  files = g_array_new (FALSE, FALSE, sizeof (CacheFile));
+  total = 0;
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      CacheFile file;
+      GStatBuf buf;
+
+      file.path = g_build_filename (get_cache_dir (), name, NULL);
+      if (g_stat (file.path, &buf) != 0)
+        {
+          g_free (file.path);
+          continue;
+        }
+
+      /* Lookups map the files, so atime tells when they were used,
+       * unless the file system doesn't update it */
+      file.atime = MAX (buf.st_atime, buf.st_mtime);
+      file.size = buf.st_size;
+      total += file.size;
+      g_array_append_val (files, file);
+    }
+
+  g_dir_close (dir);
+
+  if (total > max_size)
+    {
+      /* Leave some room, so we don't prune on every write */
+      guint64 target = max_size / 4 * 3;
+
+      g_array_sort (files, compare_atime);
+
+      for (i = 0; i < files->len && total > target; i++)
+        {
+          CacheFile *file = &g_array_index (files, CacheFile, i);
+
+          if (g_remove (file->path) == 0)
+            total -= file->size;
+        }
+
+      GTK_DEBUG (ICONTHEME, "Pruned icon cache to %" G_GUINT64_FORMAT " bytes", total);
+    }
+
+  for (i = 0; i < files->len; i++)
+    g_free (g_array_index (files, CacheFile, i).path);
+  g_array_free (files, TRUE);
+
+  return total;
+}
+
+static void
+store_job_free (StoreJob *job)
+{
+  g_free (job->path);
+  g_object_unref (job->texture);
+  g_free (job);
+}
+
+/* Runs on the worker thread, only one at a time */
+static void
+store_func (gpointer data,
+            gpointer user_data)
+{
+  /* Not known until we looked at the directory */
+  static guint64 cache_size = G_MAXUINT64;
+  StoreJob *job = data;
+  GdkTextureDownloader *downloader;
+  GdkMemoryFormat format;
+  RasterHeader header;
+  GBytes *pixels;
+  GError *error = NULL;
+  char *contents;
+  gsize stride, pixels_size;
+  guint64 max_size;
+
+  if (g_mkdir_with_parents (get_cache_dir (), 0755) != 0)
+    {
+      GTK_DEBUG (ICONTHEME, "Failed to create %s", get_cache_dir ());
+      store_job_free (job);
+      return;
+    }
+
+  /* Keep the format, symbolic icons need the exact channel values */
+  format = gdk_texture_get_format (job->texture);
+  downloader = gdk_texture_downloader_new (job->texture);
+  gdk_texture_downloader_set_format (downloader, format);
+  pixels = gdk_texture_downloader_download_bytes (downloader, &stride);
+  gdk_texture_downloader_free (downloader);
+
+  memcpy (header.magic, RASTER_CACHE_MAGIC, sizeof (header.magic));
+  header.width = gdk_texture_get_width (job->texture);
+  header.height = gdk_texture_get_height (job->texture);
+  header.stride = stride;
+  header.format = format;
+
+  pixels_size = stride * header.height;
+  g_assert (g_bytes_get_size (pixels) >= pixels_size);
+
+  contents = g_malloc (sizeof (RasterHeader) + pixels_size);
+  memcpy (contents, &header, sizeof (RasterHeader));
+  memcpy (contents + sizeof (RasterHeader), g_bytes_get_data (pixels, NULL), pixels_size);
+
+  /* Writes to a temporary file and renames it, so other processes
+   * never see partial files, and ones that mapped the old file keep
+   * their contents */
+  if (g_file_set_contents (job->path, contents, sizeof (RasterHeader) + pixels_size, &error))
+    {
+      max_size = get_max_cache_size ();
+
+      if (cache_size != G_MAXUINT64)
+        cache_size += sizeof (RasterHeader) + pixels_size;
+
+      if (cache_size > max_size)
+        cache_size = prune_cache (max_size);
+    }
+  else
+    {
+      GTK_DEBUG (ICONTHEME, "Failed to write icon cache file %s: %s", job->path, error->message);
+      g_error_free (error);
+    }
+
+  g_free (contents);
+  g_bytes_unref (pixels);
+  store_job_free (job);
+}
+
+static GThreadPool *
+get_store_pool (void)
+{
+  static GThreadPool *pool = NULL;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *p = g_thread_pool_new (store_func, NULL, 1, FALSE, NULL);
+      g_once_init_leave (&pool, p);
+    }
+
+  return pool;
+}
+
+/*
+ * gtk_icon_raster_cache_store:
+ * @cache_path: the path returned by gtk_icon_raster_cache_lookup()
+ * @texture: the result of rasterizing the icon
+ *
+ * Stores @texture so gtk_icon_raster_cache_lookup() finds it,
+ * in this process and in others.
+ *
+ * The file is written on a worker thread, so it may take a while
+ * until it is found.
+ */
+void
+gtk_icon_raster_cache_store (const char *cache_path,
+                             GdkTexture *texture)
+{
+  StoreJob *job;
+
+  g_return_if_fail (cache_path != NULL);
+  g_return_if_fail (GDK_IS_TEXTURE (texture));
+
+  /* Other textures may not be downloadable from other threads */
+  if (!GDK_IS_MEMORY_TEXTURE (texture))
+    return;
+
+  if ((gsize) gdk_texture_get_width (texture) * gdk_texture_get_height (texture) *
+      gdk_memory_format_bytes_per_pixel (gdk_texture_get_format (texture)) > MAX_CACHED_SIZE)
+    return;
+
+  job = g_new (StoreJob, 1);
+  job->path = g_strdup (cache_path);
+  job->texture = g_object_ref (texture);
+
+  g_thread_pool_push (get_store_pool (), job, NULL);
+}
@@ -44,6 +44,7 @@
 #include "gtkcsscolorvalueprivate.h"
 #include "gtkdebug.h"
 #include "gtkiconcacheprivate.h"
+#include "gtkiconrastercacheprivate.h"
 #include "gtkmain.h"
 #include "gtkprivate.h"
 #include "gtksettingsprivate.h"
@@ -3764,27 +3765,43 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
     {
       if (icon->is_svg)
         {
-          if (gtk_icon_paintable_is_symbolic (icon))
-            icon->texture = gdk_texture_new_from_path_symbolic (icon->filename,
-                                                                pixel_size, pixel_size,
-                                                                icon->desired_scale,
-                                                                &load_error);
-          else
+          gboolean symbolic = gtk_icon_paintable_is_symbolic (icon);
+          char *cache_path;
+
+          icon->texture = gtk_icon_raster_cache_lookup (icon->filename,
+                                                        pixel_size,
+                                                        icon->desired_scale,
+                                                        symbolic,
+                                                        &cache_path);
+          if (icon->texture == NULL)
             {
-              GFile *file = g_file_new_for_path (icon->filename);
-              GInputStream *stream = G_INPUT_STREAM (g_file_read (file, NULL, &load_error));
-
-              if (stream)
+              if (symbolic)
+                icon->texture = gdk_texture_new_from_path_symbolic (icon->filename,
+                                                                    pixel_size, pixel_size,
+                                                                    icon->desired_scale,
+                                                                    &load_error);
+              else
                 {
-                  icon->texture = gdk_texture_new_from_stream_at_scale (stream,
-                                                                        pixel_size, pixel_size,
-                                                                        TRUE, NULL,
-                                                                        &load_error);
-                  g_object_unref (stream);
+                  GFile *file = g_file_new_for_path (icon->filename);
+                  GInputStream *stream = G_INPUT_STREAM (g_file_read (file, NULL, &load_error));
+
+                  if (stream)
+                    {
+                      icon->texture = gdk_texture_new_from_stream_at_scale (stream,
+                                                                            pixel_size, pixel_size,
+                                                                            TRUE, NULL,
+                                                                            &load_error);
+                      g_object_unref (stream);
+                    }
+
+                  g_object_unref (file);
                 }
 
-              g_object_unref (file);
+              if (icon->texture && cache_path)
+                gtk_icon_raster_cache_store (cache_path, icon->texture);
             }
+
+          g_free (cache_path);
         }
       else
         {
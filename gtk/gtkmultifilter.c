@@ -22,6 +22,7 @@
 #include "gtkmultifilter.h"
 
 #include "gtkbuildable.h"
+#include "gtkfilterprivate.h"
 #include "gtktypebuiltins.h"
 
 #define GDK_ARRAY_TYPE_NAME GtkFilters
@@ -140,6 +141,21 @@ G_DEFINE_ABSTRACT_TYPE_WITH_CODE (GtkMultiFilter, gtk_multi_filter, GTK_TYPE_FIL
                                   G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_multi_filter_list_model_init)
                                   G_IMPLEMENT_INTERFACE (GTK_TYPE_BUILDABLE, gtk_multi_filter_buildable_init))
 
+static gboolean
+gtk_multi_filter_is_thread_safe (GtkFilter *filter)
+{
+  GtkMultiFilter *self = GTK_MULTI_FILTER (filter);
+  guint i;
+
+  for (i = 0; i < gtk_filters_get_size (&self->filters); i++)
+    {
+      if (!gtk_filter_is_thread_safe (gtk_filters_get (&self->filters, i)))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static void
 gtk_multi_filter_changed_cb (GtkFilter       *filter,
                              GtkFilterChange  change,
@@ -192,8 +208,11 @@ gtk_multi_filter_dispose (GObject *object)
 static void
 gtk_multi_filter_class_init (GtkMultiFilterClass *class)
 {
+  GtkFilterClass *filter_class = GTK_FILTER_CLASS (class);
   GObjectClass *object_class = G_OBJECT_CLASS (class);
 
+  filter_class->is_thread_safe = gtk_multi_filter_is_thread_safe;
+
   object_class->get_property = gtk_multi_filter_get_property;
   object_class->dispose = gtk_multi_filter_dispose;
 
@@ -22,14 +22,33 @@
 #include "gtkmultiselection.h"
 
 #include "gtkbitset.h"
+#include "gtkfilterprivate.h"
+#include "gtkparallelprivate.h"
 #include "gtksectionmodelprivate.h"
 #include "gtkselectionmodel.h"
 
+#define GDK_ARRAY_TYPE_NAME SelectedItems
+#define GDK_ARRAY_NAME selected_items
+#define GDK_ARRAY_ELEMENT_TYPE gpointer
+#define GDK_ARRAY_FREE_FUNC g_object_unref
+
+#include "gdk/gdkarrayimpl.c"
+
 /**
  * GtkMultiSelection:
  *
  * `GtkMultiSelection` is a `GtkSelectionModel` that allows selecting multiple
  * elements.
+ *
+ * The selection can be changed in bulk with
+ * [method@Gtk.SelectionModel.set_selection] and queried with
+ * [method@Gtk.SelectionModel.get_selection], both of which are cheap
+ * even for huge selections. To select items by their contents, use
+ * [method@Gtk.MultiSelection.select_matching].
+ *
+ * Selected items stay selected when the underlying model removes and
+ * re-adds them, for example when a [class@Gtk.SortListModel] reorders
+ * them.
  */
 
 struct _GtkMultiSelection
@@ -39,7 +58,9 @@ struct _GtkMultiSelection
   GListModel *model;
 
   GtkBitset *selected;
-  GHashTable *items; /* item => position */
+  /* The selected items, in the order of their positions, so that
+   * they can be found again when the model reorders them. */
+  SelectedItems items;
 };
 
 struct _GtkMultiSelectionClass
@@ -131,55 +152,92 @@ gtk_multi_selection_get_selection_in_range (GtkSelectionModel *model,
   return gtk_bitset_ref (self->selected);
 }
 
+/* The index of the item at @position in self->items */
+static guint
+gtk_multi_selection_get_rank (GtkMultiSelection *self,
+                              guint              position)
+{
+  if (position == 0)
+    return 0;
+
+  return gtk_bitset_get_size_in_range (self->selected, 0, position - 1);
+}
+
+/* Toggles the selection of all items in @changes.
+ *
+ * Only the items between the first and last change need to be
+ * looked at. If @new_items is not %NULL, it contains the items of
+ * the model by position, so they don't need to be looked up again.
+ */
 static void
 gtk_multi_selection_toggle_selection (GtkMultiSelection *self,
-                                      GtkBitset         *changes)
+                                      GtkBitset         *changes,
+                                      gpointer          *new_items)
 {
-  GListModel *model = G_LIST_MODEL (self);
-  GtkBitsetIter change_iter, selected_iter;
-  GtkBitset *selected;
-  guint change_pos, selected_pos;
-  gboolean more;
+  GtkBitsetIter old_iter, new_iter;
+  GtkBitset *old;
+  gpointer *window;
+  guint min, max, first, n_old, n_new, old_pos, new_pos, i, j;
+  gboolean old_more, new_more;
 
-  gtk_bitset_difference (self->selected, changes);
+  if (gtk_bitset_is_empty (changes))
+    return;
 
-  selected = gtk_bitset_copy (changes);
-  gtk_bitset_intersect (selected, self->selected);
+  min = gtk_bitset_get_minimum (changes);
+  max = gtk_bitset_get_maximum (changes);
 
-  if (!gtk_bitset_iter_init_first (&selected_iter, selected, &selected_pos))
-    selected_pos = G_MAXUINT;
+  old = gtk_bitset_new_range (min, max - min + 1);
+  gtk_bitset_intersect (old, self->selected);
+  first = gtk_multi_selection_get_rank (self, min);
+  n_old = gtk_bitset_get_size (old);
 
-  for (more = gtk_bitset_iter_init_first (&change_iter, changes, &change_pos);
-       more;
-       more = gtk_bitset_iter_next (&change_iter, &change_pos))
-    {
-      gpointer item = g_list_model_get_item (model, change_pos);
+  gtk_bitset_difference (self->selected, changes);
+
+  n_new = gtk_bitset_get_size_in_range (self->selected, min, max);
+  window = g_new (gpointer, n_new);
 
-      if (change_pos < selected_pos)
+  /* Merge the items that stay selected with the newly selected ones */
+  i = first;
+  j = 0;
+  old_more = gtk_bitset_iter_init_first (&old_iter, old, &old_pos);
+  new_more = gtk_bitset_iter_init_at (&new_iter, self->selected, min, &new_pos) && new_pos <= max;
+  while (old_more || new_more)
+    {
+      if (old_more && (!new_more || old_pos < new_pos))
         {
-          g_hash_table_remove (self->items, item);
-          g_object_unref (item);
+          g_object_unref (selected_items_get (&self->items, i++));
+          old_more = gtk_bitset_iter_next (&old_iter, &old_pos);
+        }
+      else if (old_more && old_pos == new_pos)
+        {
+          window[j++] = selected_items_get (&self->items, i++);
+          old_more = gtk_bitset_iter_next (&old_iter, &old_pos);
+          new_more = gtk_bitset_iter_next (&new_iter, &new_pos) && new_pos <= max;
         }
       else
         {
-          g_assert (change_pos == selected_pos);
-
-          g_hash_table_insert (self->items, item, GUINT_TO_POINTER (change_pos));
-
-          if (!gtk_bitset_iter_next (&selected_iter, &selected_pos))
-            selected_pos = G_MAXUINT;
+          if (new_items)
+            window[j++] = g_object_ref (new_items[new_pos]);
+          else
+            window[j++] = g_list_model_get_item (G_LIST_MODEL (self), new_pos);
+          new_more = gtk_bitset_iter_next (&new_iter, &new_pos) && new_pos <= max;
         }
     }
+  g_assert (i == first + n_old);
+  g_assert (j == n_new);
 
-  gtk_bitset_unref (selected);
+  selected_items_splice (&self->items, first, n_old, TRUE, window, n_new);
+
+  g_free (window);
+  gtk_bitset_unref (old);
 }
 
-static gboolean
-gtk_multi_selection_set_selection (GtkSelectionModel *model,
-                                   GtkBitset         *selected,
-                                   GtkBitset         *mask)
+static void
+gtk_multi_selection_update_selection (GtkMultiSelection *self,
+                                      GtkBitset         *selected,
+                                      GtkBitset         *mask,
+                                      gpointer          *new_items)
 {
-  GtkMultiSelection *self = GTK_MULTI_SELECTION (model);
   GtkBitset *changes;
   guint min, max, n_items;
 
@@ -202,16 +260,86 @@ gtk_multi_selection_set_selection (GtkSelectionModel *model,
     }
 
   /* actually do the change */
-  gtk_multi_selection_toggle_selection (self, changes);
+  gtk_multi_selection_toggle_selection (self, changes, new_items);
 
   gtk_bitset_unref (changes);
 
   if (min <= max)
-    gtk_selection_model_selection_changed (model, min, max - min + 1);
+    gtk_selection_model_selection_changed (GTK_SELECTION_MODEL (self), min, max - min + 1);
+}
+
+static gboolean
+gtk_multi_selection_set_selection (GtkSelectionModel *model,
+                                   GtkBitset         *selected,
+                                   GtkBitset         *mask)
+{
+  gtk_multi_selection_update_selection (GTK_MULTI_SELECTION (model), selected, mask, NULL);
 
   return TRUE;
 }
 
+/* Matching items in parallel
+ *
+ * Like GtkFilterListModel does, the items are looked up on the main
+ * thread and thread-safe filters are run on a pool of threads, while
+ * the main thread waits for them.
+ */
+#define GTK_MULTI_SELECTION_MIN_CHUNK_SIZE 256
+#define GTK_MULTI_SELECTION_MAX_CHUNKS 64
+
+typedef struct _MatchJob MatchJob;
+
+struct _MatchJob
+{
+  GtkFilter *filter;
+
+  gpointer *items;
+  gboolean *results;
+  gsize n_items;
+};
+
+static void
+match_job_run (gpointer data)
+{
+  MatchJob *job = data;
+  gsize i;
+
+  for (i = 0; i < job->n_items; i++)
+    job->results[i] = gtk_filter_match (job->filter, job->items[i]);
+}
+
+static void
+gtk_multi_selection_match_items (GtkFilter *filter,
+                                 gpointer  *items,
+                                 gboolean  *results,
+                                 guint      n_items)
+{
+  MatchJob job_list[GTK_MULTI_SELECTION_MAX_CHUNKS];
+  guint i, n_chunks;
+
+  if (g_get_num_processors () < 2 || !gtk_filter_is_thread_safe (filter))
+    n_chunks = 1;
+  else
+    n_chunks = MIN (MIN (g_get_num_processors (), GTK_MULTI_SELECTION_MAX_CHUNKS),
+                    n_items / GTK_MULTI_SELECTION_MIN_CHUNK_SIZE);
+  n_chunks = MAX (n_chunks, 1);
+
+  for (i = 0; i < n_chunks; i++)
+    {
+      guint start = (guint64) n_items * i / n_chunks;
+      guint end = (guint64) n_items * (i + 1) / n_chunks;
+
+      job_list[i] = (MatchJob) {
+                      .filter = filter,
+                      .items = items + start,
+                      .results = results + start,
+                      .n_items = end - start,
+                    };
+    }
+
+  gtk_parallel_run (job_list, sizeof (MatchJob), n_chunks, match_job_run);
+}
+
 static void
 gtk_multi_selection_selection_model_init (GtkSelectionModelInterface *iface)
 {
@@ -235,56 +363,51 @@ gtk_multi_selection_items_changed_cb (GListModel        *model,
                                       guint              added,
                                       GtkMultiSelection *self)
 {
-  GHashTableIter iter;
-  gpointer item, pos_pointer;
-  GHashTable *pending = NULL;
-  guint i;
+  GHashTable *pending;
+  gpointer *restored;
+  guint i, first, n_removed, n_restored;
+
+  /* The selected items after the change don't need to be looked at,
+   * only the ones that got removed. */
+  first = gtk_multi_selection_get_rank (self, position);
+  if (removed > 0)
+    n_removed = gtk_bitset_get_size_in_range (self->selected, position, position + removed - 1);
+  else
+    n_removed = 0;
 
   gtk_bitset_splice (self->selected, position, removed, added);
 
-  g_hash_table_iter_init (&iter, self->items);
-  while (g_hash_table_iter_next (&iter, &item, &pos_pointer))
+  if (n_removed == 0 || added == 0)
     {
-      guint pos = GPOINTER_TO_UINT (pos_pointer);
-
-      if (pos < position)
-        continue;
-      else if (pos >= position + removed)
-        g_hash_table_iter_replace (&iter, GUINT_TO_POINTER (pos - removed + added));
-      else /* if pos is in the removed range */
-        {
-          if (added == 0)
-            {
-              g_hash_table_iter_remove (&iter);
-            }
-          else
-            {
-              g_hash_table_iter_steal (&iter);
-              if (pending == NULL)
-                pending = g_hash_table_new_full (NULL, NULL, g_object_unref, NULL);
-              g_hash_table_add (pending, item);
-            }
-        }
+      selected_items_splice (&self->items, first, n_removed, FALSE, NULL, 0);
     }
-
-  for (i = position; pending != NULL && i < position + added; i++)
+  else
     {
-      item = g_list_model_get_item (model, i);
-      if (g_hash_table_contains (pending, item))
-        {
-          gtk_bitset_add (self->selected, i);
-          g_hash_table_insert (self->items, item, GUINT_TO_POINTER (i));
-          g_hash_table_remove (pending, item);
-          if (g_hash_table_size (pending) == 0)
-            g_clear_pointer (&pending, g_hash_table_unref);
-        }
-      else
+      /* Items that are removed and added again, like when they are
+       * reordered, stay selected. */
+      pending = g_hash_table_new_full (NULL, NULL, g_object_unref, NULL);
+      for (i = 0; i < n_removed; i++)
+        g_hash_table_add (pending, selected_items_get (&self->items, first + i));
+
+      restored = g_new (gpointer, MIN (n_removed, added));
+      n_restored = 0;
+      for (i = position; i < position + added && g_hash_table_size (pending) > 0; i++)
         {
+          gpointer item = g_list_model_get_item (model, i);
+
+          if (g_hash_table_steal (pending, item))
+            {
+              gtk_bitset_add (self->selected, i);
+              restored[n_restored++] = item;
+            }
           g_object_unref (item);
         }
-    }
 
-  g_clear_pointer (&pending, g_hash_table_unref);
+      selected_items_splice (&self->items, first, n_removed, TRUE, restored, n_restored);
+
+      g_hash_table_unref (pending);
+      g_free (restored);
+    }
 
   g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
   if (removed != added)
@@ -374,7 +497,7 @@ gtk_multi_selection_dispose (GObject *object)
   gtk_multi_selection_clear_model (self);
 
   g_clear_pointer (&self->selected, gtk_bitset_unref);
-  g_clear_pointer (&self->items, g_hash_table_unref);
+  selected_items_clear (&self->items);
 
   G_OBJECT_CLASS (gtk_multi_selection_parent_class)->dispose (object);
 }
@@ -429,7 +552,7 @@ static void
 gtk_multi_selection_init (GtkMultiSelection *self)
 {
   self->selected = gtk_bitset_new_empty ();
-  self->items = g_hash_table_new_full (NULL, NULL, g_object_unref, NULL);
+  selected_items_init (&self->items);
 }
 
 /**
@@ -516,7 +639,7 @@ gtk_multi_selection_set_model (GtkMultiSelection *self,
   else
     {
       gtk_bitset_remove_all (self->selected);
-      g_hash_table_remove_all (self->items);
+      selected_items_set_size (&self->items, 0);
       g_list_model_items_changed (G_LIST_MODEL (self), 0, n_items_before, 0);
       if (n_items_before)
         g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
@@ -524,3 +647,91 @@ gtk_multi_selection_set_model (GtkMultiSelection *self,
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MODEL]);
 }
+
+/**
+ * gtk_multi_selection_select_matching:
+ * @self: a `GtkMultiSelection`
+ * @filter: the `GtkFilter` deciding which items to select
+ * @unselect_rest: whether to unselect the items that don't match
+ *
+ * Selects all items that @filter matches.
+ *
+ * If @unselect_rest is %TRUE, all other items are unselected,
+ * otherwise they keep their selection state.
+ *
+ * This is a lot faster than checking the items and selecting them one
+ * by one, because the selection only changes once. Thread-safe filters
+ * like [class@Gtk.StringFilter] are run on multiple threads.
+ *
+ * The @filter is only used once, the selection does not change when
+ * the filter changes later.
+ *
+ * Since: 4.12
+ */
+void
+gtk_multi_selection_select_matching (GtkMultiSelection *self,
+                                     GtkFilter         *filter,
+                                     gboolean           unselect_rest)
+{
+  GtkBitset *selected, *mask;
+  gpointer *items;
+  gboolean *results;
+  guint i, n_items;
+
+  g_return_if_fail (GTK_IS_MULTI_SELECTION (self));
+  g_return_if_fail (GTK_IS_FILTER (filter));
+
+  n_items = gtk_multi_selection_get_n_items (G_LIST_MODEL (self));
+  if (n_items == 0)
+    return;
+
+  switch (gtk_filter_get_strictness (filter))
+    {
+    case GTK_FILTER_MATCH_NONE:
+      selected = gtk_bitset_new_empty ();
+      items = NULL;
+      break;
+
+    case GTK_FILTER_MATCH_ALL:
+      selected = gtk_bitset_new_range (0, n_items);
+      items = NULL;
+      break;
+
+    case GTK_FILTER_MATCH_SOME:
+    default:
+      items = g_new (gpointer, n_items);
+      results = g_new (gboolean, n_items);
+
+      for (i = 0; i < n_items; i++)
+        items[i] = g_list_model_get_item (self->model, i);
+
+      gtk_multi_selection_match_items (filter, items, results, n_items);
+
+      selected = gtk_bitset_new_empty ();
+      for (i = 0; i < n_items; i++)
+        {
+          if (results[i])
+            gtk_bitset_add (selected, i);
+        }
+
+      g_free (results);
+      break;
+    }
+
+  if (unselect_rest)
+    mask = gtk_bitset_new_range (0, n_items);
+  else
+    mask = gtk_bitset_ref (selected);
+
+  gtk_multi_selection_update_selection (self, selected, mask, items);
+
+  gtk_bitset_unref (mask);
+  gtk_bitset_unref (selected);
+
+  if (items)
+    {
+      for (i = 0; i < n_items; i++)
+        g_object_unref (items[i]);
+      g_free (items);
+    }
+}
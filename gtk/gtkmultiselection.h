@@ -19,8 +19,9 @@
 
 #pragma once
 
-#include <gtk/gtktypes.h>
+#include <gtk/gtkfilter.h>
 #include <gtk/gtkselectionmodel.h>
+#include <gtk/gtktypes.h>
 
 G_BEGIN_DECLS
 
@@ -38,5 +39,10 @@ GDK_AVAILABLE_IN_ALL
 void                gtk_multi_selection_set_model          (GtkMultiSelection    *self,
                                                             GListModel           *model);
 
+GDK_AVAILABLE_IN_4_12
+void                gtk_multi_selection_select_matching    (GtkMultiSelection    *self,
+                                                            GtkFilter            *filter,
+                                                            gboolean              unselect_rest);
+
 G_END_DECLS
 
@@ -0,0 +1,136 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkparallelprivate.h"
+
+/* Fork/join helper for the list models that filter or sort on
+ * multiple threads. All of them share one thread pool, so the
+ * number of threads doesn't grow with every user.
+ */
+
+typedef struct _GtkParallelJobs GtkParallelJobs;
+typedef struct _GtkParallelJob GtkParallelJob;
+
+struct _GtkParallelJobs
+{
+  GMutex mutex;
+  GCond cond;
+  guint pending;
+  GtkParallelFunc func;
+};
+
+struct _GtkParallelJob
+{
+  GtkParallelJobs *jobs;
+  gpointer data;
+};
+
+static void
+gtk_parallel_job_run (gpointer data,
+                      gpointer unused)
+{
+  GtkParallelJob *job = data;
+  GtkParallelJobs *jobs = job->jobs;
+
+  jobs->func (job->data);
+
+  g_mutex_lock (&jobs->mutex);
+  jobs->pending--;
+  if (jobs->pending == 0)
+    g_cond_signal (&jobs->cond);
+  g_mutex_unlock (&jobs->mutex);
+}
+
+static GThreadPool *
+gtk_parallel_get_thread_pool (void)
+{
+  static gsize pool__set;
+  static GThreadPool *pool;
+
+  if (g_once_init_enter (&pool__set))
+    {
+      pool = g_thread_pool_new (gtk_parallel_job_run,
+                                NULL,
+                                g_get_num_processors (),
+                                FALSE,
+                                NULL);
+
+      g_once_init_leave (&pool__set, 1);
+    }
+
+  return pool;
+}
+
+/*
+ * gtk_parallel_run:
+ * @job_list: an array of @n_jobs jobs
+ * @job_size: the size of one job in @job_list
+ * @n_jobs: the number of jobs
+ * @func: the function to call for every job
+ *
+ * Calls @func for every job in @job_list and returns when
+ * all of them are done.
+ *
+ * The first job is run in the calling thread and all the
+ * others in a thread pool. So it's fine for the jobs to refer
+ * to data on the caller's stack, but @func must not call this
+ * function again.
+ */
+void
+gtk_parallel_run (gpointer        job_list,
+                  gsize           job_size,
+                  guint           n_jobs,
+                  GtkParallelFunc func)
+{
+  GtkParallelJobs jobs;
+  GtkParallelJob *job_data;
+  guint i;
+
+  if (n_jobs == 0)
+    return;
+
+  if (n_jobs == 1)
+    {
+      func (job_list);
+      return;
+    }
+
+  g_mutex_init (&jobs.mutex);
+  g_cond_init (&jobs.cond);
+  jobs.pending = n_jobs;
+  jobs.func = func;
+
+  job_data = g_newa (GtkParallelJob, n_jobs);
+  for (i = 0; i < n_jobs; i++)
+    {
+      job_data[i].jobs = &jobs;
+      job_data[i].data = (guchar *) job_list + i * job_size;
+    }
+
+  for (i = 1; i < n_jobs; i++)
+    g_thread_pool_push (gtk_parallel_get_thread_pool (), &job_data[i], NULL);
+
+  gtk_parallel_job_run (&job_data[0], NULL);
+
+  g_mutex_lock (&jobs.mutex);
+  while (jobs.pending > 0)
+    g_cond_wait (&jobs.cond, &jobs.mutex);
+  g_mutex_unlock (&jobs.mutex);
+
+  g_mutex_clear (&jobs.mutex);
+  g_cond_clear (&jobs.cond);
+}
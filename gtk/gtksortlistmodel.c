@@ -23,6 +23,7 @@
 
 #include "gtkbitset.h"
 #include "gtkmultisorter.h"
+#include "gtkparallelprivate.h"
 #include "gtkprivate.h"
 #include "gtksectionmodel.h"
 #include "gtksorterprivate.h"
@@ -53,6 +54,15 @@
  */
 #define GTK_SORT_STEP_TIME_US (1000) /* 1 millisecond */
 
+/* Minimum number of items for sorting in parallel
+ *
+ * Below this, handing work to other threads costs more than it saves.
+ */
+#define GTK_SORT_PARALLEL_MIN_ITEMS (4096)
+
+/* Maximum number of chunks that are sorted in parallel */
+#define GTK_SORT_PARALLEL_MAX_CHUNKS (64)
+
 /**
  * GtkSortListModel:
  *
@@ -70,6 +80,9 @@
  * sorting long lists doesn't block the UI. See
  * [method@Gtk.SortListModel.set_incremental] for details.
  *
+ * Alternatively, the model can sort long lists using multiple threads,
+ * see [method@Gtk.SortListModel.set_parallel].
+ *
  * `GtkSortListModel` is a generic model and because of that it
  * cannot take advantage of any external knowledge when sorting.
  * If you run into performance issues with `GtkSortListModel`,
@@ -90,6 +103,7 @@ enum {
   PROP_ITEM_TYPE,
   PROP_MODEL,
   PROP_N_ITEMS,
+  PROP_PARALLEL,
   PROP_PENDING,
   PROP_SECTION_SORTER,
   PROP_SORTER,
@@ -105,6 +119,7 @@ struct _GtkSortListModel
   GtkSorter *section_sorter;
   GtkSorter *real_sorter;
   gboolean incremental;
+  gboolean parallel;
 
   GtkTimSort sort; /* ongoing sort operation */
   guint sort_cb; /* 0 or current ongoing sort callback */
@@ -471,6 +486,285 @@ sort_func (gconstpointer a,
   return *sa < *sb ? -1 : 1;
 }
 
+/* Parallel sorting
+ *
+ * When the sort keys are thread-safe, the keys are initialized in
+ * chunks on a thread pool. Then the positions are split into one chunk
+ * per thread, every chunk gets sorted on its own and the sorted chunks
+ * get merged pairwise until only one is left. Every merge is split
+ * into pieces of similar size again, so that all threads have work to
+ * do, even for the last merge.
+ *
+ * The main thread waits for all of that, so items are never modified
+ * while other threads look at them.
+ */
+typedef struct _GtkSortJob GtkSortJob;
+
+struct _GtkSortJob
+{
+  void (* func) (GtkSortJob *job);
+  GtkSortKeys *sort_keys;
+
+  /* init keys: items and their keys
+   * sort: the positions to sort
+   * merge: the 2 sorted ranges to merge into dest
+   */
+  gpointer *a;
+  gsize n_a;
+  gpointer *b;
+  gsize n_b;
+  gpointer *dest;
+};
+
+static void
+gtk_sort_job_init_keys (GtkSortJob *job)
+{
+  gsize i;
+
+  for (i = 0; i < job->n_a; i++)
+    gtk_sort_keys_init_key (job->sort_keys, job->a[i], job->b[i]);
+}
+
+static void
+gtk_sort_job_sort (GtkSortJob *job)
+{
+  gtk_tim_sort (job->a, job->n_a, sizeof (gpointer), sort_func, job->sort_keys);
+}
+
+static void
+gtk_sort_job_merge (GtkSortJob *job)
+{
+  gpointer *a = job->a;
+  gpointer *a_end = job->a + job->n_a;
+  gpointer *b = job->b;
+  gpointer *b_end = job->b + job->n_b;
+  gpointer *dest = job->dest;
+
+  while (a < a_end && b < b_end)
+    {
+      if (sort_func (a, b, job->sort_keys) < 0)
+        *dest++ = *a++;
+      else
+        *dest++ = *b++;
+    }
+
+  memcpy (dest, a, (a_end - a) * sizeof (gpointer));
+  dest += a_end - a;
+  memcpy (dest, b, (b_end - b) * sizeof (gpointer));
+}
+
+static void
+gtk_sort_job_run (gpointer data)
+{
+  GtkSortJob *job = data;
+
+  job->func (job);
+}
+
+static guint
+gtk_sort_list_model_get_n_chunks (gsize n_items)
+{
+  guint n_chunks;
+
+  n_chunks = MIN (g_get_num_processors (), GTK_SORT_PARALLEL_MAX_CHUNKS);
+  n_chunks = MIN (n_chunks, n_items / (GTK_SORT_PARALLEL_MIN_ITEMS / 4));
+
+  return MAX (n_chunks, 1);
+}
+
+/* Runs the first job in the calling thread and all the others
+ * in the thread pool and waits for all of them to finish.
+ */
+static void
+gtk_sort_list_model_run_jobs (GtkSortJob *job_list,
+                              guint       n_jobs)
+{
+  gtk_parallel_run (job_list, sizeof (GtkSortJob), n_jobs, gtk_sort_job_run);
+}
+
+static gboolean
+gtk_sort_list_model_should_sort_parallel (GtkSortListModel *self)
+{
+  return self->parallel &&
+         self->n_items >= GTK_SORT_PARALLEL_MIN_ITEMS &&
+         gtk_sort_keys_is_thread_safe (self->sort_keys) &&
+         g_get_num_processors () > 1;
+}
+
+static void
+gtk_sort_list_model_init_keys_parallel (GtkSortListModel *self)
+{
+  GtkSortJob job_list[GTK_SORT_PARALLEL_MAX_CHUNKS];
+  GtkBitsetIter iter;
+  gpointer *items, *keys;
+  gsize i, n;
+  guint pos, n_chunks;
+
+  n = gtk_bitset_get_size (self->missing_keys);
+  if (n == 0)
+    return;
+
+  /* Models are not thread-safe, so get the items here */
+  items = g_new (gpointer, n);
+  keys = g_new (gpointer, n);
+  i = 0;
+  for (gtk_bitset_iter_init_first (&iter, self->missing_keys, &pos);
+       gtk_bitset_iter_is_valid (&iter);
+       gtk_bitset_iter_next (&iter, &pos))
+    {
+      items[i] = g_list_model_get_item (self->model, pos);
+      keys[i] = key_from_pos (self, pos);
+      i++;
+    }
+
+  n_chunks = gtk_sort_list_model_get_n_chunks (n);
+  for (i = 0; i < n_chunks; i++)
+    {
+      gsize start = n * i / n_chunks;
+      gsize end = n * (i + 1) / n_chunks;
+
+      job_list[i] = (GtkSortJob) {
+                      .func = gtk_sort_job_init_keys,
+                      .sort_keys = self->sort_keys,
+                      .a = items + start,
+                      .n_a = end - start,
+                      .b = keys + start,
+                    };
+    }
+
+  gtk_sort_list_model_run_jobs (job_list, n_chunks);
+
+  for (i = 0; i < n; i++)
+    g_object_unref (items[i]);
+  g_free (items);
+  g_free (keys);
+
+  gtk_bitset_remove_all (self->missing_keys);
+}
+
+/* Finds how many of the first @k items of merging @a and @b are from @a */
+static gsize
+gtk_sort_list_model_merge_split (GtkSortKeys *sort_keys,
+                                 gpointer    *a,
+                                 gsize        n_a,
+                                 gpointer    *b,
+                                 gsize        n_b,
+                                 gsize        k)
+{
+  gsize lo, hi, mid;
+
+  lo = k > n_b ? k - n_b : 0;
+  hi = MIN (k, n_a);
+
+  while (lo < hi)
+    {
+      mid = (lo + hi) / 2;
+      if (sort_func (&a[mid], &b[k - mid - 1], sort_keys) < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+static void
+gtk_sort_list_model_sort_parallel (GtkSortListModel *self,
+                                   guint            *out_position,
+                                   guint            *out_n_items)
+{
+  GtkSortJob job_list[2 * GTK_SORT_PARALLEL_MAX_CHUNKS];
+  gsize bounds[GTK_SORT_PARALLEL_MAX_CHUNKS + 1];
+  gpointer *old, *buffer, *src, *dest, *tmp;
+  guint i, n_jobs, n_chunks, n_runs;
+  gsize n, start, end;
+
+  n = self->n_items;
+  old = g_memdup2 (self->positions, n * sizeof (gpointer));
+  buffer = g_new (gpointer, n);
+
+  n_chunks = gtk_sort_list_model_get_n_chunks (n);
+  for (i = 0; i <= n_chunks; i++)
+    bounds[i] = n * i / n_chunks;
+
+  for (i = 0; i < n_chunks; i++)
+    {
+      job_list[i] = (GtkSortJob) {
+                      .func = gtk_sort_job_sort,
+                      .sort_keys = self->sort_keys,
+                      .a = self->positions + bounds[i],
+                      .n_a = bounds[i + 1] - bounds[i],
+                    };
+    }
+  gtk_sort_list_model_run_jobs (job_list, n_chunks);
+
+  src = self->positions;
+  dest = buffer;
+  for (n_runs = n_chunks; n_runs > 1; n_runs = (n_runs + 1) / 2)
+    {
+      n_jobs = 0;
+      for (i = 0; i + 1 < n_runs; i += 2)
+        {
+          gpointer *a = src + bounds[i];
+          gpointer *b = src + bounds[i + 1];
+          gsize n_a = bounds[i + 1] - bounds[i];
+          gsize n_b = bounds[i + 2] - bounds[i + 1];
+          guint p, n_pieces;
+
+          n_pieces = MAX (1, n_chunks * (n_a + n_b) / n);
+          for (p = 0; p < n_pieces; p++)
+            {
+              gsize k0 = (n_a + n_b) * p / n_pieces;
+              gsize k1 = (n_a + n_b) * (p + 1) / n_pieces;
+              gsize a0 = gtk_sort_list_model_merge_split (self->sort_keys, a, n_a, b, n_b, k0);
+              gsize a1 = gtk_sort_list_model_merge_split (self->sort_keys, a, n_a, b, n_b, k1);
+
+              job_list[n_jobs++] = (GtkSortJob) {
+                                     .func = gtk_sort_job_merge,
+                                     .sort_keys = self->sort_keys,
+                                     .a = a + a0,
+                                     .n_a = a1 - a0,
+                                     .b = b + k0 - a0,
+                                     .n_b = (k1 - a1) - (k0 - a0),
+                                     .dest = dest + bounds[i] + k0,
+                                   };
+            }
+        }
+      /* an odd run out */
+      if (i < n_runs)
+        memcpy (dest + bounds[i], src + bounds[i], (bounds[i + 1] - bounds[i]) * sizeof (gpointer));
+
+      gtk_sort_list_model_run_jobs (job_list, n_jobs);
+
+      for (i = 0; i < (n_runs + 1) / 2; i++)
+        bounds[i] = bounds[2 * i];
+      bounds[(n_runs + 1) / 2] = n;
+
+      tmp = src;
+      src = dest;
+      dest = tmp;
+    }
+
+  if (src != self->positions)
+    memcpy (self->positions, src, n * sizeof (gpointer));
+  g_free (buffer);
+
+  for (start = 0; start < n; start++)
+    {
+      if (old[start] != self->positions[start])
+        break;
+    }
+  for (end = n; end > start; end--)
+    {
+      if (old[end - 1] != self->positions[end - 1])
+        break;
+    }
+  g_free (old);
+
+  *out_position = end > start ? start : 0;
+  *out_n_items = end - start;
+}
+
 static gboolean
 gtk_sort_list_model_start_sorting (GtkSortListModel *self,
                                    gsize            *runs)
@@ -488,7 +782,7 @@ gtk_sort_list_model_start_sorting (GtkSortListModel *self,
   if (self->incremental)
     gtk_tim_sort_set_max_merge_size (&self->sort, GTK_SORT_MAX_MERGE_SIZE);
 
-  if (!self->incremental)
+  if (!self->incremental || gtk_sort_list_model_should_sort_parallel (self))
     return FALSE;
 
   self->sort_cb = g_idle_add (gtk_sort_list_model_sort_cb, self);
@@ -504,6 +798,24 @@ gtk_sort_list_model_finish_sorting (GtkSortListModel *self,
 {
   gtk_tim_sort_set_max_merge_size (&self->sort, 0);
 
+  if (gtk_sort_list_model_should_sort_parallel (self))
+    {
+      gsize runs[GTK_TIM_SORT_MAX_PENDING + 1];
+
+      gtk_sort_list_model_init_keys_parallel (self);
+
+      /* When only some items changed, merging the runs that are
+       * known to be sorted already is cheaper than sorting everything */
+      gtk_tim_sort_get_runs (&self->sort, runs);
+      if (runs[0] == 0)
+        {
+          gtk_sort_list_model_sort_parallel (self, pos, n_items);
+          gtk_tim_sort_finish (&self->sort);
+          gtk_sort_list_model_stop_sorting (self, NULL);
+          return;
+        }
+    }
+
   gtk_sort_list_model_sort_step (self, TRUE, pos, n_items);
   gtk_tim_sort_finish (&self->sort);
 
@@ -815,6 +1127,10 @@ gtk_sort_list_model_set_property (GObject      *object,
       gtk_sort_list_model_set_model (self, g_value_get_object (value));
       break;
 
+    case PROP_PARALLEL:
+      gtk_sort_list_model_set_parallel (self, g_value_get_boolean (value));
+      break;
+
     case PROP_SECTION_SORTER:
       gtk_sort_list_model_set_section_sorter (self, g_value_get_object (value));
       break;
@@ -855,6 +1171,10 @@ gtk_sort_list_model_get_property (GObject     *object,
       g_value_set_uint (value, gtk_sort_list_model_get_n_items (G_LIST_MODEL (self)));
       break;
 
+    case PROP_PARALLEL:
+      g_value_set_boolean (value, self->parallel);
+      break;
+
     case PROP_PENDING:
       g_value_set_uint (value, gtk_sort_list_model_get_pending (self));
       break;
@@ -1069,6 +1389,18 @@ gtk_sort_list_model_class_init (GtkSortListModelClass *class)
                        0, G_MAXUINT, 0,
                        G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GtkSortListModel:parallel: (attributes org.gtk.Property.get=gtk_sort_list_model_get_parallel org.gtk.Property.set=gtk_sort_list_model_set_parallel)
+   *
+   * If the model should sort items using multiple threads.
+   *
+   * Since: 4.12
+   */
+  properties[PROP_PARALLEL] =
+      g_param_spec_boolean ("parallel", NULL, NULL,
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkSortListModel:pending: (attributes org.gtk.Property.get=gtk_sort_list_model_get_pending)
    *
@@ -1351,6 +1683,78 @@ gtk_sort_list_model_get_incremental (GtkSortListModel *self)
   return self->incremental;
 }
 
+/**
+ * gtk_sort_list_model_set_parallel: (attributes org.gtk.Method.set_property=parallel)
+ * @self: a `GtkSortListModel`
+ * @parallel: %TRUE to sort using multiple threads
+ *
+ * Sets the sort model to sort long lists using multiple threads.
+ *
+ * When parallel sorting is enabled and the sorter supports it, the
+ * `GtkSortListModel` computes the values to sort by and sorts the
+ * items on a pool of threads. The items are in the right place when
+ * sorting is done, just like with non-incremental sorting, which
+ * it takes precedence over.
+ *
+ * Only sorters that look up properties of the items, like
+ * [class@Gtk.StringSorter] and [class@Gtk.NumericSorter] with
+ * property expressions, and [class@Gtk.MultiSorter]s made of such
+ * sorters, can sort in parallel. Other sorters and short lists are
+ * sorted as if parallel sorting was disabled.
+ *
+ * Note that when sorting in parallel, the properties used for sorting
+ * will be read from other threads, while the main thread waits for
+ * sorting to finish. So their getters must not depend on being called
+ * from the main thread.
+ *
+ * By default, parallel sorting is disabled.
+ *
+ * Since: 4.12
+ */
+void
+gtk_sort_list_model_set_parallel (GtkSortListModel *self,
+                                  gboolean          parallel)
+{
+  g_return_if_fail (GTK_IS_SORT_LIST_MODEL (self));
+
+  if (self->parallel == parallel)
+    return;
+
+  self->parallel = parallel;
+
+  if (gtk_sort_list_model_is_sorting (self) &&
+      gtk_sort_list_model_should_sort_parallel (self))
+    {
+      guint pos, n_items;
+
+      gtk_sort_list_model_finish_sorting (self, &pos, &n_items);
+      if (n_items)
+        g_list_model_items_changed (G_LIST_MODEL (self), pos, n_items, n_items);
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PARALLEL]);
+}
+
+/**
+ * gtk_sort_list_model_get_parallel: (attributes org.gtk.Method.get_property=parallel)
+ * @self: a `GtkSortListModel`
+ *
+ * Returns whether parallel sorting is enabled.
+ *
+ * See [method@Gtk.SortListModel.set_parallel].
+ *
+ * Returns: %TRUE if parallel sorting is enabled
+ *
+ * Since: 4.12
+ */
+gboolean
+gtk_sort_list_model_get_parallel (GtkSortListModel *self)
+{
+  g_return_val_if_fail (GTK_IS_SORT_LIST_MODEL (self), FALSE);
+
+  return self->parallel;
+}
+
 /**
  * gtk_sort_list_model_get_pending: (attributes org.gtk.Method.get_property=pending)
  * @self: a `GtkSortListModel`
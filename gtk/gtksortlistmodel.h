@@ -63,6 +63,12 @@ void                    gtk_sort_list_model_set_incremental     (GtkSortListMode
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_sort_list_model_get_incremental     (GtkSortListModel       *self);
 
+GDK_AVAILABLE_IN_4_12
+void                    gtk_sort_list_model_set_parallel        (GtkSortListModel       *self,
+                                                                 gboolean                parallel);
+GDK_AVAILABLE_IN_4_12
+gboolean                gtk_sort_list_model_get_parallel        (GtkSortListModel       *self);
+
 GDK_AVAILABLE_IN_ALL
 guint                   gtk_sort_list_model_get_pending         (GtkSortListModel       *self);
 
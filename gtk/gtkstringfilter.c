@@ -19,8 +19,9 @@
 
 #include "config.h"
 
-#include "gtkstringfilter.h"
+#include "gtkstringfilterprivate.h"
 
+#include "gtkexpressionprivate.h"
 #include "gtktypebuiltins.h"
 
 /**
@@ -39,6 +40,9 @@
  *
  * It is also possible to make case-insensitive comparisons, with
  * [method@Gtk.StringFilter.set_ignore_case].
+ *
+ * For long lists, [method@Gtk.StringFilter.set_use_index] can be used
+ * to find matching items without looking at all of them.
  */
 
 struct _GtkStringFilter
@@ -50,8 +54,13 @@ struct _GtkStringFilter
 
   gboolean ignore_case;
   GtkStringFilterMatchMode match_mode;
+  gboolean use_index;
 
   GtkExpression *expression;
+
+  /* changes whenever prepared strings of items become invalid */
+  guint values_serial;
+  gboolean changing_search;
 };
 
 enum {
@@ -60,6 +69,7 @@ enum {
   PROP_IGNORE_CASE,
   PROP_MATCH_MODE,
   PROP_SEARCH,
+  PROP_USE_INDEX,
   NUM_PROPERTIES
 };
 
@@ -97,48 +107,66 @@ gtk_string_filter_has_search (GtkStringFilter *self)
   return self->search_prepared != NULL;
 }
 
-static gboolean
-gtk_string_filter_match (GtkFilter *filter,
-                         gpointer   item)
+static char *
+gtk_string_filter_prepare_item (GtkStringFilter *self,
+                                gpointer         item)
 {
-  GtkStringFilter *self = GTK_STRING_FILTER (filter);
   GValue value = G_VALUE_INIT;
   char *prepared;
-  const char *s;
-  gboolean result;
 
-  if (!gtk_string_filter_has_search (self))
-    return TRUE;
+  if (!gtk_expression_evaluate (self->expression, item, &value))
+    return NULL;
 
-  if (self->expression == NULL ||
-      !gtk_expression_evaluate (self->expression, item, &value))
-    return FALSE;
-  s = g_value_get_string (&value);
-  prepared = gtk_string_filter_prepare (self, s);
+  prepared = gtk_string_filter_prepare (self, g_value_get_string (&value));
+
+  g_value_unset (&value);
+
+  return prepared;
+}
+
+static gboolean
+gtk_string_filter_match_prepared (GtkStringFilter *self,
+                                  const char      *prepared)
+{
   if (prepared == NULL)
     return FALSE;
 
   switch (self->match_mode)
     {
     case GTK_STRING_FILTER_MATCH_MODE_EXACT:
-      result = strcmp (prepared, self->search_prepared) == 0;
-      break;
+      return strcmp (prepared, self->search_prepared) == 0;
     case GTK_STRING_FILTER_MATCH_MODE_SUBSTRING:
-      result = strstr (prepared, self->search_prepared) != NULL;
-      break;
+      return strstr (prepared, self->search_prepared) != NULL;
     case GTK_STRING_FILTER_MATCH_MODE_PREFIX:
-      result = g_str_has_prefix (prepared, self->search_prepared);
-      break;
+      return g_str_has_prefix (prepared, self->search_prepared);
     default:
       g_assert_not_reached ();
+      return FALSE;
     }
+}
+
+static gboolean
+gtk_string_filter_match (GtkFilter *filter,
+                         gpointer   item)
+{
+  GtkStringFilter *self = GTK_STRING_FILTER (filter);
+  char *prepared;
+  gboolean result;
+
+  if (!gtk_string_filter_has_search (self))
+    return TRUE;
+
+  if (self->expression == NULL)
+    return FALSE;
+
+  prepared = gtk_string_filter_prepare_item (self, item);
+  result = gtk_string_filter_match_prepared (self, prepared);
 
 #if 0
-  g_print ("%s (%s) %s %s (%s)\n", s, prepared, result ? "==" : "!=", self->search, self->search_prepared);
+  g_print ("%s %s %s (%s)\n", prepared, result ? "==" : "!=", self->search, self->search_prepared);
 #endif
 
   g_free (prepared);
-  g_value_unset (&value);
 
   return result;
 }
@@ -157,6 +185,350 @@ gtk_string_filter_get_strictness (GtkFilter *filter)
   return GTK_FILTER_MATCH_SOME;
 }
 
+static gboolean
+gtk_string_filter_is_thread_safe (GtkFilter *filter)
+{
+  GtkStringFilter *self = GTK_STRING_FILTER (filter);
+
+  return gtk_expression_is_thread_safe (self->expression);
+}
+
+/* Emits ::changed for changes that don't change the strings
+ * of the items, so they can be kept in caches.
+ */
+static void
+gtk_string_filter_search_changed (GtkStringFilter *self,
+                                  GtkFilterChange  change)
+{
+  self->changing_search = TRUE;
+  gtk_filter_changed (GTK_FILTER (self), change);
+  self->changing_search = FALSE;
+}
+
+static void
+gtk_string_filter_changed_cb (GtkStringFilter *self,
+                              GtkFilterChange  change,
+                              gpointer         unused)
+{
+  /* Somebody else told us that items changed */
+  if (!self->changing_search)
+    self->values_serial++;
+}
+
+/* Caching prepared strings
+ *
+ * If the filter uses an index, GtkFilterListModel keeps a cache of the
+ * prepared strings of its items, so they only need to be computed once
+ * and not for every search term.
+ *
+ * It also keeps an index of the trigrams - all the 3 byte sequences -
+ * contained in those strings. An item can only
+ * match the search term if it contains all the trigrams of the search
+ * term, which is true for every match mode. So that allows finding
+ * candidates without looking at all items.
+ *
+ * Appending items keeps the index valid, the new items get added to
+ * it the next time it is used. Other changes throw it away.
+ */
+
+struct _GtkStringFilterCache
+{
+  GtkStringFilter *filter;
+  guint values_serial;
+
+  char **strings;
+  guint n_items;
+
+  GHashTable *index; /* trigram => GtkBitset */
+  guint n_indexed;
+};
+
+static const char NOT_PREPARED[] = "";
+
+#define TRIGRAM(s) GUINT_TO_POINTER (((guchar) (s)[0] << 16) | ((guchar) (s)[1] << 8) | (guchar) (s)[2])
+
+static void
+gtk_string_filter_cache_clear_strings (GtkStringFilterCache *cache,
+                                       guint                 position,
+                                       guint                 n_items)
+{
+  guint i;
+
+  for (i = position; i < position + n_items; i++)
+    {
+      if (cache->strings[i] != NOT_PREPARED)
+        g_free (cache->strings[i]);
+      cache->strings[i] = (char *) NOT_PREPARED;
+    }
+}
+
+static void
+gtk_string_filter_cache_clear_index (GtkStringFilterCache *cache)
+{
+  g_clear_pointer (&cache->index, g_hash_table_unref);
+  cache->n_indexed = 0;
+}
+
+/*<private>
+ * gtk_string_filter_cache_new:
+ * @self: a `GtkStringFilter`
+ * @n_items: the number of items in the model
+ *
+ * Creates a cache for the prepared strings of the items of a model.
+ *
+ * The cache does not keep a reference to @self, so it must be freed
+ * before @self is finalized. It must be kept up to date with the
+ * model's changes by calling gtk_string_filter_cache_splice().
+ *
+ * Returns: a new cache
+ **/
+GtkStringFilterCache *
+gtk_string_filter_cache_new (GtkStringFilter *self,
+                             guint            n_items)
+{
+  GtkStringFilterCache *cache;
+
+  cache = g_new0 (GtkStringFilterCache, 1);
+  cache->filter = self;
+  cache->values_serial = self->values_serial;
+  cache->strings = g_new (char *, n_items);
+  cache->n_items = n_items;
+  gtk_string_filter_cache_clear_strings (cache, 0, n_items);
+
+  return cache;
+}
+
+void
+gtk_string_filter_cache_free (GtkStringFilterCache *cache)
+{
+  gtk_string_filter_cache_clear_strings (cache, 0, cache->n_items);
+  gtk_string_filter_cache_clear_index (cache);
+  g_free (cache->strings);
+  g_free (cache);
+}
+
+void
+gtk_string_filter_cache_splice (GtkStringFilterCache *cache,
+                                guint                 position,
+                                guint                 removed,
+                                guint                 added)
+{
+  guint n_items;
+
+  g_assert (position + removed <= cache->n_items);
+
+  n_items = cache->n_items - removed + added;
+
+  gtk_string_filter_cache_clear_strings (cache, position, removed);
+
+  if (removed > added)
+    {
+      memmove (cache->strings + position + added,
+               cache->strings + position + removed,
+               sizeof (char *) * (cache->n_items - position - removed));
+      cache->strings = g_renew (char *, cache->strings, n_items);
+    }
+  else if (removed < added)
+    {
+      cache->strings = g_renew (char *, cache->strings, n_items);
+      memmove (cache->strings + position + added,
+               cache->strings + position + removed,
+               sizeof (char *) * (cache->n_items - position - removed));
+    }
+
+  cache->n_items = n_items;
+  gtk_string_filter_cache_clear_strings (cache, position, added);
+
+  /* Appending items keeps the index valid */
+  if (position < cache->n_indexed)
+    gtk_string_filter_cache_clear_index (cache);
+}
+
+/*<private>
+ * gtk_string_filter_cache_validate:
+ * @cache: a `GtkStringFilterCache`
+ *
+ * Throws away the cached strings if the filter was told that the
+ * items changed since they were prepared.
+ *
+ * This happens automatically in the functions using the cache, except
+ * for gtk_string_filter_cache_match_item().
+ **/
+void
+gtk_string_filter_cache_validate (GtkStringFilterCache *cache)
+{
+  if (cache->values_serial == cache->filter->values_serial)
+    return;
+
+  gtk_string_filter_cache_clear_strings (cache, 0, cache->n_items);
+  gtk_string_filter_cache_clear_index (cache);
+  cache->values_serial = cache->filter->values_serial;
+}
+
+static const char *
+gtk_string_filter_cache_get (GtkStringFilterCache *cache,
+                             GListModel           *model,
+                             guint                 position)
+{
+  if (cache->strings[position] == NOT_PREPARED)
+    {
+      gpointer item = g_list_model_get_item (model, position);
+      cache->strings[position] = gtk_string_filter_prepare_item (cache->filter, item);
+      g_object_unref (item);
+    }
+
+  return cache->strings[position];
+}
+
+/*<private>
+ * gtk_string_filter_cache_match:
+ * @cache: a `GtkStringFilterCache`
+ * @model: the model the cache is for
+ * @position: position of the item to check
+ *
+ * Does the same as gtk_filter_match() for the item at @position,
+ * but reuses the prepared string of the item if it is cached.
+ *
+ * Returns: %TRUE if the item matches
+ **/
+gboolean
+gtk_string_filter_cache_match (GtkStringFilterCache *cache,
+                               GListModel           *model,
+                               guint                 position)
+{
+  GtkStringFilter *self = cache->filter;
+
+  g_assert (position < cache->n_items);
+
+  if (!gtk_string_filter_has_search (self))
+    return TRUE;
+
+  if (self->expression == NULL)
+    return FALSE;
+
+  gtk_string_filter_cache_validate (cache);
+
+  return gtk_string_filter_match_prepared (self, gtk_string_filter_cache_get (cache, model, position));
+}
+
+/*<private>
+ * gtk_string_filter_cache_match_item:
+ * @cache: a `GtkStringFilterCache`
+ * @item: the item at @position
+ * @position: position of the item to check
+ *
+ * Like gtk_string_filter_cache_match(), but with the item provided
+ * by the caller.
+ *
+ * This only touches the cache entry for @position, so it may be called
+ * from multiple threads at once for different positions, as long as
+ * the cache and the filter are not modified at the same time and
+ * gtk_string_filter_cache_validate() has been called before.
+ *
+ * Returns: %TRUE if the item matches
+ **/
+gboolean
+gtk_string_filter_cache_match_item (GtkStringFilterCache *cache,
+                                    gpointer              item,
+                                    guint                 position)
+{
+  GtkStringFilter *self = cache->filter;
+
+  g_assert (position < cache->n_items);
+
+  if (!gtk_string_filter_has_search (self))
+    return TRUE;
+
+  if (self->expression == NULL)
+    return FALSE;
+
+  if (cache->strings[position] == NOT_PREPARED)
+    cache->strings[position] = gtk_string_filter_prepare_item (self, item);
+
+  return gtk_string_filter_match_prepared (self, cache->strings[position]);
+}
+
+static void
+gtk_string_filter_cache_ensure_index (GtkStringFilterCache *cache,
+                                      GListModel           *model)
+{
+  guint pos;
+
+  if (cache->index == NULL)
+    cache->index = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) gtk_bitset_unref);
+
+  for (pos = cache->n_indexed; pos < cache->n_items; pos++)
+    {
+      const char *s = gtk_string_filter_cache_get (cache, model, pos);
+      gsize i, len;
+
+      if (s == NULL)
+        continue;
+
+      len = strlen (s);
+      for (i = 0; i + 3 <= len; i++)
+        {
+          GtkBitset *set = g_hash_table_lookup (cache->index, TRIGRAM (s + i));
+
+          if (set == NULL)
+            {
+              set = gtk_bitset_new_empty ();
+              g_hash_table_insert (cache->index, TRIGRAM (s + i), set);
+            }
+
+          gtk_bitset_add (set, pos);
+        }
+    }
+
+  cache->n_indexed = cache->n_items;
+}
+
+/*<private>
+ * gtk_string_filter_cache_filter_candidates:
+ * @cache: a `GtkStringFilterCache`
+ * @model: the model the cache is for
+ * @positions: the positions of the items to check
+ *
+ * Removes items from @positions that cannot match the filter.
+ *
+ * This uses the trigram index if the filter has
+ * [property@Gtk.StringFilter:use-index] set and does nothing
+ * otherwise. The remaining items still need to be checked with
+ * gtk_string_filter_cache_match().
+ **/
+void
+gtk_string_filter_cache_filter_candidates (GtkStringFilterCache *cache,
+                                           GListModel           *model,
+                                           GtkBitset            *positions)
+{
+  GtkStringFilter *self = cache->filter;
+  const char *search;
+  gsize i, len;
+
+  if (!self->use_index ||
+      !gtk_string_filter_has_search (self) ||
+      self->expression == NULL)
+    return;
+
+  search = self->search_prepared;
+  len = strlen (search);
+  if (len < 3)
+    return;
+
+  gtk_string_filter_cache_validate (cache);
+  gtk_string_filter_cache_ensure_index (cache, model);
+
+  for (i = 0; i + 3 <= len && !gtk_bitset_is_empty (positions); i++)
+    {
+      GtkBitset *set = g_hash_table_lookup (cache->index, TRIGRAM (search + i));
+
+      if (set == NULL)
+        gtk_bitset_remove_all (positions);
+      else
+        gtk_bitset_intersect (positions, set);
+    }
+}
+
 static void
 gtk_string_filter_set_property (GObject      *object,
                                 guint         prop_id,
@@ -183,6 +555,10 @@ gtk_string_filter_set_property (GObject      *object,
       gtk_string_filter_set_search (self, g_value_get_string (value));
       break;
 
+    case PROP_USE_INDEX:
+      gtk_string_filter_set_use_index (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -215,6 +591,10 @@ gtk_string_filter_get_property (GObject     *object,
       g_value_set_string (value, self->search);
       break;
 
+    case PROP_USE_INDEX:
+      g_value_set_boolean (value, self->use_index);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -241,6 +621,7 @@ gtk_string_filter_class_init (GtkStringFilterClass *class)
 
   filter_class->match = gtk_string_filter_match;
   filter_class->get_strictness = gtk_string_filter_get_strictness;
+  filter_class->is_thread_safe = gtk_string_filter_is_thread_safe;
 
   object_class->get_property = gtk_string_filter_get_property;
   object_class->set_property = gtk_string_filter_set_property;
@@ -286,6 +667,18 @@ gtk_string_filter_class_init (GtkStringFilterClass *class)
                            NULL,
                            G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkStringFilter:use-index: (attributes org.gtk.Property.get=gtk_string_filter_get_use_index org.gtk.Property.set=gtk_string_filter_set_use_index)
+   *
+   * If an index should be used to find matching items.
+   *
+   * Since: 4.12
+   */
+  properties[PROP_USE_INDEX] =
+      g_param_spec_boolean ("use-index", NULL, NULL,
+                            FALSE,
+                            G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (object_class, NUM_PROPERTIES, properties);
 
 }
@@ -295,6 +688,9 @@ gtk_string_filter_init (GtkStringFilter *self)
 {
   self->ignore_case = TRUE;
   self->match_mode = GTK_STRING_FILTER_MATCH_MODE_SUBSTRING;
+
+  /* Connect first, so caches get invalidated before anyone looks at them */
+  g_signal_connect (self, "changed", G_CALLBACK (gtk_string_filter_changed_cb), NULL);
 }
 
 /**
@@ -374,7 +770,7 @@ gtk_string_filter_set_search (GtkStringFilter *self,
   self->search = g_strdup (search);
   self->search_prepared = gtk_string_filter_prepare (self, search);
 
-  gtk_filter_changed (GTK_FILTER (self), change);
+  gtk_string_filter_search_changed (self, change);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SEARCH]);
 }
@@ -418,6 +814,7 @@ gtk_string_filter_set_expression (GtkStringFilter *self,
 
   g_clear_pointer (&self->expression, gtk_expression_unref);
   self->expression = gtk_expression_ref (expression);
+  self->values_serial++;
 
   if (gtk_string_filter_has_search (self))
     gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_DIFFERENT);
@@ -458,6 +855,7 @@ gtk_string_filter_set_ignore_case (GtkStringFilter *self,
     return;
 
   self->ignore_case = ignore_case;
+  self->values_serial++;
 
   if (self->search)
     {
@@ -511,18 +909,18 @@ gtk_string_filter_set_match_mode (GtkStringFilter *self,
       switch (old_mode)
         {
         case GTK_STRING_FILTER_MATCH_MODE_EXACT:
-          gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_LESS_STRICT);
+          gtk_string_filter_search_changed (self, GTK_FILTER_CHANGE_LESS_STRICT);
           break;
 
         case GTK_STRING_FILTER_MATCH_MODE_SUBSTRING:
-          gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_MORE_STRICT);
+          gtk_string_filter_search_changed (self, GTK_FILTER_CHANGE_MORE_STRICT);
           break;
 
         case GTK_STRING_FILTER_MATCH_MODE_PREFIX:
           if (mode == GTK_STRING_FILTER_MATCH_MODE_SUBSTRING)
-            gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_LESS_STRICT);
+            gtk_string_filter_search_changed (self, GTK_FILTER_CHANGE_LESS_STRICT);
           else
-            gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_MORE_STRICT);
+            gtk_string_filter_search_changed (self, GTK_FILTER_CHANGE_MORE_STRICT);
           break;
 
         default:
@@ -533,3 +931,59 @@ gtk_string_filter_set_match_mode (GtkStringFilter *self,
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MATCH_MODE]);
 }
+
+/**
+ * gtk_string_filter_get_use_index: (attributes org.gtk.Method.get_property=use-index)
+ * @self: a `GtkStringFilter`
+ *
+ * Returns whether the filter uses an index to find matching items.
+ *
+ * Returns: %TRUE if the filter uses an index
+ *
+ * Since: 4.12
+ */
+gboolean
+gtk_string_filter_get_use_index (GtkStringFilter *self)
+{
+  g_return_val_if_fail (GTK_IS_STRING_FILTER (self), FALSE);
+
+  return self->use_index;
+}
+
+/**
+ * gtk_string_filter_set_use_index: (attributes org.gtk.Method.set_property=use-index)
+ * @self: a `GtkStringFilter`
+ * @use_index: %TRUE to use an index
+ *
+ * Sets whether the filter uses an index to find matching items.
+ *
+ * When this is enabled, a [class@Gtk.FilterListModel] using the
+ * filter keeps an index of the strings of its items. That allows it to
+ * find the items matching a search term of 3 or more bytes without
+ * looking at every item.
+ *
+ * Creating the index requires looking at every item once and it needs
+ * memory proportional to the total length of all strings, so this is
+ * only worth it for long lists that get searched repeatedly, like when
+ * filtering as the user types.
+ *
+ * The strings of the items are only computed once and are then reused
+ * for every new search term. So when the string of an item changes,
+ * the model containing it has to emit [signal@Gio.ListModel::items-changed]
+ * for it, or the filter has to emit [signal@Gtk.Filter::changed].
+ *
+ * Since: 4.12
+ */
+void
+gtk_string_filter_set_use_index (GtkStringFilter *self,
+                                 gboolean         use_index)
+{
+  g_return_if_fail (GTK_IS_STRING_FILTER (self));
+
+  if (self->use_index == use_index)
+    return;
+
+  self->use_index = use_index;
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_USE_INDEX]);
+}
@@ -73,6 +73,12 @@ GDK_AVAILABLE_IN_ALL
 void                     gtk_string_filter_set_match_mode       (GtkStringFilter        *self,
                                                                  GtkStringFilterMatchMode mode);
 
+GDK_AVAILABLE_IN_4_12
+gboolean                gtk_string_filter_get_use_index         (GtkStringFilter        *self);
+GDK_AVAILABLE_IN_4_12
+void                    gtk_string_filter_set_use_index         (GtkStringFilter        *self,
+                                                                 gboolean                use_index);
+
 
 
 G_END_DECLS
@@ -0,0 +1,47 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <gtk/gtkstringfilter.h>
+
+#include "gtk/gtkbitset.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GtkStringFilterCache GtkStringFilterCache;
+
+GtkStringFilterCache *  gtk_string_filter_cache_new             (GtkStringFilter        *self,
+                                                                 guint                   n_items);
+void                    gtk_string_filter_cache_free            (GtkStringFilterCache   *cache);
+
+void                    gtk_string_filter_cache_splice          (GtkStringFilterCache   *cache,
+                                                                 guint                   position,
+                                                                 guint                   removed,
+                                                                 guint                   added);
+
+void                    gtk_string_filter_cache_validate        (GtkStringFilterCache   *cache);
+
+gboolean                gtk_string_filter_cache_match           (GtkStringFilterCache   *cache,
+                                                                 GListModel             *model,
+                                                                 guint                   position);
+gboolean                gtk_string_filter_cache_match_item      (GtkStringFilterCache   *cache,
+                                                                 gpointer                item,
+                                                                 guint                   position);
+void                    gtk_string_filter_cache_filter_candidates (GtkStringFilterCache *cache,
+                                                                 GListModel             *model,
+                                                                 GtkBitset              *positions);
+
+G_END_DECLS
@@ -21,6 +21,7 @@
 
 #include "gtkstringlist.h"
 
+#include "gtkbitset.h"
 #include "gtkbuildable.h"
 #include "gtkbuilderprivate.h"
 #include "gtkprivate.h"
@@ -35,6 +36,14 @@
  * `GtkStringList` is well-suited for any place where you would
  * typically use a `char*[]`, but need a list model.
  *
+ * The strings are stored in large blocks of memory and the objects
+ * for them are only created when they are needed. To fill lists with
+ * many strings quickly, use [method@Gtk.StringList.take_strv] or
+ * [method@Gtk.StringList.take_bytes].
+ *
+ * For lists with millions of strings, consider making them
+ * [property@Gtk.StringList:compact].
+ *
  * # GtkStringList as GtkBuildable
  *
  * The `GtkStringList` implementation of the `GtkBuildable` interface
@@ -67,18 +76,25 @@
  * a [property@Gtk.StringObject:string] property.
  */
 
-#define GDK_ARRAY_ELEMENT_TYPE GtkStringObject *
-#define GDK_ARRAY_NAME objects
-#define GDK_ARRAY_TYPE_NAME Objects
-#define GDK_ARRAY_FREE_FUNC g_object_unref
-#include "gdk/gdkarrayimpl.c"
+typedef struct _StringChunk StringChunk;
 
 struct _GtkStringObject
 {
   GObject parent_instance;
   char *string;
+
+  /* If set, @string belongs to the list, and the object holds a
+   * reference on it if the list is compact. Otherwise, if set, @chunk
+   * keeps @string alive, else @string is owned by the object.
+   */
+  GtkStringList *list;
+  StringChunk *chunk;
 };
 
+static void     gtk_string_list_forget_object   (GtkStringList   *self,
+                                                 GtkStringObject *object);
+static void     string_chunk_unref              (StringChunk     *chunk);
+
 enum {
   PROP_STRING = 1,
   PROP_NUM_PROPERTIES
@@ -96,7 +112,16 @@ gtk_string_object_finalize (GObject *object)
 {
   GtkStringObject *self = GTK_STRING_OBJECT (object);
 
-  g_free (self->string);
+  /* Only objects of compact lists get here while in a list */
+  if (self->list)
+    {
+      gtk_string_list_forget_object (self->list, self);
+      g_object_unref (self->list);
+    }
+  else if (self->chunk)
+    string_chunk_unref (self->chunk);
+  else
+    g_free (self->string);
 
   G_OBJECT_CLASS (gtk_string_object_parent_class)->finalize (object);
 }
@@ -144,17 +169,6 @@ gtk_string_object_class_init (GtkStringObjectClass *class)
 
 }
 
-static GtkStringObject *
-gtk_string_object_new_take (char *string)
-{
-  GtkStringObject *obj;
-
-  obj = g_object_new (GTK_TYPE_STRING_OBJECT, NULL);
-  obj->string = string;
-
-  return obj;
-}
-
 /**
  * gtk_string_object_new:
  * @string: (not nullable): The string to wrap
@@ -166,7 +180,12 @@ gtk_string_object_new_take (char *string)
 GtkStringObject *
 gtk_string_object_new (const char *string)
 {
-  return gtk_string_object_new_take (g_strdup (string));
+  GtkStringObject *obj;
+
+  obj = g_object_new (GTK_TYPE_STRING_OBJECT, NULL);
+  obj->string = g_strdup (string);
+
+  return obj;
 }
 
 /**
@@ -186,13 +205,63 @@ gtk_string_object_get_string (GtkStringObject *self)
 }
 
 /* }}} */
-/* {{{ List model implementation */
+/* {{{ String storage */
+
+/* Strings are not stored in allocations of their own, but packed into
+ * chunks of memory. Appended strings get copied into the last chunk
+ * until it is full, and the data passed to gtk_string_list_take_bytes()
+ * becomes a chunk of its own. A chunk is freed when no string in it is
+ * used anymore.
+ *
+ * Strings passed to gtk_string_list_take() or gtk_string_list_take_strv()
+ * keep their own allocation, those are tracked in the owned bitset.
+ *
+ * GtkStringObjects are only created when somebody asks for an item.
+ * They borrow their string from the list and are remembered, so that
+ * asking for the same item again returns the same object. When a string
+ * is removed from the list while its object is still alive, the object
+ * takes over the string.
+ *
+ * Usually, the list keeps the objects alive until their string is
+ * removed, like a GListStore would. Compact lists only keep a weak
+ * reference, so the objects that are not used anymore get freed. As
+ * that can happen on any thread, @objects is protected by a lock for
+ * compact lists, and objects keep the list alive, so that they can
+ * remove themselves.
+ */
+
+#define MIN_CHUNK_SIZE 256
+#define MAX_CHUNK_SIZE (64 * 1024)
+
+struct _StringChunk
+{
+  guint ref_count; /* the list and objects that took over a string */
+  guint n_strings; /* strings in the list */
+  char *data;
+  gsize size;
+  gsize used;
+};
+
+#define GDK_ARRAY_ELEMENT_TYPE char *
+#define GDK_ARRAY_NAME strings
+#define GDK_ARRAY_TYPE_NAME Strings
+#define GDK_ARRAY_NO_MEMSET 1
+#include "gdk/gdkarrayimpl.c"
 
 struct _GtkStringList
 {
   GObject parent_instance;
 
-  Objects items;
+  Strings items;
+  GtkBitset *owned; /* items that are allocated on their own */
+  GPtrArray *chunks; /* StringChunk, sorted by address */
+  StringChunk *last_chunk; /* the chunk new strings get copied to */
+
+  /* string => GtkStringObject, or GWeakRef to it if compact */
+  GHashTable *objects;
+  GMutex objects_lock;
+
+  guint compact : 1;
 };
 
 struct _GtkStringListClass
@@ -200,6 +269,270 @@ struct _GtkStringListClass
   GObjectClass parent_class;
 };
 
+static StringChunk *
+string_chunk_new (gsize size)
+{
+  StringChunk *chunk;
+
+  chunk = g_malloc (sizeof (StringChunk) + size);
+  chunk->ref_count = 1;
+  chunk->n_strings = 0;
+  chunk->data = (char *) (chunk + 1);
+  chunk->size = size;
+  chunk->used = 0;
+
+  return chunk;
+}
+
+static StringChunk *
+string_chunk_new_take (char  *data,
+                       gsize  size)
+{
+  StringChunk *chunk;
+
+  chunk = g_new (StringChunk, 1);
+  chunk->ref_count = 1;
+  chunk->n_strings = 0;
+  chunk->data = data;
+  chunk->size = size;
+  chunk->used = size;
+
+  return chunk;
+}
+
+static StringChunk *
+string_chunk_ref (StringChunk *chunk)
+{
+  chunk->ref_count++;
+
+  return chunk;
+}
+
+static void
+string_chunk_unref (StringChunk *chunk)
+{
+  chunk->ref_count--;
+  if (chunk->ref_count > 0)
+    return;
+
+  if (chunk->data != (char *) (chunk + 1))
+    g_free (chunk->data);
+  g_free (chunk);
+}
+
+/* Returns the index of the last chunk starting at or before @data */
+static guint
+gtk_string_list_find_chunk_index (GtkStringList *self,
+                                  const char    *data)
+{
+  guint lo, hi;
+
+  lo = 0;
+  hi = self->chunks->len;
+  while (hi - lo > 1)
+    {
+      guint mid = (lo + hi) / 2;
+      StringChunk *chunk = g_ptr_array_index (self->chunks, mid);
+
+      if (chunk->data <= data)
+        lo = mid;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+static void
+gtk_string_list_add_chunk (GtkStringList *self,
+                           StringChunk   *chunk)
+{
+  guint i;
+
+  if (self->chunks->len == 0)
+    i = 0;
+  else
+    {
+      i = gtk_string_list_find_chunk_index (self, chunk->data);
+      if (((StringChunk *) g_ptr_array_index (self->chunks, i))->data < chunk->data)
+        i++;
+    }
+
+  g_ptr_array_insert (self->chunks, i, chunk);
+}
+
+static char *
+gtk_string_list_copy_string (GtkStringList *self,
+                             const char    *string)
+{
+  StringChunk *chunk = self->last_chunk;
+  gsize len;
+  char *result;
+
+  len = strlen (string) + 1;
+
+  if (chunk == NULL || chunk->size - chunk->used < len)
+    {
+      gsize size;
+
+      if (chunk)
+        {
+          size = CLAMP (2 * chunk->size, MIN_CHUNK_SIZE, MAX_CHUNK_SIZE);
+          if (chunk->n_strings == 0)
+            g_ptr_array_remove_index (self->chunks, gtk_string_list_find_chunk_index (self, chunk->data));
+        }
+      else
+        size = MIN_CHUNK_SIZE;
+
+      chunk = string_chunk_new (MAX (size, len));
+      gtk_string_list_add_chunk (self, chunk);
+      self->last_chunk = chunk;
+    }
+
+  result = chunk->data + chunk->used;
+  memcpy (result, string, len);
+  chunk->used += len;
+  chunk->n_strings++;
+
+  return result;
+}
+
+static void
+weak_ref_free (GWeakRef *ref)
+{
+  g_weak_ref_clear (ref);
+  g_free (ref);
+}
+
+/* Lets go of the string at @position, which must be removed
+ * from the list afterwards.
+ */
+static void
+gtk_string_list_release_string (GtkStringList *self,
+                                guint          position)
+{
+  GtkStringObject *object;
+  StringChunk *chunk;
+  char *string;
+  guint i;
+
+  string = strings_get (&self->items, position);
+
+  if (self->compact)
+    {
+      GWeakRef *ref;
+
+      g_mutex_lock (&self->objects_lock);
+      ref = g_hash_table_lookup (self->objects, string);
+      if (ref)
+        {
+          /* If the object is being finalized, it only uses
+           * the string as a key to look for itself.
+           */
+          object = g_weak_ref_get (ref);
+          g_hash_table_remove (self->objects, string);
+          weak_ref_free (ref);
+        }
+      else
+        object = NULL;
+      g_mutex_unlock (&self->objects_lock);
+
+      if (object)
+        {
+          /* The object's reference on us */
+          object->list = NULL;
+          g_object_unref (self);
+        }
+    }
+  else
+    {
+      object = g_hash_table_lookup (self->objects, string);
+      if (object)
+        {
+          g_hash_table_steal (self->objects, string);
+          object->list = NULL;
+        }
+    }
+
+  if (gtk_bitset_contains (self->owned, position))
+    {
+      if (object == NULL)
+        g_free (string);
+    }
+  else
+    {
+      i = gtk_string_list_find_chunk_index (self, string);
+      chunk = g_ptr_array_index (self->chunks, i);
+      g_assert (chunk->data <= string && string < chunk->data + chunk->size);
+
+      if (object)
+        object->chunk = string_chunk_ref (chunk);
+
+      chunk->n_strings--;
+      if (chunk->n_strings == 0 && chunk != self->last_chunk)
+        g_ptr_array_remove_index (self->chunks, i);
+    }
+
+  /* Our reference, or the one from g_weak_ref_get() */
+  if (object)
+    g_object_unref (object);
+}
+
+/* Removes @n_removals strings at @position and makes room
+ * for @n_additions new ones that the caller must fill in.
+ */
+static char **
+gtk_string_list_replace (GtkStringList *self,
+                         guint          position,
+                         guint          n_removals,
+                         guint          n_additions)
+{
+  guint i;
+
+  for (i = position; i < position + n_removals; i++)
+    gtk_string_list_release_string (self, i);
+
+  if (!gtk_bitset_is_empty (self->owned))
+    gtk_bitset_splice (self->owned, position, n_removals, n_additions);
+
+  strings_splice (&self->items, position, n_removals, FALSE, NULL, n_additions);
+
+  return strings_index (&self->items, position);
+}
+
+/* Called from the finalizer of @object, on any thread */
+static void
+gtk_string_list_forget_object (GtkStringList   *self,
+                               GtkStringObject *object)
+{
+  GWeakRef *ref;
+
+  g_assert (self->compact);
+
+  g_mutex_lock (&self->objects_lock);
+
+  /* get_item() may have replaced us already */
+  ref = g_hash_table_lookup (self->objects, object->string);
+  if (ref)
+    {
+      GObject *current = g_weak_ref_get (ref);
+
+      if (current == NULL)
+        {
+          g_hash_table_remove (self->objects, object->string);
+          weak_ref_free (ref);
+        }
+      else
+        g_object_unref (current);
+    }
+
+  g_mutex_unlock (&self->objects_lock);
+}
+
+
+/* }}} */
+/* {{{ List model implementation */
+
 static GType
 gtk_string_list_get_item_type (GListModel *list)
 {
@@ -211,7 +544,7 @@ gtk_string_list_get_n_items (GListModel *list)
 {
   GtkStringList *self = GTK_STRING_LIST (list);
 
-  return objects_get_size (&self->items);
+  return strings_get_size (&self->items);
 }
 
 static gpointer
@@ -219,11 +552,56 @@ gtk_string_list_get_item (GListModel *list,
                           guint       position)
 {
   GtkStringList *self = GTK_STRING_LIST (list);
+  GtkStringObject *object;
+  char *string;
 
-  if (position >= objects_get_size (&self->items))
+  if (position >= strings_get_size (&self->items))
     return NULL;
 
-  return g_object_ref (objects_get (&self->items, position));
+  string = strings_get (&self->items, position);
+
+  if (!self->compact)
+    {
+      object = g_hash_table_lookup (self->objects, string);
+      if (object == NULL)
+        {
+          object = g_object_new (GTK_TYPE_STRING_OBJECT, NULL);
+          object->string = string;
+          object->list = self;
+          g_hash_table_insert (self->objects, string, object);
+        }
+
+      return g_object_ref (object);
+    }
+  else
+    {
+      GWeakRef *ref;
+
+      g_mutex_lock (&self->objects_lock);
+
+      ref = g_hash_table_lookup (self->objects, string);
+      if (ref == NULL)
+        {
+          ref = g_new (GWeakRef, 1);
+          g_weak_ref_init (ref, NULL);
+          g_hash_table_insert (self->objects, string, ref);
+          object = NULL;
+        }
+      else
+        object = g_weak_ref_get (ref);
+
+      if (object == NULL)
+        {
+          object = g_object_new (GTK_TYPE_STRING_OBJECT, NULL);
+          object->string = string;
+          object->list = g_object_ref (self);
+          g_weak_ref_set (ref, object);
+        }
+
+      g_mutex_unlock (&self->objects_lock);
+
+      return object;
+    }
 }
 
 static void
@@ -406,9 +784,14 @@ gtk_string_list_buildable_init (GtkBuildableIface *iface)
 /* {{{ GObject implementation */
 
 enum {
-  PROP_STRINGS = 1
+  PROP_0,
+  PROP_STRINGS,
+  PROP_COMPACT,
+  N_PROPS
 };
 
+static GParamSpec *properties[N_PROPS] = { NULL, };
+
 G_DEFINE_TYPE_WITH_CODE (GtkStringList, gtk_string_list, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (GTK_TYPE_BUILDABLE,
                                                 gtk_string_list_buildable_init)
@@ -420,11 +803,27 @@ gtk_string_list_dispose (GObject *object)
 {
   GtkStringList *self = GTK_STRING_LIST (object);
 
-  objects_clear (&self->items);
+  gtk_string_list_replace (self, 0, strings_get_size (&self->items), 0);
+  g_ptr_array_set_size (self->chunks, 0);
+  self->last_chunk = NULL;
 
   G_OBJECT_CLASS (gtk_string_list_parent_class)->dispose (object);
 }
 
+static void
+gtk_string_list_finalize (GObject *object)
+{
+  GtkStringList *self = GTK_STRING_LIST (object);
+
+  strings_clear (&self->items);
+  gtk_bitset_unref (self->owned);
+  g_ptr_array_unref (self->chunks);
+  g_hash_table_unref (self->objects);
+  g_mutex_clear (&self->objects_lock);
+
+  G_OBJECT_CLASS (gtk_string_list_parent_class)->finalize (object);
+}
+
 static void
 gtk_string_list_set_property (GObject      *object,
                               unsigned int  prop_id,
@@ -440,6 +839,32 @@ gtk_string_list_set_property (GObject      *object,
                               (const char * const *) g_value_get_boxed (value));
       break;
 
+    case PROP_COMPACT:
+      /* Construct properties are set in order of installation */
+      g_assert (strings_get_size (&self->items) == 0);
+      self->compact = g_value_get_boolean (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_string_list_get_property (GObject      *object,
+                              unsigned int  prop_id,
+                              GValue       *value,
+                              GParamSpec   *pspec)
+{
+  GtkStringList *self = GTK_STRING_LIST (object);
+
+  switch (prop_id)
+    {
+    case PROP_COMPACT:
+      g_value_set_boolean (value, self->compact);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -452,23 +877,54 @@ gtk_string_list_class_init (GtkStringListClass *class)
   GObjectClass *gobject_class = G_OBJECT_CLASS (class);
 
   gobject_class->dispose = gtk_string_list_dispose;
+  gobject_class->finalize = gtk_string_list_finalize;
   gobject_class->set_property = gtk_string_list_set_property;
+  gobject_class->get_property = gtk_string_list_get_property;
+
+  /**
+   * GtkStringList:compact: (attributes org.gtk.Property.get=gtk_string_list_get_compact)
+   *
+   * Whether the list only keeps the objects for its items alive
+   * while they are used.
+   *
+   * By default, the object for an item is kept until the item is
+   * removed from the list, like in a `GListStore`. Compact lists free
+   * the objects nobody holds a reference to, and create new ones
+   * when the item is requested again, so data that was attached to
+   * the old object is lost.
+   *
+   * Objects of a compact list keep the list alive.
+   *
+   * Since: 4.12
+   */
+  properties[PROP_COMPACT] =
+      g_param_spec_boolean ("compact", NULL, NULL,
+                            FALSE,
+                            G_PARAM_READWRITE|G_PARAM_STATIC_STRINGS|G_PARAM_CONSTRUCT_ONLY);
 
   /**
    * GtkStringList:strings:
    *
    * Since: 4.10
    */
-  g_object_class_install_property (gobject_class, PROP_STRINGS,
+  properties[PROP_STRINGS] =
       g_param_spec_boxed ("strings", NULL, NULL,
                           G_TYPE_STRV,
-                          G_PARAM_WRITABLE|G_PARAM_STATIC_STRINGS|G_PARAM_CONSTRUCT_ONLY));
+                          G_PARAM_WRITABLE|G_PARAM_STATIC_STRINGS|G_PARAM_CONSTRUCT_ONLY);
+
+  /* compact needs to be set before the strings get added */
+  g_object_class_install_property (gobject_class, PROP_COMPACT, properties[PROP_COMPACT]);
+  g_object_class_install_property (gobject_class, PROP_STRINGS, properties[PROP_STRINGS]);
 }
 
 static void
 gtk_string_list_init (GtkStringList *self)
 {
-  objects_init (&self->items);
+  strings_init (&self->items);
+  self->owned = gtk_bitset_new_empty ();
+  self->chunks = g_ptr_array_new_with_free_func ((GDestroyNotify) string_chunk_unref);
+  self->objects = g_hash_table_new (NULL, NULL);
+  g_mutex_init (&self->objects_lock);
 }
 
 /* }}} */
@@ -490,6 +946,44 @@ gtk_string_list_new (const char * const *strings)
                        NULL);
 }
 
+/**
+ * gtk_string_list_new_compact:
+ * @strings: (array zero-terminated=1) (nullable): The strings to put in the model
+ *
+ * Creates a new [property@Gtk.StringList:compact] `GtkStringList`
+ * with the given @strings.
+ *
+ * Returns: a new `GtkStringList`
+ *
+ * Since: 4.12
+ */
+GtkStringList *
+gtk_string_list_new_compact (const char * const *strings)
+{
+  return g_object_new (GTK_TYPE_STRING_LIST,
+                       "compact", TRUE,
+                       "strings", strings,
+                       NULL);
+}
+
+/**
+ * gtk_string_list_get_compact: (attributes org.gtk.Method.get_property=compact)
+ * @self: a `GtkStringList`
+ *
+ * Returns whether @self is [property@Gtk.StringList:compact].
+ *
+ * Returns: %TRUE if @self is compact
+ *
+ * Since: 4.12
+ */
+gboolean
+gtk_string_list_get_compact (GtkStringList *self)
+{
+  g_return_val_if_fail (GTK_IS_STRING_LIST (self), FALSE);
+
+  return self->compact;
+}
+
 /**
  * gtk_string_list_splice:
  * @self: a `GtkStringList`
@@ -517,22 +1011,21 @@ gtk_string_list_splice (GtkStringList      *self,
                         const char * const *additions)
 {
   guint i, n_additions;
+  char **items;
 
   g_return_if_fail (GTK_IS_STRING_LIST (self));
   g_return_if_fail (position + n_removals >= position); /* overflow */
-  g_return_if_fail (position + n_removals <= objects_get_size (&self->items));
+  g_return_if_fail (position + n_removals <= strings_get_size (&self->items));
 
   if (additions)
     n_additions = g_strv_length ((char **) additions);
   else
     n_additions = 0;
 
-  objects_splice (&self->items, position, n_removals, FALSE, NULL, n_additions);
+  items = gtk_string_list_replace (self, position, n_removals, n_additions);
 
   for (i = 0; i < n_additions; i++)
-    {
-      *objects_index (&self->items, position + i) = gtk_string_object_new (additions[i]);
-    }
+    items[i] = gtk_string_list_copy_string (self, additions[i]);
 
   if (n_removals || n_additions)
     g_list_model_items_changed (G_LIST_MODEL (self), position, n_removals, n_additions);
@@ -552,11 +1045,14 @@ void
 gtk_string_list_append (GtkStringList *self,
                         const char    *string)
 {
+  guint position;
+
   g_return_if_fail (GTK_IS_STRING_LIST (self));
 
-  objects_append (&self->items, gtk_string_object_new (string));
+  position = strings_get_size (&self->items);
+  *gtk_string_list_replace (self, position, 0, 1) = gtk_string_list_copy_string (self, string);
 
-  g_list_model_items_changed (G_LIST_MODEL (self), objects_get_size (&self->items) - 1, 0, 1);
+  g_list_model_items_changed (G_LIST_MODEL (self), position, 0, 1);
 }
 
 /**
@@ -578,11 +1074,121 @@ void
 gtk_string_list_take (GtkStringList *self,
                       char          *string)
 {
+  guint position;
+
+  g_return_if_fail (GTK_IS_STRING_LIST (self));
+
+  position = strings_get_size (&self->items);
+  *gtk_string_list_replace (self, position, 0, 1) = string;
+  gtk_bitset_add (self->owned, position);
+
+  g_list_model_items_changed (G_LIST_MODEL (self), position, 0, 1);
+}
+
+/**
+ * gtk_string_list_take_strv:
+ * @self: a `GtkStringList`
+ * @strings: (transfer full) (array zero-terminated=1): the strings to append
+ *
+ * Appends @strings to @self and takes ownership of them.
+ *
+ * Unlike [method@Gtk.StringList.splice], this does not copy the
+ * strings, and it emits the ::items-changed signal only once.
+ *
+ * Since: 4.12
+ */
+void
+gtk_string_list_take_strv (GtkStringList  *self,
+                           char          **strings)
+{
+  guint position, n_additions;
+
+  g_return_if_fail (GTK_IS_STRING_LIST (self));
+  g_return_if_fail (strings != NULL);
+
+  position = strings_get_size (&self->items);
+  n_additions = g_strv_length (strings);
+
+  if (n_additions > 0)
+    {
+      memcpy (gtk_string_list_replace (self, position, 0, n_additions),
+              strings,
+              n_additions * sizeof (char *));
+      gtk_bitset_add_range (self->owned, position, n_additions);
+    }
+
+  g_free (strings);
+
+  if (n_additions > 0)
+    g_list_model_items_changed (G_LIST_MODEL (self), position, 0, n_additions);
+}
+
+/**
+ * gtk_string_list_take_bytes:
+ * @self: a `GtkStringList`
+ * @bytes: (transfer full): text with one string per line
+ *
+ * Appends every line of @bytes to @self, and takes ownership
+ * of @bytes.
+ *
+ * Lines are separated by `\n`, the last line does not need to be
+ * terminated. The lines must not contain nul bytes.
+ *
+ * If there are no other references to @bytes, its data is used for
+ * storing the strings without copying them, otherwise it is copied
+ * once. Either way, this is the fastest way to fill a list with many
+ * strings, for example from a file.
+ *
+ * Since: 4.12
+ */
+void
+gtk_string_list_take_bytes (GtkStringList *self,
+                            GBytes        *bytes)
+{
+  StringChunk *chunk;
+  guint position, n_additions;
+  char **items;
+  char *data, *line, *end;
+  gsize size;
+
   g_return_if_fail (GTK_IS_STRING_LIST (self));
+  g_return_if_fail (bytes != NULL);
 
-  objects_append (&self->items, gtk_string_object_new_take (string));
+  data = g_bytes_unref_to_data (bytes, &size);
+  if (size == 0)
+    {
+      g_free (data);
+      return;
+    }
+
+  if (data[size - 1] != '\n')
+    {
+      data = g_realloc (data, size + 1);
+      data[size++] = '\n';
+    }
+
+  n_additions = 0;
+  for (line = data; line < data + size; line = end + 1)
+    {
+      end = memchr (line, '\n', data + size - line);
+      n_additions++;
+    }
+
+  chunk = string_chunk_new_take (data, size);
+  chunk->n_strings = n_additions;
+  gtk_string_list_add_chunk (self, chunk);
+
+  position = strings_get_size (&self->items);
+  items = gtk_string_list_replace (self, position, 0, n_additions);
+
+  for (line = data; line < data + size; line = end + 1)
+    {
+      end = memchr (line, '\n', data + size - line);
+      *end = '\0';
+      *items++ = line;
+    }
 
-  g_list_model_items_changed (G_LIST_MODEL (self), objects_get_size (&self->items) - 1, 0, 1);
+  g_list_model_items_changed (G_LIST_MODEL (self), position, 0, n_additions);
 }
 
 /**
@@ -624,10 +1230,10 @@ gtk_string_list_get_string (GtkStringList *self,
 {
   g_return_val_if_fail (GTK_IS_STRING_LIST (self), NULL);
 
-  if (position >= objects_get_size (&self->items))
+  if (position >= strings_get_size (&self->items))
     return NULL;
 
-  return objects_get (&self->items, position)->string;
+  return strings_get (&self->items, position);
 }
 
 /* }}} */
@@ -47,6 +47,11 @@ G_DECLARE_FINAL_TYPE (GtkStringList, gtk_string_list, GTK, STRING_LIST, GObject)
 
 GDK_AVAILABLE_IN_ALL
 GtkStringList * gtk_string_list_new             (const char * const    *strings);
+GDK_AVAILABLE_IN_4_12
+GtkStringList * gtk_string_list_new_compact     (const char * const    *strings);
+
+GDK_AVAILABLE_IN_4_12
+gboolean        gtk_string_list_get_compact     (GtkStringList         *self);
 
 GDK_AVAILABLE_IN_ALL
 void            gtk_string_list_append          (GtkStringList         *self,
@@ -56,6 +61,14 @@ GDK_AVAILABLE_IN_ALL
 void            gtk_string_list_take            (GtkStringList         *self,
                                                  char                  *string);
 
+GDK_AVAILABLE_IN_4_12
+void            gtk_string_list_take_strv       (GtkStringList         *self,
+                                                 char                 **strings);
+
+GDK_AVAILABLE_IN_4_12
+void            gtk_string_list_take_bytes      (GtkStringList         *self,
+                                                 GBytes                *bytes);
+
 GDK_AVAILABLE_IN_ALL
 void            gtk_string_list_remove          (GtkStringList         *self,
                                                  guint                  position);
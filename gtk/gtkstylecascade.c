@@ -265,6 +265,18 @@ _gtk_style_cascade_new (void)
   return g_object_new (GTK_TYPE_STYLE_CASCADE, NULL);
 }
 
+/* Forwards the changed signal of the parent and the providers */
+static void
+gtk_style_cascade_provider_changed (GtkStyleProvider         *provider,
+                                    const GtkCssSelectorTree *rules,
+                                    GtkStyleCascade          *cascade)
+{
+  if (rules)
+    gtk_style_provider_rules_changed (GTK_STYLE_PROVIDER (cascade), rules);
+  else
+    gtk_style_provider_changed (GTK_STYLE_PROVIDER (cascade));
+}
+
 void
 _gtk_style_cascade_set_parent (GtkStyleCascade *cascade,
                                GtkStyleCascade *parent)
@@ -278,16 +290,16 @@ _gtk_style_cascade_set_parent (GtkStyleCascade *cascade,
   if (parent)
     {
       g_object_ref (parent);
-      g_signal_connect_swapped (parent,
-                                "gtk-private-changed",
-                                G_CALLBACK (gtk_style_provider_changed),
-                                cascade);
+      g_signal_connect (parent,
+                        "gtk-private-changed",
+                        G_CALLBACK (gtk_style_cascade_provider_changed),
+                        cascade);
     }
 
   if (cascade->parent)
     {
-      g_signal_handlers_disconnect_by_func (cascade->parent, 
-                                            gtk_style_provider_changed,
+      g_signal_handlers_disconnect_by_func (cascade->parent,
+                                            gtk_style_cascade_provider_changed,
                                             cascade);
       g_object_unref (cascade->parent);
     }
@@ -309,10 +321,10 @@ _gtk_style_cascade_add_provider (GtkStyleCascade  *cascade,
 
   data.provider = g_object_ref (provider);
   data.priority = priority;
-  data.changed_signal_id = g_signal_connect_swapped (provider,
-                                                     "gtk-private-changed",
-                                                     G_CALLBACK (gtk_style_provider_changed),
-                                                     cascade);
+  data.changed_signal_id = g_signal_connect (provider,
+                                             "gtk-private-changed",
+                                             G_CALLBACK (gtk_style_cascade_provider_changed),
+                                             cascade);
 
   /* ensure it gets removed first */
   _gtk_style_cascade_remove_provider (cascade, provider);
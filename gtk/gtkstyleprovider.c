@@ -48,13 +48,16 @@ static guint signals[LAST_SIGNAL];
 static void
 gtk_style_provider_default_init (GtkStyleProviderInterface *iface)
 {
+  /* The argument is the GtkCssSelectorTree of the rules that
+   * changed, or NULL if everything needs to be restyled */
   signals[CHANGED] = g_signal_new (I_("gtk-private-changed"),
                                    G_TYPE_FROM_INTERFACE (iface),
                                    G_SIGNAL_RUN_LAST,
                                    G_STRUCT_OFFSET (GtkStyleProviderInterface, changed),
                                    NULL, NULL,
                                    NULL,
-                                   G_TYPE_NONE, 0);
+                                   G_TYPE_NONE, 1,
+                                   G_TYPE_POINTER);
 
 }
 
@@ -124,7 +127,26 @@ gtk_style_provider_changed (GtkStyleProvider *provider)
 {
   gtk_internal_return_if_fail (GTK_IS_STYLE_PROVIDER (provider));
 
-  g_signal_emit (provider, signals[CHANGED], 0);
+  g_signal_emit (provider, signals[CHANGED], 0, NULL);
+}
+
+/*
+ * gtk_style_provider_rules_changed:
+ * @provider: a `GtkStyleProvider`
+ * @rules: the rules that were added, removed or modified
+ *
+ * Like gtk_style_provider_changed(), but tells handlers that only
+ * nodes which may match @rules need to be restyled. Handlers get
+ * @rules as the argument of the changed signal.
+ */
+void
+gtk_style_provider_rules_changed (GtkStyleProvider         *provider,
+                                  const GtkCssSelectorTree *rules)
+{
+  gtk_internal_return_if_fail (GTK_IS_STYLE_PROVIDER (provider));
+  gtk_internal_return_if_fail (rules != NULL);
+
+  g_signal_emit (provider, signals[CHANGED], 0, rules);
 }
 
 GtkSettings *
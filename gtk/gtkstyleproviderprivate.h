@@ -51,7 +51,8 @@ struct _GtkStyleProviderInterface
                                                  GtkCssSection           *section,
                                                  const GError            *error);
   /* signal */
-  void                  (* changed)             (GtkStyleProvider        *provider);
+  void                  (* changed)             (GtkStyleProvider        *provider,
+                                                 const GtkCssSelectorTree *rules);
 };
 
 GtkSettings *           gtk_style_provider_get_settings          (GtkStyleProvider        *provider);
@@ -67,6 +68,8 @@ void                    gtk_style_provider_lookup                (GtkStyleProvid
                                                                   GtkCssChange            *out_change);
 
 void                    gtk_style_provider_changed               (GtkStyleProvider        *provider);
+void                    gtk_style_provider_rules_changed         (GtkStyleProvider        *provider,
+                                                                  const GtkCssSelectorTree *rules);
 
 void                    gtk_style_provider_emit_error            (GtkStyleProvider        *provider,
                                                                   GtkCssSection           *section,
@@ -209,6 +209,9 @@ struct _GtkTextBTree {
   guint end_iter_segment_stamp;
 
   GHashTable *child_anchor_table;
+
+  /* Whether searches use the signatures of lines */
+  guint search_index : 1;
 };
 
 
@@ -266,6 +269,7 @@ static void             gtk_text_line_destroy           (GtkTextBTree     *tree,
                                                          GtkTextLine      *line);
 static void             gtk_text_line_set_parent        (GtkTextLine      *line,
                                                          GtkTextBTreeNode *node);
+static void             gtk_text_line_invalidate_search (GtkTextLine      *line);
 static void             gtk_text_btree_node_remove_data (GtkTextBTreeNode *node,
                                                          gpointer          view_id);
 
@@ -1053,6 +1057,7 @@ _gtk_text_btree_delete (GtkTextIter *start,
    */
 
   cleanup_line (start_line);
+  gtk_text_line_invalidate_search (start_line);
 
   /*
    * Lastly, rebalance the first GtkTextBTreeNode of the range.
@@ -1209,6 +1214,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
    */
 
   cleanup_line (start_line);
+  gtk_text_line_invalidate_search (start_line);
   if (line != start_line)
     {
       cleanup_line (line);
@@ -1271,6 +1277,8 @@ insert_paintable_or_widget_segment (GtkTextIter        *iter,
       prevPtr->next = seg;
     }
 
+  gtk_text_line_invalidate_search (line);
+
   post_insert_fixup (tree, line, 0, seg->char_count);
 
   chars_changed (tree);
@@ -4693,6 +4701,227 @@ _gtk_text_line_previous_could_contain_tag (GtkTextLine  *line,
   return prev;
 }
 
+/*
+ * Search index
+ */
+
+static inline void
+search_signature_add (guint64 *bits,
+                      guint    trigram)
+{
+  guint bit;
+
+  /* Fibonacci hashing, the top 8 bits select one of the 256 bits */
+  bit = (trigram * 2654435761u) >> 24;
+  bits[bit >> 6] |= G_GUINT64_CONSTANT (1) << (bit & 63);
+}
+
+static void
+gtk_text_line_update_search_signature (GtkTextLine *line)
+{
+  GtkTextLineSegment *seg;
+  guint trigram, n_bytes;
+  guchar flags;
+  int i;
+
+  if (line->search_flags & GTK_TEXT_LINE_SEARCH_VALID)
+    return;
+
+  if (line->search_signature == NULL)
+    line->search_signature = g_new (guint64, GTK_TEXT_SEARCH_SIGNATURE_SIZE);
+  memset (line->search_signature, 0, sizeof (guint64) * GTK_TEXT_SEARCH_SIGNATURE_SIZE);
+
+  flags = GTK_TEXT_LINE_SEARCH_VALID;
+  trigram = 0;
+  n_bytes = 0;
+
+  /* Toggles and marks don't interrupt the text, so trigrams
+   * continue across them.
+   */
+  for (seg = line->segments; seg != NULL; seg = seg->next)
+    {
+      if (seg->type == &gtk_text_char_type)
+        {
+          for (i = 0; i < seg->byte_count; i++)
+            {
+              guchar c = seg->body.chars[i];
+
+              if (c >= 0x80)
+                flags |= GTK_TEXT_LINE_SEARCH_NON_ASCII;
+
+              trigram = ((trigram << 8) | g_ascii_tolower (c)) & 0xffffff;
+              if (++n_bytes >= 3)
+                search_signature_add (line->search_signature, trigram);
+            }
+        }
+      else if (seg->type == &gtk_text_paintable_type ||
+               seg->type == &gtk_text_child_type)
+        {
+          flags |= GTK_TEXT_LINE_SEARCH_NON_TEXT;
+          n_bytes = 0;
+        }
+    }
+
+  line->search_flags = flags;
+}
+
+static void
+gtk_text_line_invalidate_search (GtkTextLine *line)
+{
+  line->search_flags = 0;
+}
+
+/*
+ * _gtk_text_search_signature_init:
+ * @signature: the signature to initialize
+ * @str: the search string
+ * @case_insensitive: whether the search ignores case
+ *
+ * Initializes @signature with the trigrams of the first line of @str,
+ * as it is passed to gtk_text_iter_forward_search().
+ *
+ * Returns: %FALSE if @str is too short to skip any lines
+ */
+gboolean
+_gtk_text_search_signature_init (GtkTextSearchSignature *signature,
+                                 const char             *str,
+                                 gboolean                case_insensitive)
+{
+  guint trigram, n_bytes, n_trigrams;
+  const guchar *p;
+
+  memset (signature, 0, sizeof (GtkTextSearchSignature));
+
+  /* Casefolding and normalizing can turn non-ASCII text into
+   * ASCII, so such lines may match in unexpected ways and
+   * trigrams containing non-ASCII can't be relied upon.
+   */
+  signature->unsure_flags = GTK_TEXT_LINE_SEARCH_NON_TEXT;
+  if (case_insensitive)
+    signature->unsure_flags |= GTK_TEXT_LINE_SEARCH_NON_ASCII;
+
+  trigram = 0;
+  n_bytes = 0;
+  n_trigrams = 0;
+
+  /* Only the first line is looked for inside of a line */
+  for (p = (const guchar *) str; *p != '\0' && *p != '\n'; p++)
+    {
+      if (case_insensitive && *p >= 0x80)
+        {
+          n_bytes = 0;
+          continue;
+        }
+
+      trigram = ((trigram << 8) | g_ascii_tolower (*p)) & 0xffffff;
+      if (++n_bytes >= 3)
+        {
+          search_signature_add (signature->bits, trigram);
+          n_trigrams++;
+        }
+    }
+
+  return n_trigrams > 0;
+}
+
+/*
+ * _gtk_text_line_could_contain_text:
+ * @line: a line
+ * @signature: the signature of the search string
+ *
+ * Checks if the search string of @signature might be found
+ * in @line. If this returns %FALSE, it definitely isn't.
+ *
+ * Returns: whether the text of @line needs to be searched
+ */
+gboolean
+_gtk_text_line_could_contain_text (GtkTextLine                  *line,
+                                   const GtkTextSearchSignature *signature)
+{
+  int i;
+
+  gtk_text_line_update_search_signature (line);
+
+  if (line->search_flags & signature->unsure_flags)
+    return TRUE;
+
+  for (i = 0; i < GTK_TEXT_SEARCH_SIGNATURE_SIZE; i++)
+    {
+      if ((line->search_signature[i] & signature->bits[i]) != signature->bits[i])
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Finds the next line after @line that could contain the search
+ * string, not looking further than @last_line if it is set.
+ */
+GtkTextLine *
+_gtk_text_line_next_could_contain_text (GtkTextLine                  *line,
+                                        const GtkTextSearchSignature *signature,
+                                        GtkTextLine                  *last_line)
+{
+  while (line != last_line)
+    {
+      line = _gtk_text_line_next_excluding_last (line);
+      if (line == NULL || _gtk_text_line_could_contain_text (line, signature))
+        return line;
+    }
+
+  return NULL;
+}
+
+/* Like _gtk_text_line_next_could_contain_text(), but backwards,
+ * stopping at @first_line.
+ */
+GtkTextLine *
+_gtk_text_line_previous_could_contain_text (GtkTextLine                  *line,
+                                            const GtkTextSearchSignature *signature,
+                                            GtkTextLine                  *first_line)
+{
+  while (line != first_line)
+    {
+      line = _gtk_text_line_previous (line);
+      if (line == NULL || _gtk_text_line_could_contain_text (line, signature))
+        return line;
+    }
+
+  return NULL;
+}
+
+void
+_gtk_text_btree_set_search_index (GtkTextBTree *tree,
+                                  gboolean      search_index)
+{
+  GtkTextLine *line;
+
+  if (tree->search_index == search_index)
+    return;
+
+  tree->search_index = search_index;
+
+  if (search_index)
+    return;
+
+  /* Release the signatures, they are recomputed when
+   * the index gets used again.
+   */
+  for (line = _gtk_text_btree_get_line (tree, 0, NULL);
+       line != NULL;
+       line = _gtk_text_line_next (line))
+    {
+      g_clear_pointer (&line->search_signature, g_free);
+      gtk_text_line_invalidate_search (line);
+    }
+}
+
+gboolean
+_gtk_text_btree_get_search_index (GtkTextBTree *tree)
+{
+  return tree->search_index;
+}
+
 /*
  * Non-public function implementations
  */
@@ -4770,6 +4999,7 @@ gtk_text_line_destroy (GtkTextBTree *tree, GtkTextLine *line)
       ld = next;
     }
 
+  g_free (line->search_signature);
   g_free (line);
 }
 
@@ -54,6 +54,10 @@ guint _gtk_text_btree_get_chars_changed_stamp    (GtkTextBTree *tree);
 guint _gtk_text_btree_get_segments_changed_stamp (GtkTextBTree *tree);
 void  _gtk_text_btree_segments_changed           (GtkTextBTree *tree);
 
+void     _gtk_text_btree_set_search_index (GtkTextBTree *tree,
+                                           gboolean      search_index);
+gboolean _gtk_text_btree_get_search_index (GtkTextBTree *tree);
+
 gboolean _gtk_text_btree_is_end (GtkTextBTree       *tree,
                                  GtkTextLine        *line,
                                  GtkTextLineSegment *seg,
@@ -246,6 +250,31 @@ struct _GtkTextLine {
   guchar dir_strong;                /* BiDi algo dir of line */
   guchar dir_propagated_back;       /* BiDi algo dir of next line */
   guchar dir_propagated_forward;    /* BiDi algo dir of prev line */
+  guchar search_flags;              /* GtkTextLineSearchFlags */
+  guint64 *search_signature;        /* Trigrams of the line, allocated
+                                     * on the first indexed search */
+};
+
+/*
+ * Search index: every line caches a small bloom filter of the
+ * (ASCII-lowercased) byte trigrams of its text. A search string can
+ * only be found in lines whose filter contains all of its trigrams,
+ * so searches can skip all other lines without looking at their text.
+ */
+
+#define GTK_TEXT_SEARCH_SIGNATURE_SIZE 4 /* in guint64, so 256 bits */
+
+typedef enum {
+  GTK_TEXT_LINE_SEARCH_VALID     = 1 << 0, /* search_signature is up to date */
+  GTK_TEXT_LINE_SEARCH_NON_ASCII = 1 << 1, /* line contains non-ASCII text */
+  GTK_TEXT_LINE_SEARCH_NON_TEXT  = 1 << 2  /* line contains paintables or child anchors */
+} GtkTextLineSearchFlags;
+
+typedef struct _GtkTextSearchSignature GtkTextSearchSignature;
+
+struct _GtkTextSearchSignature {
+  guint64 bits[GTK_TEXT_SEARCH_SIGNATURE_SIZE];
+  guchar unsure_flags;              /* lines with these flags can't be skipped */
 };
 
 
@@ -319,6 +348,18 @@ GtkTextLine    *    _gtk_text_line_previous_could_contain_tag (GtkTextLine
                                                                GtkTextBTree        *tree,
                                                                GtkTextTag          *tag);
 
+gboolean            _gtk_text_search_signature_init            (GtkTextSearchSignature       *signature,
+                                                                const char                   *str,
+                                                                gboolean                      case_insensitive);
+gboolean            _gtk_text_line_could_contain_text          (GtkTextLine                  *line,
+                                                                const GtkTextSearchSignature *signature);
+GtkTextLine    *    _gtk_text_line_next_could_contain_text     (GtkTextLine                  *line,
+                                                                const GtkTextSearchSignature *signature,
+                                                                GtkTextLine                  *last_line);
+GtkTextLine    *    _gtk_text_line_previous_could_contain_text (GtkTextLine                  *line,
+                                                                const GtkTextSearchSignature *signature,
+                                                                GtkTextLine                  *first_line);
+
 GtkTextLineData    *_gtk_text_line_data_new                   (GtkTextLayout     *layout,
                                                                GtkTextLine       *line);
 
@@ -26,6 +26,7 @@
 #include "config.h"
 #include <string.h>
 #include <stdarg.h>
+#include <glib/gi18n-lib.h>
 
 #include "gtkmarshalers.h"
 #include "gtktextbuffer.h"
@@ -119,6 +120,7 @@ enum {
   PROP_CAN_UNDO,
   PROP_CAN_REDO,
   PROP_ENABLE_UNDO,
+  PROP_ENABLE_SEARCH_INDEX,
   LAST_PROP
 };
 
@@ -520,6 +522,19 @@ gtk_text_buffer_class_init (GtkTextBufferClass *klass)
                           TRUE,
                           GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkTextBuffer:enable-search-index: (attributes org.gtk.Property.get=gtk_text_buffer_get_enable_search_index org.gtk.Property.set=gtk_text_buffer_set_enable_search_index)
+   *
+   * Whether searches in the buffer use an index to skip lines
+   * that can't contain the search string.
+   *
+   * Since: 4.12
+   */
+  text_buffer_props[PROP_ENABLE_SEARCH_INDEX] =
+    g_param_spec_boolean ("enable-search-index", NULL, NULL,
+                          FALSE,
+                          GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkTextBuffer:cursor-position:
    *
@@ -979,6 +994,10 @@ gtk_text_buffer_set_property (GObject         *object,
       gtk_text_buffer_set_enable_undo (text_buffer, g_value_get_boolean (value));
       break;
 
+    case PROP_ENABLE_SEARCH_INDEX:
+      gtk_text_buffer_set_enable_search_index (text_buffer, g_value_get_boolean (value));
+      break;
+
     case PROP_TAG_TABLE:
       set_table (text_buffer, g_value_get_object (value));
       break;
@@ -1011,6 +1030,10 @@ gtk_text_buffer_get_property (GObject         *object,
       g_value_set_boolean (value, gtk_text_buffer_get_enable_undo (text_buffer));
       break;
 
+    case PROP_ENABLE_SEARCH_INDEX:
+      g_value_set_boolean (value, gtk_text_buffer_get_enable_search_index (text_buffer));
+      break;
+
     case PROP_TAG_TABLE:
       g_value_set_object (value, get_table (text_buffer));
       break;
@@ -1283,6 +1306,403 @@ gtk_text_buffer_insert_at_cursor (GtkTextBuffer *buffer,
   gtk_text_buffer_insert (buffer, &iter, text, len);
 }
 
+/* Loading streams: A thread reads the stream and cuts it into
+ * validated chunks that end at line ends where possible. The
+ * chunks are inserted from an idle with a time budget, so the
+ * main loop keeps running while big files are loaded.
+ *
+ * The thread waits while LOAD_MAX_PENDING_CHUNKS chunks have not
+ * been inserted yet, so that a fast reader does not end up with
+ * the whole stream in memory.
+ */
+
+#define LOAD_CHUNK_SIZE (64 * 1024)
+#define LOAD_MAX_PENDING_CHUNKS 16
+#define LOAD_TIME_BUDGET (G_USEC_PER_SEC / 500)
+
+typedef struct
+{
+  GtkTextMark *mark;
+  GError *error;        /* set when reading is done */
+  guint idle_id;
+  guint reading : 1;
+
+  GMutex lock;
+  GCond cond;           /* signaled when a chunk was taken or stopped is set */
+  GQueue chunks;        /* GBytes, filled by the reading thread */
+  gboolean stopped;     /* no more chunks will be taken */
+} LoadData;
+
+static void
+load_data_free (gpointer data)
+{
+  LoadData *load = data;
+
+  g_queue_clear_full (&load->chunks, (GDestroyNotify) g_bytes_unref);
+  g_mutex_clear (&load->lock);
+  g_cond_clear (&load->cond);
+  g_clear_error (&load->error);
+  g_free (load);
+}
+
+/* Returns the length of the longest prefix of @data that can be
+ * inserted on its own, without splitting characters or \r\n.
+ */
+static gsize
+find_chunk_end (const guchar *data,
+                gsize         size)
+{
+  gsize i;
+
+  for (i = size; i > 0; i--)
+    {
+      if (data[i - 1] == '\n')
+        return i;
+    }
+
+  /* No line end, back off to a character start */
+  for (i = size - 1; i > 0; i--)
+    {
+      if ((data[i] & 0xc0) != 0x80)
+        break;
+    }
+
+  if (i > 0 && data[i - 1] == '\r')
+    i--;
+
+  return i;
+}
+
+static gboolean
+load_wakeup_cb (gpointer data);
+
+static gboolean
+push_chunk (GTask        *task,
+            LoadData     *load,
+            const guchar *data,
+            gsize         size,
+            GError      **error)
+{
+  const char *valid_end;
+  gboolean valid;
+
+  valid = g_utf8_validate_len ((const char *) data, size, &valid_end);
+  size = (const guchar *) valid_end - data;
+
+  if (size > 0)
+    {
+      gboolean stopped;
+
+      g_mutex_lock (&load->lock);
+      while (load->chunks.length >= LOAD_MAX_PENDING_CHUNKS && !load->stopped)
+        g_cond_wait (&load->cond, &load->lock);
+      stopped = load->stopped;
+      if (!stopped)
+        g_queue_push_tail (&load->chunks, g_bytes_new (data, size));
+      g_mutex_unlock (&load->lock);
+
+      /* Only happens when the task was cancelled */
+      if (stopped)
+        {
+          g_cancellable_set_error_if_cancelled (g_task_get_cancellable (task), error);
+          return FALSE;
+        }
+
+      g_main_context_invoke_full (g_task_get_context (task),
+                                  g_task_get_priority (task),
+                                  load_wakeup_cb,
+                                  g_object_ref (task),
+                                  g_object_unref);
+    }
+
+  if (!valid)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                           _("The text is not valid UTF-8"));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+load_thread (GTask        *read_task,
+             gpointer      source_object,
+             gpointer      task_data,
+             GCancellable *cancellable)
+{
+  GTask *task = task_data;
+  LoadData *load = g_task_get_task_data (task);
+  GByteArray *buffer;
+  GError *error = NULL;
+  gsize size, end;
+  gssize n_read;
+
+  buffer = g_byte_array_sized_new (2 * LOAD_CHUNK_SIZE);
+
+  while (TRUE)
+    {
+      size = buffer->len;
+      g_byte_array_set_size (buffer, size + LOAD_CHUNK_SIZE);
+      n_read = g_input_stream_read (source_object,
+                                    buffer->data + size,
+                                    LOAD_CHUNK_SIZE,
+                                    cancellable,
+                                    &error);
+      if (n_read < 0)
+        break;
+
+      g_byte_array_set_size (buffer, size + n_read);
+
+      if (n_read == 0)
+        {
+          /* Insert what's left */
+          if (buffer->len > 0)
+            push_chunk (task, load, buffer->data, buffer->len, &error);
+          break;
+        }
+
+      if (buffer->len < LOAD_CHUNK_SIZE)
+        continue;
+
+      end = find_chunk_end (buffer->data, buffer->len);
+      if (end == 0)
+        continue;
+
+      if (!push_chunk (task, load, buffer->data, end, &error))
+        break;
+
+      g_byte_array_remove_range (buffer, 0, end);
+    }
+
+  g_byte_array_unref (buffer);
+
+  if (error)
+    g_task_return_error (read_task, error);
+  else
+    g_task_return_boolean (read_task, TRUE);
+}
+
+static void
+load_finish (GTask *task)
+{
+  GtkTextBuffer *buffer = g_task_get_source_object (task);
+  LoadData *load = g_task_get_task_data (task);
+
+  /* Don't let the reading thread wait for us */
+  g_mutex_lock (&load->lock);
+  load->stopped = TRUE;
+  g_cond_broadcast (&load->cond);
+  g_mutex_unlock (&load->lock);
+
+  gtk_text_buffer_delete_mark (buffer, load->mark);
+  load->mark = NULL;
+  gtk_text_buffer_end_irreversible_action (buffer);
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  if (load->error)
+    g_task_return_error (task, g_steal_pointer (&load->error));
+  else
+    g_task_return_boolean (task, TRUE);
+}
+
+static gboolean
+load_idle_cb (gpointer data)
+{
+  GTask *task = data;
+  GtkTextBuffer *buffer = g_task_get_source_object (task);
+  LoadData *load = g_task_get_task_data (task);
+  gint64 end_time;
+  GtkTextIter iter;
+  GBytes *chunk;
+
+  if (g_cancellable_is_cancelled (g_task_get_cancellable (task)))
+    {
+      load->idle_id = 0;
+      load_finish (task);
+      return G_SOURCE_REMOVE;
+    }
+
+  end_time = g_get_monotonic_time () + LOAD_TIME_BUDGET;
+
+  do
+    {
+      g_mutex_lock (&load->lock);
+      chunk = g_queue_pop_head (&load->chunks);
+      if (chunk)
+        g_cond_signal (&load->cond);
+      g_mutex_unlock (&load->lock);
+
+      if (chunk == NULL)
+        {
+          if (load->reading)
+            {
+              /* Wait for the thread to read more */
+              load->idle_id = 0;
+              return G_SOURCE_REMOVE;
+            }
+
+          load->idle_id = 0;
+          load_finish (task);
+          return G_SOURCE_REMOVE;
+        }
+
+      gtk_text_buffer_get_iter_at_mark (buffer, &iter, load->mark);
+      gtk_text_buffer_insert (buffer, &iter,
+                              g_bytes_get_data (chunk, NULL),
+                              g_bytes_get_size (chunk));
+      g_bytes_unref (chunk);
+    }
+  while (g_get_monotonic_time () < end_time);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+load_start_inserting (GTask *task)
+{
+  LoadData *load = g_task_get_task_data (task);
+  GSource *source;
+
+  /* Already inserting, or done */
+  if (load->idle_id != 0 || load->mark == NULL)
+    return;
+
+  /* In the context the operation was started in, which
+   * is where the wakeups and the callback happen, too */
+  source = g_idle_source_new ();
+  g_source_set_priority (source, G_PRIORITY_DEFAULT_IDLE);
+  g_source_set_callback (source, load_idle_cb, g_object_ref (task), g_object_unref);
+  g_source_set_static_name (source, "[gtk] gtk_text_buffer_insert_stream");
+  load->idle_id = g_source_attach (source, g_task_get_context (task));
+  g_source_unref (source);
+}
+
+static gboolean
+load_wakeup_cb (gpointer data)
+{
+  load_start_inserting (data);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+load_read_done (GObject      *source,
+                GAsyncResult *result,
+                gpointer      data)
+{
+  GTask *task = data;
+  LoadData *load = g_task_get_task_data (task);
+
+  load->reading = FALSE;
+  g_task_propagate_boolean (G_TASK (result), &load->error);
+
+  /* Insert the remaining chunks, then finish */
+  load_start_inserting (task);
+
+  g_object_unref (task);
+}
+
+/**
+ * gtk_text_buffer_insert_stream_async:
+ * @buffer: a `GtkTextBuffer`
+ * @iter: a position in @buffer
+ * @stream: a `GInputStream` providing UTF-8 text
+ * @io_priority: the I/O priority of the request
+ * @cancellable: (nullable): optional `GCancellable` object
+ * @callback: (scope async): callback to call when the text is inserted
+ * @user_data: (closure): data to pass to @callback
+ *
+ * Inserts the text read from @stream at @iter, without blocking
+ * the main loop for long.
+ *
+ * This is meant for loading big files. The stream is read and
+ * validated on a separate thread and the text is inserted in
+ * pieces from the main loop, so a `GtkTextView` showing @buffer
+ * can display and scroll the text that has been inserted while
+ * the rest is still loading. To load a `GBytes` or a `GMappedFile`,
+ * use a `GMemoryInputStream`.
+ *
+ * The text is inserted at a mark that is created at @iter, so
+ * later pieces are inserted after earlier ones even if @buffer
+ * is changed while loading. Loading is an irreversible action,
+ * see [method@Gtk.TextBuffer.begin_irreversible_action].
+ *
+ * If the stream does not contain valid UTF-8, the valid text
+ * before the problem is inserted and the operation fails with
+ * %G_IO_ERROR_INVALID_DATA.
+ *
+ * Since: 4.12
+ */
+void
+gtk_text_buffer_insert_stream_async (GtkTextBuffer       *buffer,
+                                     GtkTextIter         *iter,
+                                     GInputStream        *stream,
+                                     int                  io_priority,
+                                     GCancellable        *cancellable,
+                                     GAsyncReadyCallback  callback,
+                                     gpointer             user_data)
+{
+  GTask *task, *read_task;
+  LoadData *load;
+
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (iter != NULL);
+  g_return_if_fail (gtk_text_iter_get_buffer (iter) == buffer);
+  g_return_if_fail (G_IS_INPUT_STREAM (stream));
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  load = g_new0 (LoadData, 1);
+  load->mark = gtk_text_buffer_create_mark (buffer, NULL, iter, FALSE);
+  load->reading = TRUE;
+  g_mutex_init (&load->lock);
+  g_cond_init (&load->cond);
+  g_queue_init (&load->chunks);
+
+  task = g_task_new (buffer, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gtk_text_buffer_insert_stream_async);
+  g_task_set_priority (task, io_priority);
+  g_task_set_task_data (task, load, load_data_free);
+
+  gtk_text_buffer_begin_irreversible_action (buffer);
+
+  read_task = g_task_new (stream, cancellable, load_read_done, g_object_ref (task));
+  g_task_set_source_tag (read_task, gtk_text_buffer_insert_stream_async);
+  g_task_set_priority (read_task, io_priority);
+  g_task_set_task_data (read_task, task, NULL);
+  g_task_run_in_thread (read_task, load_thread);
+
+  g_object_unref (read_task);
+  g_object_unref (task);
+}
+
+/**
+ * gtk_text_buffer_insert_stream_finish:
+ * @buffer: a `GtkTextBuffer`
+ * @result: a `GAsyncResult`
+ * @error: return location for a `GError`
+ *
+ * Finishes an asynchronous insertion started with
+ * [method@Gtk.TextBuffer.insert_stream_async].
+ *
+ * Returns: %TRUE if the whole stream was inserted
+ *
+ * Since: 4.12
+ */
+gboolean
+gtk_text_buffer_insert_stream_finish (GtkTextBuffer  *buffer,
+                                      GAsyncResult   *result,
+                                      GError        **error)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, buffer), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gtk_text_buffer_insert_stream_async, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
 /**
  * gtk_text_buffer_insert_interactive:
  * @buffer: a `GtkTextBuffer`
@@ -5045,6 +5465,133 @@ gtk_text_buffer_set_enable_undo (GtkTextBuffer *buffer,
     }
 }
 
+/**
+ * gtk_text_buffer_get_enable_search_index: (attributes org.gtk.Method.get_property=enable-search-index)
+ * @buffer: a `GtkTextBuffer`
+ *
+ * Gets whether searches in the buffer use an index.
+ *
+ * Returns: %TRUE if the search index is enabled
+ *
+ * Since: 4.12
+ */
+gboolean
+gtk_text_buffer_get_enable_search_index (GtkTextBuffer *buffer)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), FALSE);
+
+  return _gtk_text_btree_get_search_index (get_btree (buffer));
+}
+
+/**
+ * gtk_text_buffer_set_enable_search_index: (attributes org.gtk.Method.set_property=enable-search-index)
+ * @buffer: a `GtkTextBuffer`
+ * @enable_search_index: %TRUE to enable the search index
+ *
+ * Sets whether searches in the buffer use an index.
+ *
+ * The index keeps a small summary of the text of every line,
+ * which lets [method@Gtk.TextIter.forward_search],
+ * [method@Gtk.TextIter.backward_search] and
+ * [method@Gtk.TextBuffer.find_all] skip most lines
+ * that can't contain the search string without looking
+ * at their text.
+ *
+ * The summary of a line is computed by the first search
+ * that looks at the line and recomputed after the line
+ * changed, so repeated searches in big buffers that change
+ * little get much faster, at the cost of some memory per line.
+ *
+ * Searches with %GTK_TEXT_SEARCH_VISIBLE_ONLY don't use the index.
+ *
+ * Since: 4.12
+ */
+void
+gtk_text_buffer_set_enable_search_index (GtkTextBuffer *buffer,
+                                         gboolean       enable_search_index)
+{
+  GtkTextBTree *tree;
+
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+
+  tree = get_btree (buffer);
+  enable_search_index = !!enable_search_index;
+
+  if (enable_search_index != _gtk_text_btree_get_search_index (tree))
+    {
+      _gtk_text_btree_set_search_index (tree, enable_search_index);
+      g_object_notify_by_pspec (G_OBJECT (buffer),
+                                text_buffer_props[PROP_ENABLE_SEARCH_INDEX]);
+    }
+}
+
+/**
+ * gtk_text_buffer_find_all:
+ * @buffer: a `GtkTextBuffer`
+ * @str: the string to search for, must not be empty
+ * @flags: flags affecting how the search is done
+ * @start: (nullable): where to start searching, or %NULL for the start of the buffer
+ * @end: (nullable): where to stop searching, or %NULL for the end of the buffer
+ * @n_marks: (out): return location for the number of returned marks
+ *
+ * Finds all non-overlapping occurrences of @str between @start
+ * and @end, as [method@Gtk.TextIter.forward_search] would find them.
+ *
+ * For every match, an anonymous mark is created at its start and
+ * one at its end, so the returned array holds twice as many marks
+ * as matches were found. The marks keep tracking the matches while
+ * the buffer is edited. Text inserted at the start or end of a match
+ * is not included in it.
+ *
+ * The marks belong to the buffer. When they are no longer needed,
+ * remove them with [method@Gtk.TextBuffer.delete_mark].
+ *
+ * This is faster on big buffers with
+ * [property@Gtk.TextBuffer:enable-search-index] enabled.
+ *
+ * Returns: (array length=n_marks) (transfer container): the start
+ *   and end marks of all matches, %NULL-terminated
+ *
+ * Since: 4.12
+ */
+GtkTextMark **
+gtk_text_buffer_find_all (GtkTextBuffer      *buffer,
+                          const char         *str,
+                          GtkTextSearchFlags  flags,
+                          const GtkTextIter  *start,
+                          const GtkTextIter  *end,
+                          gsize              *n_marks)
+{
+  GtkTextIter iter, match_start, match_end;
+  GPtrArray *marks;
+
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), NULL);
+  g_return_val_if_fail (str != NULL && *str != '\0', NULL);
+  g_return_val_if_fail (start == NULL || gtk_text_iter_get_buffer (start) == buffer, NULL);
+  g_return_val_if_fail (end == NULL || gtk_text_iter_get_buffer (end) == buffer, NULL);
+  g_return_val_if_fail (n_marks != NULL, NULL);
+
+  marks = g_ptr_array_new ();
+
+  if (start)
+    iter = *start;
+  else
+    gtk_text_buffer_get_start_iter (buffer, &iter);
+
+  while (gtk_text_iter_forward_search (&iter, str, flags, &match_start, &match_end, end))
+    {
+      g_ptr_array_add (marks, gtk_text_buffer_create_mark (buffer, NULL, &match_start, FALSE));
+      g_ptr_array_add (marks, gtk_text_buffer_create_mark (buffer, NULL, &match_end, TRUE));
+
+      iter = match_end;
+    }
+
+  *n_marks = marks->len;
+  g_ptr_array_add (marks, NULL);
+
+  return (GtkTextMark **) g_ptr_array_free (marks, FALSE);
+}
+
 /**
  * gtk_text_buffer_begin_irreversible_action:
  * @buffer: a `GtkTextBuffer`
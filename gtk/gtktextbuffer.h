@@ -167,6 +167,18 @@ GDK_AVAILABLE_IN_ALL
 void gtk_text_buffer_insert_at_cursor  (GtkTextBuffer *buffer,
                                         const char    *text,
                                         int            len);
+GDK_AVAILABLE_IN_4_12
+void     gtk_text_buffer_insert_stream_async  (GtkTextBuffer        *buffer,
+                                               GtkTextIter          *iter,
+                                               GInputStream         *stream,
+                                               int                   io_priority,
+                                               GCancellable         *cancellable,
+                                               GAsyncReadyCallback   callback,
+                                               gpointer              user_data);
+GDK_AVAILABLE_IN_4_12
+gboolean gtk_text_buffer_insert_stream_finish (GtkTextBuffer        *buffer,
+                                               GAsyncResult         *result,
+                                               GError              **error);
 
 GDK_AVAILABLE_IN_ALL
 gboolean gtk_text_buffer_insert_interactive           (GtkTextBuffer *buffer,
@@ -442,6 +454,18 @@ gboolean        gtk_text_buffer_get_enable_undo           (GtkTextBuffer *buffer
 GDK_AVAILABLE_IN_ALL
 void            gtk_text_buffer_set_enable_undo           (GtkTextBuffer *buffer,
                                                            gboolean       enable_undo);
+GDK_AVAILABLE_IN_4_12
+gboolean        gtk_text_buffer_get_enable_search_index   (GtkTextBuffer *buffer);
+GDK_AVAILABLE_IN_4_12
+void            gtk_text_buffer_set_enable_search_index   (GtkTextBuffer *buffer,
+                                                           gboolean       enable_search_index);
+GDK_AVAILABLE_IN_4_12
+GtkTextMark   **gtk_text_buffer_find_all                  (GtkTextBuffer      *buffer,
+                                                           const char         *str,
+                                                           GtkTextSearchFlags  flags,
+                                                           const GtkTextIter  *start,
+                                                           const GtkTextIter  *end,
+                                                           gsize              *n_marks);
 GDK_AVAILABLE_IN_ALL
 guint           gtk_text_buffer_get_max_undo_levels       (GtkTextBuffer *buffer);
 GDK_AVAILABLE_IN_ALL
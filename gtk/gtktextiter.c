@@ -4968,7 +4968,8 @@ strbreakup (const char *string,
  * of the match and @match_end to the first character after the match.
  * The search will not continue past @limit. Note that a search is a
  * linear or O(n) operation, so you may wish to use @limit to avoid
- * locking up your UI on large buffers.
+ * locking up your UI on large buffers. Repeated searches in large
+ * buffers are faster with [property@Gtk.TextBuffer:enable-search-index].
  *
  * @match_start will never be set to a `GtkTextIter` located before @iter,
  * even if there is a possible @match_end after or at @iter.
@@ -4987,6 +4988,9 @@ gtk_text_iter_forward_search (const GtkTextIter *iter,
   GtkTextIter match;
   gboolean retval = FALSE;
   GtkTextIter search;
+  GtkTextBTree *tree;
+  GtkTextSearchSignature signature;
+  gboolean use_index;
   gboolean visible_only;
   gboolean slice;
   gboolean case_insensitive;
@@ -5027,6 +5031,14 @@ gtk_text_iter_forward_search (const GtkTextIter *iter,
 
   lines = strbreakup (str, "\n", -1, NULL, case_insensitive);
 
+  /* Invisible text is only known to the layout, so the
+   * index can't tell which lines have visible matches.
+   */
+  tree = _gtk_text_iter_get_btree (iter);
+  use_index = _gtk_text_btree_get_search_index (tree) &&
+              !visible_only &&
+              _gtk_text_search_signature_init (&signature, str, case_insensitive);
+
   search = *iter;
 
   do
@@ -5037,6 +5049,21 @@ gtk_text_iter_forward_search (const GtkTextIter *iter,
        */
       GtkTextIter end;
 
+      if (use_index &&
+          !_gtk_text_line_could_contain_text (_gtk_text_iter_get_text_line (&search), &signature))
+        {
+          GtkTextLine *line;
+
+          /* Lines after the limit's can't have a match */
+          line = _gtk_text_line_next_could_contain_text (_gtk_text_iter_get_text_line (&search),
+                                                         &signature,
+                                                         limit ? _gtk_text_iter_get_text_line (limit) : NULL);
+          if (line == NULL)
+            break;
+
+          _gtk_text_btree_get_iter_at_line (tree, &search, line, 0);
+        }
+
       if (limit &&
           gtk_text_iter_compare (&search, limit) >= 0)
         break;
@@ -5156,6 +5183,11 @@ struct _LinesWindow
   GtkTextIter first_line_start;
   GtkTextIter first_line_end;
 
+  /* Lines that can't match are skipped if set, but
+   * not beyond @limit_line */
+  const GtkTextSearchSignature *signature;
+  GtkTextLine *limit_line;
+
   guint slice : 1;
   guint visible_only : 1;
 };
@@ -5236,15 +5268,26 @@ lines_window_back (LinesWindow *win)
 
   new_start = win->first_line_start;
 
-  if (!gtk_text_iter_backward_line (&new_start))
-    return FALSE;
-  else
+  if (win->signature)
     {
-      win->first_line_start = new_start;
-      win->first_line_end = new_start;
+      GtkTextBTree *tree = _gtk_text_iter_get_btree (&new_start);
+      GtkTextLine *line;
 
-      gtk_text_iter_forward_line (&win->first_line_end);
+      line = _gtk_text_line_previous_could_contain_text (_gtk_text_iter_get_text_line (&new_start),
+                                                         win->signature,
+                                                         win->limit_line);
+      if (line == NULL)
+        return FALSE;
+
+      _gtk_text_btree_get_iter_at_line (tree, &new_start, line, 0);
     }
+  else if (!gtk_text_iter_backward_line (&new_start))
+    return FALSE;
+
+  win->first_line_start = new_start;
+  win->first_line_end = new_start;
+
+  gtk_text_iter_forward_line (&win->first_line_end);
 
   if (win->slice)
     {
@@ -5311,6 +5354,7 @@ gtk_text_iter_backward_search (const GtkTextIter *iter,
   char **l;
   int n_lines;
   LinesWindow win;
+  GtkTextSearchSignature signature;
   gboolean retval = FALSE;
   gboolean visible_only;
   gboolean slice;
@@ -5354,6 +5398,17 @@ gtk_text_iter_backward_search (const GtkTextIter *iter,
   win.n_lines = n_lines;
   win.slice = slice;
   win.visible_only = visible_only;
+  win.signature = NULL;
+  win.limit_line = limit ? _gtk_text_iter_get_text_line (limit) : NULL;
+
+  /* The window only moves line by line if the
+   * search string spans multiple lines.
+   */
+  if (n_lines == 1 &&
+      !visible_only &&
+      _gtk_text_btree_get_search_index (_gtk_text_iter_get_btree (iter)) &&
+      _gtk_text_search_signature_init (&signature, str, case_insensitive))
+    win.signature = &signature;
 
   lines_window_init (&win, iter);
 
@@ -28,15 +28,24 @@
  * GtkTreeListModel:
  *
  * `GtkTreeListModel` is a list model that can create child models on demand.
+ *
+ * Expanding big trees all at once can take a long time. The model can
+ * be set up to expand rows incrementally instead, see
+ * [method@Gtk.TreeListModel.set_incremental] for details.
  */
 
+/* How long one step of incremental expanding may take */
+#define GTK_TREE_LIST_MODEL_EXPAND_BUDGET (G_USEC_PER_SEC / 500)
+
 enum {
   PROP_0,
   PROP_AUTOEXPAND,
+  PROP_INCREMENTAL,
   PROP_ITEM_TYPE,
   PROP_MODEL,
   PROP_N_ITEMS,
   PROP_PASSTHROUGH,
+  PROP_PENDING,
   NUM_PROPERTIES
 };
 
@@ -56,12 +65,16 @@ struct _TreeNode
 
   guint empty : 1;
   guint is_root : 1;
+  guint expand_pending : 1; /* waiting to be expanded incrementally, with all children */
+  guint expand_urgent : 1; /* pending, but was looked at, so expand it soon */
 };
 
 struct _TreeAugment
 {
   guint n_items;
   guint n_local;
+  guint n_pending; /* includes the children's */
+  guint n_urgent; /* includes the children's */
 };
 
 struct _GtkTreeListModel
@@ -74,7 +87,10 @@ struct _GtkTreeListModel
   gpointer user_data;
   GDestroyNotify user_destroy;
 
+  guint expand_cb; /* idle handle for incremental expanding */
+
   guint autoexpand : 1;
+  guint incremental : 1;
   guint passthrough : 1;
 };
 
@@ -168,6 +184,26 @@ tree_node_get_n_children (TreeNode *node)
   return child_aug->n_items;
 }
 
+/* Number of nodes below @node waiting to be expanded */
+static guint
+tree_node_get_n_pending (TreeNode *node,
+                         gboolean  urgent)
+{
+  TreeAugment *child_aug;
+  TreeNode *child_node;
+
+  if (node->children == NULL)
+    return 0;
+
+  child_node = gtk_rb_tree_get_root (node->children);
+  if (child_node == NULL)
+    return 0;
+
+  child_aug = gtk_rb_tree_get_augment (node->children, child_node);
+
+  return urgent ? child_aug->n_urgent : child_aug->n_pending;
+}
+
 static guint
 tree_node_get_position (TreeNode *node)
 {
@@ -308,8 +344,9 @@ tree_node_get_row (TreeNode *node)
 }
 
 static guint
-gtk_tree_list_model_expand_node (GtkTreeListModel *self,
-                                 TreeNode         *node);
+gtk_tree_list_model_expand_child (GtkTreeListModel *self,
+                                  TreeNode         *node,
+                                  gboolean          recursive);
 
 static void
 gtk_tree_list_model_items_changed_cb (GListModel *model,
@@ -378,7 +415,7 @@ gtk_tree_list_model_items_changed_cb (GListModel *model,
     {
       for (i = 0; i < added; i++)
         {
-          tree_added += gtk_tree_list_model_expand_node (self, child);
+          tree_added += gtk_tree_list_model_expand_child (self, child, FALSE);
           child = gtk_rb_tree_node_get_next (child);
         }
     }
@@ -394,6 +431,7 @@ gtk_tree_list_model_items_changed_cb (GListModel *model,
 }
 
 static void gtk_tree_list_row_destroy (GtkTreeListRow *row);
+static void gtk_tree_list_row_notify_expanded (GtkTreeListRow *row);
 
 static void
 gtk_tree_list_model_clear_node_children (TreeNode *node)
@@ -436,29 +474,37 @@ gtk_tree_list_model_augment (GtkRbTree *tree,
                              gpointer   right)
 {
   TreeAugment *aug = _aug;
+  TreeNode *node = _node;
 
   aug->n_items = 1;
-  aug->n_items += tree_node_get_n_children (_node);
+  aug->n_items += tree_node_get_n_children (node);
   aug->n_local = 1;
+  aug->n_pending = node->expand_pending + tree_node_get_n_pending (node, FALSE);
+  aug->n_urgent = node->expand_urgent + tree_node_get_n_pending (node, TRUE);
 
   if (left)
     {
       TreeAugment *left_aug = gtk_rb_tree_get_augment (tree, left);
       aug->n_items += left_aug->n_items;
       aug->n_local += left_aug->n_local;
+      aug->n_pending += left_aug->n_pending;
+      aug->n_urgent += left_aug->n_urgent;
     }
   if (right)
     {
       TreeAugment *right_aug = gtk_rb_tree_get_augment (tree, right);
       aug->n_items += right_aug->n_items;
       aug->n_local += right_aug->n_local;
+      aug->n_pending += right_aug->n_pending;
+      aug->n_urgent += right_aug->n_urgent;
     }
 }
 
 static void
 gtk_tree_list_model_init_node (GtkTreeListModel *list,
                                TreeNode         *self,
-                               GListModel       *model)
+                               GListModel       *model,
+                               gboolean          recursive)
 {
   gsize i, n;
   TreeNode *node;
@@ -482,17 +528,26 @@ gtk_tree_list_model_init_node (GtkTreeListModel *list,
       node->parent = self;
       node->item = g_list_model_get_item (model, i);
       g_assert (node ->item);
-      if (list->autoexpand)
-        gtk_tree_list_model_expand_node (list, node);
+      if (recursive || list->autoexpand)
+        gtk_tree_list_model_expand_child (list, node, recursive);
     }
 }
 
+/* If @recursive is set, all children get expanded, too */
 static guint
 gtk_tree_list_model_expand_node (GtkTreeListModel *self,
-                                 TreeNode         *node)
+                                 TreeNode         *node,
+                                 gboolean          recursive)
 {
   GListModel *model;
 
+  if (node->expand_pending)
+    {
+      node->expand_pending = FALSE;
+      node->expand_urgent = FALSE;
+      tree_node_mark_dirty (node);
+    }
+
   if (node->empty)
     return 0;
   
@@ -504,13 +559,37 @@ gtk_tree_list_model_expand_node (GtkTreeListModel *self,
   if (model == NULL)
     return 0;
   
-  gtk_tree_list_model_init_node (self, node, model);
+  gtk_tree_list_model_init_node (self, node, model, recursive);
 
   tree_node_mark_dirty (node);
   
   return tree_node_get_n_children (node);
 }
 
+static void gtk_tree_list_model_start_expanding (GtkTreeListModel *self);
+
+/* Expands a node that was just added because of autoexpand or
+ * because its parent is expanded recursively.
+ * When expanding incrementally, it is only marked to be expanded
+ * later and 0 is returned. */
+static guint
+gtk_tree_list_model_expand_child (GtkTreeListModel *self,
+                                  TreeNode         *node,
+                                  gboolean          recursive)
+{
+  if (!self->incremental)
+    return gtk_tree_list_model_expand_node (self, node, recursive);
+
+  if (!node->expand_pending)
+    {
+      node->expand_pending = TRUE;
+      tree_node_mark_dirty (node);
+    }
+  gtk_tree_list_model_start_expanding (self);
+
+  return 0;
+}
+
 static guint
 gtk_tree_list_model_collapse_node (GtkTreeListModel *self,
                                    TreeNode         *node)
@@ -529,6 +608,177 @@ gtk_tree_list_model_collapse_node (GtkTreeListModel *self,
   return n_items;
 }
 
+/*** Incremental expanding ***/
+
+/* Rows waiting to be expanded are marked as pending, and the
+ * augments count them, so the first one can be found quickly.
+ * Rows that get looked at via get_item() while pending are likely
+ * visible in a view, so they are marked urgent and get expanded
+ * before all others.
+ *
+ * Expanding happens from an idle handler in steps that take
+ * about GTK_TREE_LIST_MODEL_EXPAND_BUDGET. Rows are expanded in
+ * tree order, so the rows added in one step are mostly next to each
+ * other and can be announced with a single ::items-changed.
+ */
+
+/* Finds the first pending node in tree order */
+static TreeNode *
+gtk_tree_list_model_find_pending (GtkTreeListModel *self,
+                                  gboolean          urgent)
+{
+  GtkRbTree *tree;
+  TreeNode *node, *tmp;
+
+  if (tree_node_get_n_pending (&self->root_node, urgent) == 0)
+    return NULL;
+
+  tree = self->root_node.children;
+  node = gtk_rb_tree_get_root (tree);
+
+  while (node)
+    {
+      tmp = gtk_rb_tree_node_get_left (node);
+      if (tmp)
+        {
+          TreeAugment *aug = gtk_rb_tree_get_augment (tree, tmp);
+          if ((urgent ? aug->n_urgent : aug->n_pending) > 0)
+            {
+              node = tmp;
+              continue;
+            }
+        }
+
+      if (urgent ? node->expand_urgent : node->expand_pending)
+        return node;
+
+      if (tree_node_get_n_pending (node, urgent) > 0)
+        {
+          tree = node->children;
+          node = gtk_rb_tree_get_root (tree);
+          continue;
+        }
+
+      node = gtk_rb_tree_node_get_right (node);
+    }
+
+  g_return_val_if_reached (NULL);
+}
+
+/* Expands pending nodes until @end_time */
+static void
+gtk_tree_list_model_expand_pending (GtkTreeListModel *self,
+                                    gint64            end_time)
+{
+  GPtrArray *rows;
+  guint n_items, position, added;
+
+  rows = g_ptr_array_new_with_free_func (g_object_unref);
+  n_items = tree_node_get_n_children (&self->root_node);
+  position = 0;
+  added = 0;
+
+  do
+    {
+      TreeNode *node;
+      guint node_position, n;
+
+      node = gtk_tree_list_model_find_pending (self, TRUE);
+      if (node == NULL)
+        node = gtk_tree_list_model_find_pending (self, FALSE);
+      if (node == NULL)
+        break;
+
+      node_position = tree_node_get_position (node);
+
+      /* The children don't go next to the rows added so far, so
+       * announce those before the model changes again.
+       */
+      if (added > 0 &&
+          (node_position + 1 < position || node_position + 1 > position + added))
+        {
+          g_list_model_items_changed (G_LIST_MODEL (self), position, 0, added);
+          added = 0;
+        }
+
+      n = gtk_tree_list_model_expand_node (self, node, TRUE);
+      if (node->row && node->children)
+        g_ptr_array_add (rows, g_object_ref (node->row));
+      if (n == 0)
+        continue;
+
+      if (added == 0)
+        position = node_position + 1;
+      added += n;
+    }
+  while (g_get_monotonic_time () < end_time);
+
+  if (added > 0)
+    g_list_model_items_changed (G_LIST_MODEL (self), position, 0, added);
+
+  if (n_items != tree_node_get_n_children (&self->root_node))
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+
+  g_ptr_array_foreach (rows, (GFunc) gtk_tree_list_row_notify_expanded, NULL);
+  g_ptr_array_unref (rows);
+}
+
+static gboolean
+gtk_tree_list_model_expand_cb (gpointer data)
+{
+  GtkTreeListModel *self = data;
+
+  gtk_tree_list_model_expand_pending (self, g_get_monotonic_time () + GTK_TREE_LIST_MODEL_EXPAND_BUDGET);
+
+  if (tree_node_get_n_pending (&self->root_node, FALSE) > 0)
+    return G_SOURCE_CONTINUE;
+
+  self->expand_cb = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_tree_list_model_start_expanding (GtkTreeListModel *self)
+{
+  if (self->expand_cb != 0)
+    return;
+
+  self->expand_cb = g_idle_add (gtk_tree_list_model_expand_cb, self);
+  gdk_source_set_static_name_by_id (self->expand_cb, "[gtk] gtk_tree_list_model_expand_cb");
+}
+
+/* Marks all collapsed nodes below @parent as pending */
+static void
+gtk_tree_list_model_mark_pending (TreeNode *parent)
+{
+  TreeNode *node;
+
+  for (node = gtk_rb_tree_get_first (parent->children);
+       node != NULL;
+       node = gtk_rb_tree_node_get_next (node))
+    {
+      if (node->children)
+        gtk_tree_list_model_mark_pending (node);
+      else if (!node->empty && !node->expand_pending)
+        {
+          node->expand_pending = TRUE;
+          tree_node_mark_dirty (node);
+        }
+    }
+}
+
+/* Looking at a pending node means it's probably on screen */
+static void
+tree_node_mark_urgent (TreeNode *node)
+{
+  if (!node->expand_pending || node->expand_urgent)
+    return;
+
+  node->expand_urgent = TRUE;
+  tree_node_mark_dirty (node);
+}
+
 
 static GType
 gtk_tree_list_model_get_item_type (GListModel *list)
@@ -560,6 +810,8 @@ gtk_tree_list_model_get_item (GListModel *list,
   if (node == NULL)
     return NULL;
 
+  tree_node_mark_urgent (node);
+
   if (self->passthrough)
     {
       return g_object_ref (node->item);
@@ -595,6 +847,10 @@ gtk_tree_list_model_set_property (GObject      *object,
       gtk_tree_list_model_set_autoexpand (self, g_value_get_boolean (value));
       break;
 
+    case PROP_INCREMENTAL:
+      gtk_tree_list_model_set_incremental (self, g_value_get_boolean (value));
+      break;
+
     case PROP_PASSTHROUGH:
       self->passthrough = g_value_get_boolean (value);
       break;
@@ -619,6 +875,10 @@ gtk_tree_list_model_get_property (GObject     *object,
       g_value_set_boolean (value, self->autoexpand);
       break;
 
+    case PROP_INCREMENTAL:
+      g_value_set_boolean (value, self->incremental);
+      break;
+
     case PROP_ITEM_TYPE:
       g_value_set_gtype (value, gtk_tree_list_model_get_item_type (G_LIST_MODEL (self)));
       break;
@@ -635,6 +895,10 @@ gtk_tree_list_model_get_property (GObject     *object,
       g_value_set_boolean (value, self->passthrough);
       break;
 
+    case PROP_PENDING:
+      g_value_set_uint (value, gtk_tree_list_model_get_pending (self));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -646,6 +910,7 @@ gtk_tree_list_model_finalize (GObject *object)
 {
   GtkTreeListModel *self = GTK_TREE_LIST_MODEL (object);
 
+  g_clear_handle_id (&self->expand_cb, g_source_remove);
   gtk_tree_list_model_clear_node (&self->root_node);
   if (self->user_destroy)
     self->user_destroy (self->user_data);
@@ -672,6 +937,19 @@ gtk_tree_list_model_class_init (GtkTreeListModelClass *class)
                             FALSE,
                             GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkTreeListModel:incremental: (attributes org.gtk.Property.get=gtk_tree_list_model_get_incremental org.gtk.Property.set=gtk_tree_list_model_set_incremental)
+   *
+   * If rows that get expanded automatically should be expanded
+   * incrementally.
+   *
+   * Since: 4.12
+   */
+  properties[PROP_INCREMENTAL] =
+      g_param_spec_boolean ("incremental", NULL, NULL,
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkTreeListModel:item-type:
    *
@@ -720,6 +998,18 @@ gtk_tree_list_model_class_init (GtkTreeListModelClass *class)
                             FALSE,
                             GTK_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkTreeListModel:pending: (attributes org.gtk.Property.get=gtk_tree_list_model_get_pending)
+   *
+   * The number of rows that are still waiting to be expanded.
+   *
+   * Since: 4.12
+   */
+  properties[PROP_PENDING] =
+      g_param_spec_uint ("pending", NULL, NULL,
+                         0, G_MAXUINT, 0,
+                         GTK_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
 }
 
@@ -767,7 +1057,7 @@ gtk_tree_list_model_new (GListModel                      *root,
   self->user_data = user_data;
   self->user_destroy = user_destroy;
 
-  gtk_tree_list_model_init_node (self, &self->root_node, root);
+  gtk_tree_list_model_init_node (self, &self->root_node, root, FALSE);
 
   return self;
 }
@@ -858,6 +1148,230 @@ gtk_tree_list_model_get_autoexpand (GtkTreeListModel *self)
   return self->autoexpand;
 }
 
+/**
+ * gtk_tree_list_model_set_incremental: (attributes org.gtk.Method.set_property=incremental)
+ * @self: a `GtkTreeListModel`
+ * @incremental: %TRUE to expand rows incrementally
+ *
+ * Sets whether rows that get expanded automatically should be
+ * expanded incrementally.
+ *
+ * This affects rows expanded because of [property@Gtk.TreeListModel:autoexpand]
+ * and by [method@Gtk.TreeListModel.expand_all]. Rows expanded with
+ * [method@Gtk.TreeListRow.set_expanded] are always expanded right away.
+ *
+ * When expanding incrementally, the child models are only created
+ * in an idle handler that runs for a short time per frame, so the
+ * application stays responsive while a big tree gets expanded.
+ * Rows that are looked at with g_list_model_get_item() are expanded
+ * first, so the rows visible in a [class@Gtk.ListView] appear
+ * quickly. The [property@Gtk.TreeListModel:pending] property
+ * can be used to track the progress.
+ *
+ * Turning incremental expanding off while rows are pending expands
+ * them all right away.
+ *
+ * Since: 4.12
+ */
+void
+gtk_tree_list_model_set_incremental (GtkTreeListModel *self,
+                                     gboolean          incremental)
+{
+  g_return_if_fail (GTK_IS_TREE_LIST_MODEL (self));
+
+  if (self->incremental == incremental)
+    return;
+
+  self->incremental = incremental;
+
+  if (!incremental && self->expand_cb != 0)
+    {
+      g_clear_handle_id (&self->expand_cb, g_source_remove);
+      gtk_tree_list_model_expand_pending (self, G_MAXINT64);
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_INCREMENTAL]);
+}
+
+/**
+ * gtk_tree_list_model_get_incremental: (attributes org.gtk.Method.get_property=incremental)
+ * @self: a `GtkTreeListModel`
+ *
+ * Returns whether rows are expanded incrementally.
+ *
+ * See [method@Gtk.TreeListModel.set_incremental] for details.
+ *
+ * Returns: %TRUE if rows are expanded incrementally
+ *
+ * Since: 4.12
+ */
+gboolean
+gtk_tree_list_model_get_incremental (GtkTreeListModel *self)
+{
+  g_return_val_if_fail (GTK_IS_TREE_LIST_MODEL (self), FALSE);
+
+  return self->incremental;
+}
+
+/**
+ * gtk_tree_list_model_get_pending: (attributes org.gtk.Method.get_property=pending)
+ * @self: a `GtkTreeListModel`
+ *
+ * Returns the number of rows that are waiting to be expanded.
+ *
+ * This is always 0 unless the model is
+ * [property@Gtk.TreeListModel:incremental].
+ *
+ * Returns: the number of rows waiting to be expanded
+ *
+ * Since: 4.12
+ */
+guint
+gtk_tree_list_model_get_pending (GtkTreeListModel *self)
+{
+  g_return_val_if_fail (GTK_IS_TREE_LIST_MODEL (self), 0);
+
+  return tree_node_get_n_pending (&self->root_node, FALSE);
+}
+
+static void
+gtk_tree_list_model_expand_all_nodes (GtkTreeListModel *self,
+                                      TreeNode         *parent,
+                                      guint            *first,
+                                      GPtrArray        *rows)
+{
+  TreeNode *node;
+
+  for (node = gtk_rb_tree_get_first (parent->children);
+       node != NULL;
+       node = gtk_rb_tree_node_get_next (node))
+    {
+      if (node->children)
+        {
+          gtk_tree_list_model_expand_all_nodes (self, node, first, rows);
+          continue;
+        }
+
+      if (gtk_tree_list_model_expand_node (self, node, TRUE) == 0)
+        continue;
+
+      if (*first == G_MAXUINT)
+        *first = tree_node_get_position (node) + 1;
+      if (node->row)
+        g_ptr_array_add (rows, g_object_ref (node->row));
+    }
+}
+
+/**
+ * gtk_tree_list_model_expand_all:
+ * @self: a `GtkTreeListModel`
+ *
+ * Expands all rows of @self recursively.
+ *
+ * All rows after the first one that gets expanded are announced
+ * with a single [signal@Gio.ListModel::items-changed] emission,
+ * which is a lot cheaper for views than one emission per row.
+ *
+ * If @self is [property@Gtk.TreeListModel:incremental], the rows
+ * are only marked for expanding and get expanded over time.
+ *
+ * Since: 4.12
+ */
+void
+gtk_tree_list_model_expand_all (GtkTreeListModel *self)
+{
+  GPtrArray *rows;
+  guint old_n_items, n_items, first;
+
+  g_return_if_fail (GTK_IS_TREE_LIST_MODEL (self));
+
+  if (self->incremental)
+    {
+      gtk_tree_list_model_mark_pending (&self->root_node);
+      if (tree_node_get_n_pending (&self->root_node, FALSE) > 0)
+        {
+          gtk_tree_list_model_start_expanding (self);
+          g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+        }
+      return;
+    }
+
+  rows = g_ptr_array_new_with_free_func (g_object_unref);
+  old_n_items = tree_node_get_n_children (&self->root_node);
+  first = G_MAXUINT;
+
+  gtk_tree_list_model_expand_all_nodes (self, &self->root_node, &first, rows);
+
+  n_items = tree_node_get_n_children (&self->root_node);
+  if (first != G_MAXUINT)
+    {
+      g_list_model_items_changed (G_LIST_MODEL (self), first, old_n_items - first, n_items - first);
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+    }
+
+  g_ptr_array_foreach (rows, (GFunc) gtk_tree_list_row_notify_expanded, NULL);
+  g_ptr_array_unref (rows);
+}
+
+/**
+ * gtk_tree_list_model_collapse_all:
+ * @self: a `GtkTreeListModel`
+ *
+ * Collapses all rows of @self, so only the items of the root
+ * model remain.
+ *
+ * Like [method@Gtk.TreeListModel.expand_all], this emits a
+ * single [signal@Gio.ListModel::items-changed].
+ *
+ * Since: 4.12
+ */
+void
+gtk_tree_list_model_collapse_all (GtkTreeListModel *self)
+{
+  GPtrArray *rows;
+  TreeNode *node;
+  guint old_n_items, old_pending, first, i;
+
+  g_return_if_fail (GTK_IS_TREE_LIST_MODEL (self));
+
+  rows = g_ptr_array_new_with_free_func (g_object_unref);
+  old_n_items = tree_node_get_n_children (&self->root_node);
+  old_pending = tree_node_get_n_pending (&self->root_node, FALSE);
+  first = G_MAXUINT;
+
+  for (node = gtk_rb_tree_get_first (self->root_node.children), i = 0;
+       node != NULL;
+       node = gtk_rb_tree_node_get_next (node), i++)
+    {
+      if (node->expand_pending)
+        {
+          node->expand_pending = FALSE;
+          node->expand_urgent = FALSE;
+          tree_node_mark_dirty (node);
+        }
+
+      if (gtk_tree_list_model_collapse_node (self, node) == 0)
+        continue;
+
+      /* all rows before this one are collapsed already */
+      if (first == G_MAXUINT)
+        first = i + 1;
+      if (node->row)
+        g_ptr_array_add (rows, g_object_ref (node->row));
+    }
+
+  if (first != G_MAXUINT)
+    {
+      g_list_model_items_changed (G_LIST_MODEL (self), first, old_n_items - first, i - first);
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+    }
+  if (old_pending > 0)
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+
+  g_ptr_array_foreach (rows, (GFunc) gtk_tree_list_row_notify_expanded, NULL);
+  g_ptr_array_unref (rows);
+}
+
 /**
  * gtk_tree_list_model_get_row:
  * @self: a `GtkTreeListModel`
@@ -895,6 +1409,8 @@ gtk_tree_list_model_get_row (GtkTreeListModel *self,
   if (node == NULL)
     return NULL;
 
+  tree_node_mark_urgent (node);
+
   return tree_node_get_row (node);
 }
 
@@ -969,6 +1485,13 @@ gtk_tree_list_row_destroy (GtkTreeListRow *self)
   g_object_notify_by_pspec (G_OBJECT (self), row_properties[ROW_PROP_EXPANDED]);
 }
 
+static void
+gtk_tree_list_row_notify_expanded (GtkTreeListRow *self)
+{
+  g_object_notify_by_pspec (G_OBJECT (self), row_properties[ROW_PROP_EXPANDED]);
+  g_object_notify_by_pspec (G_OBJECT (self), row_properties[ROW_PROP_CHILDREN]);
+}
+
 static void
 gtk_tree_list_row_set_property (GObject      *object,
                                 guint         prop_id,
@@ -1180,24 +1703,36 @@ gtk_tree_list_row_set_expanded (GtkTreeListRow *self,
 {
   GtkTreeListModel *list;
   gboolean was_expanded;
-  guint n_items;
+  guint n_items, n_pending;
 
   g_return_if_fail (GTK_IS_TREE_LIST_ROW (self));
 
   if (self->node == NULL)
     return;
 
-  was_expanded = self->node->children != NULL;
-  if (was_expanded == expanded)
-    return;
-
   list = tree_node_get_tree_list_model (self->node);
   if (list == NULL)
     return;
 
+  n_pending = gtk_tree_list_model_get_pending (list);
+
+  /* Collapsing a row that is waiting to be expanded keeps it collapsed */
+  if (!expanded && self->node->expand_pending)
+    {
+      self->node->expand_pending = FALSE;
+      self->node->expand_urgent = FALSE;
+      tree_node_mark_dirty (self->node);
+      g_object_notify_by_pspec (G_OBJECT (list), properties[PROP_PENDING]);
+    }
+
+  was_expanded = self->node->children != NULL;
+  if (was_expanded == expanded)
+    return;
+
   if (expanded)
     {
-      n_items = gtk_tree_list_model_expand_node (list, self->node);
+      /* Rows pending because of gtk_tree_list_model_expand_all() expand recursively */
+      n_items = gtk_tree_list_model_expand_node (list, self->node, self->node->expand_pending);
       if (n_items > 0)
         {
           g_list_model_items_changed (G_LIST_MODEL (list), tree_node_get_position (self->node) + 1, 0, n_items);
@@ -1214,6 +1749,9 @@ gtk_tree_list_row_set_expanded (GtkTreeListRow *self,
         }
     }
 
+  if (n_pending != gtk_tree_list_model_get_pending (list))
+    g_object_notify_by_pspec (G_OBJECT (list), properties[PROP_PENDING]);
+
   g_object_notify_by_pspec (G_OBJECT (self), row_properties[ROW_PROP_EXPANDED]);
   g_object_notify_by_pspec (G_OBJECT (self), row_properties[ROW_PROP_CHILDREN]);
 }
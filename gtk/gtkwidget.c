@@ -3505,16 +3505,49 @@ gtk_widget_queue_draw (GtkWidget *widget)
     {
       GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
 
-      if (priv->draw_needed)
+      /* If the content node is still around, only the effects were
+       * queued for redrawing, see gtk_widget_queue_draw_effects() */
+      if (priv->draw_needed && priv->content_node == NULL)
         break;
 
       priv->draw_needed = TRUE;
       g_clear_pointer (&priv->render_node, gsk_render_node_unref);
+      g_clear_pointer (&priv->content_node, gsk_render_node_unref);
       if (GTK_IS_NATIVE (widget) && _gtk_widget_get_realized (widget))
         gdk_surface_queue_render (gtk_native_get_surface (GTK_NATIVE (widget)));
     }
 }
 
+/*
+ * gtk_widget_queue_draw_effects:
+ * @widget: a `GtkWidget`
+ *
+ * Like gtk_widget_queue_draw(), but only the opacity and filter
+ * applied to the widget changed, not what it draws. The widget
+ * keeps its content node and the next snapshot wraps it again
+ * without calling the snapshot vfunc.
+ */
+static void
+gtk_widget_queue_draw_effects (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+
+  if (!_gtk_widget_get_mapped (widget))
+    return;
+
+  /* Either way, the render node will be recreated */
+  if (priv->draw_needed)
+    return;
+
+  priv->draw_needed = TRUE;
+  g_clear_pointer (&priv->render_node, gsk_render_node_unref);
+
+  if (priv->parent)
+    gtk_widget_queue_draw (priv->parent);
+  else if (GTK_IS_NATIVE (widget) && _gtk_widget_get_realized (widget))
+    gdk_surface_queue_render (gtk_native_get_surface (GTK_NATIVE (widget)));
+}
+
 static void
 gtk_widget_set_alloc_needed (GtkWidget *widget);
 
@@ -3908,6 +3941,149 @@ gtk_widget_ensure_allocate_on_children (GtkWidget *widget)
     }
 }
 
+/* Computes the transform from the widget's parent to its content box
+ * and the size of the content box for the given allocation.
+ */
+static GskTransform *
+gtk_widget_compute_content_transform (GtkWidget    *widget,
+                                      int           width,
+                                      int           height,
+                                      int          *baseline_inout,
+                                      GskTransform *transform,
+                                      int          *content_width,
+                                      int          *content_height)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GdkRectangle adjusted;
+  int baseline = *baseline_inout;
+  GtkCssStyle *style;
+  GtkBorder margin, border, padding;
+  GskTransform *css_transform;
+
+  if (_gtk_widget_get_direction (widget) == GTK_TEXT_DIR_LTR)
+    adjusted.x = priv->margin.left;
+  else
+    adjusted.x = priv->margin.right;
+  adjusted.y = priv->margin.top;
+  adjusted.width = width - priv->margin.left - priv->margin.right;
+  adjusted.height = height - priv->margin.top - priv->margin.bottom;
+  if (baseline >= 0)
+    baseline -= priv->margin.top;
+
+  gtk_widget_adjust_size_allocation (widget, &adjusted, &baseline);
+
+  if (adjusted.width < 0 || adjusted.height < 0)
+    {
+      g_warning ("gtk_widget_size_allocate(): attempt to allocate %s %s %p with width %d and height %d",
+                 G_OBJECT_TYPE_NAME (widget), g_quark_to_string (gtk_css_node_get_name (priv->cssnode)), widget,
+                 adjusted.width,
+                 adjusted.height);
+
+      adjusted.width = 0;
+      adjusted.height = 0;
+    }
+
+  style = gtk_css_node_get_style (priv->cssnode);
+  get_box_margin (style, &margin);
+  get_box_border (style, &border);
+  get_box_padding (style, &padding);
+
+  /* Apply CSS transformation */
+  adjusted.x += margin.left;
+  adjusted.y += margin.top;
+  adjusted.width -= margin.left + margin.right;
+  adjusted.height -= margin.top + margin.bottom;
+  css_transform = gtk_css_transform_value_get_transform (style->other->transform);
+
+  if (css_transform)
+    {
+      double origin_x, origin_y;
+
+      origin_x = _gtk_css_position_value_get_x (style->other->transform_origin, adjusted.width);
+      origin_y = _gtk_css_position_value_get_y (style->other->transform_origin, adjusted.height);
+
+      transform = gsk_transform_translate (transform, &GRAPHENE_POINT_INIT (adjusted.x, adjusted.y));
+      adjusted.x = adjusted.y = 0;
+
+      transform = gsk_transform_translate (transform, &GRAPHENE_POINT_INIT (origin_x, origin_y));
+      transform = gsk_transform_transform (transform, css_transform);
+      transform = gsk_transform_translate (transform, &GRAPHENE_POINT_INIT (- origin_x, - origin_y));
+
+      gsk_transform_unref (css_transform);
+    }
+
+  adjusted.x += border.left + padding.left;
+  adjusted.y += border.top + padding.top;
+
+  if (baseline >= 0)
+    baseline -= margin.top + border.top + padding.top;
+  if (adjusted.x || adjusted.y)
+    transform = gsk_transform_translate (transform, &GRAPHENE_POINT_INIT (adjusted.x, adjusted.y));
+
+  /* Since gtk_widget_measure does it for us, we can be sure here that
+   * the given alloaction is large enough for the css margin/bordder/padding */
+  adjusted.width -= border.left + padding.left +
+                    border.right + padding.right;
+  adjusted.height -= border.top + padding.top +
+                     border.bottom + padding.bottom;
+
+  *baseline_inout = baseline;
+  *content_width = adjusted.width;
+  *content_height = adjusted.height;
+
+  return transform;
+}
+
+/* Called when only the CSS transform changed. The size of the widget
+ * does not depend on it, so instead of reallocating the parent, just
+ * update the transform the parent draws the widget with.
+ */
+static void
+gtk_widget_update_css_transform (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GskTransform *transform;
+  int baseline, width, height;
+
+  if (!priv->visible ||
+      priv->alloc_needed ||
+      gtk_widget_get_resize_needed (widget))
+    {
+      gtk_widget_queue_allocate (priv->parent);
+      return;
+    }
+
+  baseline = priv->allocated_baseline;
+  transform = gtk_widget_compute_content_transform (widget,
+                                                    priv->allocated_width,
+                                                    priv->allocated_height,
+                                                    &baseline,
+                                                    gsk_transform_ref (priv->allocated_transform),
+                                                    &width,
+                                                    &height);
+
+  if (width != priv->width || height != priv->height || baseline != priv->baseline)
+    {
+      gsk_transform_unref (transform);
+      gtk_widget_queue_allocate (priv->parent);
+      return;
+    }
+
+  if (gsk_transform_equal (transform, priv->transform))
+    {
+      gsk_transform_unref (transform);
+      return;
+    }
+
+  gsk_transform_unref (priv->transform);
+  priv->transform = transform;
+
+  if (priv->surface_transform_data)
+    sync_widget_surface_transform (widget);
+
+  gtk_widget_queue_draw (priv->parent);
+}
+
 /**
  * gtk_widget_allocate:
  * @widget: A `GtkWidget`
@@ -3940,9 +4116,6 @@ gtk_widget_allocate (GtkWidget    *widget,
   gboolean size_changed;
   gboolean baseline_changed;
   gboolean transform_changed;
-  GtkCssStyle *style;
-  GtkBorder margin, border, padding;
-  GskTransform *css_transform;
 
   g_return_if_fail (GTK_IS_WIDGET (widget));
   g_return_if_fail (baseline >= -1);
@@ -3999,65 +4172,12 @@ gtk_widget_allocate (GtkWidget    *widget,
   priv->allocated_height = height;
   priv->allocated_baseline = baseline;
 
-  if (_gtk_widget_get_direction (widget) == GTK_TEXT_DIR_LTR)
-    adjusted.x = priv->margin.left;
-  else
-    adjusted.x = priv->margin.right;
-  adjusted.y = priv->margin.top;
-  adjusted.width = width - priv->margin.left - priv->margin.right;
-  adjusted.height = height - priv->margin.top - priv->margin.bottom;
-  if (baseline >= 0)
-    baseline -= priv->margin.top;
-
-  gtk_widget_adjust_size_allocation (widget, &adjusted, &baseline);
-
-  if (adjusted.width < 0 || adjusted.height < 0)
-    {
-      g_warning ("gtk_widget_size_allocate(): attempt to allocate %s %s %p with width %d and height %d",
-                 G_OBJECT_TYPE_NAME (widget), g_quark_to_string (gtk_css_node_get_name (priv->cssnode)), widget,
-                 adjusted.width,
-                 adjusted.height);
-
-      adjusted.width = 0;
-      adjusted.height = 0;
-    }
-
-  style = gtk_css_node_get_style (priv->cssnode);
-  get_box_margin (style, &margin);
-  get_box_border (style, &border);
-  get_box_padding (style, &padding);
-
-  /* Apply CSS transformation */
-  adjusted.x += margin.left;
-  adjusted.y += margin.top;
-  adjusted.width -= margin.left + margin.right;
-  adjusted.height -= margin.top + margin.bottom;
-  css_transform = gtk_css_transform_value_get_transform (style->other->transform);
-
-  if (css_transform)
-    {
-      double origin_x, origin_y;
-
-      origin_x = _gtk_css_position_value_get_x (style->other->transform_origin, adjusted.width);
-      origin_y = _gtk_css_position_value_get_y (style->other->transform_origin, adjusted.height);
-
-      transform = gsk_transform_translate (transform, &GRAPHENE_POINT_INIT (adjusted.x, adjusted.y));
-      adjusted.x = adjusted.y = 0;
-
-      transform = gsk_transform_translate (transform, &GRAPHENE_POINT_INIT (origin_x, origin_y));
-      transform = gsk_transform_transform (transform, css_transform);
-      transform = gsk_transform_translate (transform, &GRAPHENE_POINT_INIT (- origin_x, - origin_y));
-
-      gsk_transform_unref (css_transform);
-    }
-
-  adjusted.x += border.left + padding.left;
-  adjusted.y += border.top + padding.top;
-
-  if (baseline >= 0)
-    baseline -= margin.top + border.top + padding.top;
-  if (adjusted.x || adjusted.y)
-    transform = gsk_transform_translate (transform, &GRAPHENE_POINT_INIT (adjusted.x, adjusted.y));
+  transform = gtk_widget_compute_content_transform (widget,
+                                                    width, height,
+                                                    &baseline,
+                                                    transform,
+                                                    &adjusted.width,
+                                                    &adjusted.height);
 
   gsk_transform_unref (priv->transform);
   priv->transform = transform;
@@ -4065,12 +4185,6 @@ gtk_widget_allocate (GtkWidget    *widget,
   if (priv->surface_transform_data)
     sync_widget_surface_transform (widget);
 
-  /* Since gtk_widget_measure does it for us, we can be sure here that
-   * the given alloaction is large enough for the css margin/bordder/padding */
-  adjusted.width -= border.left + padding.left +
-                    border.right + padding.right;
-  adjusted.height -= border.top + padding.top +
-                     border.bottom + padding.bottom;
   size_changed = (priv->width != adjusted.width) || (priv->height != adjusted.height);
 
   if (!alloc_needed && !size_changed && !baseline_changed)
@@ -4992,14 +5106,18 @@ gtk_widget_real_css_changed (GtkWidget         *widget,
           else if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_TRANSFORM) &&
                    priv->parent)
             {
-              gtk_widget_queue_allocate (priv->parent);
+              gtk_widget_update_css_transform (widget);
             }
 
-          if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_REDRAW) ||
+          if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_REDRAW & ~GTK_CSS_AFFECTS_POSTEFFECT) ||
               (has_text && gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_TEXT_CONTENT)))
             {
               gtk_widget_queue_draw (widget);
             }
+          else if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_POSTEFFECT))
+            {
+              gtk_widget_queue_draw_effects (widget);
+            }
         }
     }
   else
@@ -10588,7 +10706,7 @@ gtk_widget_set_opacity (GtkWidget *widget,
 
   priv->user_alpha = alpha;
 
-  gtk_widget_queue_draw (widget);
+  gtk_widget_queue_draw_effects (widget);
 
   g_object_notify_by_pspec (G_OBJECT (widget), widget_props[PROP_OPACITY]);
 }
@@ -11796,13 +11914,45 @@ gtk_widget_list_controllers (GtkWidget           *widget,
   return (GtkEventController **)g_ptr_array_free (controllers, FALSE);
 }
 
+/* Everything the widget draws, without the opacity and filter,
+ * so it can be reused when only those change.
+ */
 static GskRenderNode *
-gtk_widget_create_render_node (GtkWidget   *widget,
-                               GtkSnapshot *snapshot)
+gtk_widget_create_content_node (GtkWidget   *widget,
+                                GtkSnapshot *snapshot)
 {
   GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (widget);
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GtkCssBoxes boxes;
+
+  gtk_css_boxes_init (&boxes, widget);
+
+  gtk_snapshot_push_collect (snapshot);
+
+  gtk_css_style_snapshot_background (&boxes, snapshot);
+  gtk_css_style_snapshot_border (&boxes, snapshot);
+
+  if (priv->overflow == GTK_OVERFLOW_HIDDEN)
+    {
+      gtk_snapshot_push_rounded_clip (snapshot, gtk_css_boxes_get_padding_box (&boxes));
+      klass->snapshot (widget, snapshot);
+      gtk_snapshot_pop (snapshot);
+    }
+  else
+    {
+      klass->snapshot (widget, snapshot);
+    }
+
+  gtk_css_style_snapshot_outline (&boxes, snapshot);
+
+  return gtk_snapshot_pop_collect (snapshot);
+}
+
+static GskRenderNode *
+gtk_widget_create_render_node (GtkWidget   *widget,
+                               GtkSnapshot *snapshot)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GtkCssValue *filter_value;
   double css_opacity, opacity;
   GtkCssStyle *style;
@@ -11815,7 +11965,8 @@ gtk_widget_create_render_node (GtkWidget   *widget,
   if (opacity <= 0.0)
     return NULL;
 
-  gtk_css_boxes_init (&boxes, widget);
+  if (priv->content_node == NULL)
+    priv->content_node = gtk_widget_create_content_node (widget, snapshot);
 
   gtk_snapshot_push_collect (snapshot);
   gtk_snapshot_push_debug (snapshot,
@@ -11828,21 +11979,8 @@ gtk_widget_create_render_node (GtkWidget   *widget,
   if (opacity < 1.0)
     gtk_snapshot_push_opacity (snapshot, opacity);
 
-  gtk_css_style_snapshot_background (&boxes, snapshot);
-  gtk_css_style_snapshot_border (&boxes, snapshot);
-
-  if (priv->overflow == GTK_OVERFLOW_HIDDEN)
-    {
-      gtk_snapshot_push_rounded_clip (snapshot, gtk_css_boxes_get_padding_box (&boxes));
-      klass->snapshot (widget, snapshot);
-      gtk_snapshot_pop (snapshot);
-    }
-  else
-    {
-      klass->snapshot (widget, snapshot);
-    }
-
-  gtk_css_style_snapshot_outline (&boxes, snapshot);
+  if (priv->content_node)
+    gtk_snapshot_append_node (snapshot, priv->content_node);
 
   if (opacity < 1.0)
     gtk_snapshot_pop (snapshot);
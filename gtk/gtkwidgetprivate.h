@@ -165,6 +165,8 @@ struct _GtkWidgetPrivate
 
   /* The render node we draw or %NULL if not yet created.*/
   GskRenderNode *render_node;
+  /* The part of render_node without opacity and filter, or %NULL */
+  GskRenderNode *content_node;
 
   /* The layout manager, or %NULL */
   GtkLayoutManager *layout_manager;
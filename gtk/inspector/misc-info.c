@@ -33,6 +33,7 @@
 #include "gtkwidgetprivate.h"
 #include "gtkbinlayout.h"
 #include "gtkwidgetprivate.h"
+#include "gtkcssnodeprivate.h"
 
 struct _GtkInspectorMiscInfo
 {
@@ -78,6 +79,8 @@ struct _GtkInspectorMiscInfo
   GtkWidget *tick_callback;
   GtkWidget *framerate_row;
   GtkWidget *framerate;
+  GtkWidget *style_cache_row;
+  GtkWidget *style_cache;
   GtkWidget *scale_row;
   GtkWidget *scale;
   GtkWidget *framecount_row;
@@ -399,6 +402,7 @@ update_info (gpointer data)
       gint64 history_len;
       gint64 previous_frame_time;
       GdkFrameTimings *previous_timings;
+      guint64 hits, misses;
 
       clock = GDK_FRAME_CLOCK (sl->object);
       frame = gdk_frame_clock_get_frame_counter (clock);
@@ -425,6 +429,15 @@ update_info (gpointer data)
         }
 
       sl->last_frame = frame;
+
+      gtk_css_node_get_style_cache_statistics (&hits, &misses);
+      if (hits + misses > 0)
+        tmp = g_strdup_printf ("%" G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT " misses (%.1f%%)",
+                               hits, misses, 100. * hits / (hits + misses));
+      else
+        tmp = g_strdup ("—");
+      gtk_label_set_label (GTK_LABEL (sl->style_cache), tmp);
+      g_free (tmp);
     }
 
   if (GDK_IS_SURFACE (sl->object))
@@ -519,6 +532,7 @@ gtk_inspector_misc_info_set_object (GtkInspectorMiscInfo *sl,
   gtk_widget_set_visible (sl->buildable_id_row, GTK_IS_BUILDABLE (object));
   gtk_widget_set_visible (sl->framecount_row, GDK_IS_FRAME_CLOCK (object));
   gtk_widget_set_visible (sl->framerate_row, GDK_IS_FRAME_CLOCK (object));
+  gtk_widget_set_visible (sl->style_cache_row, GDK_IS_FRAME_CLOCK (object));
   gtk_widget_set_visible (sl->scale_row, GDK_IS_SURFACE (object));
 
   if (GTK_IS_WIDGET (object))
@@ -631,6 +645,8 @@ gtk_inspector_misc_info_class_init (GtkInspectorMiscInfoClass *klass)
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, framecount);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, framerate_row);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, framerate);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, style_cache_row);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, style_cache);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, scale_row);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, scale);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, mapped_row);
@@ -2,6 +2,13 @@
 
 #include <gsk/gskcairoblurprivate.h>
 
+static const char *kernel_names[GSK_BLUR_N_KERNELS] = {
+  [GSK_BLUR_KERNEL_SCALAR] = "scalar",
+  [GSK_BLUR_KERNEL_SSE2] = "sse2",
+  [GSK_BLUR_KERNEL_AVX2] = "avx2",
+  [GSK_BLUR_KERNEL_NEON] = "neon",
+};
+
 static void
 init_surface (cairo_t *cr)
 {
@@ -9,46 +16,96 @@ init_surface (cairo_t *cr)
   int h = cairo_image_surface_get_height (cairo_get_target (cr));
 
   cairo_set_source_rgb (cr, 0, 0, 0);
-  cairo_fill (cr);
+  cairo_paint (cr);
 
-  cairo_set_source_rgb (cr, 1, 1, 1);
+  cairo_set_source_rgba (cr, 1, 0.5, 0.25, 1);
   cairo_arc (cr, w/2, h/2, w/2, 0, 2*G_PI);
   cairo_fill (cr);
 }
 
-int
-main (int argc, char **argv)
+static gboolean
+surfaces_equal (cairo_surface_t *a,
+                cairo_surface_t *b)
+{
+  int stride = cairo_image_surface_get_stride (a);
+  int height = cairo_image_surface_get_height (a);
+
+  cairo_surface_flush (a);
+  cairo_surface_flush (b);
+
+  return memcmp (cairo_image_surface_get_data (a),
+                 cairo_image_surface_get_data (b),
+                 stride * height) == 0;
+}
+
+static void
+run_benchmark (cairo_format_t  format,
+               const char     *format_name,
+               int             size)
 {
-  cairo_surface_t *surface;
-  cairo_t *cr;
+  cairo_surface_t *surface, *reference;
+  cairo_t *cr, *ref_cr;
   GTimer *timer;
-  double msec;
+  double msec, scalar_msec[16] = { 0, };
+  GskBlurKernel kernel;
   int i, j;
-  int size;
 
   timer = g_timer_new ();
 
-  size = 2000;
-
-  surface = cairo_image_surface_create (CAIRO_FORMAT_A8, size, size);
-
+  surface = cairo_image_surface_create (format, size, size);
+  reference = cairo_image_surface_create (format, size, size);
   cr = cairo_create (surface);
+  ref_cr = cairo_create (reference);
 
-  /* We do everything three times, first two as warmup */
-  for (j = 0; j < 2; j++)
+  for (kernel = 0; kernel < GSK_BLUR_N_KERNELS; kernel++)
     {
-      for (i = 1; i < 16; i++)
-	{
-	  init_surface (cr);
-	  g_timer_start (timer);
-	  gsk_cairo_blur_surface (surface, i, GSK_BLUR_X | GSK_BLUR_Y);
-	  msec = g_timer_elapsed (timer, NULL) * 1000;
-	  if (j == 1)
-	    g_print ("Radius %2d: %.2f msec, %.2f kpixels/msec:\n", i, msec, size*size/(msec*1000));
-	}
+      if (!gsk_cairo_blur_kernel_is_supported (kernel))
+        continue;
+
+      g_print ("%s, %s kernel:\n", format_name, kernel_names[kernel]);
+
+      /* We do everything three times, first two as warmup */
+      for (j = 0; j < 2; j++)
+        {
+          for (i = 1; i < 16; i++)
+            {
+              init_surface (cr);
+              g_timer_start (timer);
+              gsk_cairo_blur_surface_with_kernel (surface, i, GSK_BLUR_X | GSK_BLUR_Y, kernel);
+              msec = g_timer_elapsed (timer, NULL) * 1000;
+              if (j == 1)
+                {
+                  if (kernel == GSK_BLUR_KERNEL_SCALAR)
+                    scalar_msec[i] = msec;
+
+                  init_surface (ref_cr);
+                  gsk_cairo_blur_surface_with_kernel (reference, i, GSK_BLUR_X | GSK_BLUR_Y, GSK_BLUR_KERNEL_SCALAR);
+
+                  g_print ("Radius %2d: %.2f msec, %.2f kpixels/msec, %.2fx%s\n",
+                           i, msec, size*size/(msec*1000), scalar_msec[i] / msec,
+                           surfaces_equal (surface, reference) ? "" : " MISMATCH");
+                }
+            }
+        }
     }
 
+  cairo_destroy (cr);
+  cairo_destroy (ref_cr);
+  cairo_surface_destroy (surface);
+  cairo_surface_destroy (reference);
+
   g_timer_destroy (timer);
+}
+
+int
+main (int argc, char **argv)
+{
+  int size;
+
+  size = 2000;
+
+  run_benchmark (CAIRO_FORMAT_A8, "A8", size);
+  run_benchmark (CAIRO_FORMAT_ARGB32, "ARGB32", size);
 
   return 0;
 }
@@ -0,0 +1,132 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Replays saved render node files with the Cairo renderer, once
+ * for every thread count, to show how tiled rendering scales.
+ *
+ * Usage: cairo-tile-performance [--runs N] [--threads N] NODE-FILE...
+ */
+
+#include <gtk/gtk.h>
+
+static int runs = 10;
+static int max_threads = 0;
+
+static GOptionEntry options[] = {
+  { "runs", 'r', 0, G_OPTION_ARG_INT, &runs, "Render each file N times per thread count", "N" },
+  { "threads", 't', 0, G_OPTION_ARG_INT, &max_threads, "Maximum number of threads to use", "N" },
+  { NULL }
+};
+
+static double
+benchmark_node (GskRenderNode *node,
+                guint          n_threads)
+{
+  GskRenderer *renderer;
+  GdkTexture *texture;
+  char *threads;
+  gint64 start, total;
+  int run;
+
+  /* The renderer picks up the thread count when it's created */
+  threads = g_strdup_printf ("%u", n_threads);
+  g_setenv ("GSK_CAIRO_THREADS", threads, TRUE);
+  g_free (threads);
+
+  renderer = gsk_cairo_renderer_new ();
+  if (!gsk_renderer_realize (renderer, NULL, NULL))
+    g_error ("Failed to realize renderer");
+
+  /* warmup, so font and glyph caches are filled */
+  texture = gsk_renderer_render_texture (renderer, node, NULL);
+  g_object_unref (texture);
+
+  total = 0;
+  for (run = 0; run < runs; run++)
+    {
+      start = g_get_monotonic_time ();
+      texture = gsk_renderer_render_texture (renderer, node, NULL);
+      total += g_get_monotonic_time () - start;
+      g_object_unref (texture);
+    }
+
+  gsk_renderer_unrealize (renderer);
+  g_object_unref (renderer);
+
+  return (double) total / runs / 1000.;
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  int i;
+
+  context = g_option_context_new ("NODE-FILE...");
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (argc < 2)
+    {
+      g_printerr ("Usage: %s [OPTIONS] NODE-FILE...\n", argv[0]);
+      return 1;
+    }
+
+  if (runs < 1)
+    runs = 1;
+  if (max_threads < 1)
+    max_threads = g_get_num_processors ();
+
+  gtk_init ();
+
+  for (i = 1; i < argc; i++)
+    {
+      GskRenderNode *node;
+      graphene_rect_t bounds;
+      GBytes *bytes;
+      char *contents;
+      gsize len;
+      double base_msec = 0;
+      guint n_threads;
+
+      if (!g_file_get_contents (argv[i], &contents, &len, &error))
+        {
+          g_printerr ("Could not open node file: %s\n", error->message);
+          g_clear_error (&error);
+          continue;
+        }
+
+      bytes = g_bytes_new_take (contents, len);
+      node = gsk_render_node_deserialize (bytes, NULL, NULL);
+      g_bytes_unref (bytes);
+
+      if (node == NULL)
+        {
+          g_printerr ("Could not parse node file %s\n", argv[i]);
+          continue;
+        }
+
+      gsk_render_node_get_bounds (node, &bounds);
+      g_print ("%s (%gx%g):\n", argv[i], bounds.size.width, bounds.size.height);
+
+      for (n_threads = 1; n_threads <= (guint) max_threads; n_threads *= 2)
+        {
+          double msec = benchmark_node (node, n_threads);
+
+          if (n_threads == 1)
+            base_msec = msec;
+
+          g_print ("  %2u threads: %8.2f msec/frame, %.2fx\n",
+                   n_threads, msec, base_msec / msec);
+        }
+
+      gsk_render_node_unref (node);
+    }
+
+  return 0;
+}
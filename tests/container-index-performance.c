@@ -0,0 +1,245 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Renders small parts of a container node with many children, once
+ * with the spatial index for large containers disabled and once with
+ * it enabled, to show how much the index saves.
+ *
+ * The index is configured when GTK starts, so every configuration is
+ * run in a child process.
+ *
+ * Usage: container-index-performance [--runs N] [--children N] [--size N]
+ */
+
+#include <gtk/gtk.h>
+#include <math.h>
+
+static int runs = 50;
+static int n_children = 40000;
+static int viewport_size = 256;
+static gboolean child_process = FALSE;
+
+static GOptionEntry options[] = {
+  { "runs", 'r', 0, G_OPTION_ARG_INT, &runs, "Render N viewports per renderer", "N" },
+  { "children", 'c', 0, G_OPTION_ARG_INT, &n_children, "Number of children in the container", "N" },
+  { "size", 's', 0, G_OPTION_ARG_INT, &viewport_size, "Size of the rendered viewports", "N" },
+  { "child", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_NONE, &child_process, NULL, NULL },
+  { NULL }
+};
+
+static const struct {
+  const char *name;
+  GskRenderer * (* create_func) (void);
+} renderers[] = {
+  { "cairo", gsk_cairo_renderer_new },
+  { "gl", gsk_gl_renderer_new },
+};
+
+static GskRenderNode *
+create_grid (int n)
+{
+  GskRenderNode **children;
+  GskRenderNode *node;
+  int side, i;
+
+  side = ceil (sqrt (n));
+  children = g_new (GskRenderNode *, n);
+
+  for (i = 0; i < n; i++)
+    {
+      GdkRGBA color = { (i % 7) / 7., (i % 11) / 11., (i % 13) / 13., 1 };
+
+      children[i] = gsk_color_node_new (&color,
+                                        &GRAPHENE_RECT_INIT ((i % side) * 10,
+                                                             (i / side) * 10,
+                                                             9, 9));
+    }
+
+  node = gsk_container_node_new (children, n);
+
+  for (i = 0; i < n; i++)
+    gsk_render_node_unref (children[i]);
+  g_free (children);
+
+  return node;
+}
+
+static double
+benchmark_renderer (GskRenderer   *renderer,
+                    GskRenderNode *node)
+{
+  graphene_rect_t bounds, viewport;
+  GdkTexture *texture;
+  gint64 start, total;
+  int run;
+
+  gsk_render_node_get_bounds (node, &bounds);
+
+  /* warmup, this is also where the index gets built */
+  graphene_rect_init (&viewport, 0, 0, viewport_size, viewport_size);
+  texture = gsk_renderer_render_texture (renderer, node, &viewport);
+  g_object_unref (texture);
+
+  total = 0;
+  for (run = 0; run < runs; run++)
+    {
+      /* Walk diagonally across the node */
+      float f = (float) run / runs;
+
+      graphene_rect_init (&viewport,
+                          f * MAX (bounds.size.width - viewport_size, 0),
+                          f * MAX (bounds.size.height - viewport_size, 0),
+                          viewport_size, viewport_size);
+
+      start = g_get_monotonic_time ();
+      texture = gsk_renderer_render_texture (renderer, node, &viewport);
+      total += g_get_monotonic_time () - start;
+      g_object_unref (texture);
+    }
+
+  return (double) total / runs / 1000.;
+}
+
+static void
+run_child (void)
+{
+  GskRenderNode *node;
+  guint i;
+
+  gtk_init ();
+
+  node = create_grid (n_children);
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      GskRenderer *renderer;
+
+      renderer = renderers[i].create_func ();
+      if (!gsk_renderer_realize (renderer, NULL, NULL))
+        {
+          g_object_unref (renderer);
+          continue;
+        }
+
+      g_print ("%s %f\n", renderers[i].name, benchmark_renderer (renderer, node));
+
+      gsk_renderer_unrealize (renderer);
+      g_object_unref (renderer);
+    }
+
+  gsk_render_node_unref (node);
+}
+
+static GHashTable *
+spawn_child (const char *self,
+             const char *threshold)
+{
+  GHashTable *results;
+  GError *error = NULL;
+  char **envp, **lines;
+  char *argv[9];
+  char *out;
+  int status, i;
+
+  argv[0] = (char *) self;
+  argv[1] = (char *) "--child";
+  argv[2] = (char *) "--runs";
+  argv[3] = g_strdup_printf ("%d", runs);
+  argv[4] = (char *) "--children";
+  argv[5] = g_strdup_printf ("%d", n_children);
+  argv[6] = (char *) "--size";
+  argv[7] = g_strdup_printf ("%d", viewport_size);
+  argv[8] = NULL;
+
+  envp = g_environ_setenv (g_get_environ (), "GSK_CONTAINER_INDEX_THRESHOLD", threshold, TRUE);
+
+  results = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  if (!g_spawn_sync (NULL, argv, envp, G_SPAWN_DEFAULT, NULL, NULL, &out, NULL, &status, &error) ||
+      !g_spawn_check_wait_status (status, &error))
+    {
+      g_printerr ("Failed to run benchmark: %s\n", error->message);
+      g_clear_error (&error);
+    }
+  else
+    {
+      lines = g_strsplit (out, "\n", -1);
+      for (i = 0; lines[i]; i++)
+        {
+          char **fields = g_strsplit (lines[i], " ", 2);
+
+          if (g_strv_length (fields) == 2)
+            {
+              double *msec = g_new (double, 1);
+              *msec = g_ascii_strtod (fields[1], NULL);
+              g_hash_table_insert (results, g_strdup (fields[0]), msec);
+            }
+
+          g_strfreev (fields);
+        }
+      g_strfreev (lines);
+      g_free (out);
+    }
+
+  g_strfreev (envp);
+  g_free (argv[3]);
+  g_free (argv[5]);
+  g_free (argv[7]);
+
+  return results;
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GHashTable *flat, *indexed;
+  guint i;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (runs < 1)
+    runs = 1;
+  if (n_children < 1)
+    n_children = 1;
+  if (viewport_size < 1)
+    viewport_size = 1;
+
+  if (child_process)
+    {
+      run_child ();
+      return 0;
+    }
+
+  flat = spawn_child (argv[0], "0");
+  indexed = spawn_child (argv[0], "1");
+
+  g_print ("%d children, %dx%d viewports:\n", n_children, viewport_size, viewport_size);
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      double *flat_msec = g_hash_table_lookup (flat, renderers[i].name);
+      double *indexed_msec = g_hash_table_lookup (indexed, renderers[i].name);
+
+      if (flat_msec == NULL || indexed_msec == NULL)
+        {
+          g_print ("  %-6s not available\n", renderers[i].name);
+          continue;
+        }
+
+      g_print ("  %-6s flat: %8.3f msec/frame, indexed: %8.3f msec/frame, %.2fx\n",
+               renderers[i].name, *flat_msec, *indexed_msec, *flat_msec / *indexed_msec);
+    }
+
+  g_hash_table_unref (flat);
+  g_hash_table_unref (indexed);
+
+  return 0;
+}
@@ -0,0 +1,170 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Measures loading a theme into a GtkCssProvider, and reloading a
+ * provider with one rule edited and restyling a window full of labels
+ * afterwards, with and without incremental reloading.
+ *
+ * Usage: cssprovider-performance [--runs N] [--theme NAME] [--variant VARIANT] [--labels N]
+ */
+
+#include <gtk/gtk.h>
+
+static int n_runs = 20;
+static char *theme = NULL;
+static char *variant = NULL;
+static int n_labels = 5000;
+
+static GOptionEntry options[] = {
+  { "runs", 'n', 0, G_OPTION_ARG_INT, &n_runs, "Number of loads", "N" },
+  { "theme", 't', 0, G_OPTION_ARG_STRING, &theme, "Theme to load", "NAME" },
+  { "variant", 'v', 0, G_OPTION_ARG_STRING, &variant, "Theme variant", "VARIANT" },
+  { "labels", 'l', 0, G_OPTION_ARG_INT, &n_labels, "Labels to restyle on reload", "N" },
+  { NULL }
+};
+
+static gint64
+load_theme (void)
+{
+  GtkCssProvider *provider;
+  gint64 start;
+
+  provider = gtk_css_provider_new ();
+
+  start = g_get_monotonic_time ();
+  gtk_css_provider_load_named (provider, theme, variant);
+
+  g_object_unref (provider);
+
+  return g_get_monotonic_time () - start;
+}
+
+static void
+print_times (const char *what,
+             gint64      total,
+             gint64      best)
+{
+  g_print ("  %-24s %9.2f msec average, %9.2f msec best\n",
+           what, total / 1000. / n_runs, best / 1000.);
+}
+
+static void
+benchmark_loads (const char *what)
+{
+  gint64 total, best, time;
+  int i;
+
+  total = 0;
+  best = G_MAXINT64;
+  for (i = 0; i < n_runs; i++)
+    {
+      time = load_theme ();
+      total += time;
+      best = MIN (best, time);
+    }
+
+  print_times (what, total, best);
+}
+
+static void
+ensure_styles (GtkWidget **labels)
+{
+  GdkRGBA color;
+  int i;
+
+  for (i = 0; i < n_labels; i++)
+    gtk_widget_get_color (labels[i], &color);
+}
+
+static void
+benchmark_reloads (const char *what,
+                   gboolean    incremental)
+{
+  GtkCssProvider *provider;
+  GtkWidget *window, *box;
+  GtkWidget **labels;
+  gint64 total, best, start, time;
+  char *css;
+  int i;
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_set_incremental_reload (provider, incremental);
+  gtk_css_provider_load_from_string (provider, "label.edited { color: rgb(0,0,0); }");
+  gtk_style_context_add_provider_for_display (gdk_display_get_default (),
+                                              GTK_STYLE_PROVIDER (provider),
+                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+
+  window = gtk_window_new ();
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  gtk_window_set_child (GTK_WINDOW (window), box);
+  labels = g_new (GtkWidget *, n_labels);
+  for (i = 0; i < n_labels; i++)
+    {
+      labels[i] = gtk_label_new ("Label");
+      if (i % 100 == 0)
+        gtk_widget_add_css_class (labels[i], "edited");
+      gtk_box_append (GTK_BOX (box), labels[i]);
+    }
+  ensure_styles (labels);
+
+  total = 0;
+  best = G_MAXINT64;
+  for (i = 0; i < n_runs; i++)
+    {
+      css = g_strdup_printf ("label.edited { color: rgb(%d,0,0); }", (i + 1) % 256);
+
+      start = g_get_monotonic_time ();
+      gtk_css_provider_load_from_string (provider, css);
+      ensure_styles (labels);
+      time = g_get_monotonic_time () - start;
+
+      total += time;
+      best = MIN (best, time);
+      g_free (css);
+    }
+
+  print_times (what, total, best);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_free (labels);
+
+  gtk_style_context_remove_provider_for_display (gdk_display_get_default (),
+                                                 GTK_STYLE_PROVIDER (provider));
+  g_object_unref (provider);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  gtk_init ();
+
+  if (theme == NULL)
+    theme = g_strdup ("Default");
+  n_runs = MAX (n_runs, 1);
+  n_labels = MAX (n_labels, 1);
+
+  g_print ("%s%s%s, %d loads:\n", theme, variant ? "-" : "", variant ? variant : "", n_runs);
+
+  benchmark_loads ("parse");
+
+  g_print ("Editing one rule, %d labels:\n", n_labels);
+
+  benchmark_reloads ("reload", FALSE);
+  benchmark_reloads ("incremental reload", TRUE);
+
+  g_free (theme);
+  g_free (variant);
+
+  return 0;
+}
@@ -0,0 +1,147 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Measures the time it takes to convert textures between all pairs
+ * of memory formats.
+ *
+ * Usage: memory-convert-performance [--size N] [--runs N] [--csv]
+ */
+
+#include <gtk/gtk.h>
+
+static int size = 1024;
+static int runs = 3;
+static gboolean csv = FALSE;
+
+static GOptionEntry options[] = {
+  { "size", 's', 0, G_OPTION_ARG_INT, &size, "Width and height of the images", "N" },
+  { "runs", 'r', 0, G_OPTION_ARG_INT, &runs, "Convert each pair N times and take the best", "N" },
+  { "csv", '\0', 0, G_OPTION_ARG_NONE, &csv, "Print a matrix in CSV format", NULL },
+  { NULL }
+};
+
+static const char *
+format_nick (GdkMemoryFormat format)
+{
+  GEnumClass *class = g_type_class_peek (GDK_TYPE_MEMORY_FORMAT);
+
+  return g_enum_get_value (class, format)->value_nick;
+}
+
+static GdkTexture *
+create_texture (GdkMemoryFormat format)
+{
+  GdkTexture *texture;
+  GdkTextureDownloader *downloader;
+  GBytes *bytes;
+  guchar *data;
+  gsize stride;
+  int i;
+
+  /* Fill an RGBA image with noise and let GDK convert it */
+  data = g_malloc (size * size * 4);
+  for (i = 0; i < size * size * 4; i++)
+    data[i] = g_random_int_range (0, 256);
+
+  bytes = g_bytes_new_take (data, size * size * 4);
+  texture = gdk_memory_texture_new (size, size, GDK_MEMORY_R8G8B8A8, bytes, size * 4);
+  g_bytes_unref (bytes);
+
+  downloader = gdk_texture_downloader_new (texture);
+  gdk_texture_downloader_set_format (downloader, format);
+  bytes = gdk_texture_downloader_download_bytes (downloader, &stride);
+  gdk_texture_downloader_free (downloader);
+  g_object_unref (texture);
+
+  texture = gdk_memory_texture_new (size, size, format, bytes, stride);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+static double
+benchmark_conversion (GdkTexture      *texture,
+                      GdkMemoryFormat  format)
+{
+  GdkTextureDownloader *downloader;
+  double best = G_MAXDOUBLE;
+  int run;
+
+  downloader = gdk_texture_downloader_new (texture);
+  gdk_texture_downloader_set_format (downloader, format);
+
+  for (run = 0; run < runs; run++)
+    {
+      GBytes *bytes;
+      gint64 start;
+      gsize stride;
+
+      start = g_get_monotonic_time ();
+      bytes = gdk_texture_downloader_download_bytes (downloader, &stride);
+      best = MIN (best, (g_get_monotonic_time () - start) / 1000.);
+      g_bytes_unref (bytes);
+    }
+
+  gdk_texture_downloader_free (downloader);
+
+  return best;
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GdkMemoryFormat src, dest;
+
+  context = g_option_context_new ("");
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  gtk_init ();
+
+  g_type_class_ref (GDK_TYPE_MEMORY_FORMAT);
+
+  if (csv)
+    {
+      g_print ("src\\dest");
+      for (dest = 0; dest < GDK_MEMORY_N_FORMATS; dest++)
+        g_print (",%s", format_nick (dest));
+      g_print ("\n");
+    }
+  else
+    {
+      g_print ("Converting %dx%d images, best of %d runs\n", size, size, runs);
+    }
+
+  for (src = 0; src < GDK_MEMORY_N_FORMATS; src++)
+    {
+      GdkTexture *texture = create_texture (src);
+
+      if (csv)
+        g_print ("%s", format_nick (src));
+
+      for (dest = 0; dest < GDK_MEMORY_N_FORMATS; dest++)
+        {
+          double msec = benchmark_conversion (texture, dest);
+
+          if (csv)
+            g_print (",%.3f", msec);
+          else
+            g_print ("%32s -> %-32s %8.2f msec, %7.1f Mpixels/sec\n",
+                     format_nick (src), format_nick (dest),
+                     msec, size * size / (msec * 1000));
+        }
+
+      if (csv)
+        g_print ("\n");
+
+      g_object_unref (texture);
+    }
+
+  return 0;
+}
@@ -0,0 +1,227 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Measures common operations on a GtkMultiSelection with many items:
+ * selecting everything, keeping the selection while a filter or
+ * sorter changes the model, and selecting items by their contents
+ * item by item compared to gtk_multi_selection_select_matching().
+ *
+ * Usage: multiselection-performance [--items N]
+ */
+
+#include <gtk/gtk.h>
+
+static int n_items = 1000000;
+
+static GOptionEntry options[] = {
+  { "items", 'n', 0, G_OPTION_ARG_INT, &n_items, "Number of items", "N" },
+  { NULL }
+};
+
+static GListModel *
+create_store (void)
+{
+  GtkStringList *list;
+  char buf[64];
+  int i;
+
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < n_items; i++)
+    {
+      g_snprintf (buf, sizeof (buf), "Item number %d", g_random_int_range (0, n_items));
+      gtk_string_list_append (list, buf);
+    }
+
+  return G_LIST_MODEL (list);
+}
+
+static void
+print_time (const char *what,
+            gint64      start)
+{
+  g_print ("  %-34s %9.2f msec\n", what, (g_get_monotonic_time () - start) / 1000.);
+}
+
+static gboolean
+contains_7 (gpointer item,
+            gpointer unused)
+{
+  return strchr (gtk_string_object_get_string (item), '7') != NULL;
+}
+
+static GtkExpression *
+create_string_expression (void)
+{
+  return gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string");
+}
+
+static void
+benchmark_select_all (GListModel *store)
+{
+  GtkSelectionModel *selection;
+  GtkBitset *selected;
+  GtkBitsetIter iter;
+  gint64 start;
+  guint i, pos, n;
+  gboolean more;
+
+  selection = GTK_SELECTION_MODEL (gtk_multi_selection_new (g_object_ref (store)));
+
+  start = g_get_monotonic_time ();
+  gtk_selection_model_select_all (selection);
+  print_time ("select all", start);
+
+  start = g_get_monotonic_time ();
+  n = 0;
+  for (i = 0; i < (guint) n_items; i++)
+    {
+      if (gtk_selection_model_is_selected (selection, i))
+        n++;
+    }
+  print_time ("count with is_selected()", start);
+  g_assert (n == (guint) n_items);
+
+  start = g_get_monotonic_time ();
+  n = 0;
+  selected = gtk_selection_model_get_selection (selection);
+  for (more = gtk_bitset_iter_init_first (&iter, selected, &pos);
+       more;
+       more = gtk_bitset_iter_next (&iter, &pos))
+    n++;
+  gtk_bitset_unref (selected);
+  print_time ("count with get_selection()", start);
+  g_assert (n == (guint) n_items);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < 1000; i++)
+    gtk_selection_model_unselect_item (selection, g_random_int_range (0, n_items));
+  print_time ("unselect 1000 items one by one", start);
+
+  start = g_get_monotonic_time ();
+  gtk_selection_model_unselect_all (selection);
+  print_time ("unselect all", start);
+
+  g_object_unref (selection);
+}
+
+static void
+benchmark_filter_changes (GListModel *store)
+{
+  const char *searches[] = { "1", "12", "123", "12", "1", "" };
+  GtkSelectionModel *selection;
+  GtkStringFilter *filter;
+  GtkFilterListModel *filtered;
+  gint64 start;
+  guint i;
+
+  filter = gtk_string_filter_new (create_string_expression ());
+  filtered = gtk_filter_list_model_new (g_object_ref (store), GTK_FILTER (g_object_ref (filter)));
+  selection = GTK_SELECTION_MODEL (gtk_multi_selection_new (G_LIST_MODEL (filtered)));
+  gtk_selection_model_select_all (selection);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < G_N_ELEMENTS (searches); i++)
+    gtk_string_filter_set_search (filter, searches[i]);
+  print_time ("6 filter changes, all selected", start);
+
+  g_object_unref (selection);
+  g_object_unref (filter);
+}
+
+static void
+benchmark_sort_changes (GListModel *store)
+{
+  GtkSelectionModel *selection;
+  GtkSortListModel *sorted;
+  GtkStringSorter *sorter;
+  GtkFilter *filter;
+  gint64 start;
+
+  sorter = gtk_string_sorter_new (create_string_expression ());
+  sorted = gtk_sort_list_model_new (g_object_ref (store), NULL);
+  selection = GTK_SELECTION_MODEL (gtk_multi_selection_new (G_LIST_MODEL (sorted)));
+
+  filter = GTK_FILTER (gtk_custom_filter_new (contains_7, NULL, NULL));
+  gtk_multi_selection_select_matching (GTK_MULTI_SELECTION (selection), filter, TRUE);
+  g_object_unref (filter);
+
+  start = g_get_monotonic_time ();
+  gtk_sort_list_model_set_sorter (sorted, GTK_SORTER (sorter));
+  print_time ("sort, some selected", start);
+
+  g_object_unref (selection);
+}
+
+static void
+benchmark_select_matching (GListModel *store)
+{
+  GtkSelectionModel *selection;
+  GtkStringFilter *string_filter;
+  GtkFilter *custom_filter;
+  gint64 start;
+  guint i;
+
+  selection = GTK_SELECTION_MODEL (gtk_multi_selection_new (g_object_ref (store)));
+  custom_filter = GTK_FILTER (gtk_custom_filter_new (contains_7, NULL, NULL));
+  string_filter = gtk_string_filter_new (create_string_expression ());
+  gtk_string_filter_set_match_mode (string_filter, GTK_STRING_FILTER_MATCH_MODE_SUBSTRING);
+  gtk_string_filter_set_search (string_filter, "7");
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < (guint) n_items; i++)
+    {
+      gpointer item = g_list_model_get_item (G_LIST_MODEL (selection), i);
+
+      if (gtk_filter_match (custom_filter, item))
+        gtk_selection_model_select_item (selection, i, FALSE);
+
+      g_object_unref (item);
+    }
+  print_time ("select matching one by one", start);
+
+  gtk_selection_model_unselect_all (selection);
+  start = g_get_monotonic_time ();
+  gtk_multi_selection_select_matching (GTK_MULTI_SELECTION (selection), custom_filter, TRUE);
+  print_time ("select_matching(), custom filter", start);
+
+  gtk_selection_model_unselect_all (selection);
+  start = g_get_monotonic_time ();
+  gtk_multi_selection_select_matching (GTK_MULTI_SELECTION (selection), GTK_FILTER (string_filter), TRUE);
+  print_time ("select_matching(), string filter", start);
+
+  g_object_unref (custom_filter);
+  g_object_unref (string_filter);
+  g_object_unref (selection);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GListModel *store;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (n_items < 1)
+    n_items = 1;
+
+  store = create_store ();
+
+  g_print ("%d items, %u threads:\n", n_items, g_get_num_processors ());
+
+  benchmark_select_all (store);
+  benchmark_filter_changes (store);
+  benchmark_sort_changes (store);
+  benchmark_select_matching (store);
+
+  g_object_unref (store);
+
+  return 0;
+}
@@ -3,12 +3,16 @@
 static gboolean benchmark = FALSE;
 static gboolean dump_variant = FALSE;
 static gboolean fallback = FALSE;
+static gboolean binary = FALSE;
+static char *binary_file = NULL;
 static int runs = 1;
 
 static GOptionEntry options[] = {
   { "benchmark", 'b', 0, G_OPTION_ARG_NONE, &benchmark, "Time operations", NULL },
   { "dump-variant", 'd', 0, G_OPTION_ARG_NONE, &dump_variant, "Dump GVariant structure", NULL },
   { "fallback", '\0', 0, G_OPTION_ARG_NONE, &fallback, "Draw node without a renderer", NULL },
+  { "binary", '\0', 0, G_OPTION_ARG_NONE, &binary, "Round-trip the node through the binary format", NULL },
+  { "write-binary", '\0', 0, G_OPTION_ARG_FILENAME, &binary_file, "Save the node in binary format to FILE", "FILE" },
   { "runs", 'r', 0, G_OPTION_ARG_INT, &runs, "Render the test N times", "N" },
   { NULL }
 };
@@ -66,7 +70,7 @@ main(int argc, char **argv)
       g_printerr ("Number of runs given with -r/--runs must be at least 1 and not %d.\n", runs);
       return 1;
     }
-  if (!(argc == 3 || (argc == 2 && (dump_variant || benchmark))))
+  if (!(argc == 3 || (argc == 2 && (dump_variant || benchmark || binary_file))))
     {
       g_printerr ("Usage: %s [OPTIONS] NODE-FILE PNG-FILE\n", argv[0]);
       return 1;
@@ -106,6 +110,51 @@ main(int argc, char **argv)
       return 1;
     }
 
+  if (binary || binary_file)
+    {
+      start = g_get_monotonic_time ();
+      bytes = gsk_render_node_serialize_binary (node);
+      end = g_get_monotonic_time ();
+      if (benchmark)
+        {
+          char *bytes_string = g_format_size (g_bytes_get_size (bytes));
+          g_print ("Saved %s binary in %.4gs\n", bytes_string, (double) (end - start) / G_USEC_PER_SEC);
+          g_free (bytes_string);
+        }
+
+      if (binary_file &&
+          !g_file_set_contents (binary_file,
+                                g_bytes_get_data (bytes, NULL),
+                                g_bytes_get_size (bytes),
+                                &error))
+        {
+          g_printerr ("Could not save binary file: %s\n", error->message);
+          g_clear_error (&error);
+        }
+
+      if (binary)
+        {
+          gsk_render_node_unref (node);
+
+          start = g_get_monotonic_time ();
+          node = gsk_render_node_deserialize (bytes, deserialize_error_func, NULL);
+          end = g_get_monotonic_time ();
+          if (benchmark)
+            g_print ("Loaded binary in %.4gs\n", (double) (end - start) / G_USEC_PER_SEC);
+        }
+
+      g_bytes_unref (bytes);
+
+      if (node == NULL)
+        return 1;
+
+      if (argc < 3 && !benchmark)
+        {
+          gsk_render_node_unref (node);
+          return 0;
+        }
+    }
+
   if (fallback)
     {
       graphene_rect_t bounds;
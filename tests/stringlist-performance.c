@@ -0,0 +1,267 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Measures how long filling a GtkStringList with many strings takes
+ * and how much memory it needs, for the different ways of adding
+ * strings. A GListStore of GtkStringObjects is measured, too, for
+ * comparison.
+ *
+ * Peak memory can only be measured once per process, so every way
+ * is run in a child process.
+ *
+ * Usage: stringlist-performance [--strings N] [--compact]
+ */
+
+#include <gtk/gtk.h>
+
+#ifdef G_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+static int n_strings = 1000000;
+static gboolean compact = FALSE;
+static char *child_mode = NULL;
+
+static GOptionEntry options[] = {
+  { "strings", 's', 0, G_OPTION_ARG_INT, &n_strings, "Number of strings", "N" },
+  { "compact", 'c', 0, G_OPTION_ARG_NONE, &compact, "Use compact string lists", NULL },
+  { "child", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_STRING, &child_mode, NULL, NULL },
+  { NULL }
+};
+
+static glong
+get_peak_memory (void)
+{
+#ifdef G_OS_UNIX
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss;
+#endif
+
+  return 0;
+}
+
+static void
+format_string (char *buf,
+               gsize size,
+               int   i)
+{
+  g_snprintf (buf, size, "Item number %d", i);
+}
+
+static GListModel *
+load_objects (void)
+{
+  GListStore *store;
+  char buf[64];
+  int i;
+
+  store = g_list_store_new (GTK_TYPE_STRING_OBJECT);
+  for (i = 0; i < n_strings; i++)
+    {
+      GtkStringObject *object;
+
+      format_string (buf, sizeof (buf), i);
+      object = gtk_string_object_new (buf);
+      g_list_store_append (store, object);
+      g_object_unref (object);
+    }
+
+  return G_LIST_MODEL (store);
+}
+
+static GListModel *
+load_append (void)
+{
+  GtkStringList *list;
+  char buf[64];
+  int i;
+
+  list = compact ? gtk_string_list_new_compact (NULL) : gtk_string_list_new (NULL);
+  for (i = 0; i < n_strings; i++)
+    {
+      format_string (buf, sizeof (buf), i);
+      gtk_string_list_append (list, buf);
+    }
+
+  return G_LIST_MODEL (list);
+}
+
+static GListModel *
+load_take_strv (void)
+{
+  GtkStringList *list;
+  char **strv;
+  char buf[64];
+  int i;
+
+  strv = g_new (char *, n_strings + 1);
+  for (i = 0; i < n_strings; i++)
+    {
+      format_string (buf, sizeof (buf), i);
+      strv[i] = g_strdup (buf);
+    }
+  strv[n_strings] = NULL;
+
+  list = compact ? gtk_string_list_new_compact (NULL) : gtk_string_list_new (NULL);
+  gtk_string_list_take_strv (list, strv);
+
+  return G_LIST_MODEL (list);
+}
+
+static GListModel *
+load_take_bytes (void)
+{
+  GtkStringList *list;
+  GString *text;
+  char buf[64];
+  int i;
+
+  text = g_string_new (NULL);
+  for (i = 0; i < n_strings; i++)
+    {
+      format_string (buf, sizeof (buf), i);
+      g_string_append (text, buf);
+      g_string_append_c (text, '\n');
+    }
+
+  list = compact ? gtk_string_list_new_compact (NULL) : gtk_string_list_new (NULL);
+  gtk_string_list_take_bytes (list, g_string_free_to_bytes (text));
+
+  return G_LIST_MODEL (list);
+}
+
+static const struct {
+  const char *name;
+  GListModel * (* load) (void);
+} modes[] = {
+  { "objects", load_objects },
+  { "append", load_append },
+  { "take-strv", load_take_strv },
+  { "take-bytes", load_take_bytes },
+};
+
+/* Prints "load-msec get-msec peak-kb" */
+static int
+run_child (const char *mode)
+{
+  GListModel *model = NULL;
+  gint64 start, load_time, get_time;
+  glong peak_before, peak_after;
+  guint i;
+
+  peak_before = get_peak_memory ();
+  start = g_get_monotonic_time ();
+
+  for (i = 0; i < G_N_ELEMENTS (modes); i++)
+    {
+      if (g_str_equal (mode, modes[i].name))
+        model = modes[i].load ();
+    }
+
+  if (model == NULL)
+    return 1;
+
+  load_time = g_get_monotonic_time () - start;
+  peak_after = get_peak_memory ();
+
+  /* Looking at items, like a list view does when scrolling */
+  start = g_get_monotonic_time ();
+  for (i = 0; i < g_list_model_get_n_items (model); i++)
+    g_object_unref (g_list_model_get_item (model, i));
+  get_time = g_get_monotonic_time () - start;
+
+  g_print ("%f %f %ld\n", load_time / 1000., get_time / 1000., peak_after - peak_before);
+
+  g_object_unref (model);
+
+  return 0;
+}
+
+static gboolean
+spawn_child (const char *self,
+             const char *mode,
+             double     *load_msec,
+             double     *get_msec,
+             glong      *peak_kb)
+{
+  GError *error = NULL;
+  char *argv[7];
+  char *out;
+  int status;
+  gboolean result;
+
+  argv[0] = (char *) self;
+  argv[1] = (char *) "--child";
+  argv[2] = (char *) mode;
+  argv[3] = (char *) "--strings";
+  argv[4] = g_strdup_printf ("%d", n_strings);
+  argv[5] = compact ? (char *) "--compact" : NULL;
+  argv[6] = NULL;
+
+  result = FALSE;
+  if (!g_spawn_sync (NULL, argv, NULL, G_SPAWN_DEFAULT, NULL, NULL, &out, NULL, &status, &error) ||
+      !g_spawn_check_wait_status (status, &error))
+    {
+      g_printerr ("Failed to run benchmark: %s\n", error->message);
+      g_clear_error (&error);
+    }
+  else
+    {
+      char **fields = g_strsplit (g_strstrip (out), " ", -1);
+
+      if (g_strv_length (fields) == 3)
+        {
+          *load_msec = g_ascii_strtod (fields[0], NULL);
+          *get_msec = g_ascii_strtod (fields[1], NULL);
+          *peak_kb = g_ascii_strtoll (fields[2], NULL, 10);
+          result = TRUE;
+        }
+
+      g_strfreev (fields);
+      g_free (out);
+    }
+
+  g_free (argv[4]);
+
+  return result;
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  guint i;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (n_strings < 1)
+    n_strings = 1;
+
+  if (child_mode)
+    return run_child (child_mode);
+
+  g_print ("%d strings%s:\n", n_strings, compact ? ", compact lists" : "");
+
+  for (i = 0; i < G_N_ELEMENTS (modes); i++)
+    {
+      double load_msec, get_msec;
+      glong peak_kb;
+
+      if (!spawn_child (argv[0], modes[i].name, &load_msec, &get_msec, &peak_kb))
+        continue;
+
+      g_print ("  %-10s load %8.2f msec, get all items %8.2f msec, peak %7ld kB, %5.1f bytes/string\n",
+               modes[i].name, load_msec, get_msec, peak_kb, peak_kb * 1024. / n_strings);
+    }
+
+  return 0;
+}
@@ -0,0 +1,238 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Measures loading a big file into a GtkTextView, either in one
+ * gtk_text_buffer_set_text() call or with
+ * gtk_text_buffer_insert_stream_async().
+ *
+ * Reports the time until the first frame showing text is painted,
+ * the time until all text is loaded, the longest time between two
+ * frames while loading and the peak memory use.
+ *
+ * Peak memory can only be measured once per process, so run it once
+ * for every mode.
+ *
+ * Usage: textload-performance [--size MB] [--set-text] [FILE]
+ */
+
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+
+#ifdef G_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+static int size_mb = 100;
+static gboolean set_text = FALSE;
+
+static GOptionEntry options[] = {
+  { "size", 's', 0, G_OPTION_ARG_INT, &size_mb, "Size of the generated file in MB", "MB" },
+  { "set-text", 0, 0, G_OPTION_ARG_NONE, &set_text, "Load with gtk_text_buffer_set_text()", NULL },
+  { NULL }
+};
+
+typedef struct {
+  GtkTextBuffer *buffer;
+  gint64 start;
+  gint64 first_paint;
+  gint64 loaded;
+  gint64 last_paint;
+  gint64 longest_frame;
+  gboolean painted;
+} Stats;
+
+static glong
+get_peak_memory (void)
+{
+#ifdef G_OS_UNIX
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss;
+#endif
+
+  return 0;
+}
+
+static char *
+create_file (void)
+{
+  GString *text;
+  GError *error = NULL;
+  char *filename;
+  int fd;
+  guint i;
+
+  fd = g_file_open_tmp ("gtk-textload-XXXXXX.txt", &filename, &error);
+  if (fd < 0)
+    {
+      g_printerr ("Could not create file: %s\n", error->message);
+      exit (1);
+    }
+  g_close (fd, NULL);
+
+  text = g_string_sized_new ((gsize) size_mb * 1024 * 1024 + 1024);
+  for (i = 0; text->len < (gsize) size_mb * 1024 * 1024; i++)
+    {
+      g_string_append_printf (text, "%u: processed request %08x from worker %d in %d usec\n",
+                              i, g_random_int (), g_random_int_range (0, 16),
+                              g_random_int_range (0, 100000));
+    }
+
+  if (!g_file_set_contents (filename, text->str, text->len, &error))
+    {
+      g_printerr ("Could not write file: %s\n", error->message);
+      exit (1);
+    }
+
+  g_string_free (text, TRUE);
+
+  return filename;
+}
+
+static void
+after_paint (GdkFrameClock *clock,
+             Stats         *stats)
+{
+  gint64 now = g_get_monotonic_time ();
+
+  if (stats->start == 0)
+    {
+      stats->painted = TRUE;
+      return;
+    }
+
+  if (stats->first_paint == 0 && gtk_text_buffer_get_char_count (stats->buffer) > 0)
+    stats->first_paint = now;
+
+  if (stats->loaded == 0)
+    stats->longest_frame = MAX (stats->longest_frame, now - stats->last_paint);
+
+  stats->last_paint = now;
+}
+
+static void
+insert_done (GObject      *source,
+             GAsyncResult *result,
+             gpointer      data)
+{
+  Stats *stats = data;
+  GError *error = NULL;
+
+  if (!gtk_text_buffer_insert_stream_finish (GTK_TEXT_BUFFER (source), result, &error))
+    {
+      g_printerr ("Could not load file: %s\n", error->message);
+      exit (1);
+    }
+
+  stats->loaded = g_get_monotonic_time ();
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GtkWidget *window, *sw, *view;
+  Stats stats = { NULL, };
+  GFile *file;
+  char *filename;
+  gboolean remove_file;
+
+  context = g_option_context_new ("[FILE]");
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  gtk_init ();
+
+  size_mb = MAX (size_mb, 1);
+
+  if (argc > 1)
+    {
+      filename = g_strdup (argv[1]);
+      remove_file = FALSE;
+    }
+  else
+    {
+      filename = create_file ();
+      remove_file = TRUE;
+    }
+  file = g_file_new_for_commandline_arg (filename);
+
+  window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 800, 600);
+  sw = gtk_scrolled_window_new ();
+  gtk_window_set_child (GTK_WINDOW (window), sw);
+  view = gtk_text_view_new ();
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (sw), view);
+  stats.buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (view));
+  gtk_text_buffer_set_enable_undo (stats.buffer, FALSE);
+
+  gtk_window_present (GTK_WINDOW (window));
+  g_signal_connect (gtk_widget_get_frame_clock (window), "after-paint",
+                    G_CALLBACK (after_paint), &stats);
+
+  while (!stats.painted)
+    g_main_context_iteration (NULL, TRUE);
+
+  stats.start = g_get_monotonic_time ();
+  stats.last_paint = stats.start;
+
+  if (set_text)
+    {
+      char *contents;
+      gsize len;
+
+      if (!g_file_load_contents (file, NULL, &contents, &len, NULL, &error))
+        {
+          g_printerr ("Could not load file: %s\n", error->message);
+          return 1;
+        }
+
+      gtk_text_buffer_set_text (stats.buffer, contents, len);
+      g_free (contents);
+      stats.loaded = g_get_monotonic_time ();
+    }
+  else
+    {
+      GFileInputStream *stream;
+      GtkTextIter iter;
+
+      stream = g_file_read (file, NULL, &error);
+      if (stream == NULL)
+        {
+          g_printerr ("Could not open file: %s\n", error->message);
+          return 1;
+        }
+
+      gtk_text_buffer_get_end_iter (stats.buffer, &iter);
+      gtk_text_buffer_insert_stream_async (stats.buffer, &iter, G_INPUT_STREAM (stream),
+                                           G_PRIORITY_DEFAULT, NULL, insert_done, &stats);
+      g_object_unref (stream);
+    }
+
+  while (stats.loaded == 0 || stats.first_paint == 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_print ("%s, %d lines, %d chars:\n",
+           set_text ? "set_text()" : "insert_stream_async()",
+           gtk_text_buffer_get_line_count (stats.buffer),
+           gtk_text_buffer_get_char_count (stats.buffer));
+  g_print ("  first paint   %9.2f msec\n", (stats.first_paint - stats.start) / 1000.);
+  g_print ("  loaded        %9.2f msec\n", (stats.loaded - stats.start) / 1000.);
+  g_print ("  longest frame %9.2f msec\n", stats.longest_frame / 1000.);
+  g_print ("  peak memory   %9ld kB\n", get_peak_memory ());
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  if (remove_file)
+    g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+  g_free (filename);
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Measures searching a big log-like GtkTextBuffer with and without
+ * the search index: finding all matches of a rare and of a common
+ * word, searching backward, and searching again after editing a
+ * single line.
+ *
+ * Usage: textsearch-performance [--lines N]
+ */
+
+#include <gtk/gtk.h>
+
+static int n_lines = 500000;
+
+static GOptionEntry options[] = {
+  { "lines", 'n', 0, G_OPTION_ARG_INT, &n_lines, "Number of lines", "N" },
+  { NULL }
+};
+
+static const char *levels[] = { "DEBUG", "INFO", "WARNING", "ERROR" };
+
+static GtkTextBuffer *
+create_buffer (void)
+{
+  GtkTextBuffer *buffer;
+  GString *text;
+  int i;
+
+  text = g_string_new (NULL);
+  for (i = 0; i < n_lines; i++)
+    {
+      g_string_append_printf (text, "2023-05-%02d 12:%02d:%02d.%06d %s [worker-%d] processed request %u in %d usec\n",
+                              1 + i % 28, i / 60 % 60, i % 60, g_random_int_range (0, 1000000),
+                              levels[g_random_int_range (0, G_N_ELEMENTS (levels))],
+                              g_random_int_range (0, 16), g_random_int (), g_random_int_range (0, 100000));
+    }
+
+  /* A few lines that are actually looked for */
+  for (i = 0; i < 10; i++)
+    g_string_append_printf (text, "2023-05-28 23:59:%02d.000000 ERROR [worker-0] connection reset by peer\n", i);
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_enable_undo (buffer, FALSE);
+  gtk_text_buffer_set_text (buffer, text->str, text->len);
+  g_string_free (text, TRUE);
+
+  return buffer;
+}
+
+static void
+print_time (const char *what,
+            gint64      start,
+            gsize       n_matches)
+{
+  g_print ("  %-34s %9.2f msec, %" G_GSIZE_FORMAT " matches\n", what, (g_get_monotonic_time () - start) / 1000., n_matches);
+}
+
+static gsize
+find_all (GtkTextBuffer *buffer,
+          const char    *str)
+{
+  GtkTextMark **marks;
+  gsize i, n_marks;
+
+  marks = gtk_text_buffer_find_all (buffer, str, GTK_TEXT_SEARCH_CASE_INSENSITIVE, NULL, NULL, &n_marks);
+  for (i = 0; i < n_marks; i++)
+    gtk_text_buffer_delete_mark (buffer, marks[i]);
+  g_free (marks);
+
+  return n_marks / 2;
+}
+
+static gsize
+search_backward (GtkTextBuffer *buffer,
+                 const char    *str)
+{
+  GtkTextIter iter;
+
+  gtk_text_buffer_get_end_iter (buffer, &iter);
+  if (!gtk_text_iter_backward_search (&iter, str, 0, NULL, NULL, NULL))
+    return 0;
+
+  return 1;
+}
+
+static void
+benchmark (GtkTextBuffer *buffer,
+           gboolean       search_index)
+{
+  GtkTextIter iter, end;
+  gint64 start;
+  gsize n;
+
+  g_print ("%s:\n", search_index ? "with index" : "without index");
+
+  gtk_text_buffer_set_enable_search_index (buffer, search_index);
+
+  start = g_get_monotonic_time ();
+  n = find_all (buffer, "connection reset");
+  print_time ("find all, rare, first time", start, n);
+
+  start = g_get_monotonic_time ();
+  n = find_all (buffer, "connection reset");
+  print_time ("find all, rare", start, n);
+
+  start = g_get_monotonic_time ();
+  n = find_all (buffer, "worker-15]");
+  print_time ("find all, common", start, n);
+
+  start = g_get_monotonic_time ();
+  n = search_backward (buffer, "2023-05-01 00:00:00");
+  print_time ("backward search", start, n);
+
+  gtk_text_buffer_get_iter_at_line (buffer, &iter, n_lines / 2);
+  gtk_text_buffer_insert (buffer, &iter, "connection reset ", -1);
+
+  start = g_get_monotonic_time ();
+  n = find_all (buffer, "connection reset");
+  print_time ("find all, rare, after edit", start, n);
+
+  gtk_text_buffer_get_iter_at_line (buffer, &iter, n_lines / 2);
+  end = iter;
+  gtk_text_iter_forward_chars (&end, strlen ("connection reset "));
+  gtk_text_buffer_delete (buffer, &iter, &end);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GtkTextBuffer *buffer;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (n_lines < 1)
+    n_lines = 1;
+
+  buffer = create_buffer ();
+
+  g_print ("%d lines, %d chars:\n", gtk_text_buffer_get_line_count (buffer), gtk_text_buffer_get_char_count (buffer));
+
+  benchmark (buffer, FALSE);
+  benchmark (buffer, TRUE);
+
+  g_object_unref (buffer);
+
+  return 0;
+}
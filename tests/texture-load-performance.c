@@ -0,0 +1,265 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Measures decode time and peak memory of loading images at full size
+ * and at a reduced size, and how long loading all of them takes with
+ * gdk_texture_new_from_file_async() compared to loading them one after
+ * another.
+ *
+ * Peak memory can only be measured once per process, so every image
+ * is decoded in a child process for that.
+ *
+ * Usage: texture-load-performance [--runs N] [--size N] IMAGE-FILE...
+ */
+
+#include <gtk/gtk.h>
+
+#ifdef G_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+static int runs = 10;
+static int size = 256;
+static gboolean child_process = FALSE;
+
+static GOptionEntry options[] = {
+  { "runs", 'r', 0, G_OPTION_ARG_INT, &runs, "Decode each image N times", "N" },
+  { "size", 's', 0, G_OPTION_ARG_INT, &size, "Size to load images at", "N" },
+  { "child", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_NONE, &child_process, NULL, NULL },
+  { NULL }
+};
+
+static glong
+get_peak_memory (void)
+{
+#ifdef G_OS_UNIX
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss;
+#endif
+
+  return 0;
+}
+
+/* Prints "msec peak-kb width height" for one image at one size */
+static int
+run_child (const char *filename,
+           int         load_size)
+{
+  GdkTexture *texture;
+  GBytes *bytes;
+  GError *error = NULL;
+  gint64 start, total;
+  glong peak_before, peak_after;
+  int run, width, height;
+  char *contents;
+  gsize len;
+
+  if (!g_file_get_contents (filename, &contents, &len, &error))
+    {
+      g_printerr ("Could not open image file: %s\n", error->message);
+      g_error_free (error);
+      return 1;
+    }
+  bytes = g_bytes_new_take (contents, len);
+
+  peak_before = get_peak_memory ();
+  texture = gdk_texture_new_from_bytes_at_size (bytes, load_size, load_size, &error);
+  peak_after = get_peak_memory ();
+  if (texture == NULL)
+    {
+      g_printerr ("Could not load image: %s\n", error->message);
+      g_error_free (error);
+      g_bytes_unref (bytes);
+      return 1;
+    }
+
+  width = gdk_texture_get_width (texture);
+  height = gdk_texture_get_height (texture);
+  g_object_unref (texture);
+
+  total = 0;
+  for (run = 0; run < runs; run++)
+    {
+      start = g_get_monotonic_time ();
+      texture = gdk_texture_new_from_bytes_at_size (bytes, load_size, load_size, NULL);
+      total += g_get_monotonic_time () - start;
+      g_object_unref (texture);
+    }
+
+  g_print ("%f %ld %d %d\n", (double) total / runs / 1000., peak_after - peak_before, width, height);
+
+  g_bytes_unref (bytes);
+
+  return 0;
+}
+
+static gboolean
+spawn_child (const char *self,
+             const char *filename,
+             int         load_size,
+             double     *msec,
+             glong      *peak_kb,
+             int        *width,
+             int        *height)
+{
+  GError *error = NULL;
+  char *argv[8];
+  char *out;
+  int status;
+  gboolean result;
+
+  argv[0] = (char *) self;
+  argv[1] = (char *) "--child";
+  argv[2] = (char *) "--runs";
+  argv[3] = g_strdup_printf ("%d", runs);
+  argv[4] = (char *) "--size";
+  argv[5] = g_strdup_printf ("%d", load_size);
+  argv[6] = (char *) filename;
+  argv[7] = NULL;
+
+  result = FALSE;
+  if (!g_spawn_sync (NULL, argv, NULL, G_SPAWN_DEFAULT, NULL, NULL, &out, NULL, &status, &error) ||
+      !g_spawn_check_wait_status (status, &error))
+    {
+      g_printerr ("Failed to run benchmark: %s\n", error->message);
+      g_clear_error (&error);
+    }
+  else
+    {
+      char **fields = g_strsplit (g_strstrip (out), " ", -1);
+
+      if (g_strv_length (fields) == 4)
+        {
+          *msec = g_ascii_strtod (fields[0], NULL);
+          *peak_kb = g_ascii_strtoll (fields[1], NULL, 10);
+          *width = g_ascii_strtoll (fields[2], NULL, 10);
+          *height = g_ascii_strtoll (fields[3], NULL, 10);
+          result = TRUE;
+        }
+
+      g_strfreev (fields);
+      g_free (out);
+    }
+
+  g_free (argv[3]);
+  g_free (argv[5]);
+
+  return result;
+}
+
+static void
+load_done_cb (GObject      *source,
+              GAsyncResult *result,
+              gpointer      data)
+{
+  int *pending = data;
+  GdkTexture *texture;
+  GError *error = NULL;
+
+  texture = gdk_texture_new_from_file_finish (result, &error);
+  if (texture)
+    g_object_unref (texture);
+  else
+    {
+      g_printerr ("Could not load image: %s\n", error->message);
+      g_error_free (error);
+    }
+
+  (*pending)--;
+  g_main_context_wakeup (NULL);
+}
+
+static void
+benchmark_async (char **filenames,
+                 int    n_files)
+{
+  gint64 start, sync_time, async_time;
+  int i, pending;
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < n_files; i++)
+    {
+      GFile *file = g_file_new_for_commandline_arg (filenames[i]);
+      GdkTexture *texture = NULL;
+      GBytes *bytes;
+
+      bytes = g_file_load_bytes (file, NULL, NULL, NULL);
+      if (bytes)
+        {
+          texture = gdk_texture_new_from_bytes_at_size (bytes, size, size, NULL);
+          g_bytes_unref (bytes);
+        }
+      g_clear_object (&texture);
+      g_object_unref (file);
+    }
+  sync_time = g_get_monotonic_time () - start;
+
+  start = g_get_monotonic_time ();
+  pending = n_files;
+  for (i = 0; i < n_files; i++)
+    {
+      GFile *file = g_file_new_for_commandline_arg (filenames[i]);
+
+      gdk_texture_new_from_file_async (file, size, size, NULL, load_done_cb, &pending);
+      g_object_unref (file);
+    }
+  while (pending > 0)
+    g_main_context_iteration (NULL, TRUE);
+  async_time = g_get_monotonic_time () - start;
+
+  g_print ("all %d images at %d: %.2f msec one by one, %.2f msec async, %.2fx\n",
+           n_files, size,
+           sync_time / 1000., async_time / 1000.,
+           (double) sync_time / async_time);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  int i;
+
+  context = g_option_context_new ("IMAGE-FILE...");
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (argc < 2)
+    {
+      g_printerr ("Usage: %s [OPTIONS] IMAGE-FILE...\n", argv[0]);
+      return 1;
+    }
+
+  if (runs < 1)
+    runs = 1;
+
+  if (child_process)
+    return run_child (argv[1], size);
+
+  for (i = 1; i < argc; i++)
+    {
+      double full_msec, scaled_msec;
+      glong full_kb, scaled_kb;
+      int full_width, full_height, scaled_width, scaled_height;
+
+      if (!spawn_child (argv[0], argv[i], -1, &full_msec, &full_kb, &full_width, &full_height) ||
+          !spawn_child (argv[0], argv[i], size, &scaled_msec, &scaled_kb, &scaled_width, &scaled_height))
+        continue;
+
+      g_print ("%s:\n", argv[i]);
+      g_print ("  full    %5dx%-5d %8.2f msec, peak %6ld kB\n",
+               full_width, full_height, full_msec, full_kb);
+      g_print ("  scaled  %5dx%-5d %8.2f msec, peak %6ld kB, %.2fx faster\n",
+               scaled_width, scaled_height, scaled_msec, scaled_kb, full_msec / scaled_msec);
+    }
+
+  benchmark_async (argv + 1, argc - 1);
+
+  return 0;
+}
@@ -0,0 +1,258 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Measures how long it takes to fully expand a synthetic deep tree
+ * with a GtkTreeListModel: eagerly via autoexpand, with
+ * gtk_tree_list_model_expand_all(), and incrementally.
+ *
+ * For incremental expanding, the first rows are looked at after
+ * every main loop iteration like a list view would, and the time
+ * until they show the fully expanded tree as well as the longest
+ * time the main loop was blocked are reported.
+ *
+ * Usage: treelistmodel-performance [--width N] [--depth N] [--visible N]
+ */
+
+#include <gtk/gtk.h>
+
+static int width = 10;
+static int depth = 5;
+static int n_visible = 50;
+
+static GOptionEntry options[] = {
+  { "width", 'w', 0, G_OPTION_ARG_INT, &width, "Children per row", "N" },
+  { "depth", 'd', 0, G_OPTION_ARG_INT, &depth, "Depth of the tree", "N" },
+  { "visible", 'v', 0, G_OPTION_ARG_INT, &n_visible, "Rows looked at after every iteration", "N" },
+  { NULL }
+};
+
+static GListModel *
+create_level (const char *prefix)
+{
+  GtkStringList *list;
+  char buf[256];
+  int i;
+
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < width; i++)
+    {
+      if (prefix)
+        g_snprintf (buf, sizeof (buf), "%s/%d", prefix, i);
+      else
+        g_snprintf (buf, sizeof (buf), "%d", i);
+      gtk_string_list_append (list, buf);
+    }
+
+  return G_LIST_MODEL (list);
+}
+
+static int
+get_depth (const char *path)
+{
+  int result = 1;
+
+  for (; *path; path++)
+    {
+      if (*path == '/')
+        result++;
+    }
+
+  return result;
+}
+
+static GListModel *
+create_model_cb (gpointer item,
+                 gpointer unused)
+{
+  const char *path = gtk_string_object_get_string (item);
+
+  if (get_depth (path) >= depth)
+    return NULL;
+
+  return create_level (path);
+}
+
+static guint
+get_n_rows (void)
+{
+  guint n, level;
+
+  n = 0;
+  for (level = 1; level <= (guint) depth; level++)
+    n = n * width + width;
+
+  return n;
+}
+
+/* The paths of the first rows of the fully expanded tree */
+static void
+add_expected (GPtrArray  *expected,
+              const char *prefix)
+{
+  int i;
+
+  for (i = 0; i < width && expected->len < (guint) n_visible; i++)
+    {
+      char *path;
+
+      if (prefix)
+        path = g_strdup_printf ("%s/%d", prefix, i);
+      else
+        path = g_strdup_printf ("%d", i);
+      g_ptr_array_add (expected, path);
+
+      if (get_depth (path) < depth)
+        add_expected (expected, path);
+    }
+}
+
+static gboolean
+check_visible (GListModel *model,
+               GPtrArray  *expected)
+{
+  gboolean result = TRUE;
+  guint i;
+
+  for (i = 0; i < expected->len; i++)
+    {
+      GtkStringObject *item = g_list_model_get_item (model, i);
+
+      if (item == NULL)
+        return FALSE;
+
+      if (!g_str_equal (gtk_string_object_get_string (item), g_ptr_array_index (expected, i)))
+        result = FALSE;
+
+      g_object_unref (item);
+    }
+
+  return result;
+}
+
+static void
+count_changes (GListModel *model,
+               guint       position,
+               guint       removed,
+               guint       added,
+               guint      *counter)
+{
+  (*counter)++;
+}
+
+static GtkTreeListModel *
+create_tree (gboolean autoexpand)
+{
+  return gtk_tree_list_model_new (create_level (NULL),
+                                  TRUE,
+                                  autoexpand,
+                                  create_model_cb,
+                                  NULL, NULL);
+}
+
+static void
+benchmark_eager (void)
+{
+  GtkTreeListModel *tree;
+  gint64 start, total;
+
+  start = g_get_monotonic_time ();
+  tree = create_tree (TRUE);
+  total = g_get_monotonic_time () - start;
+
+  g_assert (g_list_model_get_n_items (G_LIST_MODEL (tree)) == get_n_rows ());
+
+  g_print ("  autoexpand   %9.2f msec\n", total / 1000.);
+
+  g_object_unref (tree);
+}
+
+static void
+benchmark_expand_all (void)
+{
+  GtkTreeListModel *tree;
+  gint64 start, total;
+  guint changes = 0;
+
+  tree = create_tree (FALSE);
+  g_signal_connect (tree, "items-changed", G_CALLBACK (count_changes), &changes);
+
+  start = g_get_monotonic_time ();
+  gtk_tree_list_model_expand_all (tree);
+  total = g_get_monotonic_time () - start;
+
+  g_assert (g_list_model_get_n_items (G_LIST_MODEL (tree)) == get_n_rows ());
+
+  g_print ("  expand-all   %9.2f msec, %u items-changed\n", total / 1000., changes);
+
+  g_object_unref (tree);
+}
+
+static void
+benchmark_incremental (void)
+{
+  GtkTreeListModel *tree;
+  GPtrArray *expected;
+  gint64 start, iteration_start, visible_time, longest, total;
+  guint changes = 0;
+
+  expected = g_ptr_array_new_with_free_func (g_free);
+  add_expected (expected, NULL);
+
+  tree = create_tree (FALSE);
+  g_signal_connect (tree, "items-changed", G_CALLBACK (count_changes), &changes);
+
+  start = g_get_monotonic_time ();
+  gtk_tree_list_model_set_incremental (tree, TRUE);
+  gtk_tree_list_model_expand_all (tree);
+
+  visible_time = -1;
+  longest = 0;
+  while (TRUE)
+    {
+      if (visible_time < 0 && check_visible (G_LIST_MODEL (tree), expected))
+        visible_time = g_get_monotonic_time () - start;
+
+      if (gtk_tree_list_model_get_pending (tree) == 0)
+        break;
+
+      iteration_start = g_get_monotonic_time ();
+      g_main_context_iteration (NULL, TRUE);
+      longest = MAX (longest, g_get_monotonic_time () - iteration_start);
+    }
+  total = g_get_monotonic_time () - start;
+
+  g_assert (g_list_model_get_n_items (G_LIST_MODEL (tree)) == get_n_rows ());
+
+  g_print ("  incremental  %9.2f msec, %u items-changed, first %u rows after %.2f msec, longest step %.2f msec\n",
+           total / 1000., changes, expected->len, visible_time / 1000., longest / 1000.);
+
+  g_object_unref (tree);
+  g_ptr_array_unref (expected);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  width = CLAMP (width, 1, 1000);
+  depth = CLAMP (depth, 1, 20);
+  n_visible = MAX (n_visible, 1);
+
+  g_print ("%d levels of %d children, %u rows:\n", depth, width, get_n_rows ());
+
+  benchmark_eager ();
+  benchmark_expand_all ();
+  benchmark_incremental ();
+
+  return 0;
+}
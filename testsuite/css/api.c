@@ -18,7 +18,9 @@
  * License along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <glib/gstdio.h>
 #include <gtk/gtk.h>
+#include <string.h>
 
 static void
 gtk_css_provider_load_data_not_null_terminated (void)
@@ -36,6 +38,104 @@ gtk_css_provider_load_data_not_null_terminated (void)
   g_object_unref (p);
 }
 
+static void
+count_errors (GtkCssProvider *provider,
+              GtkCssSection  *section,
+              const GError   *error,
+              guint          *n_errors)
+{
+  (*n_errors)++;
+}
+
+static void
+gtk_css_provider_load_twice (void)
+{
+  const char *css = "@define-color c red; label { color: @c; } box { margin: 1px; }";
+  GtkCssProvider *p1, *p2;
+  char *s1, *s2;
+
+  p1 = gtk_css_provider_new ();
+  gtk_css_provider_load_from_string (p1, css);
+  p2 = gtk_css_provider_new ();
+  gtk_css_provider_load_from_string (p2, css);
+
+  s1 = gtk_css_provider_to_string (p1);
+  s2 = gtk_css_provider_to_string (p2);
+  g_assert_cmpstr (s1, ==, s2);
+  g_free (s2);
+
+  /* Changing one provider must not affect the other */
+  gtk_css_provider_load_from_string (p1, "label { color: blue; }");
+  s2 = gtk_css_provider_to_string (p2);
+  g_assert_cmpstr (s1, ==, s2);
+  g_free (s2);
+
+  g_free (s1);
+  g_object_unref (p1);
+  g_object_unref (p2);
+}
+
+static void
+gtk_css_provider_load_twice_errors (void)
+{
+  const char *css = "label { color: nonsense; } box { margin: 1px; }";
+  GtkCssProvider *p1, *p2;
+  guint n_errors = 0;
+
+  p1 = gtk_css_provider_new ();
+  g_signal_connect (p1, "parsing-error", G_CALLBACK (count_errors), &n_errors);
+  gtk_css_provider_load_from_string (p1, css);
+  g_assert_cmpuint (n_errors, ==, 1);
+
+  p2 = gtk_css_provider_new ();
+  g_signal_connect (p2, "parsing-error", G_CALLBACK (count_errors), &n_errors);
+  gtk_css_provider_load_from_string (p2, css);
+  g_assert_cmpuint (n_errors, ==, 2);
+
+  g_object_unref (p1);
+  g_object_unref (p2);
+}
+
+static void
+gtk_css_provider_load_twice_import_changed (void)
+{
+  GtkCssProvider *p1, *p2;
+  char *dir, *main_css, *imported_css;
+  char *s1, *s2;
+
+  dir = g_dir_make_tmp ("gtk-css-api-XXXXXX", NULL);
+  g_assert_nonnull (dir);
+  main_css = g_build_filename (dir, "main.css", NULL);
+  imported_css = g_build_filename (dir, "imported.css", NULL);
+
+  g_assert_true (g_file_set_contents (main_css, "@import url(\"imported.css\");", -1, NULL));
+  g_assert_true (g_file_set_contents (imported_css, "label { margin: 3px; }", -1, NULL));
+
+  p1 = gtk_css_provider_new ();
+  gtk_css_provider_load_from_path (p1, main_css);
+  s1 = gtk_css_provider_to_string (p1);
+  g_assert_nonnull (strstr (s1, "3px"));
+
+  /* The main file is unchanged, but the import is not */
+  g_assert_true (g_file_set_contents (imported_css, "label { margin: 7px; }", -1, NULL));
+
+  p2 = gtk_css_provider_new ();
+  gtk_css_provider_load_from_path (p2, main_css);
+  s2 = gtk_css_provider_to_string (p2);
+  g_assert_nonnull (strstr (s2, "7px"));
+
+  g_free (s1);
+  g_free (s2);
+  g_object_unref (p1);
+  g_object_unref (p2);
+
+  g_remove (imported_css);
+  g_remove (main_css);
+  g_rmdir (dir);
+  g_free (imported_css);
+  g_free (main_css);
+  g_free (dir);
+}
 
 int
 main (int argc, char *argv[])
@@ -44,6 +144,9 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/gtk_css_provider_load_data/not_null_terminated",
       gtk_css_provider_load_data_not_null_terminated);
+  g_test_add_func ("/gtk_css_provider_load_data/twice", gtk_css_provider_load_twice);
+  g_test_add_func ("/gtk_css_provider_load_data/twice_errors", gtk_css_provider_load_twice_errors);
+  g_test_add_func ("/gtk_css_provider_load_data/twice_import_changed", gtk_css_provider_load_twice_import_changed);
 
   return g_test_run ();
 }
@@ -49,11 +49,11 @@ test_load_image (gconstpointer data)
 
   /* use the internal api, we want to avoid pixbuf fallback here */
   if (g_str_has_suffix (filename, ".png"))
-    texture = gdk_load_png (bytes, &error);
+    texture = gdk_load_png (bytes, -1, -1, &error);
   else if (g_str_has_suffix (filename, ".tiff"))
-    texture = gdk_load_tiff (bytes, &error);
+    texture = gdk_load_tiff (bytes, -1, -1, &error);
   else if (g_str_has_suffix (filename, ".jpeg"))
-    texture = gdk_load_jpeg (bytes, &error);
+    texture = gdk_load_jpeg (bytes, -1, -1, &error);
   else
     g_assert_not_reached ();
 
@@ -68,6 +68,103 @@ test_load_image (gconstpointer data)
   g_free (path);
 }
 
+static void
+test_load_image_at_size (gconstpointer data)
+{
+  const char *filename = data;
+  GdkTexture *texture;
+  char *path;
+  GFile *file;
+  GBytes *bytes;
+  GError *error = NULL;
+
+  path = g_test_build_filename (G_TEST_DIST, "image-data", filename, NULL);
+  file = g_file_new_for_path (path);
+  bytes = g_file_load_bytes (file, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  /* 32x32 images can be halved and still be at least 12x12 */
+  texture = gdk_texture_new_from_bytes_at_size (bytes, 12, 12, &error);
+  g_assert_no_error (error);
+  g_assert_true (GDK_IS_TEXTURE (texture));
+  g_assert_cmpint (gdk_texture_get_width (texture), ==, 16);
+  g_assert_cmpint (gdk_texture_get_height (texture), ==, 16);
+  g_object_unref (texture);
+
+  /* Only one dimension given */
+  texture = gdk_texture_new_from_bytes_at_size (bytes, -1, 20, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (gdk_texture_get_width (texture), ==, 32);
+  g_assert_cmpint (gdk_texture_get_height (texture), ==, 32);
+  g_object_unref (texture);
+
+  g_bytes_unref (bytes);
+  g_object_unref (file);
+  g_free (path);
+}
+
+static void
+load_async_cb (GObject      *source,
+               GAsyncResult *result,
+               gpointer      data)
+{
+  GdkTexture **texture = data;
+  GError *error = NULL;
+
+  *texture = gdk_texture_new_from_file_finish (result, &error);
+  g_assert_no_error (error);
+  g_main_context_wakeup (NULL);
+}
+
+static void
+cancel_async_cb (GObject      *source,
+                 GAsyncResult *result,
+                 gpointer      data)
+{
+  gboolean *done = data;
+  GdkTexture *texture;
+  GError *error = NULL;
+
+  texture = gdk_texture_new_from_file_finish (result, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_null (texture);
+  g_clear_error (&error);
+
+  *done = TRUE;
+  g_main_context_wakeup (NULL);
+}
+
+static void
+test_load_image_async (void)
+{
+  GdkTexture *texture = NULL;
+  GCancellable *cancellable;
+  gboolean done = FALSE;
+  char *path;
+  GFile *file;
+
+  path = g_test_build_filename (G_TEST_DIST, "image-data", "image.png", NULL);
+  file = g_file_new_for_path (path);
+
+  gdk_texture_new_from_file_async (file, 16, 16, NULL, load_async_cb, &texture);
+  while (texture == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpint (gdk_texture_get_width (texture), ==, 16);
+  g_assert_cmpint (gdk_texture_get_height (texture), ==, 16);
+  g_object_unref (texture);
+
+  cancellable = g_cancellable_new ();
+  gdk_texture_new_from_file_async (file, -1, -1, cancellable, cancel_async_cb, &done);
+  g_cancellable_cancel (cancellable);
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_object_unref (cancellable);
+  g_object_unref (file);
+  g_free (path);
+}
+
 static void
 test_save_image (gconstpointer test_data)
 {
@@ -169,6 +266,11 @@ main (int argc, char *argv[])
      g_free (test);
    }
 
+  g_test_add_data_func ("/image/load-at-size/image.png", "image.png", test_load_image_at_size);
+  g_test_add_data_func ("/image/load-at-size/image.tiff", "image.tiff", test_load_image_at_size);
+  g_test_add_data_func ("/image/load-at-size/image.jpeg", "image.jpeg", test_load_image_at_size);
+  g_test_add_func ("/image/load-async", test_load_image_async);
+
   g_test_add_data_func ("/image/save/image.png", "image.png", test_save_image);
   g_test_add_data_func ("/image/save/image.tiff", "image.tiff", test_save_image);
   g_test_add_data_func ("/image/save/image.jpeg", "image.jpeg", test_save_image);
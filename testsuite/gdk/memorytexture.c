@@ -1,5 +1,6 @@
 #include <gtk/gtk.h>
 
+#include "gdk/gdkmemoryformatprivate.h"
 #include "gsk/gl/gskglrenderer.h"
 #ifdef GDK_RENDERING_VULKAN
 #include "gsk/vulkan/gskvulkanrenderer.h"
@@ -79,60 +80,6 @@ float_to_half (const float x)
   return (b&0x80000000)>>16 | (e>112)*((((e-112)<<10)&0x7C00)|m>>13) | ((e<113)&(e>101))*((((0x007FF000+m)>>(125-e))+1)>>1) | (e>143)*0x7FFF; // sign : normalized : denormalized : saturate
 }
 
-static gsize
-gdk_memory_format_bytes_per_pixel (GdkMemoryFormat format)
-{
-  switch (format)
-    {
-    case GDK_MEMORY_G8:
-    case GDK_MEMORY_A8:
-      return 1;
-
-    case GDK_MEMORY_G8A8_PREMULTIPLIED:
-    case GDK_MEMORY_G8A8:
-    case GDK_MEMORY_G16:
-    case GDK_MEMORY_A16:
-      return 2;
-
-    case GDK_MEMORY_R8G8B8:
-    case GDK_MEMORY_B8G8R8:
-      return 3;
-
-    case GDK_MEMORY_B8G8R8A8_PREMULTIPLIED:
-    case GDK_MEMORY_A8R8G8B8_PREMULTIPLIED:
-    case GDK_MEMORY_R8G8B8A8_PREMULTIPLIED:
-    case GDK_MEMORY_B8G8R8A8:
-    case GDK_MEMORY_A8R8G8B8:
-    case GDK_MEMORY_R8G8B8A8:
-    case GDK_MEMORY_A8B8G8R8:
-    case GDK_MEMORY_G16A16_PREMULTIPLIED:
-    case GDK_MEMORY_G16A16:
-      return 4;
-
-    case GDK_MEMORY_R16G16B16:
-    case GDK_MEMORY_R16G16B16_FLOAT:
-      return 6;
-
-    case GDK_MEMORY_R16G16B16A16_PREMULTIPLIED:
-    case GDK_MEMORY_R16G16B16A16:
-    case GDK_MEMORY_R16G16B16A16_FLOAT_PREMULTIPLIED:
-    case GDK_MEMORY_R16G16B16A16_FLOAT:
-      return 8;
-
-    case GDK_MEMORY_R32G32B32_FLOAT:
-      return 12;
-
-    case GDK_MEMORY_R32G32B32A32_FLOAT_PREMULTIPLIED:
-    case GDK_MEMORY_R32G32B32A32_FLOAT:
-      return 16;
-
-    case GDK_MEMORY_N_FORMATS:
-    default:
-      g_assert_not_reached ();
-      return 4;
-    }
-}
-
 static ChannelType
 gdk_memory_format_get_channel_type (GdkMemoryFormat format)
 {
@@ -1333,6 +1280,168 @@ test_conversion_random (gconstpointer data)
   test_conversion (data, g_test_rand_int_range (2, 18));
 }
 
+static GdkMemoryFormat
+get_float_format (GdkMemoryFormat format)
+{
+  if (gdk_memory_format_alpha (format) == GDK_MEMORY_ALPHA_PREMULTIPLIED)
+    return GDK_MEMORY_R32G32B32A32_FLOAT_PREMULTIPLIED;
+  else
+    return GDK_MEMORY_R32G32B32A32_FLOAT;
+}
+
+/* Compares gdk_memory_convert(), which uses direct converters for
+ * many pairs, against the float path they are supposed to match.
+ * They may round differently by at most one step of the target.
+ */
+static void
+test_direct_conversion (gconstpointer data)
+{
+  GdkMemoryFormat src_format, dest_format, float_format;
+  gsize width, height, src_stride, dest_stride, i;
+  guchar *src, *direct, *reference;
+  float *rgba, *direct_rgba, *reference_rgba;
+  float epsilon;
+
+  decode_two_formats (data, &src_format, &dest_format);
+
+  /* wide enough for vectorized code and a scalar remainder */
+  width = g_test_rand_int_range (1, 70);
+  height = g_test_rand_int_range (1, 5);
+
+  rgba = g_new (float, width * height * 4);
+  for (i = 0; i < width * height * 4; i++)
+    rgba[i] = g_test_rand_double_range (0, 1);
+
+  /* make some pixels transparent or almost so */
+  for (i = 0; i < width * height; i += 7)
+    rgba[4 * i + 3] = g_test_rand_int_range (0, 3) / 255.f;
+
+  src_stride = width * gdk_memory_format_bytes_per_pixel (src_format);
+  src = g_malloc (src_stride * height);
+  gdk_memory_convert_via_float (src, src_stride, src_format,
+                                (guchar *) rgba, width * 4 * sizeof (float), GDK_MEMORY_R32G32B32A32_FLOAT,
+                                width, height);
+
+  dest_stride = width * gdk_memory_format_bytes_per_pixel (dest_format);
+  direct = g_malloc (dest_stride * height);
+  reference = g_malloc (dest_stride * height);
+  gdk_memory_convert (direct, dest_stride, dest_format,
+                      src, src_stride, src_format,
+                      width, height);
+  gdk_memory_convert_via_float (reference, dest_stride, dest_format,
+                                src, src_stride, src_format,
+                                width, height);
+
+  /* compare with the same kind of alpha, so tiny differences
+   * don't get amplified by unpremultiplying */
+  float_format = get_float_format (dest_format);
+  direct_rgba = g_new (float, width * height * 4);
+  reference_rgba = g_new (float, width * height * 4);
+  gdk_memory_convert_via_float ((guchar *) direct_rgba, width * 4 * sizeof (float), float_format,
+                                direct, dest_stride, dest_format,
+                                width, height);
+  gdk_memory_convert_via_float ((guchar *) reference_rgba, width * 4 * sizeof (float), float_format,
+                                reference, dest_stride, dest_format,
+                                width, height);
+
+  /* The direct converters premultiply in integer math and round at
+   * every step, the float path only rounds once at the end. So they
+   * may be one step apart. test_simd_conversion() checks the vector
+   * code exactly. */
+  switch (gdk_memory_format_get_depth (dest_format))
+    {
+    case GDK_MEMORY_U8:
+      epsilon = 1.01f / 255.f;
+      break;
+    case GDK_MEMORY_U16:
+      epsilon = 1.01f / 65535.f;
+      break;
+    case GDK_MEMORY_FLOAT16:
+      epsilon = 1.f / 1024.f;
+      break;
+    case GDK_MEMORY_FLOAT32:
+    default:
+      epsilon = 1e-6f;
+      break;
+    }
+
+  for (i = 0; i < width * height * 4; i++)
+    {
+      if (G_APPROX_VALUE (direct_rgba[i], reference_rgba[i], epsilon))
+        continue;
+
+      g_test_message ("pixel %" G_GSIZE_FORMAT " channel %" G_GSIZE_FORMAT ": %g vs %g",
+                      i / 4, i % 4, direct_rgba[i], reference_rgba[i]);
+      g_test_fail ();
+      break;
+    }
+
+  g_free (reference_rgba);
+  g_free (direct_rgba);
+  g_free (reference);
+  g_free (direct);
+  g_free (src);
+  g_free (rgba);
+}
+
+/* The vector code only handles runs of several pixels, so converting
+ * one pixel at a time goes through the scalar converters. Both must
+ * give exactly the same result.
+ */
+static void
+test_simd_conversion (gconstpointer data)
+{
+  GdkMemoryFormat src_format, dest_format;
+  gsize width, height, src_stride, dest_stride, src_bpp, dest_bpp, x, y, i;
+  guchar *src, *rows, *pixels;
+  float *rgba;
+
+  decode_two_formats (data, &src_format, &dest_format);
+
+  width = g_test_rand_int_range (1, 70);
+  height = g_test_rand_int_range (1, 5);
+
+  rgba = g_new (float, width * height * 4);
+  for (i = 0; i < width * height * 4; i++)
+    rgba[i] = g_test_rand_double_range (0, 1);
+
+  for (i = 0; i < width * height; i += 7)
+    rgba[4 * i + 3] = g_test_rand_int_range (0, 3) / 255.f;
+
+  src_bpp = gdk_memory_format_bytes_per_pixel (src_format);
+  src_stride = width * src_bpp;
+  src = g_malloc (src_stride * height);
+  gdk_memory_convert_via_float (src, src_stride, src_format,
+                                (guchar *) rgba, width * 4 * sizeof (float), GDK_MEMORY_R32G32B32A32_FLOAT,
+                                width, height);
+
+  dest_bpp = gdk_memory_format_bytes_per_pixel (dest_format);
+  dest_stride = width * dest_bpp;
+  rows = g_malloc (dest_stride * height);
+  pixels = g_malloc (dest_stride * height);
+
+  gdk_memory_convert (rows, dest_stride, dest_format,
+                      src, src_stride, src_format,
+                      width, height);
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x < width; x++)
+        {
+          gdk_memory_convert (pixels + y * dest_stride + x * dest_bpp, dest_stride, dest_format,
+                              src + y * src_stride + x * src_bpp, src_stride, src_format,
+                              1, 1);
+        }
+    }
+
+  g_assert_cmpmem (rows, dest_stride * height, pixels, dest_stride * height);
+
+  g_free (pixels);
+  g_free (rows);
+  g_free (src);
+  g_free (rgba);
+}
+
 static void
 add_test (const char    *name,
           GTestDataFunc  func)
@@ -1392,6 +1501,8 @@ main (int argc, char *argv[])
   add_test ("/memorytexture/download_random", test_download_random);
   add_conversion_test ("/memorytexture/conversion_1x1", test_conversion_1x1);
   add_conversion_test ("/memorytexture/conversion_random", test_conversion_random);
+  add_conversion_test ("/memorytexture/direct_conversion", test_direct_conversion);
+  add_conversion_test ("/memorytexture/simd_conversion", test_simd_conversion);
 
   gl_context = gdk_display_create_gl_context (gdk_display_get_default (), NULL);
   if (gl_context == NULL || !gdk_gl_context_realize (gl_context, NULL))
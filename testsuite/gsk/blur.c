@@ -0,0 +1,93 @@
+#include <gtk/gtk.h>
+
+#include "gsk/gskcairoblurprivate.h"
+
+static cairo_surface_t *
+create_random_surface (cairo_format_t format,
+                       int            width,
+                       int            height)
+{
+  cairo_surface_t *surface;
+  guchar *data;
+  int stride, i;
+
+  surface = cairo_image_surface_create (format, width, height);
+  data = cairo_image_surface_get_data (surface);
+  stride = cairo_image_surface_get_stride (surface);
+
+  /* Mostly opaque pixels, so the sums get large */
+  for (i = 0; i < stride * height; i++)
+    data[i] = g_random_boolean () ? 255 : g_random_int_range (0, 256);
+
+  cairo_surface_mark_dirty (surface);
+
+  return surface;
+}
+
+static cairo_surface_t *
+copy_surface (cairo_surface_t *surface)
+{
+  cairo_surface_t *copy;
+
+  copy = cairo_image_surface_create (cairo_image_surface_get_format (surface),
+                                     cairo_image_surface_get_width (surface),
+                                     cairo_image_surface_get_height (surface));
+  memcpy (cairo_image_surface_get_data (copy),
+          cairo_image_surface_get_data (surface),
+          cairo_image_surface_get_stride (surface) * cairo_image_surface_get_height (surface));
+  cairo_surface_mark_dirty (copy);
+
+  return copy;
+}
+
+static void
+test_kernel (gconstpointer data)
+{
+  GskBlurKernel kernel = GPOINTER_TO_UINT (data);
+  const cairo_format_t formats[] = { CAIRO_FORMAT_A8, CAIRO_FORMAT_ARGB32 };
+
+  if (!gsk_cairo_blur_kernel_is_supported (kernel))
+    {
+      g_test_skip ("Kernel not supported");
+      return;
+    }
+
+  for (int i = 0; i < 50; i++)
+    {
+      cairo_surface_t *surface, *reference;
+      cairo_format_t format;
+      GskBlurFlags flags;
+      int width, height, radius, size;
+
+      format = formats[i % G_N_ELEMENTS (formats)];
+      width = g_random_int_range (1, 100);
+      height = g_random_int_range (1, 100);
+      radius = g_random_int_range (2, 30);
+      flags = g_random_int_range (GSK_BLUR_X, (GSK_BLUR_X | GSK_BLUR_Y) + 1);
+
+      reference = create_random_surface (format, width, height);
+      surface = copy_surface (reference);
+
+      gsk_cairo_blur_surface_with_kernel (reference, radius, flags, GSK_BLUR_KERNEL_SCALAR);
+      gsk_cairo_blur_surface_with_kernel (surface, radius, flags, kernel);
+
+      size = cairo_image_surface_get_stride (surface) * height;
+      g_assert_cmpmem (cairo_image_surface_get_data (surface), size,
+                       cairo_image_surface_get_data (reference), size);
+
+      cairo_surface_destroy (surface);
+      cairo_surface_destroy (reference);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  (g_test_init) (&argc, &argv, NULL);
+
+  g_test_add_data_func ("/blur/kernel/sse2", GUINT_TO_POINTER (GSK_BLUR_KERNEL_SSE2), test_kernel);
+  g_test_add_data_func ("/blur/kernel/avx2", GUINT_TO_POINTER (GSK_BLUR_KERNEL_AVX2), test_kernel);
+  g_test_add_data_func ("/blur/kernel/neon", GUINT_TO_POINTER (GSK_BLUR_KERNEL_NEON), test_kernel);
+
+  return g_test_run ();
+}
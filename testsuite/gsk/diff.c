@@ -95,6 +95,128 @@ test_can_diff_transform (void)
   gsk_transform_unref (t2);
 }
 
+static void
+test_hash (void)
+{
+  GskRenderNode *color1, *color2, *color3;
+  GskRenderNode *container1, *container2;
+
+  color1 = gsk_color_node_new (&(GdkRGBA){0, 1, 0, 1 }, &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+  color2 = gsk_color_node_new (&(GdkRGBA){0, 1, 0, 1 }, &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+  color3 = gsk_color_node_new (&(GdkRGBA){0, 1, 0, 1 }, &GRAPHENE_RECT_INIT (10, 0, 10, 10));
+
+  container1 = gsk_container_node_new ((GskRenderNode *[]) { color1, color3 }, 2);
+  container2 = gsk_container_node_new ((GskRenderNode *[]) { color2, color3 }, 2);
+
+  /* Equal nodes hash the same, even if they are different objects */
+  g_assert_cmpuint (gsk_render_node_get_hash (color1), ==, gsk_render_node_get_hash (color2));
+  g_assert_cmpuint (gsk_render_node_get_hash (container1), ==, gsk_render_node_get_hash (container2));
+  g_assert_cmpuint (gsk_render_node_get_hash (color1), !=, gsk_render_node_get_hash (color3));
+
+  gsk_render_node_unref (color2);
+  gsk_render_node_unref (color3);
+
+  /* Floats are hashed by value */
+  color2 = gsk_color_node_new (&(GdkRGBA){0, 1, 0, 1 }, &GRAPHENE_RECT_INIT (-0.f, -0.f, 10, 10));
+  color3 = gsk_color_node_new (&(GdkRGBA){-0.f, 1, -0.f, 1 }, &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+  g_assert_cmpuint (gsk_render_node_get_hash (color1), ==, gsk_render_node_get_hash (color2));
+  g_assert_cmpuint (gsk_render_node_get_hash (color1), ==, gsk_render_node_get_hash (color3));
+
+  gsk_render_node_unref (color1);
+  gsk_render_node_unref (color2);
+  gsk_render_node_unref (color3);
+  gsk_render_node_unref (container1);
+  gsk_render_node_unref (container2);
+}
+
+#define N_ROWS 20
+
+static GskRenderNode *
+create_row (int i)
+{
+  return gsk_color_node_new (&(GdkRGBA){ 0, 0, 1, 1 }, &GRAPHENE_RECT_INIT (0, i * 10, 10, 10));
+}
+
+static void
+test_diff_insert (void)
+{
+  GskRenderNode *children1[N_ROWS], *children2[N_ROWS + 1];
+  GskRenderNode *container1, *container2;
+  cairo_region_t *region;
+  cairo_rectangle_int_t rect;
+  int i;
+
+  for (i = 0; i < N_ROWS; i++)
+    {
+      children1[i] = create_row (i);
+      children2[i < 5 ? i : i + 1] = create_row (i);
+    }
+  children2[5] = gsk_color_node_new (&(GdkRGBA){ 1, 0, 0, 1 }, &GRAPHENE_RECT_INIT (100, 0, 10, 10));
+
+  container1 = gsk_container_node_new (children1, N_ROWS);
+  container2 = gsk_container_node_new (children2, N_ROWS + 1);
+
+  /* Only the inserted node is damaged, not the ones after it */
+  region = cairo_region_create ();
+  gsk_render_node_diff (container1, container2, region);
+
+  g_assert_cmpint (cairo_region_num_rectangles (region), ==, 1);
+  cairo_region_get_rectangle (region, 0, &rect);
+  g_assert_cmpint (rect.x, ==, 100);
+  g_assert_cmpint (rect.y, ==, 0);
+  g_assert_cmpint (rect.width, ==, 10);
+  g_assert_cmpint (rect.height, ==, 10);
+
+  cairo_region_destroy (region);
+
+  for (i = 0; i < N_ROWS; i++)
+    gsk_render_node_unref (children1[i]);
+  for (i = 0; i < N_ROWS + 1; i++)
+    gsk_render_node_unref (children2[i]);
+  gsk_render_node_unref (container1);
+  gsk_render_node_unref (container2);
+}
+
+static void
+test_diff_reorder (void)
+{
+  GskRenderNode *children1[N_ROWS], *children2[N_ROWS];
+  GskRenderNode *container1, *container2;
+  cairo_region_t *region;
+  cairo_rectangle_int_t rect;
+  int i;
+
+  /* Move the last row to the front, drawing order changes but nothing else */
+  for (i = 0; i < N_ROWS; i++)
+    {
+      children1[i] = create_row (i);
+      children2[(i + 1) % N_ROWS] = create_row (i);
+    }
+
+  container1 = gsk_container_node_new (children1, N_ROWS);
+  container2 = gsk_container_node_new (children2, N_ROWS);
+
+  region = cairo_region_create ();
+  gsk_render_node_diff (container1, container2, region);
+
+  g_assert_cmpint (cairo_region_num_rectangles (region), ==, 1);
+  cairo_region_get_rectangle (region, 0, &rect);
+  g_assert_cmpint (rect.x, ==, 0);
+  g_assert_cmpint (rect.y, ==, (N_ROWS - 1) * 10);
+  g_assert_cmpint (rect.width, ==, 10);
+  g_assert_cmpint (rect.height, ==, 10);
+
+  cairo_region_destroy (region);
+
+  for (i = 0; i < N_ROWS; i++)
+    {
+      gsk_render_node_unref (children1[i]);
+      gsk_render_node_unref (children2[i]);
+    }
+  gsk_render_node_unref (container1);
+  gsk_render_node_unref (container2);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -103,6 +225,9 @@ main (int   argc,
 
   g_test_add_func ("/node/can-diff/basic", test_can_diff_basic);
   g_test_add_func ("/node/can-diff/transform", test_can_diff_transform);
+  g_test_add_func ("/node/diff/hash", test_hash);
+  g_test_add_func ("/node/diff/insert", test_diff_insert);
+  g_test_add_func ("/node/diff/reorder", test_diff_reorder);
 
   return g_test_run ();
 }
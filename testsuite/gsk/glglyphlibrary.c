@@ -0,0 +1,106 @@
+#include <gtk/gtk.h>
+#include <pango/pangocairo.h>
+
+#include "gsk/gl/gskgldriverprivate.h"
+#include "gsk/gl/gskglglyphlibraryprivate.h"
+
+static void
+test_prewarm (void)
+{
+  GdkDisplay *display;
+  GdkGLContext *context;
+  GskGLDriver *driver;
+  GskGLGlyphLibrary *library;
+  PangoFontMap *fontmap;
+  PangoContext *pango_context;
+  PangoFontDescription *desc;
+  PangoFont *font;
+  PangoGlyphString *glyphs;
+  PangoAnalysis analysis = { 0, };
+  const GskGLGlyphValue *value;
+  GskGLGlyphKey key;
+  guint n_pending, n_hits, n_misses;
+  GError *error = NULL;
+
+  display = gdk_display_get_default ();
+  if (!gdk_display_prepare_gl (display, &error))
+    {
+      g_test_skip_printf ("no GL support: %s", error->message);
+      g_clear_error (&error);
+      return;
+    }
+
+  driver = gsk_gl_driver_for_display (display, FALSE, &error);
+  g_assert_no_error (error);
+
+  context = gdk_display_get_gl_context (display);
+  gdk_gl_context_make_current (context);
+
+  library = driver->glyphs_library;
+  if (library->pool == NULL)
+    {
+      g_test_skip ("glyphs are not rasterized on worker threads");
+      g_object_unref (driver);
+      return;
+    }
+
+  fontmap = pango_cairo_font_map_new ();
+  pango_context = pango_font_map_create_context (fontmap);
+  desc = pango_font_description_from_string ("Sans 11");
+  font = pango_font_map_load_font (fontmap, pango_context, desc);
+  g_assert_nonnull (font);
+
+  n_pending = library->pending->len;
+  n_misses = library->n_misses;
+  gsk_gl_glyph_library_prewarm (library, font, 1);
+  g_assert_cmpuint (library->pending->len, >, n_pending);
+  /* Prewarming is not a miss */
+  g_assert_cmpuint (library->n_misses, ==, n_misses);
+
+  /* A second time does nothing */
+  n_pending = library->pending->len;
+  gsk_gl_glyph_library_prewarm (library, font, 1);
+  g_assert_cmpuint (library->pending->len, ==, n_pending);
+
+  /* Text using the font finds its glyphs without rasterizing */
+  analysis.font = font;
+  glyphs = pango_glyph_string_new ();
+  pango_shape ("Hello", -1, &analysis, glyphs);
+  g_assert_cmpint (glyphs->num_glyphs, ==, 5);
+
+  n_hits = library->n_hits;
+  n_misses = library->n_misses;
+
+  memset (&key, 0, sizeof key);
+  key.font = font;
+  key.scale = 1024;
+  for (int i = 0; i < glyphs->num_glyphs; i++)
+    {
+      key.glyph = glyphs->glyphs[i].glyph;
+      key.xshift = i % 4;
+      gsk_gl_glyph_library_lookup_or_add (library, &key, &value);
+    }
+
+  g_assert_cmpuint (library->n_hits - n_hits, ==, glyphs->num_glyphs);
+  g_assert_cmpuint (library->n_misses, ==, n_misses);
+
+  gsk_gl_glyph_library_upload_pending (library);
+  g_assert_cmpuint (library->pending->len, ==, 0);
+
+  pango_glyph_string_free (glyphs);
+  g_object_unref (font);
+  pango_font_description_free (desc);
+  g_object_unref (pango_context);
+  g_object_unref (fontmap);
+  g_object_unref (driver);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/gl/glyph-library/prewarm", test_prewarm);
+
+  return g_test_run ();
+}
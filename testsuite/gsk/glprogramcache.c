@@ -0,0 +1,193 @@
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+
+#include "gsk/gl/gskglcompilerprivate.h"
+#include "gsk/gl/gskgldriverprivate.h"
+#include "gsk/gl/gskglprogramcacheprivate.h"
+#include "gsk/gl/gskglprogramprivate.h"
+
+#include <epoxy/gl.h>
+
+/* Compiles the color program the same way the driver does, so
+ * it has the same key as the one the driver put into the cache.
+ */
+static GskGLProgram *
+compile_color_program (GskGLDriver *driver)
+{
+  GskGLCompiler *compiler;
+  GskGLProgram *program;
+  GError *error = NULL;
+
+  compiler = gsk_gl_compiler_new (driver, FALSE);
+
+  gsk_gl_compiler_set_preamble_from_resource (compiler,
+                                              GSK_GL_COMPILER_ALL,
+                                              "/org/gtk/libgsk/gl/preamble.glsl");
+  gsk_gl_compiler_set_preamble_from_resource (compiler,
+                                              GSK_GL_COMPILER_VERTEX,
+                                              "/org/gtk/libgsk/gl/preamble.vs.glsl");
+  gsk_gl_compiler_set_preamble_from_resource (compiler,
+                                              GSK_GL_COMPILER_FRAGMENT,
+                                              "/org/gtk/libgsk/gl/preamble.fs.glsl");
+
+  gsk_gl_compiler_bind_attribute (compiler, "aPosition", 0);
+  gsk_gl_compiler_bind_attribute (compiler, "aUv", 1);
+  gsk_gl_compiler_bind_attribute (compiler, "aColor", 2);
+  gsk_gl_compiler_bind_attribute (compiler, "aColor2", 3);
+
+  gsk_gl_compiler_set_source_from_resource (compiler,
+                                            GSK_GL_COMPILER_ALL,
+                                            "/org/gtk/libgsk/gl/color.glsl");
+
+  program = gsk_gl_compiler_compile (compiler, "color", "", &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (program);
+
+  g_object_unref (compiler);
+
+  return program;
+}
+
+static void
+assert_programs_equal (int program1,
+                       int program2)
+{
+  int status, n1, n2;
+  int i;
+
+  glGetProgramiv (program1, GL_LINK_STATUS, &status);
+  g_assert_true (status);
+  glGetProgramiv (program2, GL_LINK_STATUS, &status);
+  g_assert_true (status);
+
+  glGetProgramiv (program1, GL_ACTIVE_ATTRIBUTES, &n1);
+  glGetProgramiv (program2, GL_ACTIVE_ATTRIBUTES, &n2);
+  g_assert_cmpint (n1, ==, n2);
+
+  for (i = 0; i < n1; i++)
+    {
+      char name[256];
+      GLenum type;
+      int size;
+
+      glGetActiveAttrib (program1, i, sizeof (name), NULL, &size, &type, name);
+      g_assert_cmpint (glGetAttribLocation (program1, name), ==, glGetAttribLocation (program2, name));
+    }
+
+  glGetProgramiv (program1, GL_ACTIVE_UNIFORMS, &n1);
+  glGetProgramiv (program2, GL_ACTIVE_UNIFORMS, &n2);
+  g_assert_cmpint (n1, ==, n2);
+
+  for (i = 0; i < n1; i++)
+    {
+      char name[256];
+      GLenum type;
+      int size;
+
+      glGetActiveUniform (program1, i, sizeof (name), NULL, &size, &type, name);
+      g_assert_cmpint (glGetUniformLocation (program2, name), >=, 0);
+      g_assert_cmpint (glGetUniformLocation (program1, name), ==, glGetUniformLocation (program2, name));
+    }
+}
+
+static void
+test_cached_program (void)
+{
+  GdkDisplay *display;
+  GdkGLContext *context;
+  GskGLDriver *driver;
+  GskGLProgramCache *cache;
+  GskGLProgram *compiled, *cached;
+  GError *error = NULL;
+
+  display = gdk_display_get_default ();
+  if (!gdk_display_prepare_gl (display, &error))
+    {
+      g_test_skip_printf ("no GL support: %s", error->message);
+      g_clear_error (&error);
+      return;
+    }
+
+  driver = gsk_gl_driver_for_display (display, FALSE, &error);
+  g_assert_no_error (error);
+
+  context = gdk_display_get_gl_context (display);
+  gdk_gl_context_make_current (context);
+
+  if (driver->program_cache == NULL)
+    {
+      g_test_skip ("GL program binaries not supported");
+      g_object_unref (driver);
+      return;
+    }
+
+  /* Compile from source */
+  cache = g_steal_pointer (&driver->program_cache);
+  compiled = compile_color_program (driver);
+
+  /* The driver added all its programs when it was created, so
+   * this writes the color program to disk, and reading it back
+   * into a new cache gives us the binary path */
+  g_assert_true (gsk_gl_program_cache_save (cache));
+  driver->program_cache = gsk_gl_program_cache_new (context);
+  g_assert_nonnull (driver->program_cache);
+
+  cached = compile_color_program (driver);
+  /* a program that had to be compiled would have been added */
+  g_assert_false (gsk_gl_program_cache_is_dirty (driver->program_cache));
+
+  assert_programs_equal (compiled->id, cached->id);
+
+  gsk_gl_program_cache_free (driver->program_cache);
+  driver->program_cache = cache;
+
+  g_object_unref (cached);
+  g_object_unref (compiled);
+  g_object_unref (driver);
+}
+
+static void
+remove_cache_dir (const char *path)
+{
+  const char *name;
+  GDir *dir;
+
+  dir = g_dir_open (path, 0, NULL);
+  if (dir == NULL)
+    {
+      g_remove (path);
+      return;
+    }
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      char *child = g_build_filename (path, name, NULL);
+      remove_cache_dir (child);
+      g_free (child);
+    }
+  g_dir_close (dir);
+
+  g_rmdir (path);
+}
+
+int
+main (int argc, char *argv[])
+{
+  char *cache_dir;
+  int result;
+
+  /* Start with an empty cache and don't touch the user's */
+  cache_dir = g_dir_make_tmp ("gsk-program-cache-XXXXXX", NULL);
+  g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/gl/program-cache/cached-program", test_cached_program);
+
+  result = g_test_run ();
+
+  remove_cache_dir (cache_dir);
+  g_free (cache_dir);
+
+  return result;
+}
@@ -156,6 +156,53 @@ deserialize_error_func (const GskParseLocation *start,
   g_string_append_c (errors, '\n');
 }
 
+/* Checks that saving @node in the binary format and loading it again
+ * produces the same text as @expected.
+ */
+static gboolean
+test_binary_roundtrip (GskRenderNode *node,
+                       GBytes        *expected)
+{
+  GskRenderNode *copy;
+  GBytes *binary, *text;
+  GString *errors;
+  gboolean result = TRUE;
+
+  errors = g_string_new ("");
+
+  binary = gsk_render_node_serialize_binary (node);
+  copy = gsk_render_node_deserialize (binary, deserialize_error_func, errors);
+  g_bytes_unref (binary);
+
+  if (errors->str[0])
+    {
+      g_print ("Unexpected errors loading binary format:\n%s\n", errors->str);
+      result = FALSE;
+    }
+
+  if (copy == NULL)
+    {
+      g_print ("Failed to load binary format\n");
+      result = FALSE;
+    }
+  else
+    {
+      text = gsk_render_node_serialize (copy);
+      if (!g_bytes_equal (text, expected))
+        {
+          g_print ("Binary format doesn't round-trip:\n%s\n",
+                   (const char *) g_bytes_get_data (text, NULL));
+          result = FALSE;
+        }
+      g_bytes_unref (text);
+      gsk_render_node_unref (copy);
+    }
+
+  g_string_free (errors, TRUE);
+
+  return result;
+}
+
 static gboolean
 parse_node_file (GFile *file, gboolean generate)
 {
@@ -180,16 +227,19 @@ parse_node_file (GFile *file, gboolean generate)
   node = gsk_render_node_deserialize (bytes, deserialize_error_func, errors);
   g_bytes_unref (bytes);
   bytes = gsk_render_node_serialize (node);
-  gsk_render_node_unref (node);
 
   if (generate)
     {
       g_print ("%s", (char *) g_bytes_get_data (bytes, NULL));
+      gsk_render_node_unref (node);
       g_bytes_unref (bytes);
       g_string_free (errors, TRUE);
       return TRUE;
     }
 
+  result &= test_binary_roundtrip (node, bytes);
+  gsk_render_node_unref (node);
+
   node_file = g_file_get_path (file);
   reference_file = test_get_reference_file (node_file);
 
@@ -33,6 +33,292 @@ test_section_load_nonexisting_file (void)
   g_object_unref (provider);
 }
 
+static gboolean
+label_is_red (GtkWidget *label)
+{
+  GdkRGBA color;
+
+  gtk_widget_get_color (label, &color);
+
+  return color.red == 1.0 && color.blue == 0.0;
+}
+
+/* Rows and their subtrees share styles when they are alike, so check
+ * that styles depending on the position of an ancestor come out right.
+ */
+static void
+test_style_sharing (void)
+{
+  GtkCssProvider *provider;
+  GtkWidget *window, *box, *row, *inner, *label;
+  GtkWidget *labels[8];
+  guint i;
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_string (provider,
+                                     "label { color: rgb(0,0,255); }\n"
+                                     ".row:nth-child(even) > label { color: rgb(255,0,0); }\n"
+                                     ".row:nth-child(3n) box label { color: rgb(255,0,0); }\n"
+                                     ".row.special label { color: rgb(255,0,0); }\n");
+  gtk_style_context_add_provider_for_display (gdk_display_get_default (),
+                                              GTK_STYLE_PROVIDER (provider),
+                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+
+  window = gtk_window_new ();
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  gtk_window_set_child (GTK_WINDOW (window), box);
+
+  for (i = 0; i < G_N_ELEMENTS (labels); i++)
+    {
+      row = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+      gtk_widget_add_css_class (row, "row");
+      gtk_box_append (GTK_BOX (box), row);
+
+      label = gtk_label_new ("direct");
+      gtk_box_append (GTK_BOX (row), label);
+
+      inner = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+      gtk_box_append (GTK_BOX (row), inner);
+      labels[i] = gtk_label_new ("nested");
+      gtk_box_append (GTK_BOX (inner), labels[i]);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (labels); i++)
+    {
+      row = gtk_widget_get_parent (gtk_widget_get_parent (labels[i]));
+      g_assert_true (label_is_red (gtk_widget_get_first_child (row)) == ((i + 1) % 2 == 0));
+      g_assert_true (label_is_red (labels[i]) == ((i + 1) % 3 == 0));
+    }
+
+  /* Changing one row must not leak into the rows sharing its styles */
+  row = gtk_widget_get_parent (gtk_widget_get_parent (labels[0]));
+  gtk_widget_add_css_class (row, "special");
+  for (i = 0; i < G_N_ELEMENTS (labels); i++)
+    g_assert_true (label_is_red (labels[i]) == (i == 0 || (i + 1) % 3 == 0));
+
+  /* Moving all rows by one position */
+  gtk_box_remove (GTK_BOX (box), row);
+  for (i = 1; i < G_N_ELEMENTS (labels); i++)
+    g_assert_true (label_is_red (labels[i]) == (i % 3 == 0));
+
+  gtk_window_destroy (GTK_WINDOW (window));
+
+  gtk_style_context_remove_provider_for_display (gdk_display_get_default (),
+                                                 GTK_STYLE_PROVIDER (provider));
+  g_object_unref (provider);
+}
+
+/* Reloading incrementally only restyles widgets affected by changed
+ * rules, so check they all come out right.
+ */
+static void
+test_incremental_reload (void)
+{
+  GtkCssProvider *provider;
+  GtkWidget *window, *box, *a, *b, *plain;
+
+  provider = gtk_css_provider_new ();
+  g_assert_false (gtk_css_provider_get_incremental_reload (provider));
+  gtk_css_provider_set_incremental_reload (provider, TRUE);
+  g_assert_true (gtk_css_provider_get_incremental_reload (provider));
+
+  gtk_css_provider_load_from_string (provider,
+                                     "label { color: rgb(0,0,255); }\n"
+                                     ".a { color: rgb(255,0,0); }\n");
+  gtk_style_context_add_provider_for_display (gdk_display_get_default (),
+                                              GTK_STYLE_PROVIDER (provider),
+                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+
+  window = gtk_window_new ();
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  gtk_window_set_child (GTK_WINDOW (window), box);
+  a = gtk_label_new ("a");
+  gtk_widget_add_css_class (a, "a");
+  gtk_box_append (GTK_BOX (box), a);
+  b = gtk_label_new ("b");
+  gtk_widget_add_css_class (b, "b");
+  gtk_box_append (GTK_BOX (box), b);
+  plain = gtk_label_new ("plain");
+  gtk_box_append (GTK_BOX (box), plain);
+
+  g_assert_true (label_is_red (a));
+  g_assert_false (label_is_red (b));
+  g_assert_false (label_is_red (plain));
+
+  /* Modify one rule and add another */
+  gtk_css_provider_load_from_string (provider,
+                                     "label { color: rgb(0,0,255); }\n"
+                                     ".a { color: rgb(0,255,0); }\n"
+                                     ".b { color: rgb(255,0,0); }\n");
+  g_assert_false (label_is_red (a));
+  g_assert_true (label_is_red (b));
+  g_assert_false (label_is_red (plain));
+
+  /* Unchanged */
+  gtk_css_provider_load_from_string (provider,
+                                     "label { color: rgb(0,0,255); }\n"
+                                     ".a { color: rgb(0,255,0); }\n"
+                                     ".b { color: rgb(255,0,0); }\n");
+  g_assert_false (label_is_red (a));
+  g_assert_true (label_is_red (b));
+
+  /* Rules for states the widgets are not in yet */
+  gtk_css_provider_load_from_string (provider,
+                                     "label { color: rgb(0,0,255); }\n"
+                                     "box > label:disabled { color: rgb(255,0,0); }\n");
+  g_assert_false (label_is_red (b));
+  gtk_widget_set_sensitive (plain, FALSE);
+  g_assert_true (label_is_red (plain));
+  g_assert_false (label_is_red (a));
+
+  /* Changing colors restyles everything */
+  gtk_css_provider_load_from_string (provider,
+                                     "@define-color c rgb(255,0,0);\n"
+                                     "label { color: @c; }\n");
+  g_assert_true (label_is_red (a));
+  gtk_css_provider_load_from_string (provider,
+                                     "@define-color c rgb(0,0,255);\n"
+                                     "label { color: @c; }\n");
+  g_assert_false (label_is_red (a));
+  g_assert_false (label_is_red (plain));
+
+  gtk_window_destroy (GTK_WINDOW (window));
+
+  gtk_style_context_remove_provider_for_display (gdk_display_get_default (),
+                                                 GTK_STYLE_PROVIDER (provider));
+  g_object_unref (provider);
+}
+
+static void
+load_nested (GtkStyleProvider *provider,
+             gpointer          rules,
+             GtkCssProvider   *other)
+{
+  g_signal_handlers_disconnect_by_func (provider, load_nested, other);
+
+  gtk_css_provider_load_from_string (other, "label { color: rgb(255,0,0); }");
+}
+
+/* A full change of another provider while the changed rules of an
+ * incremental reload are handled still restyles everything.
+ */
+static void
+test_incremental_reload_nested (void)
+{
+  GtkCssProvider *provider, *other;
+  GtkWidget *window, *box, *a, *plain;
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_set_incremental_reload (provider, TRUE);
+  gtk_css_provider_load_from_string (provider, ".a { color: rgb(0,0,255); }");
+  gtk_style_context_add_provider_for_display (gdk_display_get_default (),
+                                              GTK_STYLE_PROVIDER (provider),
+                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+  other = gtk_css_provider_new ();
+  gtk_style_context_add_provider_for_display (gdk_display_get_default (),
+                                              GTK_STYLE_PROVIDER (other),
+                                              GTK_STYLE_PROVIDER_PRIORITY_USER);
+
+  window = gtk_window_new ();
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  gtk_window_set_child (GTK_WINDOW (window), box);
+  a = gtk_label_new ("a");
+  gtk_widget_add_css_class (a, "a");
+  gtk_box_append (GTK_BOX (box), a);
+  plain = gtk_label_new ("plain");
+  gtk_box_append (GTK_BOX (box), plain);
+
+  g_assert_false (label_is_red (a));
+  g_assert_false (label_is_red (plain));
+
+  g_signal_connect (provider, "gtk-private-changed", G_CALLBACK (load_nested), other);
+  gtk_css_provider_load_from_string (provider, ".a { color: rgb(0,255,0); }");
+
+  g_assert_true (label_is_red (a));
+  g_assert_true (label_is_red (plain));
+
+  gtk_window_destroy (GTK_WINDOW (window));
+
+  gtk_style_context_remove_provider_for_display (gdk_display_get_default (),
+                                                 GTK_STYLE_PROVIDER (other));
+  gtk_style_context_remove_provider_for_display (gdk_display_get_default (),
+                                                 GTK_STYLE_PROVIDER (provider));
+  g_object_unref (other);
+  g_object_unref (provider);
+}
+
+static void
+count_draws (GtkDrawingArea *area,
+             cairo_t        *cr,
+             int             width,
+             int             height,
+             gpointer        data)
+{
+  guint *n_draws = data;
+
+  (*n_draws)++;
+}
+
+static void
+wait_for_frames (GtkWidget *widget)
+{
+  /* The tick callback runs before the frame is painted */
+  gtk_test_widget_wait_for_draw (widget);
+  gtk_test_widget_wait_for_draw (widget);
+}
+
+/* Changing only opacity, filter or transform does not redraw the widget */
+static void
+test_effects_no_redraw (void)
+{
+  GtkCssProvider *provider;
+  GtkWidget *window, *area;
+  guint n_draws = 0, n;
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_string (provider,
+                                     ".faded { opacity: 0.5; filter: blur(2px); }\n"
+                                     ".moved { transform: translate(10px, 5px) rotate(10deg); }\n"
+                                     ".red { background-color: red; }\n");
+  gtk_style_context_add_provider_for_display (gdk_display_get_default (),
+                                              GTK_STYLE_PROVIDER (provider),
+                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+
+  window = gtk_window_new ();
+  area = gtk_drawing_area_new ();
+  gtk_drawing_area_set_content_width (GTK_DRAWING_AREA (area), 50);
+  gtk_drawing_area_set_content_height (GTK_DRAWING_AREA (area), 50);
+  gtk_drawing_area_set_draw_func (GTK_DRAWING_AREA (area), count_draws, &n_draws, NULL);
+  gtk_window_set_child (GTK_WINDOW (window), area);
+  gtk_window_present (GTK_WINDOW (window));
+
+  wait_for_frames (area);
+  n = n_draws;
+  g_assert_cmpuint (n, >, 0);
+
+  gtk_widget_add_css_class (area, "faded");
+  wait_for_frames (area);
+  g_assert_cmpuint (n_draws, ==, n);
+
+  gtk_widget_add_css_class (area, "moved");
+  wait_for_frames (area);
+  g_assert_cmpuint (n_draws, ==, n);
+
+  gtk_widget_set_opacity (area, 0.7);
+  wait_for_frames (area);
+  g_assert_cmpuint (n_draws, ==, n);
+
+  gtk_widget_add_css_class (area, "red");
+  wait_for_frames (area);
+  g_assert_cmpuint (n_draws, >, n);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+
+  gtk_style_context_remove_provider_for_display (gdk_display_get_default (),
+                                                 GTK_STYLE_PROVIDER (provider));
+  g_object_unref (provider);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -41,6 +327,10 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/cssprovider/section-in-load-from-data", test_section_in_load_from_data);
   g_test_add_func ("/cssprovider/load-nonexisting-file", test_section_load_nonexisting_file);
+  g_test_add_func ("/cssprovider/style-sharing", test_style_sharing);
+  g_test_add_func ("/cssprovider/effects-no-redraw", test_effects_no_redraw);
+  g_test_add_func ("/cssprovider/incremental-reload", test_incremental_reload);
+  g_test_add_func ("/cssprovider/incremental-reload-nested", test_incremental_reload_nested);
 
   return g_test_run ();
 }
@@ -0,0 +1,410 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+
+/* Loads a big directory and then creates and deletes lots of files
+ * in it, checking that the list ends up matching the directory.
+ *
+ * The directory is created on a tmpfs if possible, so the monitor
+ * sees the changes as quickly as they can be made. Run with -m perf
+ * for a directory with 100000 files.
+ */
+
+#define TIMEOUT 60
+#define SETTLE_TIME (G_USEC_PER_SEC / 5)
+
+typedef struct {
+  guint n_changes;
+  gint64 last_change;
+} ChangeCounter;
+
+static guint
+get_n_files (void)
+{
+  return g_test_perf () ? 100000 : 2000;
+}
+
+static char *
+make_tmp_dir (void)
+{
+  char *path;
+
+  /* tmpfs */
+  path = g_strdup ("/dev/shm/gtk-directorylist-XXXXXX");
+  if (g_mkdtemp (path))
+    return path;
+  g_free (path);
+
+  path = g_dir_make_tmp ("gtk-directorylist-XXXXXX", NULL);
+  g_assert_nonnull (path);
+
+  return path;
+}
+
+static void
+remove_tmp_dir (const char *path)
+{
+  const char *name;
+  GDir *dir;
+
+  dir = g_dir_open (path, 0, NULL);
+  g_assert_nonnull (dir);
+  while ((name = g_dir_read_name (dir)))
+    {
+      char *filename = g_build_filename (path, name, NULL);
+      g_remove (filename);
+      g_free (filename);
+    }
+  g_dir_close (dir);
+
+  g_rmdir (path);
+}
+
+static char *
+get_filename (const char *path,
+              const char *prefix,
+              guint       i)
+{
+  char name[64];
+
+  g_snprintf (name, sizeof (name), "%s%u", prefix, i);
+
+  return g_build_filename (path, name, NULL);
+}
+
+static void
+create_files (const char *path,
+              const char *prefix,
+              guint       n)
+{
+  guint i;
+
+  for (i = 0; i < n; i++)
+    {
+      char *filename = get_filename (path, prefix, i);
+      g_assert_true (g_file_set_contents (filename, "", 0, NULL));
+      g_free (filename);
+    }
+}
+
+static void
+delete_files (const char *path,
+              const char *prefix,
+              guint       first,
+              guint       n)
+{
+  guint i;
+
+  for (i = first; i < first + n; i++)
+    {
+      char *filename = get_filename (path, prefix, i);
+      g_assert_cmpint (g_remove (filename), ==, 0);
+      g_free (filename);
+    }
+}
+
+static void
+count_changes (GListModel    *model,
+               guint          position,
+               guint          removed,
+               guint          added,
+               ChangeCounter *counter)
+{
+  counter->n_changes++;
+  counter->last_change = g_get_monotonic_time ();
+}
+
+/* Checks that every items-changed emission matches the items,
+ * by applying it to a copy of the list */
+static void
+assert_items_changed_correctly (GListModel *model,
+                                guint       position,
+                                guint       removed,
+                                guint       added,
+                                GListModel *compare)
+{
+  guint i, n_items;
+
+  g_assert_cmpuint (g_list_model_get_n_items (model), ==, g_list_model_get_n_items (compare) - removed + added);
+  n_items = g_list_model_get_n_items (model);
+
+  for (i = 0; i < position; i++)
+    {
+      gpointer o1 = g_list_model_get_item (model, i);
+      gpointer o2 = g_list_model_get_item (compare, i);
+      g_assert_true (o1 == o2);
+      g_object_unref (o1);
+      g_object_unref (o2);
+    }
+  for (i = position + added; i < n_items; i++)
+    {
+      gpointer o1 = g_list_model_get_item (model, i);
+      gpointer o2 = g_list_model_get_item (compare, i - added + removed);
+      g_assert_true (o1 == o2);
+      g_object_unref (o1);
+      g_object_unref (o2);
+    }
+
+  g_list_store_splice (G_LIST_STORE (compare), position, removed, NULL, 0);
+  for (i = position; i < position + added; i++)
+    {
+      gpointer item = g_list_model_get_item (model, i);
+      g_list_store_insert (G_LIST_STORE (compare), i, item);
+      g_object_unref (item);
+    }
+}
+
+static void
+check_model_changes (GListModel *model)
+{
+  GListStore *check;
+  guint i;
+
+  check = g_list_store_new (g_list_model_get_item_type (model));
+  for (i = 0; i < g_list_model_get_n_items (model); i++)
+    {
+      gpointer item = g_list_model_get_item (model, i);
+      g_list_store_append (check, item);
+      g_object_unref (item);
+    }
+
+  g_signal_connect_data (model,
+                         "items-changed",
+                         G_CALLBACK (assert_items_changed_correctly),
+                         check,
+                         (GClosureNotify) g_object_unref,
+                         0);
+}
+
+/* Remembers the monitor of the list, to fake events with it */
+static gboolean
+find_monitor (GSignalInvocationHint *ihint,
+              guint                  n_param_values,
+              const GValue          *param_values,
+              gpointer               data)
+{
+  GFileMonitor **monitor = data;
+
+  *monitor = g_value_dup_object (&param_values[0]);
+
+  return FALSE;
+}
+
+static gboolean
+timeout_cb (gpointer data)
+{
+  gboolean *timed_out = data;
+
+  *timed_out = TRUE;
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+wakeup_cb (gpointer data)
+{
+  return G_SOURCE_CONTINUE;
+}
+
+/* Waits until the list has n_items and didn't change for a while */
+static void
+wait_for_items (GtkDirectoryList *list,
+                ChangeCounter    *counter,
+                guint             n_items)
+{
+  gboolean timed_out = FALSE;
+  guint timeout_id, wakeup_id;
+
+  timeout_id = g_timeout_add_seconds (TIMEOUT, timeout_cb, &timed_out);
+  wakeup_id = g_timeout_add (50, wakeup_cb, NULL);
+
+  while (!timed_out &&
+         (gtk_directory_list_is_loading (list) ||
+          g_list_model_get_n_items (G_LIST_MODEL (list)) != n_items ||
+          g_get_monotonic_time () - counter->last_change < SETTLE_TIME))
+    g_main_context_iteration (NULL, TRUE);
+
+  g_source_remove (wakeup_id);
+  if (timed_out)
+    g_test_fail_printf ("Timed out waiting for %u items, got %u",
+                        n_items, g_list_model_get_n_items (G_LIST_MODEL (list)));
+  else
+    g_source_remove (timeout_id);
+}
+
+/* Checks that every file in the directory is in the list once */
+static void
+assert_list_matches_dir (GtkDirectoryList *list,
+                         const char       *path)
+{
+  GHashTable *names;
+  const char *name;
+  GDir *dir;
+  guint i, n_files;
+
+  names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  for (i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (list)); i++)
+    {
+      GFileInfo *info = g_list_model_get_item (G_LIST_MODEL (list), i);
+      GFile *file = G_FILE (g_file_info_get_attribute_object (info, "standard::file"));
+
+      g_assert_true (g_hash_table_add (names, g_file_get_basename (file)));
+      g_object_unref (info);
+    }
+
+  n_files = 0;
+  dir = g_dir_open (path, 0, NULL);
+  g_assert_nonnull (dir);
+  while ((name = g_dir_read_name (dir)))
+    {
+      g_assert_true (g_hash_table_contains (names, name));
+      n_files++;
+    }
+  g_dir_close (dir);
+
+  g_assert_cmpuint (n_files, ==, g_hash_table_size (names));
+
+  g_hash_table_unref (names);
+}
+
+static void
+test_storm (void)
+{
+  GtkDirectoryList *list;
+  ChangeCounter counter = { 0, 0 };
+  GFileMonitor *monitor = NULL;
+  GFileInfo *info;
+  GFile *file, *child;
+  char *path, *filename;
+  guint i, n_files, n_changed, n_events;
+  double load_time, storm_time;
+
+  n_files = get_n_files ();
+  n_changed = n_files / 4;
+  path = make_tmp_dir ();
+  g_test_message ("Using %s", path);
+
+  create_files (path, "file", n_files);
+
+  file = g_file_new_for_path (path);
+  list = gtk_directory_list_new ("standard::name", file);
+  g_signal_connect (list, "items-changed", G_CALLBACK (count_changes), &counter);
+
+  g_test_timer_start ();
+  wait_for_items (list, &counter, n_files);
+  load_time = g_test_timer_elapsed ();
+  assert_list_matches_dir (list, path);
+  check_model_changes (G_LIST_MODEL (list));
+
+  counter.n_changes = 0;
+  g_signal_add_emission_hook (g_signal_lookup ("changed", G_TYPE_FILE_MONITOR), 0,
+                              find_monitor, &monitor, NULL);
+  g_test_timer_start ();
+
+  /* Delete some, add some, and add some that are gone again before
+   * the list gets to query them */
+  delete_files (path, "file", 0, n_changed);
+  create_files (path, "new", n_changed);
+  create_files (path, "temp", n_changed / 10);
+  delete_files (path, "temp", 0, n_changed / 10);
+  n_events = 2 * n_changed + 2 * (n_changed / 10);
+
+  wait_for_items (list, &counter, n_files);
+  storm_time = g_test_timer_elapsed () - SETTLE_TIME / (double) G_USEC_PER_SEC;
+  assert_list_matches_dir (list, path);
+
+  g_test_message ("%u events caused %u items-changed emissions", n_events, counter.n_changes);
+
+  if (g_test_perf ())
+    {
+      g_test_minimized_result (load_time, "loading %u files: %gsec", n_files, load_time);
+      g_test_minimized_result (storm_time, "handling %u events: %gsec", n_events, storm_time);
+    }
+
+  /* Events that are ready at once get coalesced. How the monitor
+   * delivers real events depends on timing, so delete a block of
+   * files and emit their events directly */
+  g_assert_nonnull (monitor);
+  counter.n_changes = 0;
+  for (i = 0; i < n_changed; i++)
+    {
+      /* The list doesn't change before the main loop runs */
+      info = g_list_model_get_item (G_LIST_MODEL (list), n_changed + i);
+      child = G_FILE (g_file_info_get_attribute_object (info, "standard::file"));
+
+      g_assert_true (g_file_delete (child, NULL, NULL));
+      g_signal_emit_by_name (monitor, "changed", child, NULL, G_FILE_MONITOR_EVENT_DELETED);
+      g_object_unref (info);
+    }
+
+  while (g_main_context_iteration (NULL, FALSE));
+
+  g_assert_cmpuint (counter.n_changes, ==, 1);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (list)), ==, n_files - n_changed);
+  n_files -= n_changed;
+
+  /* The real events of the deleted files change nothing */
+  wait_for_items (list, &counter, n_files);
+  assert_list_matches_dir (list, path);
+  g_assert_cmpuint (counter.n_changes, ==, 1);
+
+  /* A change that can't be merged gets emitted before the items
+   * are modified, so the items match every emission. Adding at the
+   * end and then removing near the start does that. */
+  counter.n_changes = 0;
+  filename = get_filename (path, "late", 0);
+  g_assert_true (g_file_set_contents (filename, "", 0, NULL));
+  child = g_file_new_for_path (filename);
+  g_signal_emit_by_name (monitor, "changed", child, NULL, G_FILE_MONITOR_EVENT_CREATED);
+  g_object_unref (child);
+  g_free (filename);
+
+  info = g_list_model_get_item (G_LIST_MODEL (list), 10);
+  child = G_FILE (g_file_info_get_attribute_object (info, "standard::file"));
+  g_assert_true (g_file_delete (child, NULL, NULL));
+  g_signal_emit_by_name (monitor, "changed", child, NULL, G_FILE_MONITOR_EVENT_DELETED);
+  g_object_unref (info);
+
+  while (counter.n_changes < 2)
+    g_main_context_iteration (NULL, TRUE);
+
+  wait_for_items (list, &counter, n_files);
+  assert_list_matches_dir (list, path);
+
+  /* Changing the file reloads without duplicates */
+  gtk_directory_list_set_file (list, NULL);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (list)), ==, 0);
+  gtk_directory_list_set_file (list, file);
+  wait_for_items (list, &counter, n_files);
+  assert_list_matches_dir (list, path);
+
+  g_object_unref (list);
+  g_object_unref (monitor);
+  g_object_unref (file);
+  remove_tmp_dir (path);
+  g_free (path);
+}
+
+int
+main (int argc, char *argv[])
+{
+  (g_test_init) (&argc, &argv, NULL);
+
+  g_test_add_func ("/directorylist/storm", test_storm);
+
+  return g_test_run ();
+}
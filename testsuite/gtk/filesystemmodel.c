@@ -0,0 +1,226 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+
+#include "gtk/gtkfilesystemmodelprivate.h"
+
+/* Enough files to be filtered in several chunks on multiple threads */
+#define N_FILES 3000
+
+#define ATTRIBUTES "standard::name,standard::display-name,standard::type,standard::is-hidden,standard::is-backup"
+
+static char *
+make_tmp_dir (void)
+{
+  char *path;
+
+  path = g_dir_make_tmp ("gtk-filesystemmodel-XXXXXX", NULL);
+  g_assert_nonnull (path);
+
+  return path;
+}
+
+static void
+remove_tmp_dir (const char *path)
+{
+  const char *name;
+  GDir *dir;
+
+  dir = g_dir_open (path, 0, NULL);
+  g_assert_nonnull (dir);
+  while ((name = g_dir_read_name (dir)))
+    {
+      char *filename = g_build_filename (path, name, NULL);
+      g_remove (filename);
+      g_free (filename);
+    }
+  g_dir_close (dir);
+
+  g_rmdir (path);
+}
+
+static void
+create_file (const char *path,
+             const char *name)
+{
+  char *filename = g_build_filename (path, name, NULL);
+
+  g_assert_true (g_file_set_contents (filename, "", 0, NULL));
+  g_free (filename);
+}
+
+static GtkFileFilter *
+filter_new_for_suffix (const char *suffix)
+{
+  GtkFileFilter *filter;
+
+  filter = gtk_file_filter_new ();
+  gtk_file_filter_add_suffix (filter, suffix);
+
+  return filter;
+}
+
+static void
+set_true (GtkFileSystemModel *model,
+          GError             *error,
+          gboolean           *done)
+{
+  *done = TRUE;
+}
+
+static void
+count_changes (GListModel *model,
+               guint       position,
+               guint       removed,
+               guint       added,
+               guint      *n_changes)
+{
+  (*n_changes)++;
+}
+
+/* Checks the flags the model computed against matching every
+ * file one at a time on this thread, and returns the number of
+ * visible files */
+static guint
+assert_matches_single_threaded (GtkFileSystemModel *model,
+                                GtkFileFilter      *filter)
+{
+  guint i, n_visible;
+
+  n_visible = 0;
+  for (i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (model)); i++)
+    {
+      GFileInfo *info = g_list_model_get_item (G_LIST_MODEL (model), i);
+      gboolean filtered_out, visible;
+
+      filtered_out = !gtk_filter_match (GTK_FILTER (filter), info);
+      visible = !g_file_info_get_is_hidden (info) && !filtered_out;
+
+      g_assert_cmpint (g_file_info_get_attribute_boolean (info, "filechooser::filtered-out"), ==, filtered_out);
+      g_assert_cmpint (g_file_info_get_attribute_boolean (info, "filechooser::visible"), ==, visible);
+
+      if (visible)
+        n_visible++;
+
+      g_object_unref (info);
+    }
+
+  return n_visible;
+}
+
+static void
+test_parallel_filter (void)
+{
+  GtkFileSystemModel *model;
+  GtkFileFilter *txt, *png;
+  char *path, *extra_path;
+  GFile *dir, *extra;
+  GList *files;
+  gboolean done;
+  guint i, n_changes;
+
+  if (g_get_num_processors () < 2)
+    {
+      g_test_skip ("Filtering only uses threads with multiple processors");
+      return;
+    }
+
+  path = make_tmp_dir ();
+  for (i = 0; i < N_FILES; i++)
+    {
+      char name[64];
+
+      switch (i % 4)
+        {
+        case 0:
+          g_snprintf (name, sizeof (name), "file%u.txt", i);
+          break;
+        case 1:
+          g_snprintf (name, sizeof (name), "file%u.png", i);
+          break;
+        case 2:
+          g_snprintf (name, sizeof (name), ".hidden%u.txt", i);
+          break;
+        default:
+          g_snprintf (name, sizeof (name), "file%u.TXT", i);
+          break;
+        }
+      create_file (path, name);
+    }
+
+  txt = filter_new_for_suffix ("txt");
+  png = filter_new_for_suffix ("png");
+
+  /* All files get added while the model is frozen for loading, and
+   * are filtered at once when it thaws */
+  dir = g_file_new_for_path (path);
+  model = _gtk_file_system_model_new_for_directory (dir, ATTRIBUTES);
+  _gtk_file_system_model_set_filter (model, txt);
+  done = FALSE;
+  g_signal_connect (model, "finished-loading", G_CALLBACK (set_true), &done);
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, N_FILES);
+  g_assert_cmpuint (assert_matches_single_threaded (model, txt), ==, N_FILES / 2);
+
+  /* Keep the model frozen until the query for another file is done.
+   * That file is not in the directory, so the monitor doesn't see it */
+  extra_path = make_tmp_dir ();
+  create_file (extra_path, "extra.png");
+  extra = g_file_new_build_filename (extra_path, "extra.png", NULL);
+  files = g_list_prepend (NULL, extra);
+  _gtk_file_system_model_add_and_query_files (model, files, ATTRIBUTES);
+  g_list_free (files);
+
+  /* Refiltering waits for the thaw */
+  n_changes = 0;
+  g_signal_connect (model, "items-changed", G_CALLBACK (count_changes), &n_changes);
+  _gtk_file_system_model_set_filter (model, png);
+  g_assert_cmpuint (n_changes, ==, 0);
+  g_assert_cmpuint (assert_matches_single_threaded (model, txt), ==, N_FILES / 2);
+
+  while (n_changes == 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, N_FILES + 1);
+  g_assert_cmpuint (assert_matches_single_threaded (model, png), ==, N_FILES / 4 + 1);
+
+  /* Not frozen anymore, so this refilters right away */
+  _gtk_file_system_model_set_filter (model, txt);
+  g_assert_cmpuint (assert_matches_single_threaded (model, txt), ==, N_FILES / 2);
+
+  g_object_unref (model);
+  g_object_unref (txt);
+  g_object_unref (png);
+  g_object_unref (extra);
+  g_object_unref (dir);
+  remove_tmp_dir (extra_path);
+  remove_tmp_dir (path);
+  g_free (extra_path);
+  g_free (path);
+}
+
+int
+main (int argc, char *argv[])
+{
+  (g_test_init) (&argc, &argv, NULL);
+
+  g_test_add_func ("/filesystemmodel/parallel-filter", test_parallel_filter);
+
+  return g_test_run ();
+}
@@ -324,6 +324,96 @@ test_string_properties (void)
   g_object_unref (filter);
 }
 
+static void
+test_string_index (void)
+{
+  GtkFilterListModel *model;
+  GtkFilter *filter;
+  GListModel *store;
+  GObject *item;
+
+  filter = GTK_FILTER (gtk_string_filter_new (
+               gtk_cclosure_expression_new (G_TYPE_STRING,
+                                            NULL,
+                                            0, NULL,
+                                            G_CALLBACK (get_spelled_out),
+                                            NULL, NULL)));
+  gtk_string_filter_set_use_index (GTK_STRING_FILTER (filter), TRUE);
+  g_assert_true (gtk_string_filter_get_use_index (GTK_STRING_FILTER (filter)));
+
+  model = new_model (1000, filter);
+  store = gtk_filter_list_model_get_model (model);
+
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "thirte");
+  assert_model (model, "13 113 213 313 413 513 613 713 813 913");
+
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "hundred thirteen");
+  assert_model (model, "113 213 313 413 513 613 713 813 913");
+
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "xyz");
+  assert_model (model, "");
+
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "Nine hundred thirteen");
+  gtk_string_filter_set_match_mode (GTK_STRING_FILTER (filter), GTK_STRING_FILTER_MATCH_MODE_EXACT);
+  assert_model (model, "913");
+
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "thirteen");
+  gtk_string_filter_set_match_mode (GTK_STRING_FILTER (filter), GTK_STRING_FILTER_MATCH_MODE_PREFIX);
+  assert_model (model, "13");
+
+  /* appended items are found, too */
+  gtk_string_filter_set_match_mode (GTK_STRING_FILTER (filter), GTK_STRING_FILTER_MATCH_MODE_SUBSTRING);
+  add (G_LIST_STORE (store), 1013);
+  assert_model (model, "13 113 213 313 413 513 613 713 813 913 1013");
+
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "thousand thirteen");
+  assert_model (model, "1013");
+
+  /* cached strings get updated when the filter is told about changes */
+  item = g_list_model_get_item (store, 999);
+  g_object_set_qdata (item, number_quark, GUINT_TO_POINTER (2013));
+  g_object_unref (item);
+  gtk_filter_changed (filter, GTK_FILTER_CHANGE_DIFFERENT);
+  assert_model (model, "2013 1013");
+
+  g_object_unref (model);
+  g_object_unref (filter);
+}
+
+/* Without an index, the strings are not cached */
+static void
+test_string_no_index (void)
+{
+  GtkFilterListModel *model;
+  GtkFilter *filter;
+  GListModel *store;
+  GObject *item;
+
+  filter = GTK_FILTER (gtk_string_filter_new (
+               gtk_cclosure_expression_new (G_TYPE_STRING,
+                                            NULL,
+                                            0, NULL,
+                                            G_CALLBACK (get_spelled_out),
+                                            NULL, NULL)));
+  g_assert_false (gtk_string_filter_get_use_index (GTK_STRING_FILTER (filter)));
+
+  model = new_model (1000, filter);
+  store = gtk_filter_list_model_get_model (model);
+
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "thirte");
+  assert_model (model, "13 113 213 313 413 513 613 713 813 913");
+
+  /* a changed item is picked up by the next search */
+  item = g_list_model_get_item (store, 999);
+  g_object_set_qdata (item, number_quark, GUINT_TO_POINTER (2013));
+  g_object_unref (item);
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "thousand thirteen");
+  assert_model (model, "2013");
+
+  g_object_unref (model);
+  g_object_unref (filter);
+}
+
 static void
 test_bool_simple (void)
 {
@@ -405,6 +495,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/filter/any/simple", test_any_simple);
   g_test_add_func ("/filter/string/simple", test_string_simple);
   g_test_add_func ("/filter/string/properties", test_string_properties);
+  g_test_add_func ("/filter/string/index", test_string_index);
+  g_test_add_func ("/filter/string/no-index", test_string_no_index);
   g_test_add_func ("/filter/bool/simple", test_bool_simple);
   g_test_add_func ("/filter/every/dispose", test_every_dispose);
 
@@ -202,7 +202,7 @@ filter_list_model_new (GListModel *source,
   return model;
 }
 
-#define N_MODELS 8
+#define N_MODELS 16
 
 static GtkFilterListModel *
 create_filter_list_model (gconstpointer  model_id,
@@ -223,6 +223,15 @@ create_filter_list_model (gconstpointer  model_id,
       gtk_filter_list_model_set_incremental (model, TRUE);
       break;
 
+    case 2:
+      gtk_filter_list_model_set_parallel (model, TRUE);
+      break;
+
+    case 3:
+      gtk_filter_list_model_set_incremental (model, TRUE);
+      gtk_filter_list_model_set_parallel (model, TRUE);
+      break;
+
     default:
       g_assert_not_reached ();
       break;
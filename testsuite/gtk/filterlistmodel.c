@@ -561,6 +561,114 @@ test_sections (void)
   g_object_unref (sorted);
 }
 
+/* A filter from outside of GTK that opts into being run on
+ * multiple threads and remembers the threads it ran on */
+#define THREAD_TYPE_FILTER (thread_filter_get_type ())
+G_DECLARE_FINAL_TYPE (ThreadFilter, thread_filter, THREAD, FILTER, GtkFilter)
+
+struct _ThreadFilter
+{
+  GtkFilter parent_instance;
+
+  gboolean thread_safe;
+  GMutex lock;
+  GHashTable *threads;
+};
+
+G_DEFINE_TYPE (ThreadFilter, thread_filter, GTK_TYPE_FILTER)
+
+static gboolean
+thread_filter_match (GtkFilter *filter,
+                     gpointer   item)
+{
+  ThreadFilter *self = THREAD_FILTER (filter);
+
+  g_mutex_lock (&self->lock);
+  g_hash_table_add (self->threads, g_thread_self ());
+  g_mutex_unlock (&self->lock);
+
+  return GPOINTER_TO_UINT (g_object_get_qdata (item, number_quark)) % 3 == 0;
+}
+
+static gboolean
+thread_filter_is_thread_safe (GtkFilter *filter)
+{
+  return THREAD_FILTER (filter)->thread_safe;
+}
+
+static void
+thread_filter_finalize (GObject *object)
+{
+  ThreadFilter *self = THREAD_FILTER (object);
+
+  g_hash_table_unref (self->threads);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (thread_filter_parent_class)->finalize (object);
+}
+
+static void
+thread_filter_class_init (ThreadFilterClass *class)
+{
+  GtkFilterClass *filter_class = GTK_FILTER_CLASS (class);
+  GObjectClass *object_class = G_OBJECT_CLASS (class);
+
+  filter_class->match = thread_filter_match;
+  filter_class->is_thread_safe = thread_filter_is_thread_safe;
+
+  object_class->finalize = thread_filter_finalize;
+}
+
+static void
+thread_filter_init (ThreadFilter *self)
+{
+  g_mutex_init (&self->lock);
+  self->threads = g_hash_table_new (NULL, NULL);
+}
+
+static void
+test_parallel (void)
+{
+  GtkFilterListModel *filtered;
+  ThreadFilter *filter;
+  GListStore *store;
+  guint i;
+
+  if (g_get_num_processors () < 2)
+    {
+      g_test_skip ("needs more than one processor");
+      return;
+    }
+
+  store = new_store (1, 10000, 1);
+
+  for (i = 0; i < 2; i++)
+    {
+      gboolean thread_safe = i == 0;
+      guint j;
+
+      filter = g_object_new (THREAD_TYPE_FILTER, NULL);
+      filter->thread_safe = thread_safe;
+      filtered = gtk_filter_list_model_new (g_object_ref (G_LIST_MODEL (store)), NULL);
+      gtk_filter_list_model_set_parallel (filtered, TRUE);
+      gtk_filter_list_model_set_filter (filtered, GTK_FILTER (filter));
+
+      g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (filtered)), ==, 3333);
+      for (j = 0; j < 3333; j++)
+        g_assert_cmpuint (get (G_LIST_MODEL (filtered), j), ==, 3 * (j + 1));
+
+      if (thread_safe)
+        g_assert_cmpuint (g_hash_table_size (filter->threads), >, 1);
+      else
+        g_assert_cmpuint (g_hash_table_size (filter->threads), ==, 1);
+
+      g_object_unref (filtered);
+      g_object_unref (filter);
+    }
+
+  g_object_unref (store);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -577,6 +685,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/filterlistmodel/empty", test_empty);
   g_test_add_func ("/filterlistmodel/add_remove_item", test_add_remove_item);
   g_test_add_func ("/filterlistmodel/sections", test_sections);
+  g_test_add_func ("/filterlistmodel/parallel", test_parallel);
 
   return g_test_run ();
 }
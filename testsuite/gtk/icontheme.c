@@ -1,4 +1,5 @@
 #include <gtk/gtk.h>
+#include <glib/gstdio.h>
 
 #include <string.h>
 
@@ -752,6 +753,167 @@ test_nonsquare_symbolic (void)
   g_object_unref (info);
 }
 
+static GdkTexture *
+find_texture (GskRenderNode *node)
+{
+  switch ((int) gsk_render_node_get_node_type (node))
+    {
+    case GSK_TEXTURE_NODE:
+      return gsk_texture_node_get_texture (node);
+    case GSK_COLOR_MATRIX_NODE:
+      return find_texture (gsk_color_matrix_node_get_child (node));
+    case GSK_TRANSFORM_NODE:
+      return find_texture (gsk_transform_node_get_child (node));
+    case GSK_CONTAINER_NODE:
+      g_assert_cmpuint (gsk_container_node_get_n_children (node), ==, 1);
+      return find_texture (gsk_container_node_get_child (node, 0));
+    default:
+      g_assert_not_reached ();
+      return NULL;
+    }
+}
+
+/* Loads an icon with a new theme, so it is rasterized again */
+static guchar *
+load_icon_pixels (const char *icon_name,
+                  int         size,
+                  int        *out_width,
+                  int        *out_height)
+{
+  const GdkRGBA colors[4] = {
+    { 0.1, 0.2, 0.3, 1.0 },
+    { 0.4, 0.5, 0.6, 1.0 },
+    { 0.7, 0.8, 0.9, 1.0 },
+    { 0.2, 0.4, 0.6, 1.0 },
+  };
+  GtkIconTheme *icon_theme;
+  GtkIconPaintable *info;
+  GtkSnapshot *snapshot;
+  GskRenderNode *node;
+  GdkTexture *texture;
+  const char *search_path[2];
+  guchar *pixels;
+  int width, height;
+
+  icon_theme = gtk_icon_theme_new ();
+  gtk_icon_theme_set_theme_name (icon_theme, "icons");
+  search_path[0] = g_test_get_dir (G_TEST_DIST);
+  search_path[1] = NULL;
+  gtk_icon_theme_set_search_path (icon_theme, search_path);
+
+  info = gtk_icon_theme_lookup_icon (icon_theme, icon_name, NULL, size, 1, GTK_TEXT_DIR_NONE, 0);
+  g_assert_nonnull (info);
+
+  snapshot = gtk_snapshot_new ();
+  gtk_symbolic_paintable_snapshot_symbolic (GTK_SYMBOLIC_PAINTABLE (info), snapshot,
+                                            size, size, colors, G_N_ELEMENTS (colors));
+  node = gtk_snapshot_free_to_node (snapshot);
+
+  texture = find_texture (node);
+  width = gdk_texture_get_width (texture);
+  height = gdk_texture_get_height (texture);
+  pixels = g_malloc (width * height * 4);
+  gdk_texture_download (texture, pixels, width * 4);
+
+  *out_width = width;
+  *out_height = height;
+
+  gsk_render_node_unref (node);
+  g_object_unref (info);
+  g_object_unref (icon_theme);
+
+  return pixels;
+}
+
+static guint
+count_raster_cache_files (void)
+{
+  const char *name;
+  char *path;
+  GDir *dir;
+  guint n = 0;
+
+  path = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "icons", NULL);
+  dir = g_dir_open (path, 0, NULL);
+  if (dir)
+    {
+      while ((name = g_dir_read_name (dir)))
+        {
+          /* Skip files that are still being written */
+          if (strchr (name, '.') == NULL)
+            n++;
+        }
+      g_dir_close (dir);
+    }
+  g_free (path);
+
+  return n;
+}
+
+/* Files are written on a worker thread */
+static void
+wait_for_raster_cache_files (guint n)
+{
+  gint64 end_time = g_get_monotonic_time () + 10 * G_TIME_SPAN_SECOND;
+
+  while (count_raster_cache_files () < n && g_get_monotonic_time () < end_time)
+    g_usleep (1000);
+
+  g_assert_cmpuint (count_raster_cache_files (), ==, n);
+}
+
+static void
+test_raster_cache (void)
+{
+  const char *icon_names[] = { "everything", "everything-symbolic" };
+  guchar *first, *second;
+  int width, height, width2, height2;
+  guint i, n;
+
+  for (i = 0; i < G_N_ELEMENTS (icon_names); i++)
+    {
+      n = count_raster_cache_files ();
+
+      first = load_icon_pixels (icon_names[i], 37, &width, &height);
+      wait_for_raster_cache_files (n + 1);
+
+      /* From the cache this time */
+      second = load_icon_pixels (icon_names[i], 37, &width2, &height2);
+      g_assert_cmpuint (count_raster_cache_files (), ==, n + 1);
+
+      g_assert_cmpint (width, ==, width2);
+      g_assert_cmpint (height, ==, height2);
+      g_assert_cmpmem (first, width * height * 4, second, width2 * height2 * 4);
+
+      g_free (first);
+      g_free (second);
+    }
+}
+
+static void
+remove_cache_dir (const char *path)
+{
+  const char *name;
+  GDir *dir;
+
+  dir = g_dir_open (path, 0, NULL);
+  if (dir == NULL)
+    {
+      g_remove (path);
+      return;
+    }
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      char *child = g_build_filename (path, name, NULL);
+      remove_cache_dir (child);
+      g_free (child);
+    }
+  g_dir_close (dir);
+
+  g_rmdir (path);
+}
+
 static void
 require_env (const char *var)
 {
@@ -762,8 +924,15 @@ require_env (const char *var)
 int
 main (int argc, char *argv[])
 {
+  char *cache_dir;
+  int result;
+
   require_env ("G_TEST_SRCDIR");
 
+  /* Don't fill the user's icon cache */
+  cache_dir = g_dir_make_tmp ("gtk-icontheme-XXXXXX", NULL);
+  g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+
   gtk_test_init (&argc, &argv);
 
   g_test_add_func ("/icontheme/basics", test_basics);
@@ -787,6 +956,12 @@ main (int argc, char *argv[])
   g_test_add_func ("/icontheme/lookup_order7", test_lookup_order7);
   g_test_add_func ("/icontheme/lookup_order8", test_lookup_order8);
   g_test_add_func ("/icontheme/lookup_order9", test_lookup_order9);
+  g_test_add_func ("/icontheme/raster-cache", test_raster_cache);
+
+  result = g_test_run ();
 
-  return g_test_run();
+  remove_cache_dir (cache_dir);
+  g_free (cache_dir);
+
+  return result;
 }
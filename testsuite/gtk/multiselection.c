@@ -862,6 +862,120 @@ test_sections (void)
   g_object_unref (selection);
 }
 
+static gboolean
+is_even (gpointer item,
+         gpointer unused)
+{
+  return GPOINTER_TO_UINT (g_object_get_qdata (item, number_quark)) % 2 == 0;
+}
+
+static gboolean
+is_big (gpointer item,
+        gpointer unused)
+{
+  return GPOINTER_TO_UINT (g_object_get_qdata (item, number_quark)) > 5;
+}
+
+static void
+test_select_matching (void)
+{
+  GtkSelectionModel *selection;
+  GListStore *store;
+  GtkFilter *filter;
+
+  store = new_store (1, 10, 1);
+  selection = new_model (G_LIST_MODEL (store));
+
+  filter = GTK_FILTER (gtk_custom_filter_new (is_even, NULL, NULL));
+  gtk_multi_selection_select_matching (GTK_MULTI_SELECTION (selection), filter, TRUE);
+  g_object_unref (filter);
+  assert_selection (selection, "2 4 6 8 10");
+  assert_selection_changes (selection, "1:9");
+
+  filter = GTK_FILTER (gtk_custom_filter_new (is_big, NULL, NULL));
+  gtk_multi_selection_select_matching (GTK_MULTI_SELECTION (selection), filter, FALSE);
+  assert_selection (selection, "2 4 6 7 8 9 10");
+  assert_selection_changes (selection, "6:3");
+
+  gtk_multi_selection_select_matching (GTK_MULTI_SELECTION (selection), filter, TRUE);
+  g_object_unref (filter);
+  assert_selection (selection, "6 7 8 9 10");
+  assert_selection_changes (selection, "1:3");
+
+  /* filters without a function match everything */
+  filter = GTK_FILTER (gtk_custom_filter_new (NULL, NULL, NULL));
+  gtk_multi_selection_select_matching (GTK_MULTI_SELECTION (selection), filter, TRUE);
+  g_object_unref (filter);
+  assert_selection (selection, "1 2 3 4 5 6 7 8 9 10");
+  assert_selection_changes (selection, "0:5");
+
+  assert_changes (selection, "");
+
+  g_object_unref (store);
+  g_object_unref (selection);
+}
+
+static int
+compare_reverse (gconstpointer first,
+                 gconstpointer second,
+                 gpointer      unused)
+{
+  return compare (second, first, unused);
+}
+
+static void
+test_sort_reorder (void)
+{
+  GListStore *store;
+  GtkSortListModel *sorted;
+  GtkSelectionModel *selection;
+  GtkFilter *filter;
+  guint i, n;
+
+  store = new_store (1, 10, 1);
+  sorted = gtk_sort_list_model_new (G_LIST_MODEL (store),
+                                    GTK_SORTER (gtk_custom_sorter_new (compare, NULL, NULL)));
+  selection = new_model (G_LIST_MODEL (sorted));
+
+  gtk_selection_model_select_item (selection, 1, FALSE);
+  gtk_selection_model_select_item (selection, 4, FALSE);
+  gtk_selection_model_select_item (selection, 8, FALSE);
+  assert_selection (selection, "2 5 9");
+  ignore_selection_changes (selection);
+
+  /* reordering keeps the same items selected */
+  gtk_sort_list_model_set_sorter (sorted, GTK_SORTER (gtk_custom_sorter_new (compare_reverse, NULL, NULL)));
+  assert_model (selection, "10 9 8 7 6 5 4 3 2 1");
+  assert_selection (selection, "9 5 2");
+  ignore_changes (selection);
+
+  /* and so does it for big selections */
+  for (i = 11; i <= 1000; i++)
+    add (store, i);
+  ignore_changes (selection);
+  filter = GTK_FILTER (gtk_custom_filter_new (is_even, NULL, NULL));
+  gtk_multi_selection_select_matching (GTK_MULTI_SELECTION (selection), filter, TRUE);
+  g_object_unref (filter);
+  ignore_selection_changes (selection);
+
+  gtk_sort_list_model_set_sorter (sorted, GTK_SORTER (gtk_custom_sorter_new (compare, NULL, NULL)));
+  ignore_changes (selection);
+  n = 0;
+  for (i = 0; i < 1000; i++)
+    {
+      if (gtk_selection_model_is_selected (selection, i))
+        {
+          g_assert_cmpuint (get (G_LIST_MODEL (selection), i) % 2, ==, 0);
+          n++;
+        }
+    }
+  g_assert_cmpuint (n, ==, 500);
+  assert_selection_changes (selection, "");
+
+  g_object_unref (selection);
+  g_object_unref (sorted);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -885,6 +999,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/multiselection/empty", test_empty);
   g_test_add_func ("/multiselection/selection-filter/empty", test_empty_filter);
   g_test_add_func ("/multiselection/sections", test_sections);
+  g_test_add_func ("/multiselection/select-matching", test_select_matching);
+  g_test_add_func ("/multiselection/sort-reorder", test_sort_reorder);
 
   return g_test_run ();
 }
@@ -0,0 +1,348 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <locale.h>
+
+#include <gtk/gtk.h>
+
+/* Checks that sorting in parallel gives the same results as sorting
+ * on the main thread, and compares how long both take when run with
+ * -m perf.
+ */
+
+#define SORT_TYPE_ITEM (sort_item_get_type ())
+G_DECLARE_FINAL_TYPE (SortItem, sort_item, SORT, ITEM, GObject)
+
+struct _SortItem
+{
+  GObject parent_instance;
+
+  char *name;
+  int number;
+};
+
+enum {
+  PROP_0,
+  PROP_NAME,
+  PROP_NUMBER,
+  N_PROPS
+};
+
+G_DEFINE_TYPE (SortItem, sort_item, G_TYPE_OBJECT)
+
+static void
+sort_item_get_property (GObject    *object,
+                        guint       prop_id,
+                        GValue     *value,
+                        GParamSpec *pspec)
+{
+  SortItem *self = SORT_ITEM (object);
+
+  switch (prop_id)
+    {
+    case PROP_NAME:
+      g_value_set_string (value, self->name);
+      break;
+
+    case PROP_NUMBER:
+      g_value_set_int (value, self->number);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+sort_item_finalize (GObject *object)
+{
+  SortItem *self = SORT_ITEM (object);
+
+  g_free (self->name);
+
+  G_OBJECT_CLASS (sort_item_parent_class)->finalize (object);
+}
+
+static void
+sort_item_class_init (SortItemClass *class)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (class);
+
+  object_class->get_property = sort_item_get_property;
+  object_class->finalize = sort_item_finalize;
+
+  g_object_class_install_property (object_class, PROP_NAME,
+      g_param_spec_string ("name", NULL, NULL, NULL, G_PARAM_READABLE));
+  g_object_class_install_property (object_class, PROP_NUMBER,
+      g_param_spec_int ("number", NULL, NULL, G_MININT, G_MAXINT, 0, G_PARAM_READABLE));
+}
+
+static void
+sort_item_init (SortItem *self)
+{
+}
+
+static SortItem *
+sort_item_new (void)
+{
+  SortItem *self = g_object_new (SORT_TYPE_ITEM, NULL);
+
+  /* Lots of duplicates, so ties between items get tested, too */
+  self->name = g_strdup_printf ("Item %u", g_test_rand_int_range (0, 1000));
+  self->number = g_test_rand_int_range (-100, 100);
+
+  return self;
+}
+
+static guint
+get_n_items (void)
+{
+  return g_test_perf () ? 500000 : 20000;
+}
+
+static GListModel *
+create_source (guint n)
+{
+  GListStore *store;
+  gpointer *items;
+  guint i;
+
+  items = g_new (gpointer, n);
+  for (i = 0; i < n; i++)
+    items[i] = sort_item_new ();
+
+  store = g_list_store_new (SORT_TYPE_ITEM);
+  g_list_store_splice (store, 0, 0, items, n);
+
+  for (i = 0; i < n; i++)
+    g_object_unref (items[i]);
+  g_free (items);
+
+  return G_LIST_MODEL (store);
+}
+
+static GtkSorter *
+create_string_sorter (void)
+{
+  return GTK_SORTER (gtk_string_sorter_new (gtk_property_expression_new (SORT_TYPE_ITEM, NULL, "name")));
+}
+
+static GtkSorter *
+create_numeric_sorter (void)
+{
+  return GTK_SORTER (gtk_numeric_sorter_new (gtk_property_expression_new (SORT_TYPE_ITEM, NULL, "number")));
+}
+
+static GtkSorter *
+create_multi_sorter (void)
+{
+  GtkMultiSorter *sorter = gtk_multi_sorter_new ();
+
+  gtk_multi_sorter_append (sorter, create_numeric_sorter ());
+  gtk_multi_sorter_append (sorter, create_string_sorter ());
+
+  return GTK_SORTER (sorter);
+}
+
+static char *
+get_name (SortItem *item)
+{
+  return g_strdup (item->name);
+}
+
+static GtkSorter *
+create_closure_sorter (void)
+{
+  return GTK_SORTER (gtk_string_sorter_new (gtk_cclosure_expression_new (G_TYPE_STRING,
+                                                                         NULL,
+                                                                         0, NULL,
+                                                                         G_CALLBACK (get_name),
+                                                                         NULL, NULL)));
+}
+
+static void
+count_items_changed (GListModel *model,
+                     guint       position,
+                     guint       removed,
+                     guint       added,
+                     guint      *counter)
+{
+  (*counter)++;
+}
+
+static void
+assert_models_equal (GListModel *model1,
+                     GListModel *model2)
+{
+  guint i, n;
+
+  n = g_list_model_get_n_items (model1);
+  g_assert_cmpuint (g_list_model_get_n_items (model2), ==, n);
+
+  for (i = 0; i < n; i++)
+    {
+      gpointer item1 = g_list_model_get_item (model1, i);
+      gpointer item2 = g_list_model_get_item (model2, i);
+
+      g_assert_true (item1 == item2);
+
+      g_object_unref (item1);
+      g_object_unref (item2);
+    }
+}
+
+typedef struct {
+  const char *name;
+  GtkSorter * (* create_sorter) (void);
+} SorterTest;
+
+static const SorterTest sorter_tests[] = {
+  { "string", create_string_sorter },
+  { "numeric", create_numeric_sorter },
+  { "multi", create_multi_sorter },
+  { "closure", create_closure_sorter },
+};
+
+static void
+test_sorter (gconstpointer data)
+{
+  const SorterTest *test = data;
+  GtkSortListModel *serial, *parallel;
+  GListModel *source;
+  double serial_time, parallel_time;
+  guint n, changes;
+
+  n = get_n_items ();
+  source = create_source (n);
+
+  serial = gtk_sort_list_model_new (g_object_ref (source), NULL);
+  parallel = gtk_sort_list_model_new (g_object_ref (source), NULL);
+  gtk_sort_list_model_set_parallel (parallel, TRUE);
+  g_assert_true (gtk_sort_list_model_get_parallel (parallel));
+
+  changes = 0;
+  g_signal_connect (parallel, "items-changed", G_CALLBACK (count_items_changed), &changes);
+
+  g_test_timer_start ();
+  gtk_sort_list_model_set_sorter (serial, test->create_sorter ());
+  serial_time = g_test_timer_elapsed ();
+
+  g_test_timer_start ();
+  gtk_sort_list_model_set_sorter (parallel, test->create_sorter ());
+  parallel_time = g_test_timer_elapsed ();
+
+  if (g_test_perf ())
+    {
+      g_test_minimized_result (serial_time, "sorting %u items: %gsec", n, serial_time);
+      g_test_minimized_result (parallel_time, "sorting %u items in parallel: %gsec", n, parallel_time);
+    }
+
+  g_assert_cmpuint (changes, ==, 1);
+  g_assert_cmpuint (gtk_sort_list_model_get_pending (parallel), ==, 0);
+  assert_models_equal (G_LIST_MODEL (serial), G_LIST_MODEL (parallel));
+
+  g_object_unref (serial);
+  g_object_unref (parallel);
+  g_object_unref (source);
+}
+
+static void
+test_items_changed (void)
+{
+  GtkSortListModel *serial, *parallel;
+  GListModel *source;
+  gpointer items[100];
+  guint i, n;
+
+  n = get_n_items ();
+  source = create_source (n);
+
+  serial = gtk_sort_list_model_new (g_object_ref (source), create_multi_sorter ());
+  parallel = gtk_sort_list_model_new (NULL, create_multi_sorter ());
+  gtk_sort_list_model_set_parallel (parallel, TRUE);
+  gtk_sort_list_model_set_model (parallel, source);
+  assert_models_equal (G_LIST_MODEL (serial), G_LIST_MODEL (parallel));
+
+  for (i = 0; i < G_N_ELEMENTS (items); i++)
+    items[i] = sort_item_new ();
+  g_list_store_splice (G_LIST_STORE (source), n / 3, 50, items, G_N_ELEMENTS (items));
+  for (i = 0; i < G_N_ELEMENTS (items); i++)
+    g_object_unref (items[i]);
+  assert_models_equal (G_LIST_MODEL (serial), G_LIST_MODEL (parallel));
+
+  g_list_store_remove (G_LIST_STORE (source), 0);
+  assert_models_equal (G_LIST_MODEL (serial), G_LIST_MODEL (parallel));
+
+  g_object_unref (serial);
+  g_object_unref (parallel);
+  g_object_unref (source);
+}
+
+static void
+test_incremental (void)
+{
+  GtkSortListModel *model;
+  GListModel *source;
+
+  if (g_get_num_processors () < 2)
+    {
+      g_test_skip ("Parallel sorting needs multiple processors");
+      return;
+    }
+
+  source = create_source (get_n_items ());
+
+  /* Sorting in parallel is preferred over sorting incrementally */
+  model = gtk_sort_list_model_new (g_object_ref (source), NULL);
+  gtk_sort_list_model_set_incremental (model, TRUE);
+  gtk_sort_list_model_set_parallel (model, TRUE);
+  gtk_sort_list_model_set_sorter (model, create_string_sorter ());
+  g_assert_cmpuint (gtk_sort_list_model_get_pending (model), ==, 0);
+
+  /* ...unless the sorter can't sort in parallel */
+  gtk_sort_list_model_set_sorter (model, create_closure_sorter ());
+  g_assert_cmpuint (gtk_sort_list_model_get_pending (model), >, 0);
+
+  /* ...and turning it on finishes an ongoing incremental sort */
+  gtk_sort_list_model_set_parallel (model, FALSE);
+  gtk_sort_list_model_set_sorter (model, create_numeric_sorter ());
+  g_assert_cmpuint (gtk_sort_list_model_get_pending (model), >, 0);
+  gtk_sort_list_model_set_parallel (model, TRUE);
+  g_assert_cmpuint (gtk_sort_list_model_get_pending (model), ==, 0);
+
+  g_object_unref (model);
+  g_object_unref (source);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint i;
+
+  (g_test_init) (&argc, &argv, NULL);
+  setlocale (LC_ALL, "C");
+
+  for (i = 0; i < G_N_ELEMENTS (sorter_tests); i++)
+    {
+      char *path = g_strdup_printf ("/sortlistmodel/parallel/%s", sorter_tests[i].name);
+      g_test_add_data_func (path, &sorter_tests[i], test_sorter);
+      g_free (path);
+    }
+  g_test_add_func ("/sortlistmodel/parallel/items-changed", test_items_changed);
+  g_test_add_func ("/sortlistmodel/parallel/incremental", test_incremental);
+
+  return g_test_run ();
+}
@@ -261,6 +261,176 @@ test_take (void)
   g_object_unref (list);
 }
 
+static void
+test_take_strv (void)
+{
+  GtkStringList *list;
+  char **strv;
+
+  list = new_model ((const char *[]){ "a", NULL });
+
+  strv = g_strsplit ("b c d", " ", -1);
+  gtk_string_list_take_strv (list, strv);
+  assert_model (list, "a b c d");
+  assert_changes (list, "1+3");
+
+  gtk_string_list_take_strv (list, g_new0 (char *, 1));
+  assert_model (list, "a b c d");
+  assert_changes (list, "");
+
+  gtk_string_list_remove (list, 2);
+  assert_model (list, "a b d");
+  assert_changes (list, "-2");
+
+  gtk_string_list_append (list, "e");
+  assert_model (list, "a b d e");
+  assert_changes (list, "+3");
+
+  g_object_unref (list);
+}
+
+static void
+test_take_bytes (void)
+{
+  GtkStringList *list;
+
+  list = new_model ((const char *[]){ "a", NULL });
+
+  gtk_string_list_take_bytes (list, g_bytes_new_static ("b\nc\n", 4));
+  assert_model (list, "a b c");
+  assert_changes (list, "1+2");
+
+  /* no final newline, and an empty line */
+  gtk_string_list_take_bytes (list, g_bytes_new_take (g_strdup ("d\n\ne"), 4));
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (list)), ==, 6);
+  g_assert_cmpstr (gtk_string_list_get_string (list, 4), ==, "");
+  g_assert_cmpstr (gtk_string_list_get_string (list, 5), ==, "e");
+  assert_changes (list, "3+3");
+
+  gtk_string_list_take_bytes (list, g_bytes_new_static ("", 0));
+  assert_changes (list, "");
+
+  gtk_string_list_splice (list, 1, 4, NULL);
+  assert_model (list, "a e");
+  assert_changes (list, "1-4");
+
+  g_object_unref (list);
+}
+
+static void
+test_items (void)
+{
+  GtkStringList *list;
+  GtkStringObject *a, *b, *c, *item;
+  char **strv;
+
+  list = new_model ((const char *[]){ "a", NULL });
+  strv = g_strsplit ("b", " ", -1);
+  gtk_string_list_take_strv (list, strv);
+  gtk_string_list_take_bytes (list, g_bytes_new_static ("c", 1));
+  assert_changes (list, "+1, +2");
+  g_assert_false (gtk_string_list_get_compact (list));
+
+  a = g_list_model_get_item (G_LIST_MODEL (list), 0);
+  b = g_list_model_get_item (G_LIST_MODEL (list), 1);
+  c = g_list_model_get_item (G_LIST_MODEL (list), 2);
+
+  /* items are only created once */
+  item = g_list_model_get_item (G_LIST_MODEL (list), 0);
+  g_assert_true (item == a);
+  g_object_unref (item);
+
+  /* ...and live as long as they are in the list */
+  item = g_list_model_get_item (G_LIST_MODEL (list), 1);
+  g_object_set_data (G_OBJECT (item), "data", GUINT_TO_POINTER (42));
+  g_object_unref (item);
+  item = g_list_model_get_item (G_LIST_MODEL (list), 1);
+  g_assert_true (item == b);
+  g_assert_cmpuint (GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (item), "data")), ==, 42);
+  g_object_unref (item);
+
+  /* items keep their strings when they are removed */
+  gtk_string_list_splice (list, 0, 3, (const char *[]){ "x", NULL });
+  assert_changes (list, "0-3+1");
+  g_assert_cmpstr (gtk_string_object_get_string (a), ==, "a");
+  g_assert_cmpstr (gtk_string_object_get_string (b), ==, "b");
+  g_assert_cmpstr (gtk_string_object_get_string (c), ==, "c");
+  g_object_unref (b);
+
+  /* ...and when the list is gone */
+  item = g_list_model_get_item (G_LIST_MODEL (list), 0);
+  g_object_unref (list);
+  g_assert_cmpstr (gtk_string_object_get_string (item), ==, "x");
+  g_assert_cmpstr (gtk_string_object_get_string (a), ==, "a");
+
+  g_object_unref (item);
+  g_object_unref (a);
+  g_object_unref (c);
+}
+
+static gpointer
+unref_in_thread (gpointer data)
+{
+  g_object_unref (data);
+
+  return NULL;
+}
+
+static void
+test_compact (void)
+{
+  GtkStringList *list;
+  GtkStringObject *a, *item;
+  GThread *thread;
+  gpointer weak;
+
+  list = gtk_string_list_new_compact ((const char *[]){ "a", "b", NULL });
+  g_assert_true (gtk_string_list_get_compact (list));
+
+  /* items are the same while they are used */
+  a = g_list_model_get_item (G_LIST_MODEL (list), 0);
+  item = g_list_model_get_item (G_LIST_MODEL (list), 0);
+  g_assert_true (item == a);
+  g_object_unref (item);
+
+  /* ...but not kept alive by the list */
+  weak = a;
+  g_object_add_weak_pointer (G_OBJECT (a), &weak);
+  g_object_unref (a);
+  g_assert_null (weak);
+
+  item = g_list_model_get_item (G_LIST_MODEL (list), 0);
+  g_assert_cmpstr (gtk_string_object_get_string (item), ==, "a");
+  g_object_unref (item);
+
+  /* items can be freed on other threads */
+  for (guint i = 0; i < 100; i++)
+    {
+      item = g_list_model_get_item (G_LIST_MODEL (list), i % 2);
+      thread = g_thread_new ("unref", unref_in_thread, item);
+      item = g_list_model_get_item (G_LIST_MODEL (list), i % 2);
+      g_assert_cmpstr (gtk_string_object_get_string (item), ==, i % 2 ? "b" : "a");
+      g_thread_join (thread);
+      g_object_unref (item);
+    }
+
+  /* items keep their strings when they are removed */
+  item = g_list_model_get_item (G_LIST_MODEL (list), 1);
+  gtk_string_list_remove (list, 1);
+  g_assert_cmpstr (gtk_string_object_get_string (item), ==, "b");
+  g_object_unref (item);
+
+  /* ...and keep the list alive */
+  item = g_list_model_get_item (G_LIST_MODEL (list), 0);
+  weak = list;
+  g_object_add_weak_pointer (G_OBJECT (list), &weak);
+  g_object_unref (list);
+  g_assert_nonnull (weak);
+  g_assert_cmpstr (gtk_string_object_get_string (item), ==, "a");
+  g_object_unref (item);
+  g_assert_null (weak);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -277,6 +447,10 @@ main (int argc, char *argv[])
   g_test_add_func ("/stringlist/splice", test_splice);
   g_test_add_func ("/stringlist/add_remove", test_add_remove);
   g_test_add_func ("/stringlist/take", test_take);
+  g_test_add_func ("/stringlist/take-strv", test_take_strv);
+  g_test_add_func ("/stringlist/take-bytes", test_take_bytes);
+  g_test_add_func ("/stringlist/items", test_items);
+  g_test_add_func ("/stringlist/compact", test_compact);
 
   return g_test_run ();
 }
@@ -1956,6 +1956,192 @@ test_serialize_wrap_mode (void)
   g_assert_finalize_object (buffer);
 }
 
+static void
+check_mark_offset (GtkTextBuffer *buffer,
+                   GtkTextMark   *mark,
+                   int            offset)
+{
+  GtkTextIter iter;
+
+  gtk_text_buffer_get_iter_at_mark (buffer, &iter, mark);
+  g_assert_cmpint (gtk_text_iter_get_offset (&iter), ==, offset);
+}
+
+static void
+test_find_all (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextMark **marks;
+  GtkTextIter start, end;
+  gsize i, n_marks;
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_enable_search_index (buffer, TRUE);
+  gtk_text_buffer_set_text (buffer, "foo bar\nfoofoo\nbar Foo\naaaa", -1);
+
+  marks = gtk_text_buffer_find_all (buffer, "foo", 0, NULL, NULL, &n_marks);
+  g_assert_cmpuint (n_marks, ==, 6);
+  g_assert_null (marks[n_marks]);
+  check_mark_offset (buffer, marks[0], 0);
+  check_mark_offset (buffer, marks[1], 3);
+  check_mark_offset (buffer, marks[2], 8);
+  check_mark_offset (buffer, marks[3], 11);
+  check_mark_offset (buffer, marks[4], 11);
+  check_mark_offset (buffer, marks[5], 14);
+
+  /* Text inserted at the edges is not part of the match */
+  gtk_text_buffer_get_start_iter (buffer, &start);
+  gtk_text_buffer_insert (buffer, &start, "x", -1);
+  gtk_text_buffer_insert (buffer, &start, "y", -1);
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 5);
+  gtk_text_buffer_insert (buffer, &start, "z", -1);
+  check_mark_offset (buffer, marks[0], 2);
+  check_mark_offset (buffer, marks[1], 5);
+
+  for (i = 0; i < n_marks; i++)
+    gtk_text_buffer_delete_mark (buffer, marks[i]);
+  g_free (marks);
+
+  marks = gtk_text_buffer_find_all (buffer, "foo", GTK_TEXT_SEARCH_CASE_INSENSITIVE, NULL, NULL, &n_marks);
+  g_assert_cmpuint (n_marks, ==, 8);
+  check_mark_offset (buffer, marks[6], 22);
+  check_mark_offset (buffer, marks[7], 25);
+  for (i = 0; i < n_marks; i++)
+    gtk_text_buffer_delete_mark (buffer, marks[i]);
+  g_free (marks);
+
+  /* Matches don't overlap and stay within the range */
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 11);
+  gtk_text_buffer_get_iter_at_offset (buffer, &end, 14);
+  marks = gtk_text_buffer_find_all (buffer, "foo", 0, &start, &end, &n_marks);
+  g_assert_cmpuint (n_marks, ==, 2);
+  check_mark_offset (buffer, marks[0], 11);
+  check_mark_offset (buffer, marks[1], 14);
+  for (i = 0; i < n_marks; i++)
+    gtk_text_buffer_delete_mark (buffer, marks[i]);
+  g_free (marks);
+
+  marks = gtk_text_buffer_find_all (buffer, "aa", 0, NULL, NULL, &n_marks);
+  g_assert_cmpuint (n_marks, ==, 4);
+  for (i = 0; i < n_marks; i++)
+    gtk_text_buffer_delete_mark (buffer, marks[i]);
+  g_free (marks);
+
+  marks = gtk_text_buffer_find_all (buffer, "baz", 0, NULL, NULL, &n_marks);
+  g_assert_cmpuint (n_marks, ==, 0);
+  g_assert_null (marks[0]);
+  g_free (marks);
+
+  g_object_unref (buffer);
+}
+
+typedef struct {
+  gboolean done;
+  GError *error;
+} InsertStreamResult;
+
+static void
+insert_stream_done (GObject      *source,
+                    GAsyncResult *result,
+                    gpointer      data)
+{
+  InsertStreamResult *res = data;
+
+  if (!gtk_text_buffer_insert_stream_finish (GTK_TEXT_BUFFER (source), result, &res->error))
+    g_assert_nonnull (res->error);
+
+  res->done = TRUE;
+}
+
+/* Inserts @text into @buffer at @offset using a stream and
+ * returns the error, or NULL on success.
+ *
+ * This runs in a context that is not the default one, to make
+ * sure nothing gets scheduled in the wrong place.
+ */
+static GError *
+insert_stream (GtkTextBuffer *buffer,
+               int            offset,
+               const char    *text,
+               gsize          len)
+{
+  InsertStreamResult res = { FALSE, NULL };
+  GMainContext *context;
+  GInputStream *stream;
+  GtkTextIter iter;
+
+  context = g_main_context_new ();
+  g_main_context_push_thread_default (context);
+
+  stream = g_memory_input_stream_new_from_data (g_memdup2 (text, len), len, g_free);
+  gtk_text_buffer_get_iter_at_offset (buffer, &iter, offset);
+  gtk_text_buffer_insert_stream_async (buffer, &iter, stream, G_PRIORITY_DEFAULT,
+                                       NULL, insert_stream_done, &res);
+  g_object_unref (stream);
+
+  while (!res.done)
+    g_main_context_iteration (context, TRUE);
+
+  g_main_context_pop_thread_default (context);
+  g_main_context_unref (context);
+
+  return res.error;
+}
+
+static void
+test_insert_stream (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter start, end;
+  GString *expected;
+  GString *text;
+  GError *error;
+  char *result;
+  int i;
+
+  /* Enough text for many chunks, with multibyte characters and
+   * \r\n in all kinds of positions, followed by more than a chunk
+   * without \n */
+  text = g_string_new (NULL);
+  for (i = 0; i < 20000; i++)
+    {
+      g_string_append_printf (text, "line %d \303\244\342\202\254", i);
+      g_string_append (text, i % 3 ? "\n" : "\r\n");
+    }
+  for (i = 0; i < 100000; i++)
+    g_string_append (text, i % 2 ? "\303\244\r" : "x\r");
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, "<>", -1);
+
+  error = insert_stream (buffer, 1, text->str, text->len);
+  g_assert_no_error (error);
+
+  expected = g_string_new ("<");
+  g_string_append_len (expected, text->str, text->len);
+  g_string_append (expected, ">");
+
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  result = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (result, ==, expected->str);
+  g_free (result);
+
+  /* Valid text before invalid UTF-8 is inserted */
+  gtk_text_buffer_set_text (buffer, "", -1);
+  error = insert_stream (buffer, 0, "abc\ndef\377ghi", 11);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+  g_clear_error (&error);
+
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  result = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (result, ==, "abc\ndef");
+  g_free (result);
+
+  g_object_unref (buffer);
+  g_string_free (expected, TRUE);
+  g_string_free (text, TRUE);
+}
+
 int
 main (int argc, char** argv)
 {
@@ -1984,6 +2170,8 @@ main (int argc, char** argv)
   g_test_add_func ("/TextBuffer/Undo 4", test_undo4);
   g_test_add_func ("/TextBuffer/Undo 5", test_undo5);
   g_test_add_func ("/TextBuffer/Serialize wrap-mode", test_serialize_wrap_mode);
+  g_test_add_func ("/TextBuffer/Find all", test_find_all);
+  g_test_add_func ("/TextBuffer/Insert stream", test_insert_stream);
 
   return g_test_run();
 }
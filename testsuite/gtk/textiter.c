@@ -21,6 +21,9 @@
 
 #include <gtk/gtk.h>
 
+/* Whether the search tests use the search index */
+static gboolean search_index = FALSE;
+
 static void
 test_empty_search (void)
 {
@@ -60,6 +63,7 @@ check_found_forward (const char *haystack,
   char *text;
 
   buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_enable_search_index (buffer, search_index);
 
   gtk_text_buffer_set_text (buffer, haystack, -1);
 
@@ -93,6 +97,7 @@ check_found_backward (const char *haystack,
   char *text;
 
   buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_enable_search_index (buffer, search_index);
 
   gtk_text_buffer_set_text (buffer, haystack, -1);
 
@@ -119,6 +124,7 @@ check_not_found (const char *haystack,
   gboolean res;
 
   buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_enable_search_index (buffer, search_index);
 
   gtk_text_buffer_set_text (buffer, haystack, -1);
 
@@ -279,6 +285,128 @@ test_search_caseless (void)
   check_found_backward ("aa \303\200", "aa", flags, 0, 2, "aa");
 }
 
+static void
+test_search_indexed (void)
+{
+  search_index = TRUE;
+
+  test_search_full_buffer ();
+  test_search ();
+  test_search_caseless ();
+
+  search_index = FALSE;
+}
+
+static void
+check_search (GtkTextBuffer      *buffer,
+              const char         *needle,
+              GtkTextSearchFlags  flags,
+              int                 expected_start)
+{
+  GtkTextIter i, s, e;
+  gboolean res;
+
+  gtk_text_buffer_get_start_iter (buffer, &i);
+  res = gtk_text_iter_forward_search (&i, needle, flags, &s, &e, NULL);
+  g_assert_true (res == (expected_start >= 0));
+  if (res)
+    g_assert_cmpint (gtk_text_iter_get_offset (&s), ==, expected_start);
+
+  gtk_text_buffer_get_end_iter (buffer, &i);
+  res = gtk_text_iter_backward_search (&i, needle, flags, &s, &e, NULL);
+  g_assert_true (res == (expected_start >= 0));
+  if (res)
+    g_assert_cmpint (gtk_text_iter_get_offset (&s), ==, expected_start);
+}
+
+static void
+test_search_index (void)
+{
+  GtkTextBuffer *buffer;
+  GdkPaintable *paintable;
+  GtkTextIter start, end;
+  GString *text;
+  int i, offset;
+
+  text = g_string_new (NULL);
+  for (i = 0; i < 100; i++)
+    g_string_append_printf (text, "line %d of some text\n", i);
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_enable_search_index (buffer, TRUE);
+  g_assert_true (gtk_text_buffer_get_enable_search_index (buffer));
+  gtk_text_buffer_set_text (buffer, text->str, -1);
+  g_string_free (text, TRUE);
+
+  check_search (buffer, "needle", 0, -1);
+
+  /* Lines that change are indexed again */
+  gtk_text_buffer_get_iter_at_line (buffer, &start, 50);
+  offset = gtk_text_iter_get_offset (&start);
+  gtk_text_buffer_insert (buffer, &start, "needle", -1);
+  check_search (buffer, "needle", 0, offset);
+  check_search (buffer, "NEEDLE", GTK_TEXT_SEARCH_CASE_INSENSITIVE, offset);
+  check_search (buffer, "some text\nneedle", 0, offset - 10);
+
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, offset);
+  gtk_text_buffer_get_iter_at_offset (buffer, &end, offset + 6);
+  gtk_text_buffer_delete (buffer, &start, &end);
+  check_search (buffer, "needle", 0, -1);
+
+  /* Joining lines creates new trigrams */
+  gtk_text_buffer_get_iter_at_line (buffer, &start, 20);
+  gtk_text_iter_forward_to_line_end (&start);
+  gtk_text_buffer_insert (buffer, &start, "nee", -1);
+  offset = gtk_text_iter_get_offset (&start) - 3;
+  end = start;
+  gtk_text_iter_forward_line (&end);
+  gtk_text_buffer_insert (buffer, &end, "dle", -1);
+  check_search (buffer, "needle", 0, -1);
+
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, offset + 3);
+  end = start;
+  gtk_text_iter_forward_char (&end);
+  gtk_text_buffer_delete (buffer, &start, &end);
+  check_search (buffer, "needle", 0, offset);
+
+  /* Paintables are skipped in text-only searches */
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, offset + 3);
+  paintable = gdk_paintable_new_empty (1, 1);
+  gtk_text_buffer_insert_paintable (buffer, &start, paintable);
+  g_object_unref (paintable);
+  check_search (buffer, "needle", 0, -1);
+  check_search (buffer, "needle", GTK_TEXT_SEARCH_TEXT_ONLY, offset);
+
+  /* Non-ASCII text can casefold to ASCII */
+  gtk_text_buffer_get_iter_at_line (buffer, &start, 80);
+  offset = gtk_text_iter_get_offset (&start);
+  gtk_text_buffer_insert (buffer, &start, "\342\204\252ey", -1);
+  check_search (buffer, "key", GTK_TEXT_SEARCH_CASE_INSENSITIVE, offset);
+  check_search (buffer, "key", 0, -1);
+
+  /* Limits are respected while skipping lines */
+  gtk_text_buffer_get_iter_at_line (buffer, &start, 10);
+  gtk_text_buffer_get_iter_at_line (buffer, &end, 79);
+  g_assert_false (gtk_text_iter_forward_search (&start, "key", GTK_TEXT_SEARCH_CASE_INSENSITIVE, NULL, NULL, &end));
+  gtk_text_buffer_get_iter_at_line (buffer, &end, 81);
+  g_assert_true (gtk_text_iter_forward_search (&start, "key", GTK_TEXT_SEARCH_CASE_INSENSITIVE, NULL, NULL, &end));
+  gtk_text_buffer_get_iter_at_line_offset (buffer, &end, 80, 1);
+  g_assert_false (gtk_text_iter_forward_search (&start, "key", GTK_TEXT_SEARCH_CASE_INSENSITIVE, NULL, NULL, &end));
+
+  gtk_text_buffer_get_end_iter (buffer, &start);
+  gtk_text_buffer_get_iter_at_line (buffer, &end, 81);
+  g_assert_false (gtk_text_iter_backward_search (&start, "key", GTK_TEXT_SEARCH_CASE_INSENSITIVE, NULL, NULL, &end));
+  gtk_text_buffer_get_iter_at_line (buffer, &end, 80);
+  g_assert_true (gtk_text_iter_backward_search (&start, "key", GTK_TEXT_SEARCH_CASE_INSENSITIVE, NULL, NULL, &end));
+  gtk_text_buffer_get_iter_at_line_offset (buffer, &end, 80, 1);
+  g_assert_false (gtk_text_iter_backward_search (&start, "key", GTK_TEXT_SEARCH_CASE_INSENSITIVE, NULL, NULL, &end));
+
+  gtk_text_buffer_set_enable_search_index (buffer, FALSE);
+  check_search (buffer, "key", GTK_TEXT_SEARCH_CASE_INSENSITIVE, offset);
+
+  g_object_unref (buffer);
+}
+
 static void
 test_forward_to_tag_toggle (void)
 {
@@ -841,6 +969,8 @@ main (int argc, char** argv)
   g_test_add_func ("/TextIter/Search Full Buffer", test_search_full_buffer);
   g_test_add_func ("/TextIter/Search", test_search);
   g_test_add_func ("/TextIter/Search Caseless", test_search_caseless);
+  g_test_add_func ("/TextIter/Search Indexed", test_search_indexed);
+  g_test_add_func ("/TextIter/Search Index", test_search_index);
   g_test_add_func ("/TextIter/Forward To Tag Toggle", test_forward_to_tag_toggle);
   g_test_add_func ("/TextIter/Forward To Line End", test_forward_to_line_end);
   g_test_add_func ("/TextIter/Word Boundaries", test_word_boundaries);
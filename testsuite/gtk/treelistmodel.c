@@ -613,6 +613,167 @@ test_same_child_model (void)
     g_object_unref (models[i]);
 }
 
+static void
+test_expand_all (void)
+{
+  GtkTreeListModel *tree = new_model (100, FALSE);
+  GtkTreeListRow *row;
+
+  check_model_changes (G_LIST_MODEL (tree));
+  assert_model (tree, "100");
+
+  gtk_tree_list_model_expand_all (tree);
+  assert_model (tree, "100 100 100 99 98 97 96 95 94 93 92 91 90 90 89 88 87 86 85 84 83 82 81 80 80 79 78 77 76 75 74 73 72 71 70 70 69 68 67 66 65 64 63 62 61 60 60 59 58 57 56 55 54 53 52 51 50 50 49 48 47 46 45 44 43 42 41 40 40 39 38 37 36 35 34 33 32 31 30 30 29 28 27 26 25 24 23 22 21 20 20 19 18 17 16 15 14 13 12 11 10 10 9 8 7 6 5 4 3 2 1");
+  assert_changes (tree, "1+110*");
+
+  gtk_tree_list_model_expand_all (tree);
+  assert_changes (tree, "");
+
+  gtk_tree_list_model_collapse_all (tree);
+  assert_model (tree, "100");
+  assert_changes (tree, "1-110*");
+
+  row = gtk_tree_list_model_get_row (tree, 0);
+  gtk_tree_list_row_set_expanded (row, TRUE);
+  g_object_unref (row);
+  assert_changes (tree, "1+10*");
+
+  /* everything after the first newly expanded row changes at once */
+  gtk_tree_list_model_expand_all (tree);
+  assert_model (tree, "100 100 100 99 98 97 96 95 94 93 92 91 90 90 89 88 87 86 85 84 83 82 81 80 80 79 78 77 76 75 74 73 72 71 70 70 69 68 67 66 65 64 63 62 61 60 60 59 58 57 56 55 54 53 52 51 50 50 49 48 47 46 45 44 43 42 41 40 40 39 38 37 36 35 34 33 32 31 30 30 29 28 27 26 25 24 23 22 21 20 20 19 18 17 16 15 14 13 12 11 10 10 9 8 7 6 5 4 3 2 1");
+  assert_changes (tree, "2-9+109*");
+
+  gtk_tree_list_model_collapse_all (tree);
+  assert_changes (tree, "1-110*");
+
+  g_object_unref (tree);
+}
+
+static void
+wait_for_pending (GtkTreeListModel *tree)
+{
+  GString *changes;
+
+  while (gtk_tree_list_model_get_pending (tree) > 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  /* how often the model changed depends on the time budget */
+  changes = g_object_get_qdata (G_OBJECT (tree), changes_quark);
+  g_string_set_size (changes, 0);
+}
+
+static void
+test_incremental (void)
+{
+  GtkTreeListModel *tree = new_model (100, FALSE);
+
+  check_model_changes (G_LIST_MODEL (tree));
+  gtk_tree_list_model_set_incremental (tree, TRUE);
+  g_assert_true (gtk_tree_list_model_get_incremental (tree));
+
+  /* nothing is expanded right away */
+  gtk_tree_list_model_expand_all (tree);
+  g_assert_cmpuint (gtk_tree_list_model_get_pending (tree), ==, 1);
+  assert_model (tree, "100");
+  assert_changes (tree, "");
+
+  wait_for_pending (tree);
+  assert_model (tree, "100 100 100 99 98 97 96 95 94 93 92 91 90 90 89 88 87 86 85 84 83 82 81 80 80 79 78 77 76 75 74 73 72 71 70 70 69 68 67 66 65 64 63 62 61 60 60 59 58 57 56 55 54 53 52 51 50 50 49 48 47 46 45 44 43 42 41 40 40 39 38 37 36 35 34 33 32 31 30 30 29 28 27 26 25 24 23 22 21 20 20 19 18 17 16 15 14 13 12 11 10 10 9 8 7 6 5 4 3 2 1");
+
+  /* collapsing drops pending rows */
+  gtk_tree_list_model_collapse_all (tree);
+  assert_changes (tree, "1-110*");
+  gtk_tree_list_model_expand_all (tree);
+  gtk_tree_list_model_collapse_all (tree);
+  g_assert_cmpuint (gtk_tree_list_model_get_pending (tree), ==, 0);
+  assert_model (tree, "100");
+  assert_changes (tree, "");
+
+  /* autoexpand expands incrementally, too */
+  gtk_tree_list_model_set_autoexpand (tree, TRUE);
+  gtk_tree_list_model_expand_all (tree);
+  wait_for_pending (tree);
+  assert_model (tree, "100 100 100 99 98 97 96 95 94 93 92 91 90 90 89 88 87 86 85 84 83 82 81 80 80 79 78 77 76 75 74 73 72 71 70 70 69 68 67 66 65 64 63 62 61 60 60 59 58 57 56 55 54 53 52 51 50 50 49 48 47 46 45 44 43 42 41 40 40 39 38 37 36 35 34 33 32 31 30 30 29 28 27 26 25 24 23 22 21 20 20 19 18 17 16 15 14 13 12 11 10 10 9 8 7 6 5 4 3 2 1");
+  gtk_tree_list_model_collapse_all (tree);
+  assert_changes (tree, "1-110*");
+  gtk_tree_list_model_set_autoexpand (tree, FALSE);
+
+  /* turning incremental off finishes pending work */
+  gtk_tree_list_model_expand_all (tree);
+  g_assert_cmpuint (gtk_tree_list_model_get_pending (tree), >, 0);
+  gtk_tree_list_model_set_incremental (tree, FALSE);
+  g_assert_cmpuint (gtk_tree_list_model_get_pending (tree), ==, 0);
+  assert_model (tree, "100 100 100 99 98 97 96 95 94 93 92 91 90 90 89 88 87 86 85 84 83 82 81 80 80 79 78 77 76 75 74 73 72 71 70 70 69 68 67 66 65 64 63 62 61 60 60 59 58 57 56 55 54 53 52 51 50 50 49 48 47 46 45 44 43 42 41 40 40 39 38 37 36 35 34 33 32 31 30 30 29 28 27 26 25 24 23 22 21 20 20 19 18 17 16 15 14 13 12 11 10 10 9 8 7 6 5 4 3 2 1");
+  assert_changes (tree, "1+110*");
+
+  g_object_unref (tree);
+}
+
+static void
+expand_roots (GtkTreeListModel *tree)
+{
+  GtkTreeListRow *row;
+  guint i;
+
+  for (i = 0; (row = gtk_tree_list_model_get_child_row (tree, i)); i++)
+    {
+      gtk_tree_list_row_set_expanded (row, TRUE);
+      g_object_unref (row);
+    }
+}
+
+static void
+test_incremental_many_roots (void)
+{
+  GtkTreeListModel *tree, *expected;
+  char *expected_string, *s;
+
+  expected = gtk_tree_list_model_new (G_LIST_MODEL (new_store (100, 300, 100)), TRUE, FALSE, create_sub_model_cb, NULL, NULL);
+  gtk_tree_list_model_expand_all (expected);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (expected)), ==, 333);
+  expected_string = model_to_string (G_LIST_MODEL (expected));
+  g_object_unref (expected);
+
+  tree = gtk_tree_list_model_new (G_LIST_MODEL (new_store (100, 300, 100)), TRUE, FALSE, create_sub_model_cb, NULL, NULL);
+  gtk_tree_list_model_set_incremental (tree, TRUE);
+  /* every emission must match the model at the time it is emitted */
+  check_model_changes (G_LIST_MODEL (tree));
+
+  /* all roots are pending */
+  gtk_tree_list_model_expand_all (tree);
+  g_assert_cmpuint (gtk_tree_list_model_get_pending (tree), ==, 3);
+  while (gtk_tree_list_model_get_pending (tree) > 0)
+    g_main_context_iteration (NULL, TRUE);
+  s = model_to_string (G_LIST_MODEL (tree));
+  g_assert_cmpstr (s, ==, expected_string);
+  g_free (s);
+
+  /* the children of several expanded rows are pending */
+  gtk_tree_list_model_collapse_all (tree);
+  expand_roots (tree);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (tree)), ==, 33);
+  gtk_tree_list_model_expand_all (tree);
+  g_assert_cmpuint (gtk_tree_list_model_get_pending (tree), ==, 30);
+  while (gtk_tree_list_model_get_pending (tree) > 0)
+    g_main_context_iteration (NULL, TRUE);
+  s = model_to_string (G_LIST_MODEL (tree));
+  g_assert_cmpstr (s, ==, expected_string);
+  g_free (s);
+
+  /* autoexpand */
+  gtk_tree_list_model_collapse_all (tree);
+  gtk_tree_list_model_set_autoexpand (tree, TRUE);
+  expand_roots (tree);
+  while (gtk_tree_list_model_get_pending (tree) > 0)
+    g_main_context_iteration (NULL, TRUE);
+  s = model_to_string (G_LIST_MODEL (tree));
+  g_assert_cmpstr (s, ==, expected_string);
+  g_free (s);
+
+  g_object_unref (tree);
+  g_free (expected_string);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -627,6 +788,9 @@ main (int argc, char *argv[])
   g_test_add_func ("/treelistmodel/remove_splice", test_splice);
   g_test_add_func ("/treelistmodel/collapse-change", test_collapse_change);
   g_test_add_func ("/treelistmodel/same-child-model", test_same_child_model);
+  g_test_add_func ("/treelistmodel/expand-all", test_expand_all);
+  g_test_add_func ("/treelistmodel/incremental", test_incremental);
+  g_test_add_func ("/treelistmodel/incremental-many-roots", test_incremental_many_roots);
 
   return g_test_run ();
 }